@@ -385,7 +385,10 @@ function should_attack( enemy, si, aggressor )
       end
       local lmd = mem.leadermaxdist
       if lmd then
-         local d = l:pos():dist2( enemy:pos() )
+         local lx, ly = l:posxy()
+         local ex, ey = enemy:posxy()
+         local dx, dy = lx-ex, ly-ey
+         local d = dx*dx + dy*dy
          if d > lmd*lmd then
             return false
          end
@@ -0,0 +1,15 @@
+#include "lib/sdf.glsl"
+
+uniform vec2 dimensions;
+
+in vec4 colour;
+out vec4 colour_out;
+
+/* Same as asteroidmarker.frag, but drawn as a batch of points. */
+void main(void) {
+   vec2 uv = (gl_PointCoord*2.0-1.0) * dimensions;
+   float d = sdBox( uv, dimensions-vec2(2.0) );
+   float alpha = smoothstep(-1.0,  0.0, -d);
+   float beta  = smoothstep(-2.0, -1.0, -d);
+   colour_out   = colour * vec4( vec3(alpha), beta );
+}
@@ -1,10 +1,15 @@
-uniform mat4 projection;
-
 in vec4 vertex;
 in vec2 tex_coord;
+in float vertex_m;
+in vec4 vertex_colour;
 out vec2 tex_coord_out;
+out float m;
+out vec4 colour;
 
 void main(void) {
    tex_coord_out = tex_coord;
-   gl_Position = projection * vertex;
+   m = vertex_m;
+   colour = vertex_colour;
+   // Glyphs are projected on the CPU when batched.
+   gl_Position = vertex;
 }
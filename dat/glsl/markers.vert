@@ -0,0 +1,11 @@
+in vec4 vertex;
+in vec4 vertex_colour;
+uniform mat4 projection;
+uniform float size;
+out vec4 colour;
+
+void main(void) {
+   colour = vertex_colour;
+   gl_PointSize = size;
+   gl_Position = projection * vertex;
+}
@@ -20,17 +20,15 @@ subroutine uniform trail_func_prototype trail_func;
 
 // For ideas: https://thebookofshaders.com/05/
 
-uniform vec4 c1;  // Start colour
-uniform vec4 c2;  // End colour
-uniform float t1; // Start time [0,1]
-uniform float t2; // End time [0,1]
-uniform float dt; // Current time (in seconds)
-uniform vec2 pos1;// Start position
-uniform vec2 pos2;// End position
-uniform float r;  // Unique value per trail [0,1]
 uniform vec3 nebu_col; // Base colour of the nebula, only changes when entering new system
 
 in vec2 pos;
+in vec4 trail_colour; // Colour along the segment
+in float trail_t;     // Time along the segment [0,1]
+in float trail_len;   // Length of the trail up to here (in pixels)
+in vec2 trail_thick;  // Thickness at the start and end of the segment
+in float dt;          // Current time (in seconds)
+in float r;           // Unique value per trail [0,1]
 out vec4 colour_out;
 
 /* Has a peak at 1/k */
@@ -267,11 +265,11 @@ vec4 trail_split( vec4 colour, vec2 pos_tex, vec2 pos_px )
 void main(void) {
    vec2 pos_tex, pos_px;
 
-   // Interpolate
-   colour_out = mix( c1, c2, pos.x );
-   pos_px    = mix( pos1, pos2, pos );
-   pos_px.y *= pos.y;
-   pos_tex.x = mix( t1, t2, pos.x );
+   // Interpolated by the rasterizer, except for the thickness
+   colour_out = trail_colour;
+   pos_px.x  = trail_len;
+   pos_px.y  = mix( trail_thick.x, trail_thick.y, pos.y ) * pos.y;
+   pos_tex.x = trail_t;
    pos_tex.y = 2. * pos.y - 1.;
 
 #ifdef HAS_GL_ARB_shader_subroutine
@@ -0,0 +1,27 @@
+uniform mat4 projection;
+
+in vec4 vertex;
+in vec2 vertex_pos;
+in vec4 vertex_colour;
+in vec2 vertex_time;
+in vec2 vertex_thick;
+in vec2 vertex_param;
+out vec2 pos;
+out vec4 trail_colour;
+out float trail_t;
+out float trail_len;
+out vec2 trail_thick;
+out float dt;
+out float r;
+
+void main(void) {
+   // Segments are built on the CPU, everything else is per segment or trail.
+   pos          = vertex_pos;
+   trail_colour = vertex_colour;
+   trail_t      = vertex_time.x;
+   trail_len    = vertex_time.y;
+   trail_thick  = vertex_thick;
+   dt           = vertex_param.x;
+   r            = vertex_param.y;
+   gl_Position  = projection * vertex;
+}
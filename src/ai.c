@@ -108,7 +108,6 @@
  */
 static AI_Profile *profiles  = NULL;      /**< Array of AI_Profiles loaded. */
 static nlua_env    equip_env = LUA_NOREF; /**< Equipment enviornment. */
-static IntList     ai_qtquery;            /**< Quadtree query. */
 static double ai_dt = 0.; /**< Current update tick, useful in some cases. **/
 
 /*
@@ -638,9 +637,6 @@ int ai_load( void )
              array_size( profiles ) );
 #endif /* DEBUGGING */
 
-   /* Create collision stuff. */
-   il_create( &ai_qtquery, 1 );
-
    /* Load equipment thingy. */
    ai_loadEquip();
 
@@ -664,7 +660,7 @@ static int ai_loadEquip( void )
    nlua_freeEnv( equip_env );
 
    /* Create new state. */
-   equip_env = nlua_newEnv();
+   equip_env = nlua_newEnv( "equip" );
    nlua_loadStandard( equip_env );
 
    /* Load the file. */
@@ -712,7 +708,7 @@ static int ai_loadProfile( AI_Profile *prof, const char *filename )
    prof->name[len] = '\0';
 
    /* Create Lua. */
-   env = nlua_newEnv();
+   env = nlua_newEnv( filename );
    nlua_loadStandard( env );
    prof->env = env;
 
@@ -798,9 +794,6 @@ void ai_exit( void )
    /* Free equipment Lua. */
    nlua_freeEnv( equip_env );
    equip_env = LUA_NOREF;
-
-   /* Clean up query stuff. */
-   il_destroy( &ai_qtquery );
 }
 
 /**
@@ -1488,6 +1481,21 @@ static int aiL_getrndpilot( lua_State *L )
    return 1;
 }
 
+/**
+ * @brief Quadtree filter for aiL_getnearestpilot.
+ */
+static double ai_nearestFilter( void *data, int id )
+{
+   Pilot *const *pilot_stack = pilot_getAll();
+   const Pilot  *p;
+   (void)data;
+
+   p = pilot_stack[id];
+   if ( p->id == cur_pilot->id )
+      return -1.;
+   return vec2_dist2( &p->solid.pos, &cur_pilot->solid.pos );
+}
+
 /**
  * @brief gets the nearest pilot to the current pilot
  *
@@ -1496,23 +1504,11 @@ static int aiL_getrndpilot( lua_State *L )
  */
 static int aiL_getnearestpilot( lua_State *L )
 {
-   /* dist will be initialized to a number */
-   /* this will only seek out pilots closer than dist */
-   Pilot *const *pilot_stack  = pilot_getAll();
-   int           dist         = 1e6;
-   int           candidate_id = -1;
-
-   /*cycle through all the pilots and find the closest one that is not the pilot
-    */
-   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
-      if ( pilot_stack[i]->id == cur_pilot->id )
-         continue;
-      if ( vec2_dist( &pilot_stack[i]->solid.pos, &cur_pilot->solid.pos ) >
-           dist )
-         continue;
-      dist = vec2_dist( &pilot_stack[i]->solid.pos, &cur_pilot->solid.pos );
-      candidate_id = i;
-   }
+   /* this will only seek out pilots closer than 1e6 */
+   Pilot *const *pilot_stack = pilot_getAll();
+   int candidate_id = pilot_collideNearest( cur_pilot->solid.pos.x,
+                                            cur_pilot->solid.pos.y, pow2( 1e6 ),
+                                            ai_nearestFilter, NULL, NULL );
 
    /* Last check. */
    if ( candidate_id == -1 )
@@ -1934,11 +1930,11 @@ static int aiL_face( lua_State *L )
  */
 static int aiL_careful_face( lua_State *L )
 {
-   vec2         *tv, F, F1;
-   Pilot        *p;
-   double        d, diff, dist;
-   Pilot *const *pilot_stack;
-   int           x, y, r;
+   vec2              *tv, F, F1;
+   Pilot             *p;
+   double             d, diff, dist;
+   const PilotSensed *sensed;
+   int                n;
 
    /* Default gains. */
    const double k_diff  = 1. / ( cur_pilot->turn * ai_dt );
@@ -1946,8 +1942,7 @@ static int aiL_careful_face( lua_State *L )
    const double k_enemy = 6e6;
 
    /* Init some variables */
-   pilot_stack = pilot_getAll();
-   p           = cur_pilot;
+   p = cur_pilot;
 
    /* Get first parameter, aka what to face. */
    if ( lua_ispilot( L, 1 ) ) {
@@ -1972,16 +1967,16 @@ static int aiL_careful_face( lua_State *L )
    dist = VMOD( F1 ) + 0.1; /* Avoid / 0 */
    vec2_cset( &F1, F1.x * k_goal / dist, F1.y * k_goal / dist );
 
-   /* Cycle through all the pilots in order to compute the force */
-   x = round( cur_pilot->solid.pos.x );
-   y = round( cur_pilot->solid.pos.y );
-   /* It's modulated by k_enemy * k_mult / dist^2, where k_mult<1 and
+   /* Cycle through all the sensed pilots in order to compute the force.
+    * It's modulated by k_enemy * k_mult / dist^2, where k_mult<1 and
     * k_enemy=6e6 A distance of 5000 should give a maximum factor of 0.24, but
     * it should be far away enough to not matter (hopefully).. */
-   r = 5000;
-   pilot_collideQueryIL( &ai_qtquery, x - r, y - r, x + r, y + r );
-   for ( int i = 0; i < il_size( &ai_qtquery ); i++ ) {
-      const Pilot *p_i = pilot_stack[il_get( &ai_qtquery, i, 0 )];
+   sensed = pilot_sensed( cur_pilot, &n );
+   for ( int i = 0; i < n; i++ ) {
+      const Pilot *p_i = sensed[i].p;
+
+      if ( sensed[i].dist2 > pow2( 5000. ) )
+         break;
 
       /* Valid pilot isn't self, is in range, isn't the target and isn't
        * disabled */
@@ -1991,8 +1986,9 @@ static int aiL_careful_face( lua_State *L )
          continue;
       if ( pilot_isDisabled( p_i ) )
          continue;
-      if ( pilot_inRangePilot( cur_pilot, p_i, &dist ) != 1 )
+      if ( sensed[i].inrange != 1 )
          continue;
+      dist = sensed[i].dist2;
 
       /* If the enemy is too close, ignore it*/
       if ( dist < pow2( 750. ) )
@@ -2432,8 +2428,8 @@ static int aiL_getlandspob( lua_State *L )
    /* Check if we should get only friendlies. */
    only_friend = lua_toboolean( L, 1 );
 
-   /* Allocate memory. */
-   ind = array_create_size( int, array_size( cur_system->spobs ) );
+   /* Scratch memory, released at the end of the frame. */
+   ind = array_create_frame( int, array_size( cur_system->spobs ) );
 
    /* Copy friendly spob.s */
    for ( int i = 0; i < array_size( cur_system->spobs ); i++ ) {
@@ -2456,10 +2452,8 @@ static int aiL_getlandspob( lua_State *L )
    }
 
    /* no spob to land on found */
-   if ( array_size( ind ) == 0 ) {
-      array_free( ind );
+   if ( array_size( ind ) == 0 )
       return 0;
-   }
 
    /* we can actually get a random spob now */
    id   = RNG( 0, array_size( ind ) - 1 );
@@ -2467,7 +2461,6 @@ static int aiL_getlandspob( lua_State *L )
    spob = p->id;
    lua_pushspob( L, spob );
    cur_pilot->nav_spob = ind[id];
-   array_free( ind );
 
    return 1;
 }
@@ -2700,8 +2693,8 @@ static int aiL_rndhyptarget( lua_State *L )
    useshidden = faction_usesHiddenJumps( cur_pilot->faction );
 
    /* Find usable jump points. */
-   jumps = array_create_size( JumpPoint *, array_size( cur_system->jumps ) );
-   id    = array_create_size( int, array_size( cur_system->jumps ) );
+   jumps = array_create_frame( JumpPoint *, array_size( cur_system->jumps ) );
+   id    = array_create_frame( int, array_size( cur_system->jumps ) );
    for ( int i = 0; i < array_size( cur_system->jumps ); i++ ) {
       JumpPoint *jiter = &cur_system->jumps[i];
 
@@ -2745,10 +2738,6 @@ static int aiL_rndhyptarget( lua_State *L )
    lj.destid = jumps[r]->targetid;
    lj.srcid  = cur_system->id;
 
-   /* Clean up. */
-   array_free( jumps );
-   array_free( id );
-
    /* Return Jump. */
    lua_pushjump( L, lj );
    return 1;
@@ -3163,35 +3152,24 @@ static int aiL_getenemy( lua_State *L )
       lua_pushpilot( L, id );
       return 1;
    } else {
-      double        range = luaL_checknumber( L, 1 );
-      double        r2    = pow2( range );
-      unsigned int  tp    = 0;
-      double        d     = 0.;
-      int           x, y, r;
-      Pilot *const *pilot_stack = pilot_getAll();
-
-      r = ceil( range );
-      x = round( cur_pilot->solid.pos.x );
-      y = round( cur_pilot->solid.pos.y );
-      pilot_collideQueryIL( &ai_qtquery, x - r, y - r, x + r, y + r );
-      for ( int i = 0; i < il_size( &ai_qtquery ); i++ ) {
-         const Pilot *p = pilot_stack[il_get( &ai_qtquery, i, 0 )];
-         double       td;
-
-         if ( vec2_dist2( &p->solid.pos, &cur_pilot->solid.pos ) > r2 )
-            continue;
+      double             range = luaL_checknumber( L, 1 );
+      double             r2    = pow2( range );
+      int                n;
+      const PilotSensed *sensed = pilot_sensed( cur_pilot, &n );
+
+      /* Contacts are sorted by distance so the first valid one is the
+       * nearest. */
+      for ( int i = 0; i < n; i++ ) {
+         if ( sensed[i].dist2 > r2 )
+            break;
 
-         if ( !pilot_validEnemy( cur_pilot, p ) )
+         if ( !pilot_validEnemy( cur_pilot, sensed[i].p ) )
             continue;
 
-         /* Check distance. */
-         td = vec2_dist2( &p->solid.pos, &cur_pilot->solid.pos );
-         if ( !tp || ( td < d ) ) {
-            d  = td;
-            tp = p->id;
-         }
+         lua_pushpilot( L, sensed[i].p->id );
+         return 1;
       }
-      return tp;
+      return 0;
    }
 }
 
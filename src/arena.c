@@ -0,0 +1,166 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file arena.c
+ *
+ * @brief Frame-scoped scratch memory.
+ *
+ * Bump allocator for short-lived buffers that are only needed during a frame,
+ * such as temporary tables built by the AI. Memory is never freed
+ * individually, instead everything is released at the end of the frame. Nested
+ * main loops only rewind to where they started, so the memory of the frame
+ * that started them stays valid.
+ *
+ * Chunks are kept between frames, so once the arena has grown to the peak
+ * usage frames do no heap allocations. It is not thread-safe and must only be
+ * used from the main thread.
+ */
+/** @cond */
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "arena.h"
+
+#include "log.h"
+#include "ntracing.h"
+
+#define ARENA_CHUNK_MIN ( 256 * 1024 ) /**< Size of the first chunk. */
+#define ARENA_CHUNK_MAX 24 /**< Maximum number of chunks, each doubling. */
+#define ARENA_ALIGN alignof( max_align_t ) /**< Alignment of allocations. */
+
+/**
+ * @brief Contiguous block of arena memory.
+ */
+typedef struct ArenaChunk_ {
+   char  *data; /**< Memory of the chunk. */
+   size_t size; /**< Size of the chunk. */
+   size_t used; /**< Bytes used. */
+} ArenaChunk;
+
+static ArenaChunk arena_chunks[ARENA_CHUNK_MAX]; /**< Chunks of the arena. */
+static int        arena_nchunks = 0; /**< Number of chunks. */
+static int        arena_cur     = 0; /**< Chunk being allocated from. */
+static size_t     arena_used    = 0; /**< Bytes used in previous chunks. */
+static size_t     arena_max     = 0; /**< Peak usage. */
+
+/**
+ * @brief Adds a new chunk able to hold at least size bytes.
+ */
+static void arena_addChunk( size_t size )
+{
+   ArenaChunk *c;
+   size_t      csize = ARENA_CHUNK_MIN;
+   if ( arena_nchunks >= ARENA_CHUNK_MAX )
+      ERR( _( "Frame arena ran out of chunks!" ) );
+   if ( arena_nchunks > 0 )
+      csize = 2 * arena_chunks[arena_nchunks - 1].size;
+   while ( csize < size )
+      csize *= 2;
+
+   c       = &arena_chunks[arena_nchunks];
+   c->data = nmalloc( csize );
+   c->size = csize;
+   c->used = 0;
+   arena_nchunks++;
+}
+
+/**
+ * @brief Allocates scratch memory that is valid until the end of the frame.
+ *
+ *    @param size Size to allocate.
+ *    @return Allocated memory, aligned for any type.
+ */
+void *arena_alloc( size_t size )
+{
+   size = ( size + ARENA_ALIGN - 1 ) & ~( ARENA_ALIGN - 1 );
+   if ( arena_nchunks == 0 )
+      arena_addChunk( size );
+
+   for ( ;; ) {
+      ArenaChunk *c = &arena_chunks[arena_cur];
+      if ( c->used + size <= c->size ) {
+         void *ptr = c->data + c->used;
+         c->used += size;
+         arena_max = MAX( arena_max, arena_used + c->used );
+         return ptr;
+      }
+
+      /* Move on to the next chunk, reusing the ones of previous frames. */
+      arena_used += c->used;
+      arena_cur++;
+      if ( arena_cur >= arena_nchunks )
+         arena_addChunk( size );
+      else
+         arena_chunks[arena_cur].used = 0;
+   }
+}
+
+/**
+ * @brief Allocates zeroed scratch memory that is valid until the end of the
+ * frame.
+ */
+void *arena_calloc( size_t nmemb, size_t size )
+{
+   void *ptr = arena_alloc( nmemb * size );
+   memset( ptr, 0, nmemb * size );
+   return ptr;
+}
+
+/**
+ * @brief Gets the current position of the arena.
+ */
+ArenaMark arena_mark( void )
+{
+   ArenaMark mark;
+   mark.chunk = arena_cur;
+   mark.used  = ( arena_nchunks == 0 ) ? 0 : arena_chunks[arena_cur].used;
+   return mark;
+}
+
+/**
+ * @brief Releases all the memory allocated since a mark.
+ */
+void arena_release( ArenaMark mark )
+{
+   if ( arena_nchunks == 0 )
+      return;
+   arena_cur                    = mark.chunk;
+   arena_chunks[arena_cur].used = mark.used;
+   arena_used                   = 0;
+   for ( int i = 0; i < arena_cur; i++ )
+      arena_used += arena_chunks[i].used;
+}
+
+/**
+ * @brief Releases all the memory of the arena, done at the end of the frame.
+ */
+void arena_reset( void )
+{
+   ArenaMark mark = { .chunk = 0, .used = 0 };
+   arena_release( mark );
+}
+
+/**
+ * @brief Gets the peak usage of the arena in bytes.
+ */
+size_t arena_peak( void )
+{
+   return arena_max;
+}
+
+/**
+ * @brief Frees all the memory of the arena.
+ */
+void arena_free( void )
+{
+   for ( int i = 0; i < arena_nchunks; i++ )
+      nfree( arena_chunks[i].data );
+   arena_nchunks = 0;
+   arena_cur     = 0;
+   arena_used    = 0;
+}
@@ -0,0 +1,24 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+/**
+ * @brief Position in the frame arena that can be rewound to.
+ */
+typedef struct ArenaMark_ {
+   int    chunk; /**< Chunk being used. */
+   size_t used;  /**< Bytes used in the chunk. */
+} ArenaMark;
+
+void     *arena_alloc( size_t size );
+void     *arena_calloc( size_t nmemb, size_t size );
+ArenaMark arena_mark( void );
+void      arena_release( ArenaMark mark );
+void      arena_reset( void );
+size_t    arena_peak( void );
+void      arena_free( void );
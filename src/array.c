@@ -12,9 +12,22 @@
 
 #include "array.h"
 
+#include "arena.h"
 #include "nstring.h"
 #include "ntracing.h"
 
+static void *_array_init_container( _private_container *c, size_t capacity,
+                                    int frame )
+{
+#if DEBUG_ARRAYS
+   c->_sentinel = ARRAY_SENTINEL;
+#endif
+   c->_reserved = capacity;
+   c->_size     = 0;
+   c->_frame    = frame;
+   return c->_array;
+}
+
 void *_array_create_helper( size_t e_size, size_t capacity )
 {
    if ( capacity <= 0 )
@@ -22,13 +35,31 @@ void *_array_create_helper( size_t e_size, size_t capacity )
 
    _private_container *c =
       nmalloc( sizeof( _private_container ) + e_size * capacity );
+   return _array_init_container( c, capacity, 0 );
+}
 
-#if DEBUG_ARRAYS
-   c->_sentinel = ARRAY_SENTINEL;
-#endif
-   c->_reserved = capacity;
-   c->_size     = 0;
-   return c->_array;
+void *_array_create_frame_helper( size_t e_size, size_t capacity )
+{
+   if ( capacity <= 0 )
+      capacity = 1;
+
+   _private_container *c =
+      arena_alloc( sizeof( _private_container ) + e_size * capacity );
+   return _array_init_container( c, capacity, 1 );
+}
+
+/* Reallocates the container to fit its reserved elements, copying arrays
+ * from the frame arena since they can't be reallocated in place. */
+static _private_container *_array_realloc_container( _private_container *c,
+                                                     size_t e_size,
+                                                     size_t size )
+{
+   if ( c->_frame ) {
+      _private_container *n =
+         arena_alloc( sizeof( _private_container ) + e_size * c->_reserved );
+      return memcpy( n, c, sizeof( _private_container ) + e_size * size );
+   }
+   return nrealloc( c, sizeof( _private_container ) + e_size * c->_reserved );
 }
 
 static void _array_resize_container( _private_container **c_, size_t e_size,
@@ -43,7 +74,7 @@ static void _array_resize_container( _private_container **c_, size_t e_size,
          c->_reserved *= 2;
       while ( new_size > c->_reserved );
 
-      c = nrealloc( c, sizeof( _private_container ) + e_size * c->_reserved );
+      c = _array_realloc_container( c, e_size, c->_size );
    }
 
    c->_size = new_size;
@@ -63,7 +94,7 @@ void *_array_grow_helper( void **a, size_t e_size )
    if ( c->_size == c->_reserved ) {
       /* Array full, doubles the reserved memory */
       c->_reserved *= 2;
-      c  = nrealloc( c, sizeof( _private_container ) + e_size * c->_reserved );
+      c  = _array_realloc_container( c, e_size, c->_size );
       *a = c->_array;
    }
 
@@ -90,6 +121,9 @@ void _array_erase_helper( void **a, size_t e_size, void *first, void *last )
 void _array_shrink_helper( void **a, size_t e_size )
 {
    _private_container *c = _array_private_container( *a );
+   /* Frame arrays are released at the end of the frame anyway. */
+   if ( c->_frame )
+      return;
    if ( c->_size != 0 ) {
       c = nrealloc( c, sizeof( _private_container ) + e_size * c->_size );
       c->_reserved = c->_size;
@@ -104,7 +138,10 @@ void _array_free_helper( void *a )
 {
    if ( a == NULL )
       return;
-   nfree( _array_private_container( a ) );
+   _private_container *c = _array_private_container( a );
+   if ( c->_frame )
+      return;
+   nfree( c );
 }
 
 void *_array_copy_helper( size_t e_size, void *a )
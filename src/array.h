@@ -54,10 +54,12 @@ typedef struct {
 #endif                                   /* DEBUG_ARRAYS */
    size_t _reserved;                     /**< Number of elements reserved */
    size_t _size;                         /**< Number of elements in the array */
+   int    _frame;                        /**< Whether in the frame arena */
    char alignas( max_align_t ) _array[]; /**< Begin of the array */
 } _private_container;
 
 void *_array_create_helper( size_t e_size, size_t initial_size );
+void *_array_create_frame_helper( size_t e_size, size_t initial_size );
 void *_array_grow_helper( void **a, size_t e_size );
 void  _array_resize_helper( void **a, size_t e_size, size_t new_size );
 void  _array_erase_helper( void **a, size_t e_size, void *first, void *last );
@@ -101,6 +103,18 @@ static inline _private_container *_array_private_container( void *a )
  */
 #define array_create_size( basic_type, capacity )                              \
    ( (basic_type *)( _array_create_helper( sizeof( basic_type ), capacity ) ) )
+/**
+ * @brief Creates a new dynamic array of `basic_type' in the frame arena.
+ *
+ * The array is only valid until the end of the frame. It can be manipulated
+ * like any other array, and array_free() does nothing on it.
+ *
+ *    @param basic_type Type of the array to create.
+ *    @param capacity Initial size.
+ */
+#define array_create_frame( basic_type, capacity )                             \
+   ( (basic_type *)( _array_create_frame_helper( sizeof( basic_type ),         \
+                                                 capacity ) ) )
 /**
  * @brief Resizes the array to accomodate new_size elements.
  *
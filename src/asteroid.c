@@ -866,11 +866,13 @@ void asteroids_renderOverlay( void )
    NTracingZone( _ctx, 1 );
 
    /* Render the debris. */
+   gl_batchBegin();
    for ( int j = 0; j < array_size( debris_stack ); j++ ) {
       const Debris *d = &debris_stack[j];
       if ( d->height > 1. )
          debris_renderSingle( d, cx, cy );
    }
+   gl_batchEnd();
 
    NTracingZoneEnd( _ctx );
 }
@@ -906,11 +908,13 @@ void asteroids_render( void )
    }
 
    /* Render the debris. */
+   gl_batchBegin();
    for ( int j = 0; j < array_size( debris_stack ); j++ ) {
       const Debris *d = &debris_stack[j];
       if ( d->height <= 1. )
          debris_renderSingle( d, cx, cy );
    }
+   gl_batchEnd();
 
    /* Render gatherable stuff. */
    gatherable_render();
@@ -993,8 +997,8 @@ static void debris_renderSingle( const Debris *d, double cx, double cy )
    const double   scale = 0.5;
    const glColour col   = COL_ALPHA( cInert, d->alpha );
 
-   gl_renderSpriteScaleRotate( d->gfx, d->pos.x + cx, d->pos.y + cy, scale,
-                               scale, d->ang, 0, 0, &col );
+   gl_batchSpriteScaleRotate( d->gfx, d->pos.x + cx, d->pos.y + cy, scale,
+                              scale, d->ang, 0, 0, &col );
 }
 
 /**
@@ -1255,3 +1259,25 @@ void asteroid_collideQueryIL( AsteroidAnchor *anc, IntList *il, int x1, int y1,
 {
    qt_query( &anc->qt, il, x1, y1, x2, y2 );
 }
+
+/**
+ * @brief Gets the nearest foreground asteroid of a field that passes a filter.
+ *
+ *    @param anc Asteroid field to look in.
+ *    @param x X position to look from.
+ *    @param y Y position to look from.
+ *    @param max_dist2 Maximum squared distance or negative for no limit.
+ *    @param func Filter that returns the squared distance to an asteroid or a
+ * negative value to skip it.
+ *    @param data User data for the filter.
+ *    @param[out] dist2 Squared distance to the nearest asteroid.
+ *    @return Index of the nearest asteroid or -1 if none found.
+ */
+int asteroid_collideNearest( AsteroidAnchor *anc, double x, double y,
+                             double max_dist2, QtNearFunc *func, void *data,
+                             double *dist2 )
+{
+   if ( !anc->qt_init )
+      return -1;
+   return qt_nearest( &anc->qt, x, y, max_dist2, func, data, dist2 );
+}
@@ -165,3 +165,6 @@ void asteroid_hit( Asteroid *a, const Damage *dmg, int max_rarity,
 void asteroid_explode( Asteroid *a, int max_rarity, double mine_bonus );
 void asteroid_collideQueryIL( AsteroidAnchor *anc, IntList *il, int x1, int y1,
                               int x2, int y2 );
+int  asteroid_collideNearest( AsteroidAnchor *anc, double x, double y,
+                              double max_dist2, QtNearFunc *func, void *data,
+                              double *dist2 );
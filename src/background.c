@@ -404,7 +404,7 @@ static nlua_env background_create( const char *name )
    snprintf( path, sizeof( path ), BACKGROUND_PATH "%s.lua", name );
 
    /* Create the Lua env. */
-   env = nlua_newEnv();
+   env = nlua_newEnv( path );
    nlua_loadStandard( env );
    nlua_loadTex( env );
    nlua_loadCol( env );
@@ -81,7 +81,7 @@ int board_hook( void *data )
 
    /* Set up environment first time. */
    if ( board_env == LUA_NOREF ) {
-      board_env = nlua_newEnv();
+      board_env = nlua_newEnv( "board" );
       nlua_loadStandard( board_env );
 
       size_t bufsize;
@@ -152,6 +152,8 @@ void conf_setDefaults( void )
    conf.devautosave              = 0;
    conf.lua_enet                 = 0;
    conf.lua_repl                 = 0;
+   conf.data_cache               = 1;
+   conf.data_cache_verify        = 0;
    conf.lastversion              = strdup( "" );
    conf.translation_warning_seen = 0;
    memset( &conf.last_played, 0, sizeof( time_t ) );
@@ -190,6 +192,8 @@ void conf_setGameplayDefaults( void )
    conf.mouse_doubleclick = MOUSE_DOUBLECLICK_TIME;
    conf.mouse_fly         = MOUSE_FLY_DEFAULT;
    conf.zoom_manual       = MANUAL_ZOOM_DEFAULT;
+   conf.lod_distance      = LOD_DISTANCE_DEFAULT;
+   conf.lod_dt            = LOD_DT_DEFAULT;
 }
 
 /**
@@ -260,8 +264,9 @@ void conf_setVideoDefaults( void )
       background_load( cur_system->background );
 
    /* FPS. */
-   conf.fps_show = SHOW_FPS_DEFAULT;
-   conf.fps_max  = FPS_MAX_DEFAULT;
+   conf.fps_show      = SHOW_FPS_DEFAULT;
+   conf.fps_max       = FPS_MAX_DEFAULT;
+   conf.lua_gc_budget = LUA_GC_BUDGET_DEFAULT;
 
    /* Pause. */
    conf.pause_show = SHOW_PAUSE_DEFAULT;
@@ -285,7 +290,7 @@ void conf_loadConfigPath( void )
    if ( !nfile_fileExists( file ) )
       return;
 
-   nlua_env lEnv = nlua_newEnv();
+   nlua_env lEnv = nlua_newEnv( file );
    if ( nlua_dofileenv( lEnv, file ) == 0 )
       conf_loadString( lEnv, "datapath", conf.datapath );
 
@@ -310,7 +315,7 @@ int conf_loadConfig( const char *file )
    }
 
    /* Load the configuration. */
-   nlua_env lEnv = nlua_newEnv();
+   nlua_env lEnv = nlua_newEnv( file );
    if ( nlua_dofileenv( lEnv, file ) == 0 ) {
 
       /* ndata. */
@@ -372,6 +377,7 @@ int conf_loadConfig( const char *file )
       /* FPS */
       conf_loadBool( lEnv, "showfps", conf.fps_show );
       conf_loadInt( lEnv, "maxfps", conf.fps_max );
+      conf_loadFloat( lEnv, "lua_gc_budget", conf.lua_gc_budget );
 
       /*  Pause */
       conf_loadBool( lEnv, "showpause", conf.pause_show );
@@ -429,10 +435,14 @@ int conf_loadConfig( const char *file )
       conf_loadFloat( lEnv, "mouse_doubleclick", conf.mouse_doubleclick );
       conf_loadFloat( lEnv, "autonav_reset_dist", conf.autonav_reset_dist );
       conf_loadFloat( lEnv, "autonav_reset_shield", conf.autonav_reset_shield );
+      conf_loadFloat( lEnv, "lod_distance", conf.lod_distance );
+      conf_loadFloat( lEnv, "lod_dt", conf.lod_dt );
       conf_loadBool( lEnv, "devmode", conf.devmode );
       conf_loadBool( lEnv, "devautosave", conf.devautosave );
       conf_loadBool( lEnv, "lua_enet", conf.lua_enet );
       conf_loadBool( lEnv, "lua_repl", conf.lua_repl );
+      conf_loadBool( lEnv, "data_cache", conf.data_cache );
+      conf_loadBool( lEnv, "data_cache_verify", conf.data_cache_verify );
       conf_loadBool( lEnv, "conf_nosave", conf.nosave );
       conf_loadString( lEnv, "lastversion", conf.lastversion );
       conf_loadBool( lEnv, "translation_warning_seen",
@@ -1026,6 +1036,13 @@ int conf_saveConfig( const char *file )
    conf_saveInt( "maxfps", conf.fps_max );
    conf_saveEmptyLine();
 
+   conf_saveComment(
+      _( "Maximum time in milliseconds per frame to spend collecting Lua "
+         "garbage while waiting for the next frame. A value of 0 leaves it to "
+         "the Lua collector." ) );
+   conf_saveFloat( "lua_gc_budget", conf.lua_gc_budget );
+   conf_saveEmptyLine();
+
    /* Pause */
    conf_saveComment( _( "Show 'PAUSED' on screen while paused" ) );
    conf_saveBool( "showpause", conf.pause_show );
@@ -1149,6 +1166,17 @@ int conf_saveConfig( const char *file )
    conf_saveFloat( "mouse_doubleclick", conf.mouse_doubleclick );
    conf_saveEmptyLine();
 
+   conf_saveComment( _( "Distance from the player beyond which idle pilots "
+                        "are simulated with larger time steps during time "
+                        "compression (0 disables)." ) );
+   conf_saveFloat( "lod_distance", conf.lod_distance );
+   conf_saveEmptyLine();
+
+   conf_saveComment(
+      _( "Longest time step in seconds for pilots simulated that way." ) );
+   conf_saveFloat( "lod_dt", conf.lod_dt );
+   conf_saveEmptyLine();
+
    conf_saveComment(
       _( "Enables developer mode (universe editor and the likes)" ) );
    conf_saveBool( "devmode", conf.devmode );
@@ -1167,6 +1195,14 @@ int conf_saveConfig( const char *file )
    conf_saveBool( "lua_repl", conf.lua_repl );
    conf_saveEmptyLine();
 
+   conf_saveComment( _( "Load parsed game data from snapshots in the cache "
+                        "directory instead of parsing it every start." ) );
+   conf_saveBool( "data_cache", conf.data_cache );
+   conf_saveComment( _( "Parse the game data anyway and warn if it differs "
+                        "from the snapshots (slow, for debugging)." ) );
+   conf_saveBool( "data_cache_verify", conf.data_cache_verify );
+   conf_saveEmptyLine();
+
    conf_saveComment(
       _( "Save the config every time game exits (rewriting this bit)" ) );
    conf_saveInt( "conf_nosave", conf.nosave );
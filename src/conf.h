@@ -25,6 +25,11 @@
    1 /**< Whether or not to use mouse accel controls. */
 #define MOUSE_DOUBLECLICK_TIME                                                 \
    0.5 /**< How long to consider double-clicks for. */
+#define LOD_DISTANCE_DEFAULT                                                   \
+   8000. /**< Distance from the player beyond which idle pilots are simulated \
+            coarsely during time compression. */
+#define LOD_DT_DEFAULT                                                         \
+   0.5 /**< Longest time step of pilots simulated coarsely. */
 #define MANUAL_ZOOM_DEFAULT                                                    \
    0 /**< Whether or not to enable manual zoom controls. */
 #define ZOOM_FAR_DEFAULT 0.5  /**< Far zoom distance (smaller is further) */
@@ -52,6 +57,8 @@
    4.                        /**< Default scale factor for nebula rendering. */
 #define SHOW_FPS_DEFAULT 0   /**< Whether to display FPS on screen. */
 #define FPS_MAX_DEFAULT 60   /**< Maximum FPS. */
+#define LUA_GC_BUDGET_DEFAULT                                                  \
+   2. /**< Maximum ms per frame of Lua garbage collection in idle time. */
 #define SHOW_PAUSE_DEFAULT 1 /**< Whether to display pause status. */
 #define MINIMIZE_DEFAULT 1   /**< Whether to minimize on focus loss. */
 #define COLOURBLIND_SIM_DEFAULT                                                \
@@ -142,8 +149,9 @@ typedef struct PlayerConf_s {
    double engine_vol; /**< Sound level for engines (relative). */
 
    /* FPS. */
-   int fps_show; /**< Whether or not FPS should be shown */
-   int fps_max;  /**< Maximum FPS to limit to. */
+   int    fps_show;      /**< Whether or not FPS should be shown */
+   int    fps_max;       /**< Maximum FPS to limit to. */
+   double lua_gc_budget; /**< Maximum ms per frame to collect Lua garbage. */
 
    /* Pause. */
    int pause_show; /**< Whether pause status should be shown. */
@@ -192,10 +200,15 @@ typedef struct PlayerConf_s {
                                    autonav. */
    double autonav_reset_shield; /**< Shield condition for resetting autonav
                                    speed. */
+   double lod_distance;         /**< Distance beyond which idle pilots are
+                                   simulated coarsely, 0 disables. */
+   double lod_dt;               /**< Longest time step of coarse simulation. */
    int   devmode;               /**< Developer mode. */
    int   devautosave;           /**< Developer mode autosave. */
    int   lua_enet;              /**< Enable the lua-enet library. */
    int   lua_repl;    /**< Enable the experimental CLI based on lua-repl. */
+   int   data_cache;  /**< Load parsed data from snapshots in the cache. */
+   int   data_cache_verify; /**< Check the snapshots against parsing. */
    int   nosave;      /**< Disables conf saving. */
    char *lastversion; /**< The last version the game was ran in. */
    int   translation_warning_seen; /**< No need to warn about incomplete game
@@ -0,0 +1,369 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file datacache.c
+ *
+ * @brief Binary snapshots of parsed data tables.
+ *
+ * Loaders can store what they parsed from XML here and load it back on the
+ * next start instead of parsing again. Snapshots live in the cache directory
+ * and are keyed with an MD5 of everything the data depends on, see
+ * datacache_init() and datacache_keyFile(). Serialization is done value by
+ * value with the datacache_write*() and datacache_read*() functions, so
+ * pointers have to be stored as names and looked up again when loading.
+ */
+/** @cond */
+#include <limits.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "physfs.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "datacache.h"
+
+#include "array.h"
+#include "log.h"
+#include "ndata.h"
+#include "nfile.h"
+#include "plugin.h"
+
+#define DATACACHE_MAGIC 0x4e444331 /**< "NDC1" */
+#define DATACACHE_VERSION                                                      \
+   1 /**< Version of the snapshot format, bump when any loader changes what it \
+        stores. */
+#define DATACACHE_PATH "data/" /**< Snapshot directory in the cache. */
+
+/**
+ * @brief Header of a snapshot file.
+ */
+typedef struct DataCacheHeader_ {
+   uint32_t   magic;   /**< DATACACHE_MAGIC. */
+   uint32_t   version; /**< DATACACHE_VERSION. */
+   md5_byte_t key[16]; /**< Key the snapshot was made with. */
+   uint64_t   len;     /**< Length of the data after the header. */
+} DataCacheHeader;
+
+/**
+ * @brief Starts a snapshot.
+ *
+ * The key starts with the version of Naev and the plugins, more dependencies
+ * have to be added with datacache_keyFile() before loading or saving.
+ *
+ *    @param[out] dc Snapshot to initialize.
+ *    @param name Name of the snapshot file.
+ */
+void datacache_init( DataCache *dc, const char *name )
+{
+   const plugin_t *plugins = plugin_list();
+   uint32_t        version = DATACACHE_VERSION;
+   const char     *nversion;
+
+   memset( dc, 0, sizeof( DataCache ) );
+   dc->name     = strdup( name );
+   dc->buf      = array_create( char );
+   dc->archives = array_create( char * );
+
+   md5_init( &dc->md5 );
+   md5_append( &dc->md5, (const md5_byte_t *)&version, sizeof( version ) );
+   nversion = naev_version( 1 );
+   md5_append( &dc->md5, (const md5_byte_t *)nversion, strlen( nversion ) + 1 );
+   for ( int i = 0; i < array_size( plugins ); i++ ) {
+      const plugin_t *plg = &plugins[i];
+      md5_append( &dc->md5, (const md5_byte_t *)plg->mountpoint,
+                  strlen( plg->mountpoint ) + 1 );
+      if ( plg->version != NULL )
+         md5_append( &dc->md5, (const md5_byte_t *)plg->version,
+                     strlen( plg->version ) + 1 );
+   }
+}
+
+/**
+ * @brief Makes a snapshot depend on a file in ndata.
+ *
+ *    @param dc Snapshot to modify.
+ *    @param path Path of the file, it doesn't have to exist.
+ */
+void datacache_keyFile( DataCache *dc, const char *path )
+{
+   int64_t size, modtime;
+   if ( ndata_fileInfo( path, &size, &modtime ) ) {
+      size    = -1;
+      modtime = -1;
+   }
+   md5_append( &dc->md5, (const md5_byte_t *)path, strlen( path ) + 1 );
+   md5_append( &dc->md5, (const md5_byte_t *)&size, sizeof( size ) );
+   md5_append( &dc->md5, (const md5_byte_t *)&modtime, sizeof( modtime ) );
+
+   /* Packed files don't have a modification time, so depend on the archive
+    * instead, which gets keyed once the key is finished. */
+   if ( ( size >= 0 ) && ( modtime < 0 ) ) {
+      const char *real = PHYSFS_getRealDir( path );
+      if ( real == NULL )
+         return;
+      for ( int i = 0; i < array_size( dc->archives ); i++ )
+         if ( strcmp( dc->archives[i], real ) == 0 )
+            return;
+      array_push_back( &dc->archives, strdup( real ) );
+   }
+}
+
+/**
+ * @brief Makes a snapshot depend on a list of files in ndata.
+ *
+ *    @param dc Snapshot to modify.
+ *    @param paths Array of paths, such as from ndata_listRecursive().
+ */
+void datacache_keyFiles( DataCache *dc, char *const *paths )
+{
+   int n = array_size( paths );
+   md5_append( &dc->md5, (const md5_byte_t *)&n, sizeof( n ) );
+   for ( int i = 0; i < n; i++ )
+      datacache_keyFile( dc, paths[i] );
+}
+
+/**
+ * @brief Frees a snapshot.
+ *
+ *    @param dc Snapshot to free.
+ */
+void datacache_free( DataCache *dc )
+{
+   free( dc->name );
+   array_free( dc->buf );
+   for ( int i = 0; i < array_size( dc->archives ); i++ )
+      free( dc->archives[i] );
+   array_free( dc->archives );
+   memset( dc, 0, sizeof( DataCache ) );
+}
+
+/**
+ * @brief Finishes the key of a snapshot, no more dependencies can be added.
+ */
+static void datacache_key( DataCache *dc )
+{
+   if ( dc->keyed )
+      return;
+   for ( int i = 0; i < array_size( dc->archives ); i++ ) {
+      const char *a = dc->archives[i];
+      struct stat st;
+      int64_t     size, modtime;
+      if ( stat( a, &st ) == 0 ) {
+         size    = st.st_size;
+         modtime = st.st_mtime;
+      } else {
+         size    = -1;
+         modtime = -1;
+      }
+      md5_append( &dc->md5, (const md5_byte_t *)a, strlen( a ) + 1 );
+      md5_append( &dc->md5, (const md5_byte_t *)&size, sizeof( size ) );
+      md5_append( &dc->md5, (const md5_byte_t *)&modtime, sizeof( modtime ) );
+   }
+   md5_finish( &dc->md5, dc->key );
+   dc->keyed = 1;
+}
+
+/**
+ * @brief Gets the path of the file of a snapshot.
+ */
+static void datacache_path( const DataCache *dc, char *path, int len )
+{
+   snprintf( path, len, "%s%s%s", nfile_cachePath(), DATACACHE_PATH,
+             dc->name );
+}
+
+/**
+ * @brief Loads a snapshot from the cache directory.
+ *
+ * On failure the snapshot is left empty, ready for writing the freshly parsed
+ * data to it.
+ *
+ *    @param dc Snapshot to load.
+ *    @return 0 if a snapshot with the same key was found and can be read.
+ */
+int datacache_load( DataCache *dc )
+{
+   char            path[PATH_MAX];
+   char           *data;
+   size_t          size;
+   DataCacheHeader hdr;
+
+   datacache_key( dc );
+   array_resize( &dc->buf, 0 );
+   dc->pos   = 0;
+   dc->error = 0;
+
+   datacache_path( dc, path, sizeof( path ) );
+   if ( !nfile_fileExists( path ) )
+      return -1;
+   data = nfile_readFile( &size, path );
+   if ( data == NULL )
+      return -1;
+
+   /* Consider the snapshot stale if the header doesn't match. */
+   if ( size < sizeof( hdr ) ) {
+      free( data );
+      return -1;
+   }
+   memcpy( &hdr, data, sizeof( hdr ) );
+   if ( ( hdr.magic != DATACACHE_MAGIC ) ||
+        ( hdr.version != DATACACHE_VERSION ) ||
+        ( memcmp( hdr.key, dc->key, sizeof( dc->key ) ) != 0 ) ||
+        ( hdr.len != size - sizeof( hdr ) ) ) {
+      free( data );
+      return -1;
+   }
+
+   array_resize( &dc->buf, hdr.len );
+   memcpy( dc->buf, &data[sizeof( hdr )], hdr.len );
+   free( data );
+   return 0;
+}
+
+/**
+ * @brief Saves a snapshot to the cache directory.
+ *
+ *    @param dc Snapshot to save.
+ *    @return 0 on success.
+ */
+int datacache_save( DataCache *dc )
+{
+   char            path[PATH_MAX];
+   char           *data;
+   DataCacheHeader hdr;
+   int             ret;
+
+   datacache_key( dc );
+   memset( &hdr, 0, sizeof( hdr ) );
+   hdr.magic   = DATACACHE_MAGIC;
+   hdr.version = DATACACHE_VERSION;
+   memcpy( hdr.key, dc->key, sizeof( hdr.key ) );
+   hdr.len = array_size( dc->buf );
+
+   snprintf( path, sizeof( path ), "%s/%s", nfile_cachePath(),
+             DATACACHE_PATH );
+   nfile_dirMakeExist( path );
+   datacache_path( dc, path, sizeof( path ) );
+
+   data = malloc( sizeof( hdr ) + hdr.len );
+   memcpy( data, &hdr, sizeof( hdr ) );
+   memcpy( &data[sizeof( hdr )], dc->buf, hdr.len );
+   ret = nfile_writeFile( data, sizeof( hdr ) + hdr.len, path );
+   free( data );
+   if ( ret )
+      WARN( _( "Unable to write data snapshot '%s'." ), path );
+   return ret;
+}
+
+/**
+ * @brief Checks to see if two snapshots have the same data.
+ *
+ *    @return 1 if they are equal, 0 otherwise.
+ */
+int datacache_equal( const DataCache *dc1, const DataCache *dc2 )
+{
+   return ( array_size( dc1->buf ) == array_size( dc2->buf ) ) &&
+          ( memcmp( dc1->buf, dc2->buf, array_size( dc1->buf ) ) == 0 );
+}
+
+/**
+ * @brief Appends raw bytes to a snapshot.
+ */
+static void datacache_write( DataCache *dc, const void *data, size_t len )
+{
+   size_t n = array_size( dc->buf );
+   array_resize( &dc->buf, n + len );
+   memcpy( &dc->buf[n], data, len );
+}
+
+/**
+ * @brief Reads raw bytes from a snapshot.
+ *
+ *    @return 0 on success, -1 (and the error flag is set) if past the end.
+ */
+static int datacache_read( DataCache *dc, void *data, size_t len )
+{
+   if ( dc->error || ( dc->pos + len > (size_t)array_size( dc->buf ) ) ) {
+      dc->error = 1;
+      memset( data, 0, len );
+      return -1;
+   }
+   memcpy( data, &dc->buf[dc->pos], len );
+   dc->pos += len;
+   return 0;
+}
+
+/**
+ * @brief Writes an integer to a snapshot.
+ */
+void datacache_writeInt( DataCache *dc, int64_t value )
+{
+   datacache_write( dc, &value, sizeof( value ) );
+}
+
+/**
+ * @brief Writes a floating point value to a snapshot.
+ */
+void datacache_writeDouble( DataCache *dc, double value )
+{
+   datacache_write( dc, &value, sizeof( value ) );
+}
+
+/**
+ * @brief Writes a string to a snapshot.
+ *
+ *    @param dc Snapshot to write to.
+ *    @param str String to write, can be NULL.
+ */
+void datacache_writeStr( DataCache *dc, const char *str )
+{
+   int64_t len = ( str == NULL ) ? -1 : (int64_t)strlen( str );
+   datacache_writeInt( dc, len );
+   if ( len > 0 )
+      datacache_write( dc, str, len );
+}
+
+/**
+ * @brief Reads an integer from a snapshot.
+ */
+int64_t datacache_readInt( DataCache *dc )
+{
+   int64_t value;
+   datacache_read( dc, &value, sizeof( value ) );
+   return value;
+}
+
+/**
+ * @brief Reads a floating point value from a snapshot.
+ */
+double datacache_readDouble( DataCache *dc )
+{
+   double value;
+   datacache_read( dc, &value, sizeof( value ) );
+   return value;
+}
+
+/**
+ * @brief Reads a string from a snapshot.
+ *
+ *    @param dc Snapshot to read from.
+ *    @return Newly allocated string or NULL if NULL was written (or on error).
+ */
+char *datacache_readStr( DataCache *dc )
+{
+   char   *str;
+   int64_t len = datacache_readInt( dc );
+   if ( ( len < 0 ) || dc->error )
+      return NULL;
+   if ( dc->pos + len > (size_t)array_size( dc->buf ) ) {
+      dc->error = 1;
+      return NULL;
+   }
+   str = malloc( len + 1 );
+   datacache_read( dc, str, len );
+   str[len] = '\0';
+   return str;
+}
@@ -0,0 +1,49 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/** @cond */
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#include "md5.h"
+
+/**
+ * @brief Binary snapshot of a parsed data table, stored in the cache directory.
+ *
+ * The snapshot is keyed by the version of Naev, the loaded plugins and the
+ * sizes and modification times of the source files it was built from, so it
+ * gets thrown away whenever any of them change. Files in archives have no
+ * modification time, so the archive's own size and time are used instead.
+ */
+typedef struct DataCache_ {
+   char       *name;     /**< Name of the snapshot file. */
+   md5_state_t md5;      /**< State of the key being built. */
+   md5_byte_t  key[16];  /**< Key of the snapshot once finished. */
+   int         keyed;    /**< Whether the key is finished. */
+   char      **archives; /**< Archives packed files come from, an array. */
+   char       *buf;      /**< Serialized data, an array. */
+   size_t      pos;      /**< Current reading position. */
+   int         error;    /**< Set if data was read past the end. */
+} DataCache;
+
+/* Creation. */
+void datacache_init( DataCache *dc, const char *name );
+void datacache_keyFile( DataCache *dc, const char *path );
+void datacache_keyFiles( DataCache *dc, char *const *paths );
+void datacache_free( DataCache *dc );
+
+/* Storage. */
+int datacache_load( DataCache *dc );
+int datacache_save( DataCache *dc );
+int datacache_equal( const DataCache *dc1, const DataCache *dc2 );
+
+/* Serialization. */
+void    datacache_writeInt( DataCache *dc, int64_t value );
+void    datacache_writeDouble( DataCache *dc, double value );
+void    datacache_writeStr( DataCache *dc, const char *str );
+int64_t datacache_readInt( DataCache *dc );
+double  datacache_readDouble( DataCache *dc );
+char   *datacache_readStr( DataCache *dc );
@@ -1495,9 +1495,8 @@ static void uniedit_renameSys( void )
 
       free( oldName );
       free( newName );
-      free( sys->name );
 
-      sys->name = name;
+      system_rename( sys, name );
       dsys_saveSystem( sys );
 
       /* Re-save adjacent systems. */
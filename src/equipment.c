@@ -86,6 +86,7 @@ static void equipment_getDim( unsigned int wid, int *w, int *h, int *sw,
                               int *cw, int *ch, int *bw, int *bh );
 static void equipment_genShipList( unsigned int wid );
 static void equipment_genOutfitList( unsigned int wid );
+static const Pilot *equipment_outfitPilot( void );
 /* Widget. */
 static void equipment_genLists( unsigned int wid );
 static void equipment_toggleFav( unsigned int wid, const char *wgt );
@@ -1783,7 +1784,6 @@ static void equipment_genOutfitList( unsigned int wid )
    int             noutfits, active;
    ImageArrayCell *coutfits;
    int             iconsize;
-   const Pilot    *p = ( eq_wgt.selected != NULL ) ? eq_wgt.selected->p : NULL;
 
    /* Get dimensions. */
    equipment_getDim( wid, &w, &h, NULL, NULL, &ow, &oh, NULL, NULL, NULL, NULL,
@@ -1848,9 +1848,8 @@ static void equipment_genOutfitList( unsigned int wid )
    /* Get the outfits. */
    noutfits = player_getOutfitsFiltered( (const Outfit ***)&iar_outfits[active],
                                          tabfilters[active], filtertext );
-   coutfits =
-      outfits_imageArrayCells( (const Outfit **)iar_outfits[active], &noutfits,
-                               ( p == NULL ) ? player.p : p, 0 );
+   coutfits = outfits_imageArrayCellsLazy( &noutfits );
+   pilot_outfitDescCacheClear();
 
    /* Create the actual image array. */
    iw       = ow - 6;
@@ -1868,6 +1867,9 @@ static void equipment_genOutfitList( unsigned int wid )
                          iconsize, coutfits, noutfits, equipment_updateOutfits,
                          equipment_rightClickOutfits,
                          equipment_rightClickOutfits );
+   outfits_imageArrayLazy( wid, EQUIPMENT_OUTFITS,
+                           (const Outfit **)iar_outfits[active],
+                           equipment_outfitPilot, 0 );
 
    toolkit_setImageArrayAccept( wid, EQUIPMENT_OUTFITS,
                                 equipment_rightClickOutfits );
@@ -1875,6 +1877,14 @@ static void equipment_genOutfitList( unsigned int wid )
    equipment_updateOutfits( wid, NULL );
 }
 
+/**
+ * @brief Gets the pilot the outfit list describes outfits for.
+ */
+static const Pilot *equipment_outfitPilot( void )
+{
+   return ( eq_wgt.selected != NULL ) ? eq_wgt.selected->p : player.p;
+}
+
 /**
  * @brief Gets the colour for comparing a current value vs a ship base value.
  */
@@ -2529,7 +2539,7 @@ static void equipment_autoequipShip( unsigned int wid, const char *str )
          return;
       }
       /* New env. */
-      autoequip_env = nlua_newEnv();
+      autoequip_env = nlua_newEnv( file );
       nlua_loadStandard( autoequip_env );
       nlua_loadTk( autoequip_env );
       if ( nlua_dobufenv( autoequip_env, buf, bufsize, file ) != 0 ) {
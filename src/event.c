@@ -42,6 +42,7 @@
 #include "nxml_lua.h"
 #include "player.h"
 #include "rng.h"
+#include "trigger.h"
 
 #define XML_EVENT_ID "Events" /**< XML document identifier */
 #define XML_EVENT_TAG "event" /**< XML event tag. */
@@ -79,6 +80,10 @@ typedef struct EventData_ {
  * Event data.
  */
 static EventData *event_data = NULL; /**< Allocated event data. */
+static TriggerIndex event_index[EVENT_TRIGGER_LOAD +
+                                1]; /**< Events by trigger. */
+static TriggerChapter *event_chapters =
+   NULL; /**< Cached chapter matches of the event data. */
 
 /*
  * Active events.
@@ -98,6 +103,7 @@ static int          event_create( int dataid, unsigned int *id );
 int                 events_saveActive( xmlTextWriterPtr writer );
 int                 events_loadActive( xmlNodePtr parent );
 static int          events_parseActive( xmlNodePtr parent );
+static void         events_buildIndex( void );
 
 /**
  * @brief Gets an event.
@@ -207,7 +213,7 @@ static int event_create( int dataid, unsigned int *id )
    data     = &event_data[dataid];
 
    /* Open the new state. */
-   ev->env = nlua_newEnv();
+   ev->env = nlua_newEnv( data->name );
    nlua_loadStandard( ev->env );
    nlua_loadEvt( ev->env );
    nlua_loadHook( ev->env );
@@ -319,17 +325,33 @@ int event_alreadyRunning( int data )
  */
 void events_trigger( EventTrigger_t trigger )
 {
-   int created = 0;
-   for ( int i = 0; i < array_size( event_data ); i++ ) {
+   int         created = 0;
+   int         fct     = -1;
+   const char *spob    = NULL;
+   const char *sys     = ( cur_system != NULL ) ? cur_system->name : NULL;
+   const int  *cand;
+
+   if ( ( trigger < 0 ) || ( trigger > EVENT_TRIGGER_LOAD ) )
+      return;
+
+   /* Only look at the events that can trigger here. */
+   if ( ( trigger == EVENT_TRIGGER_ENTER ) && ( cur_system != NULL ) )
+      fct = cur_system->faction;
+   else if ( ( trigger == EVENT_TRIGGER_LOAD ||
+               trigger == EVENT_TRIGGER_LAND ) &&
+             ( land_spob != NULL ) ) {
+      spob = land_spob->name;
+      fct  = land_spob->presence.faction;
+   }
+   cand = trigger_indexQuery( &event_index[trigger], spob, sys, fct );
+
+   for ( int k = 0; k < array_size( cand ); k++ ) {
+      int        i  = cand[k];
       EventData *ed = &event_data[i];
 
       if ( naev_isQuit() )
          return;
 
-      /* Make sure trigger matches. */
-      if ( ed->trigger != trigger )
-         continue;
-
       /* Spob. */
       if ( ( trigger == EVENT_TRIGGER_LAND || trigger == EVENT_TRIGGER_LOAD ) &&
            ( ed->spob != NULL ) &&
@@ -352,16 +374,9 @@ void events_trigger( EventTrigger_t trigger )
 
       /* Test factions. */
       if ( ed->factions != NULL ) {
-         int fct, match = 0;
-         if ( trigger == EVENT_TRIGGER_ENTER )
-            fct = cur_system->faction;
-         else if ( trigger == EVENT_TRIGGER_LOAD ||
-                   trigger == EVENT_TRIGGER_LAND )
-            fct = land_spob->presence.faction;
-         else {
-            fct   = -1;
+         int match = 0;
+         if ( trigger == EVENT_TRIGGER_NONE )
             match = -1; /* Don't hae to check factions. */
-         }
 
          if ( match == 0 ) {
             for ( int j = 0; j < array_size( ed->factions ); j++ ) {
@@ -376,25 +391,10 @@ void events_trigger( EventTrigger_t trigger )
       }
 
       /* If chapter, must match chapter regex. */
-      if ( ed->chapter_re != NULL ) {
-         pcre2_match_data *match_data =
-            pcre2_match_data_create_from_pattern( ed->chapter_re, NULL );
-         int rc =
-            pcre2_match( ed->chapter_re, (PCRE2_SPTR)player.chapter,
-                         strlen( player.chapter ), 0, 0, match_data, NULL );
-         pcre2_match_data_free( match_data );
-         if ( rc < 0 ) {
-            switch ( rc ) {
-            case PCRE2_ERROR_NOMATCH:
-               continue;
-            default:
-               WARN( _( "Matching error %d" ), rc );
-               break;
-            }
-            continue;
-         } else if ( rc == 0 )
-            continue;
-      }
+      if ( ( ed->chapter_re != NULL ) &&
+           !trigger_chapterMatch( ed->chapter_re, &event_chapters[i],
+                                  ed->name ) )
+         continue;
 
       /* Test conditional. */
       if ( ed->cond != NULL ) {
@@ -594,6 +594,7 @@ int events_load( void )
     * first. */
    qsort( event_data, array_size( event_data ), sizeof( EventData ),
           event_cmp );
+   events_buildIndex();
 
 #if DEBUGGING
    if ( conf.devmode ) {
@@ -610,6 +611,36 @@ int events_load( void )
    return 0;
 }
 
+/**
+ * @brief Indexes the events by where they can trigger.
+ */
+static void events_buildIndex( void )
+{
+   for ( int i = 0; i <= EVENT_TRIGGER_LOAD; i++ )
+      trigger_indexFree( &event_index[i] );
+   for ( int i = 0; i < array_size( event_data ); i++ ) {
+      const EventData *ed = &event_data[i];
+      if ( ( ed->trigger < 0 ) || ( ed->trigger > EVENT_TRIGGER_LOAD ) )
+         continue;
+      /* Spobs and factions only restrict some triggers. */
+      trigger_indexAdd( &event_index[ed->trigger], i,
+                        ( ed->trigger == EVENT_TRIGGER_LAND ||
+                          ed->trigger == EVENT_TRIGGER_LOAD )
+                           ? ed->spob
+                           : NULL,
+                        ed->system,
+                        ( ed->trigger == EVENT_TRIGGER_NONE ) ? NULL
+                                                              : ed->factions );
+   }
+   for ( int i = 0; i <= EVENT_TRIGGER_LOAD; i++ )
+      trigger_indexBuild( &event_index[i] );
+
+   /* Chapter regexes may have changed too. */
+   free( event_chapters );
+   event_chapters =
+      calloc( MAX( 1, array_size( event_data ) ), sizeof( TriggerChapter ) );
+}
+
 /**
  * @brief Parses an event file.
  *
@@ -756,6 +787,10 @@ void events_exit( void )
       event_freeData( &event_data[i] );
    array_free( event_data );
    event_data = NULL;
+   for ( int i = 0; i <= EVENT_TRIGGER_LOAD; i++ )
+      trigger_indexFree( &event_index[i] );
+   free( event_chapters );
+   event_chapters = NULL;
 }
 
 /**
@@ -975,9 +1010,11 @@ int event_reload( const char *name )
       return -1;
    save = *temp;
    res  = event_parseFile( save.sourcefile, temp );
-   if ( res == 0 )
+   if ( res == 0 ) {
+      /* The index points to the names of the old data. */
+      events_buildIndex();
       event_freeData( &save );
-   else
+   } else
       *temp = save;
    return res;
 }
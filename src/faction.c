@@ -324,6 +324,24 @@ const char *faction_name( int f )
    return faction_stack[f].name;
 }
 
+/**
+ * @brief Gets the name a faction was defined with.
+ *
+ * Unlike faction_name, the player faction isn't renamed, so this is what
+ * should be stored to look the faction up again with faction_get.
+ *
+ *    @param f Faction to get the name of.
+ *    @return Name of the faction as in its data file.
+ */
+const char *faction_nameRaw( int f )
+{
+   if ( !faction_isFaction( f ) ) {
+      WARN( _( "Faction id '%d' is invalid." ), f );
+      return NULL;
+   }
+   return faction_stack[f].name;
+}
+
 /**
  * @brief Gets a factions short name (human-readable).
  *
@@ -1471,7 +1489,7 @@ static void faction_addStandingScript( Faction *temp, const char *scriptname )
    size_t ndat;
 
    snprintf( buf, sizeof( buf ), FACTIONS_PATH "standing/%s.lua", scriptname );
-   temp->lua_env = nlua_newEnv();
+   temp->lua_env = nlua_newEnv( buf );
 
    nlua_loadStandard( temp->lua_env );
    dat = ndata_read( buf, &ndat );
@@ -1564,7 +1582,7 @@ static int faction_parseSocial( const char *file )
             WARN( _( "Faction '%s' has duplicate 'spawn' tag." ), base->name );
          snprintf( buf, sizeof( buf ), FACTIONS_PATH "spawn/%s.lua",
                    xml_raw( node ) );
-         base->sched_env = nlua_newEnv();
+         base->sched_env = nlua_newEnv( buf );
          nlua_loadStandard( base->sched_env );
          dat = ndata_read( buf, &ndat );
          if ( nlua_dobufenv( base->sched_env, dat, ndat, buf ) != 0 ) {
@@ -1585,7 +1603,7 @@ static int faction_parseSocial( const char *file )
             WARN( _( "Faction '%s' has duplicate 'equip' tag." ), base->name );
          snprintf( buf, sizeof( buf ), FACTIONS_PATH "equip/%s.lua",
                    xml_raw( node ) );
-         base->equip_env = nlua_newEnv();
+         base->equip_env = nlua_newEnv( buf );
          nlua_loadStandard( base->equip_env );
          dat = ndata_read( buf, &ndat );
          if ( nlua_dobufenv( base->equip_env, dat, ndat, buf ) != 0 ) {
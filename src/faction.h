@@ -31,6 +31,7 @@ int                     faction_setInvisible( int id, int state );
 int                     faction_isKnown( int id );
 int                     faction_isDynamic( int id );
 const char             *faction_name( int f );
+const char             *faction_nameRaw( int f );
 const char             *faction_shortname( int f );
 const char             *faction_longname( int f );
 const char             *faction_mapname( int f );
@@ -42,6 +42,7 @@
 #define DEFAULT_TEXTURE_SIZE                                                   \
    1024             /**< Default size of texture caches for glyphs. */
 #define MAX_ROWS 64 /**< Max number of rows per texture cache. */
+#define FONT_VBO_GLYPHS 4096 /**< Glyphs the stream VBO holds initially. */
 
 /**
  * OpenGL rendering stuff. Since we can't actually render with multiple threads
@@ -53,6 +54,28 @@ static FT_UInt
    prev_glyph_index; /**< Index of last character drawn (for kerning). */
 static int prev_glyph_ft_index; /**< HACK: Index into which stsh->ft[_].face? */
 
+/**
+ * @brief Vertex of a glyph quad as sent to the font shader.
+ */
+typedef struct glFontVertex_s {
+   GLfloat  x, y, z, w; /**< Position, already projected. */
+   GLfloat  s, t;       /**< Texture coordinates. */
+   GLfloat  m; /**< Number of distance units corresponding to 1 "pixel". */
+   glColour c; /**< Colour of the glyph. */
+} glFontVertex;
+
+/*
+ * Glyph batching. Glyphs are accumulated and only drawn when the texture
+ * changes or the string is done, with all the vertices going through a single
+ * streaming VBO.
+ */
+static gl_vbo       *font_vbo = NULL; /**< Streaming VBO for the glyph quads. */
+static GLsizei       font_vbo_size   = 0; /**< Size of the VBO in bytes. */
+static GLsizei       font_vbo_offset = 0; /**< Bytes already used in the VBO. */
+static glFontVertex *font_batch      = NULL; /**< Pending vertices (array.h). */
+static GLuint        font_batch_tex  = 0; /**< Texture of pending vertices. */
+static glColour      font_batch_col;      /**< Current glyph colour. */
+
 /**
  * @brief Stores the row information for a font.
  */
@@ -135,10 +158,8 @@ typedef struct glFontStash_s {
    int          tw;            /**< Width of textures. */
    int          th;            /**< Height of textures. */
    glFontTex   *tex;           /**< Textures. */
-   gl_vbo      *vbo_tex;       /**< VBO associated to texture coordinates. */
-   gl_vbo      *vbo_vert;      /**< VBO associated to vertex coordinates. */
-   GLfloat     *vbo_tex_data;  /**< Copy of texture coordinate data. */
-   GLshort     *vbo_vert_data; /**< Copy of vertex coordinate data. */
+   GLfloat     *vbo_tex_data;  /**< Texture coordinates of the glyph quads. */
+   GLshort     *vbo_vert_data; /**< Vertex coordinates of the glyph quads. */
    int          nvbo;          /**< Amount of vbo data. */
    int          mvbo;          /**< Amount of vbo memory. */
    glFontGlyph *glyphs;        /**< Unicode glyphs. */
@@ -177,12 +198,8 @@ static const glColour *gl_fontGetColour( uint32_t ch );
 static uint32_t        font_nextChar( const char *s, size_t *i );
 /* Get unicode glyphs from cache. */
 static glFontGlyph *gl_fontGetGlyph( glFontStash *stsh, uint32_t ch );
-/* Render.
- * TODO this should be changed to be more like font-stash
- * (https://github.com/akrinke/Font-Stash) In particular, instead of writing
- * char by char, they should be batched up by textures and rendered when
- * gl_fontRenderEnd() is called, saving lots of opengl calls.
- */
+/* Render. */
+static void gl_fontBatchFlush( void );
 static void gl_fontRenderStart( const glFontStash *stsh, double x, double y,
                                 const glColour *c, double outlineR );
 static void gl_fontRenderStartH( const glFontStash *stsh, const mat4 *H,
@@ -374,9 +391,6 @@ static int gl_fontAddGlyphTex( glFontStash *stsh, font_char_t *ch,
    vbo_vert[5] = vy;
    vbo_vert[6] = vx + vw; /* Bottom right. */
    vbo_vert[7] = vy;
-   /* Update vbos. */
-   gl_vboData( stsh->vbo_tex, sizeof( GLfloat ) * n, stsh->vbo_tex_data );
-   gl_vboData( stsh->vbo_vert, sizeof( GLshort ) * n, stsh->vbo_vert_data );
 
    /* Add space for the new character. */
    gr->x += ch->w;
@@ -385,12 +399,6 @@ static int gl_fontAddGlyphTex( glFontStash *stsh, font_char_t *ch,
    glyph->vbo_id    = ( n - 8 ) / 2;
    glyph->tex_index = tex - stsh->tex;
 
-   /* Since the VBOs have possibly changed, we have to reset the data. */
-   gl_vboActivateAttribOffset( stsh->vbo_vert, shaders.font.vertex, 0, 2,
-                               GL_SHORT, 0 );
-   gl_vboActivateAttribOffset( stsh->vbo_tex, shaders.font.tex_coord, 0, 2,
-                               GL_FLOAT, 0 );
-
    return 0;
 }
 
@@ -1268,7 +1276,9 @@ static void gl_fontRenderStartH( const glFontStash *stsh, const mat4 *H,
       col = c;
 
    glUseProgram( shaders.font.program );
-   gl_uniformAColour( shaders.font.colour, col, a );
+   gl_stats.states++;
+   font_batch_col   = *col;
+   font_batch_col.a = a;
    if ( outlineR == 0. )
       gl_uniformAColour( shaders.font.outline_colour, col, 0. );
    else
@@ -1281,13 +1291,11 @@ static void gl_fontRenderStartH( const glFontStash *stsh, const mat4 *H,
    font_restoreLast = 0;
    gl_fontKernStart();
 
-   /* Activate the appropriate VBOs. */
+   /* Vertex data gets set up when flushing the batch. */
    glEnableVertexAttribArray( shaders.font.vertex );
-   gl_vboActivateAttribOffset( stsh->vbo_vert, shaders.font.vertex, 0, 2,
-                               GL_SHORT, 0 );
    glEnableVertexAttribArray( shaders.font.tex_coord );
-   gl_vboActivateAttribOffset( stsh->vbo_tex, shaders.font.tex_coord, 0, 2,
-                               GL_FLOAT, 0 );
+   glEnableVertexAttribArray( shaders.font.vertex_m );
+   glEnableVertexAttribArray( shaders.font.vertex_colour );
 
    /* Depth testing is used to draw the outline under the glyph. */
    if ( outlineR > 0. )
@@ -1476,9 +1484,15 @@ static int gl_fontKernGlyph( glFontStash *stsh, uint32_t ch,
 static int gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch,
                                const glColour *c, int state )
 {
-   double       scale;
-   int          kern_adv_x;
-   glFontGlyph *glyph;
+   /* Order to turn the quad's triangle strip into two triangles. */
+   static const int tri[6] = { 0, 1, 2, 2, 1, 3 };
+   double           scale;
+   int              kern_adv_x;
+   glFontGlyph     *glyph;
+   GLuint           tex;
+   const GLshort   *vert;
+   const GLfloat   *texc;
+   const mat4      *H;
 
    /* Handle escape sequences. */
    if ( ( ch == FONT_COLOUR_CODE ) && ( state == 0 ) ) { /* Start sequence. */
@@ -1487,12 +1501,13 @@ static int gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch,
    if ( ( state == 1 ) && ( ch != FONT_COLOUR_CODE ) ) {
       const glColour *col = gl_fontGetColour( ch );
       double          a   = ( c == NULL ) ? 1. : c->a;
-      if ( col != NULL )
-         gl_uniformAColour( shaders.font.colour, col, a );
-      else if ( c == NULL )
-         gl_uniformColour( shaders.font.colour, &cWhite );
+      if ( col != NULL ) {
+         font_batch_col   = *col;
+         font_batch_col.a = a;
+      } else if ( c == NULL )
+         font_batch_col = cWhite;
       else
-         gl_uniformColour( shaders.font.colour, c );
+         font_batch_col = *c;
       font_lastCol = col;
       return 0;
    }
@@ -1511,14 +1526,31 @@ static int gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch,
    if ( kern_adv_x )
       mat4_translate_x( &font_projection_mat, kern_adv_x / scale );
 
-   /* Activate texture. */
-   glBindTexture( GL_TEXTURE_2D, stsh->tex[glyph->tex_index].id );
-
-   glUniform1f( shaders.font.m, glyph->m );
-   gl_uniformMat4( shaders.font.projection, &font_projection_mat );
+   /* Glyphs on different textures can't be drawn together. */
+   tex = stsh->tex[glyph->tex_index].id;
+   if ( tex != font_batch_tex ) {
+      gl_fontBatchFlush();
+      font_batch_tex = tex;
+   }
 
-   /* Draw the element. */
-   glDrawArrays( GL_TRIANGLE_STRIP, glyph->vbo_id, 4 );
+   /* Add the projected quad to the batch. */
+   vert = &stsh->vbo_vert_data[2 * glyph->vbo_id];
+   texc = &stsh->vbo_tex_data[2 * glyph->vbo_id];
+   H    = &font_projection_mat;
+   for ( int i = 0; i < 6; i++ ) {
+      glFontVertex *v  = &array_grow( &font_batch );
+      GLfloat       vx = vert[2 * tri[i] + 0];
+      GLfloat       vy = vert[2 * tri[i] + 1];
+      v->x             = H->m[0][0] * vx + H->m[1][0] * vy + H->m[3][0];
+      v->y             = H->m[0][1] * vx + H->m[1][1] * vy + H->m[3][1];
+      v->z             = H->m[0][2] * vx + H->m[1][2] * vy + H->m[3][2];
+      v->w             = H->m[0][3] * vx + H->m[1][3] * vy + H->m[3][3];
+      v->s             = texc[2 * tri[i] + 0];
+      v->t             = texc[2 * tri[i] + 1];
+      v->m             = glyph->m;
+      v->c             = font_batch_col;
+   }
+   gl_stats.glyphs++;
 
    /* Translate matrix. */
    mat4_translate_x( &font_projection_mat, glyph->adv_x / scale );
@@ -1526,13 +1558,66 @@ static int gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch,
    return 0;
 }
 
+/**
+ * @brief Draws all the glyphs that have been batched so far.
+ */
+static void gl_fontBatchFlush( void )
+{
+   GLsizei n    = array_size( font_batch );
+   GLsizei size = n * sizeof( glFontVertex );
+   GLuint  off;
+
+   if ( n == 0 )
+      return;
+
+   /* Orphan the buffer when it fills up so the driver doesn't stall. */
+   if ( font_vbo == NULL ) {
+      font_vbo_size = MAX( size, 6 * FONT_VBO_GLYPHS * sizeof( glFontVertex ) );
+      font_vbo      = gl_vboCreateStream( font_vbo_size, NULL );
+   } else if ( font_vbo_offset + size > font_vbo_size ) {
+      font_vbo_size = MAX( size, font_vbo_size );
+      gl_vboData( font_vbo, font_vbo_size, NULL );
+      font_vbo_offset = 0;
+   }
+   gl_vboSubData( font_vbo, font_vbo_offset, size, font_batch );
+
+   /* Set up the vertex data. */
+   off = font_vbo_offset;
+   gl_vboActivateAttribOffset( font_vbo, shaders.font.vertex,
+                               off + offsetof( glFontVertex, x ), 4, GL_FLOAT,
+                               sizeof( glFontVertex ) );
+   gl_vboActivateAttribOffset( font_vbo, shaders.font.tex_coord,
+                               off + offsetof( glFontVertex, s ), 2, GL_FLOAT,
+                               sizeof( glFontVertex ) );
+   gl_vboActivateAttribOffset( font_vbo, shaders.font.vertex_m,
+                               off + offsetof( glFontVertex, m ), 1, GL_FLOAT,
+                               sizeof( glFontVertex ) );
+   gl_vboActivateAttribOffset( font_vbo, shaders.font.vertex_colour,
+                               off + offsetof( glFontVertex, c ), 4, GL_FLOAT,
+                               sizeof( glFontVertex ) );
+
+   /* Draw everything at once. */
+   glBindTexture( GL_TEXTURE_2D, font_batch_tex );
+   glDrawArrays( GL_TRIANGLES, 0, n );
+   gl_stats.draws++;
+   gl_stats.states++;
+
+   font_vbo_offset += size;
+   array_erase( &font_batch, array_begin( font_batch ),
+                array_end( font_batch ) );
+}
+
 /**
  * @brief Ends the rendering engine.
  */
 static void gl_fontRenderEnd( void )
 {
+   gl_fontBatchFlush();
+
    glDisableVertexAttribArray( shaders.font.vertex );
    glDisableVertexAttribArray( shaders.font.tex_coord );
+   glDisableVertexAttribArray( shaders.font.vertex_m );
+   glDisableVertexAttribArray( shaders.font.vertex_colour );
    glUseProgram( 0 );
 
    glDisable( GL_DEPTH_TEST );
@@ -1659,14 +1744,10 @@ int gl_fontInit( glFont *font, const char *fname, const unsigned int h,
    stsh->glyphs = array_create( glFontGlyph );
    stsh->tex    = array_create( glFontTex );
 
-   /* Set up VBOs. */
+   /* Set up glyph quad data. */
    stsh->mvbo          = 256;
    stsh->vbo_tex_data  = calloc( 8 * stsh->mvbo, sizeof( GLfloat ) );
    stsh->vbo_vert_data = calloc( 8 * stsh->mvbo, sizeof( GLshort ) );
-   stsh->vbo_tex       = gl_vboCreateStatic( sizeof( GLfloat ) * 8 * stsh->mvbo,
-                                             stsh->vbo_tex_data );
-   stsh->vbo_vert      = gl_vboCreateStatic( sizeof( GLshort ) * 8 * stsh->mvbo,
-                                             stsh->vbo_vert_data );
 
    return 0;
 }
@@ -1806,8 +1887,6 @@ void gl_freeFont( glFont *font )
    array_free( stsh->tex );
 
    array_free( stsh->glyphs );
-   gl_vboDestroy( stsh->vbo_tex );
-   gl_vboDestroy( stsh->vbo_vert );
    free( stsh->vbo_tex_data );
    free( stsh->vbo_vert_data );
 
@@ -1839,4 +1918,10 @@ void gl_fontExit( void )
    font_library = NULL;
    array_free( avail_fonts );
    avail_fonts = NULL;
+
+   /* Clean up batching. */
+   gl_vboDestroy( font_vbo );
+   font_vbo = NULL;
+   array_free( font_batch );
+   font_batch = NULL;
 }
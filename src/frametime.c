@@ -0,0 +1,387 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file frametime.c
+ *
+ * @brief Always available frame time telemetry.
+ *
+ * Keeps the timings of the last frames split by zones in a ring buffer, so that
+ * percentiles can be computed and frames that take much longer than usual
+ * (hitches) can be reported along with what was slow in them. It only costs a
+ * performance counter read per zone, so unlike the tracing it is enabled in
+ * all builds.
+ */
+/** @cond */
+#include "physfs.h"
+#include <stdarg.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "frametime.h"
+
+#include "log.h"
+#include "nstring.h"
+#include "ntracing.h"
+
+#define FRAMETIME_HISTORY 1024 /**< Number of frames kept. */
+#define FRAMETIME_HITCHES 32   /**< Number of hitches kept. */
+#define FRAMETIME_HITCH_MIN                                                    \
+   ( 1000. / 30. ) /**< Frames faster than this are never hitches. */
+#define FRAMETIME_HITCH_FACTOR                                                 \
+   2.5 /**< How many times the average frame time a hitch takes. */
+#define FRAMETIME_AVG_WEIGHT 0.05 /**< Weight of new frames in the average. */
+
+/**
+ * @brief Timings of a single frame.
+ */
+typedef struct FrameTime_ {
+   unsigned int frame; /**< Frame number. */
+   double       total; /**< Total frame time in milliseconds. */
+   float        zones[FRAME_ZONE_SENTINEL]; /**< Time of each zone in ms. */
+   int          allocs; /**< Heap allocations during the frame. */
+   int          hitch;  /**< Whether the frame was a hitch. */
+} FrameTime;
+
+static const char *frametime_names[FRAME_ZONE_SENTINEL] = {
+   "wait",    "purge",   "space", "spfx",   "collide",
+   "pilots",  "weapons", "hooks", "render", "gc",
+}; /**< Names of the zones. */
+
+static FrameTime  frametime_ring[FRAMETIME_HISTORY]; /**< Recorded frames. */
+static int        frametime_nring  = 0; /**< Number of recorded frames. */
+static int        frametime_pos    = 0; /**< Next frame to write. */
+static FrameHitch frametime_hitches[FRAMETIME_HITCHES]; /**< Hitches. */
+static int        frametime_nhitch = 0; /**< Number of recorded hitches. */
+static int        frametime_hpos   = 0; /**< Next hitch to write. */
+static unsigned int frametime_nframe = 0; /**< Frame counter. */
+static double frametime_cur[FRAME_ZONE_SENTINEL]; /**< Zones of this frame. */
+static Uint64 frametime_last       = 0; /**< Counter at end of last frame. */
+static int    frametime_lastallocs = 0; /**< Allocations at last frame end. */
+static double frametime_avg = 0.; /**< Moving average of the frame time. */
+
+/**
+ * @brief Gets the current performance counter to start timing a zone.
+ */
+Uint64 frametime_now( void )
+{
+   return SDL_GetPerformanceCounter();
+}
+
+/**
+ * @brief Adds the time since start to a zone of the current frame.
+ *
+ * Zones can be timed several times per frame and get accumulated. Time
+ * before the end of the previous frame isn't counted.
+ *
+ *    @param zone Zone to add time to.
+ *    @param start Performance counter when the zone started.
+ *    @return The current performance counter, to chain zones.
+ */
+Uint64 frametime_zone( FrameZone zone, Uint64 start )
+{
+   Uint64 t = SDL_GetPerformanceCounter();
+   /* Zones that ran a nested main loop only count from its last frame. */
+   if ( start < frametime_last )
+      start = frametime_last;
+   frametime_cur[zone] +=
+      (double)( t - start ) * 1000. / (double)SDL_GetPerformanceFrequency();
+   return t;
+}
+
+/**
+ * @brief Records a hitch with the slowest zones of the frame.
+ */
+static void frametime_addHitch( const FrameTime *ft )
+{
+   FrameHitch *h = &frametime_hitches[frametime_hpos];
+   int         used[FRAME_ZONE_SENTINEL];
+
+   /* Waiting on purpose is never what made the frame slow. */
+   memset( used, 0, sizeof( used ) );
+   used[FRAME_ZONE_WAIT] = 1;
+   h->frame              = ft->frame;
+   h->ticks              = SDL_GetTicks();
+   h->total              = ft->total - ft->zones[FRAME_ZONE_WAIT];
+   for ( int k = 0; k < FRAMETIME_TOP; k++ ) {
+      int best = -1;
+      for ( int i = 0; i < FRAME_ZONE_SENTINEL; i++ )
+         if ( !used[i] &&
+              ( ( best < 0 ) || ( ft->zones[i] > ft->zones[best] ) ) )
+            best = i;
+      used[best] = 1;
+      h->top[k]   = best;
+      h->topms[k] = ft->zones[best];
+   }
+
+   frametime_hpos   = ( frametime_hpos + 1 ) % FRAMETIME_HITCHES;
+   frametime_nhitch = MIN( frametime_nhitch + 1, FRAMETIME_HITCHES );
+}
+
+/**
+ * @brief Marks the end of a frame, storing its timings.
+ */
+void frametime_frame( void )
+{
+   Uint64     t      = SDL_GetPerformanceCounter();
+   int        allocs = ntracing_allocs();
+   FrameTime *ft;
+
+   /* First frame only sets the reference. */
+   if ( frametime_last == 0 ) {
+      frametime_last       = t;
+      frametime_lastallocs = allocs;
+      memset( frametime_cur, 0, sizeof( frametime_cur ) );
+      return;
+   }
+
+   ft        = &frametime_ring[frametime_pos];
+   ft->frame = frametime_nframe++;
+   ft->total = (double)( t - frametime_last ) * 1000. /
+               (double)SDL_GetPerformanceFrequency();
+   for ( int i = 0; i < FRAME_ZONE_SENTINEL; i++ )
+      ft->zones[i] = frametime_cur[i];
+   ft->allocs = allocs - frametime_lastallocs;
+
+   /* Hitches are frames much slower than usual, not counting the time spent
+    * waiting on purpose. */
+   if ( frametime_avg <= 0. )
+      frametime_avg = ft->total;
+   ft->hitch = ( ( ft->total - ft->zones[FRAME_ZONE_WAIT] ) >
+                 MAX( FRAMETIME_HITCH_MIN,
+                      FRAMETIME_HITCH_FACTOR * frametime_avg ) );
+   if ( ft->hitch )
+      frametime_addHitch( ft );
+   else
+      frametime_avg += FRAMETIME_AVG_WEIGHT * ( ft->total - frametime_avg );
+
+   frametime_pos   = ( frametime_pos + 1 ) % FRAMETIME_HISTORY;
+   frametime_nring = MIN( frametime_nring + 1, FRAMETIME_HISTORY );
+   frametime_last       = t;
+   frametime_lastallocs = allocs;
+   memset( frametime_cur, 0, sizeof( frametime_cur ) );
+}
+
+/**
+ * @brief Clears all the recorded frames and hitches.
+ *
+ * The frame being run when called is not recorded either, so it can be used
+ * after stalls such as loading a game.
+ */
+void frametime_reset( void )
+{
+   frametime_nring  = 0;
+   frametime_pos    = 0;
+   frametime_nhitch = 0;
+   frametime_hpos   = 0;
+   frametime_avg    = 0.;
+   frametime_last   = 0;
+   memset( frametime_cur, 0, sizeof( frametime_cur ) );
+}
+
+/**
+ * @brief Gets the name of a zone.
+ */
+const char *frametime_zoneName( FrameZone zone )
+{
+   if ( ( zone < 0 ) || ( zone >= FRAME_ZONE_SENTINEL ) )
+      return NULL;
+   return frametime_names[zone];
+}
+
+/**
+ * @brief Gets a recorded frame, with 0 being the oldest.
+ */
+static const FrameTime *frametime_get( int i )
+{
+   int start = ( frametime_pos - frametime_nring + FRAMETIME_HISTORY ) %
+               FRAMETIME_HISTORY;
+   return &frametime_ring[( start + i ) % FRAMETIME_HISTORY];
+}
+
+/**
+ * @brief Compares doubles for qsort.
+ */
+static int frametime_cmp( const void *p1, const void *p2 )
+{
+   double d1 = *(const double *)p1;
+   double d2 = *(const double *)p2;
+   return ( d1 > d2 ) - ( d1 < d2 );
+}
+
+/**
+ * @brief Computes the percentiles of sorted values.
+ */
+static void frametime_percentiles( FrameTimeStats *s, double *v, int n )
+{
+   qsort( v, n, sizeof( double ), frametime_cmp );
+   s->p50 = v[MAX( 0, (int)ceil( 0.50 * n ) - 1 )];
+   s->p95 = v[MAX( 0, (int)ceil( 0.95 * n ) - 1 )];
+   s->p99 = v[MAX( 0, (int)ceil( 0.99 * n ) - 1 )];
+   s->max = v[n - 1];
+}
+
+/**
+ * @brief Computes percentile summaries of the recorded frames.
+ *
+ *    @param[out] total Summary of the total frame times (can be NULL).
+ *    @param[out] zones Summary of each zone (can be NULL).
+ *    @param[out] allocs Summary of the heap allocations per frame (can be
+ * NULL).
+ *    @return Number of frames the summaries are computed from.
+ */
+int frametime_stats( FrameTimeStats *total,
+                     FrameTimeStats  zones[FRAME_ZONE_SENTINEL],
+                     FrameTimeStats *allocs )
+{
+   double v[FRAMETIME_HISTORY];
+   int    n = frametime_nring;
+
+   if ( n <= 0 ) {
+      if ( total != NULL )
+         memset( total, 0, sizeof( FrameTimeStats ) );
+      if ( zones != NULL )
+         memset( zones, 0, sizeof( FrameTimeStats ) * FRAME_ZONE_SENTINEL );
+      if ( allocs != NULL )
+         memset( allocs, 0, sizeof( FrameTimeStats ) );
+      return 0;
+   }
+
+   if ( total != NULL ) {
+      for ( int i = 0; i < n; i++ )
+         v[i] = frametime_get( i )->total;
+      frametime_percentiles( total, v, n );
+   }
+   if ( zones != NULL ) {
+      for ( int z = 0; z < FRAME_ZONE_SENTINEL; z++ ) {
+         for ( int i = 0; i < n; i++ )
+            v[i] = frametime_get( i )->zones[z];
+         frametime_percentiles( &zones[z], v, n );
+      }
+   }
+   if ( allocs != NULL ) {
+      for ( int i = 0; i < n; i++ )
+         v[i] = frametime_get( i )->allocs;
+      frametime_percentiles( allocs, v, n );
+   }
+   return n;
+}
+
+/**
+ * @brief Gets the number of recorded hitches.
+ */
+int frametime_nhitches( void )
+{
+   return frametime_nhitch;
+}
+
+/**
+ * @brief Gets a recorded hitch, with 0 being the oldest.
+ */
+const FrameHitch *frametime_hitch( int i )
+{
+   int start = ( frametime_hpos - frametime_nhitch + FRAMETIME_HITCHES ) %
+               FRAMETIME_HITCHES;
+   if ( ( i < 0 ) || ( i >= frametime_nhitch ) )
+      return NULL;
+   return &frametime_hitches[( start + i ) % FRAMETIME_HITCHES];
+}
+
+/**
+ * @brief Writes a formatted string to a PhysicsFS file.
+ */
+PRINTF_FORMAT( 2, 3 )
+static void frametime_write( PHYSFS_File *f, const char *fmt, ... )
+{
+   char    buf[STRMAX];
+   va_list ap;
+   int     n;
+
+   va_start( ap, fmt );
+   n = vsnprintf( buf, sizeof( buf ), fmt, ap );
+   va_end( ap );
+   PHYSFS_writeBytes( f, buf, MIN( n, (int)sizeof( buf ) - 1 ) );
+}
+
+/**
+ * @brief Writes a summary as a JSON object.
+ */
+static void frametime_writeStats( PHYSFS_File *f, const FrameTimeStats *s )
+{
+   frametime_write( f,
+                    "{ \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, "
+                    "\"max\": %.3f }",
+                    s->p50, s->p95, s->p99, s->max );
+}
+
+/**
+ * @brief Dumps the recorded frames to a file in the write directory.
+ *
+ * The CSV format has a row per frame with the time of each zone. The JSON
+ * format also includes the percentile summaries and the hitches. Both include
+ * the heap allocations of each frame.
+ *
+ *    @param path Path to write to, relative to the write directory.
+ *    @param json Whether to write JSON instead of CSV.
+ *    @return 0 on success.
+ */
+int frametime_dump( const char *path, int json )
+{
+   FrameTimeStats total, zones[FRAME_ZONE_SENTINEL], allocs;
+   PHYSFS_File   *f = PHYSFS_openWrite( path );
+   if ( f == NULL ) {
+      WARN( _( "Unable to open '%s' for writing: %s" ), path,
+            _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+      return -1;
+   }
+
+   if ( !json ) {
+      frametime_write( f, "frame,total" );
+      for ( int z = 0; z < FRAME_ZONE_SENTINEL; z++ )
+         frametime_write( f, ",%s", frametime_names[z] );
+      frametime_write( f, ",allocs,hitch\n" );
+      for ( int i = 0; i < frametime_nring; i++ ) {
+         const FrameTime *ft = frametime_get( i );
+         frametime_write( f, "%u,%.3f", ft->frame, ft->total );
+         for ( int z = 0; z < FRAME_ZONE_SENTINEL; z++ )
+            frametime_write( f, ",%.3f", ft->zones[z] );
+         frametime_write( f, ",%d,%d\n", ft->allocs, ft->hitch );
+      }
+      PHYSFS_close( f );
+      return 0;
+   }
+
+   frametime_stats( &total, zones, &allocs );
+   frametime_write( f, "{\n\"frames\": %d,\n\"total\": ", frametime_nring );
+   frametime_writeStats( f, &total );
+   frametime_write( f, ",\n\"zones\": {\n" );
+   for ( int z = 0; z < FRAME_ZONE_SENTINEL; z++ ) {
+      frametime_write( f, "  \"%s\": ", frametime_names[z] );
+      frametime_writeStats( f, &zones[z] );
+      frametime_write( f, "%s\n", ( z < FRAME_ZONE_SENTINEL - 1 ) ? "," : "" );
+   }
+   frametime_write( f, "},\n\"allocs\": " );
+   frametime_writeStats( f, &allocs );
+   frametime_write( f, ",\n\"hitches\": [\n" );
+   for ( int i = 0; i < frametime_nhitch; i++ ) {
+      const FrameHitch *h = frametime_hitch( i );
+      frametime_write( f,
+                       "  { \"frame\": %u, \"ticks\": %u, \"total\": %.3f, "
+                       "\"top\": [",
+                       h->frame, h->ticks, h->total );
+      for ( int k = 0; k < FRAMETIME_TOP; k++ )
+         frametime_write( f, "%s{ \"zone\": \"%s\", \"ms\": %.3f }",
+                          ( k > 0 ) ? ", " : "", frametime_names[h->top[k]],
+                          h->topms[k] );
+      frametime_write( f, "] }%s\n",
+                       ( i < frametime_nhitch - 1 ) ? "," : "" );
+   }
+   frametime_write( f, "],\n\"frametimes\": [" );
+   for ( int i = 0; i < frametime_nring; i++ )
+      frametime_write( f, "%s%.3f", ( i > 0 ) ? ", " : "",
+                       frametime_get( i )->total );
+   frametime_write( f, "]\n}\n" );
+   PHYSFS_close( f );
+   return 0;
+}
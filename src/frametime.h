@@ -0,0 +1,63 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/** @cond */
+#include "SDL_stdinc.h"
+/** @endcond */
+
+#define FRAMETIME_TOP 3 /**< Number of zones recorded for each hitch. */
+
+/**
+ * @brief Parts of a frame that get timed.
+ */
+typedef enum FrameZone_e {
+   FRAME_ZONE_WAIT,    /**< Sleeping to limit the FPS. */
+   FRAME_ZONE_PURGE,   /**< Purging dead pilots and weapons. */
+   FRAME_ZONE_SPACE,   /**< Updating the system. */
+   FRAME_ZONE_SPFX,    /**< Updating special effects. */
+   FRAME_ZONE_COLLIDE, /**< Weapon collisions. */
+   FRAME_ZONE_PILOTS,  /**< Updating pilots. */
+   FRAME_ZONE_WEAPONS, /**< Updating weapons. */
+   FRAME_ZONE_HOOKS,   /**< Running the update and safe hooks. */
+   FRAME_ZONE_RENDER,  /**< Rendering and swapping buffers. */
+   FRAME_ZONE_GC,      /**< Collecting Lua garbage in idle time. */
+   FRAME_ZONE_SENTINEL /**< Number of zones. */
+} FrameZone;
+
+/**
+ * @brief Percentile summary of frame timings in milliseconds.
+ */
+typedef struct FrameTimeStats_ {
+   double p50; /**< Median. */
+   double p95; /**< 95th percentile. */
+   double p99; /**< 99th percentile. */
+   double max; /**< Maximum. */
+} FrameTimeStats;
+
+/**
+ * @brief A frame that took much longer than usual.
+ */
+typedef struct FrameHitch_ {
+   unsigned int frame;                /**< Frame number. */
+   Uint32       ticks;                /**< SDL ticks at the end of the frame. */
+   double       total;                /**< Frame time minus waiting in ms. */
+   FrameZone    top[FRAMETIME_TOP];   /**< Slowest zones, slowest first. */
+   double       topms[FRAMETIME_TOP]; /**< Time of the slowest zones. */
+} FrameHitch;
+
+/* Recording. */
+Uint64 frametime_now( void );
+Uint64 frametime_zone( FrameZone zone, Uint64 start );
+void   frametime_frame( void );
+void   frametime_reset( void );
+
+/* Querying. */
+const char       *frametime_zoneName( FrameZone zone );
+int               frametime_stats( FrameTimeStats *total,
+                                   FrameTimeStats  zones[FRAME_ZONE_SENTINEL],
+                                   FrameTimeStats *allocs );
+int               frametime_nhitches( void );
+const FrameHitch *frametime_hitch( int i );
+int               frametime_dump( const char *path, int json );
@@ -69,14 +69,27 @@
 
 #define RADAR_BLINK_PILOT 0.5 /**< Blink rate of the pilot target on radar. */
 #define RADAR_BLINK_SPOB 1.   /**< Blink rate of the spob target on radar. */
+#define RADAR_QUERY_MARGIN                                                     \
+   20. /**< Margin in radar units for pilots partially on the radar. */
 
 /* some blinking stuff. */
 static double blink_pilot  = 0.; /**< Timer on target blinking on radar. */
 static double blink_spob   = 0.; /**< Timer on spob blinking on radar. */
 static double animation_dt = 0.; /**< Used for animations. */
 
+/**
+ * @brief Blip to be rendered in a batch on the radar.
+ */
+typedef struct RadarBlip_ {
+   GLfloat x, y;       /**< Position in radar units. */
+   GLfloat r, g, b, a; /**< Colour. */
+} RadarBlip;
+
 /* for VBO. */
 static gl_vbo *gui_radar_select_vbo = NULL;
+static gl_vbo *gui_radar_blip_vbo   = NULL; /**< Batched radar blips. */
+static GLsizei gui_radar_blip_size  = 0;    /**< Size of the blip VBO. */
+static RadarBlip *gui_radar_blips = NULL; /**< Batched blips (array.h). */
 
 static int gui_getMessage =
    1; /**< Whether or not the player should receive messages. */
@@ -932,6 +945,67 @@ int gui_radarInit( int circle, int w, int h )
    return 0;
 }
 
+/**
+ * @brief Adds a blip to be rendered in a batch on the radar.
+ */
+static void gui_radarBlip( double x, double y, const glColour *c )
+{
+   RadarBlip *b = &array_grow( &gui_radar_blips );
+   b->x         = x;
+   b->y         = y;
+   b->r         = c->r;
+   b->g         = c->g;
+   b->b         = c->b;
+   b->a         = c->a;
+}
+
+/**
+ * @brief Renders all the batched radar blips with a single draw.
+ *
+ *    @param r Radius of the blips in radar units.
+ */
+static void gui_radarBlipRender( double r )
+{
+   GLsizei n    = array_size( gui_radar_blips );
+   GLsizei size = sizeof( RadarBlip ) * n;
+
+   if ( n <= 0 )
+      return;
+
+   /* Upload, growing the VBO if needed. */
+   if ( gui_radar_blip_vbo == NULL ) {
+      gui_radar_blip_size = size;
+      gui_radar_blip_vbo  = gl_vboCreateStream( size, gui_radar_blips );
+   } else if ( size > gui_radar_blip_size ) {
+      gui_radar_blip_size = size;
+      gl_vboData( gui_radar_blip_vbo, size, gui_radar_blips );
+   } else
+      gl_vboSubData( gui_radar_blip_vbo, 0, size, gui_radar_blips );
+
+   glEnable( GL_PROGRAM_POINT_SIZE );
+   glUseProgram( shaders.asteroidmarkers.program );
+   glEnableVertexAttribArray( shaders.asteroidmarkers.vertex );
+   glEnableVertexAttribArray( shaders.asteroidmarkers.vertex_colour );
+   gl_uniformMat4( shaders.asteroidmarkers.projection, &gl_view_matrix );
+   glUniform1f( shaders.asteroidmarkers.size, 2. * r / gl_screen.scale );
+   glUniform2f( shaders.asteroidmarkers.dimensions, r, r );
+   gl_vboActivateAttribOffset( gui_radar_blip_vbo,
+                               shaders.asteroidmarkers.vertex, 0, 2, GL_FLOAT,
+                               sizeof( RadarBlip ) );
+   gl_vboActivateAttribOffset(
+      gui_radar_blip_vbo, shaders.asteroidmarkers.vertex_colour,
+      offsetof( RadarBlip, r ), 4, GL_FLOAT, sizeof( RadarBlip ) );
+   glDrawArrays( GL_POINTS, 0, n );
+   glDisableVertexAttribArray( shaders.asteroidmarkers.vertex );
+   glDisableVertexAttribArray( shaders.asteroidmarkers.vertex_colour );
+   glUseProgram( 0 );
+   glDisable( GL_PROGRAM_POINT_SIZE );
+   gl_checkErr();
+
+   gl_stats.draws++;
+   gl_stats.instances += n;
+}
+
 /**
  * @brief Renders the GUI radar.
  *
@@ -940,10 +1014,12 @@ int gui_radarInit( int circle, int w, int h )
  */
 void gui_radarRender( double x, double y )
 {
-   int           f;
-   Radar        *radar;
-   mat4          view_matrix_prev;
-   Pilot *const *pilot_stack;
+   Radar          *radar;
+   mat4            view_matrix_prev;
+   Pilot *const   *pilot_stack;
+   const Pilot    *target;
+   const Asteroid *targeted;
+   double          px, py, rw, rh, m;
 
    if ( !conf.always_radar && ovr_isOpen() )
       return;
@@ -994,37 +1070,78 @@ void gui_radarRender( double x, double y )
     */
    weapon_minimap( radar->res, radar->w, radar->h, radar->shape, 1. );
 
+   /* Only query what can be seen on the radar. */
+   px = player.p->solid.pos.x;
+   py = player.p->solid.pos.y;
+   if ( radar->shape == RADAR_RECT ) {
+      rw = radar->w / 2. * radar->res;
+      rh = radar->h / 2. * radar->res;
+   } else {
+      rw = radar->w * radar->res;
+      rh = rw;
+   }
+
    /* render the pilot */
    pilot_stack = pilot_getAll();
-   f           = 0;
-   for ( int i = 1; i < array_size( pilot_stack ); i++ ) { /* skip the player */
-      if ( pilot_stack[i]->id == player.p->target )
-         f = i;
-      else
-         gui_renderPilot( pilot_stack[i], radar->shape, radar->w, radar->h,
-                          radar->res, 0 );
+   target      = pilot_get( player.p->target );
+   m           = RADAR_QUERY_MARGIN * radar->res;
+   pilot_collideQueryIL( &gui_qtquery, floor( px - rw - m ),
+                         floor( py - rh - m ), ceil( px + rw + m ),
+                         ceil( py + rh + m ) );
+   for ( int i = 0; i < il_size( &gui_qtquery ); i++ ) {
+      int          k = il_get( &gui_qtquery, i, 0 );
+      const Pilot *p;
+      if ( k >= array_size( pilot_stack ) )
+         continue;
+      p = pilot_stack[k];
+      if ( ( p == player.p ) || ( p == target ) )
+         continue;
+      gui_renderPilot( p, radar->shape, radar->w, radar->h, radar->res, 0 );
    }
-   /* render the targeted pilot */
-   if ( f != 0 )
-      gui_renderPilot( pilot_stack[f], radar->shape, radar->w, radar->h,
-                       radar->res, 0 );
-
-   /* Render the asteroids */
+   /* render the targeted pilot, which may be out of range */
+   if ( ( target != NULL ) && ( target != player.p ) )
+      gui_renderPilot( target, radar->shape, radar->w, radar->h, radar->res,
+                       0 );
+
+   /* Render the asteroids as a single batch, except the targeted one. */
+   targeted = NULL;
+   if ( gui_radar_blips == NULL )
+      gui_radar_blips = array_create( RadarBlip );
+   array_resize( &gui_radar_blips, 0 );
    for ( int i = 0; i < array_size( cur_system->asteroids ); i++ ) {
       AsteroidAnchor *ast   = &cur_system->asteroids[i];
       double          range = EW_ASTEROID_DIST *
                      player.p->stats.ew_detect; /* TODO don't hardcode. */
-      int ax, ay, r;
-      ax = round( player.p->solid.pos.x );
-      ay = round( player.p->solid.pos.y );
-      r  = ceil( range );
-      asteroid_collideQueryIL( ast, &gui_qtquery, ax - r, ay - r, ax + r,
-                               ay + r );
+      double ax, ay;
+      ax = MIN( range, rw );
+      ay = MIN( range, rh );
+      asteroid_collideQueryIL( ast, &gui_qtquery, floor( px - ax ),
+                               floor( py - ay ), ceil( px + ax ),
+                               ceil( py + ay ) );
       for ( int j = 0; j < il_size( &gui_qtquery ); j++ ) {
          const Asteroid *a = &ast->asteroids[il_get( &gui_qtquery, j, 0 )];
-         gui_renderAsteroid( a, radar->w, radar->h, radar->res, 0 );
+         double          bx, by;
+
+         /* Same checks as gui_renderAsteroid(). */
+         if ( a->state != ASTEROID_FG )
+            continue;
+         if ( ( a->id == player.p->nav_asteroid ) &&
+              ( a->parent == player.p->nav_anchor ) ) {
+            targeted = a;
+            continue;
+         }
+         if ( !pilot_inRangeAsteroid( player.p, a->id, a->parent ) )
+            continue;
+
+         bx = ( a->sol.pos.x - px ) / radar->res;
+         by = ( a->sol.pos.y - py ) / radar->res;
+         gui_radarBlip( MAX( bx - 1., -radar->w ), MAX( by - 1., -radar->h ),
+                        &cGrey70 );
       }
    }
+   gui_radarBlipRender( 2.5 );
+   if ( targeted != NULL )
+      gui_renderAsteroid( targeted, radar->w, radar->h, radar->res, 0 );
 
    /* Render the player. */
    gui_renderPlayer( radar->res, 0 );
@@ -2001,7 +2118,7 @@ int gui_load( const char *name )
    gui_env = LUA_NOREF;
 
    /* Create Lua state. */
-   gui_env = nlua_newEnv();
+   gui_env = nlua_newEnv( path );
    nlua_loadStandard( gui_env );
    nlua_loadGFX( gui_env );
    nlua_loadGUI( gui_env );
@@ -2125,6 +2242,11 @@ void gui_free( void )
 
    gl_vboDestroy( gui_radar_select_vbo );
    gui_radar_select_vbo = NULL;
+   gl_vboDestroy( gui_radar_blip_vbo );
+   gui_radar_blip_vbo  = NULL;
+   gui_radar_blip_size = 0;
+   array_free( gui_radar_blips );
+   gui_radar_blips = NULL;
 
    osd_exit();
 
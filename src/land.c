@@ -38,6 +38,7 @@
 #include "ndata.h"
 #include "news.h"
 #include "nlua.h"
+#include "nlua_gc.h"
 #include "nlua_tk.h"
 #include "nluadef.h"
 #include "npc.h"
@@ -122,7 +123,6 @@ static void     land_stranded( void );
 /*
  * prototypes
  */
-static int  land_gc( void *unused );
 static int  land_hasLocalMap( void );
 static void land_createMainTab( unsigned int wid );
 static void land_setupTabs( void );
@@ -1266,9 +1266,9 @@ void land( Spob *p, int load )
    /* Just in case? */
    bar_regen();
 
-   /* Do a lua collection pass. Run in a hook since land can be called
-    * indirectly from Lua. */
-   hook_addFunc( land_gc, NULL, "safe" );
+   /* Landing leaves a lot of garbage behind, so collect it while idle instead
+    * of waiting for the heap to grow. */
+   nlua_gcRequest();
 
    /* Mission forced take off. */
    land_needsTakeoff( 0 );
@@ -1276,16 +1276,6 @@ void land( Spob *p, int load )
    NTracingFrameMarkEnd( "land" );
 }
 
-/**
- * @brief Runs Lua garbage collection.
- */
-static int land_gc( void *unused )
-{
-   (void)unused;
-   lua_gc( naevL, LUA_GCCOLLECT, 0 );
-   return 0;
-}
-
 /**
  * @brief Creates the main tab.
  *
@@ -1681,7 +1671,7 @@ static void land_stranded( void )
       char  *buf;
       size_t bufsize;
 
-      rescue_env = nlua_newEnv();
+      rescue_env = nlua_newEnv( "rescue" );
       nlua_loadStandard( rescue_env );
       nlua_loadTk( rescue_env );
 
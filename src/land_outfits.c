@@ -343,6 +343,14 @@ static int outfitLand_filterCore( const Outfit *o )
    return outfitLand_filter( o ) && outfit_filterCore( o );
 }
 
+/**
+ * @brief Gets the pilot the outfit store describes outfits for.
+ */
+static const Pilot *outfits_player( void )
+{
+   return player.p;
+}
+
 /**
  * @brief Generates the outfit list.
  *
@@ -456,8 +464,8 @@ static void outfits_genList( unsigned int wid )
    noutfits = outfits_filter( (const Outfit **)iar_outfits[active],
                               array_size( iar_outfits[active] ),
                               tabfilters[active], filtertext );
-   coutfits = outfits_imageArrayCells( (const Outfit **)iar_outfits[active],
-                                       &noutfits, player.p, 1 );
+   coutfits = outfits_imageArrayCellsLazy( &noutfits );
+   pilot_outfitDescCacheClear();
 
    iconsize = 128;
    if ( !conf.big_icons ) {
@@ -471,6 +479,9 @@ static void outfits_genList( unsigned int wid )
    window_addImageArray( wid, 20, 20, iw, ih - 34, OUTFITS_IAR, iconsize,
                          iconsize, coutfits, noutfits, outfits_update,
                          outfits_rmouse, NULL );
+   outfits_imageArrayLazy( wid, OUTFITS_IAR,
+                           (const Outfit **)iar_outfits[active],
+                           outfits_player, 1 );
 
    /* write the outfits stuff */
    outfits_update( wid, NULL );
@@ -802,6 +813,97 @@ int outfit_altText( char *buf, int n, const Outfit *o, const Pilot *plt )
    return 0;
 }
 
+/**
+ * @brief Data used to lazily generate outfit image arrays.
+ */
+typedef struct OutfitsLazy_ {
+   const Outfit **outfits;          /**< Outfits being displayed. */
+   const Pilot *( *pilot )( void ); /**< Gets the pilot to describe for. */
+   int store;                       /**< Whether or not it is a store. */
+} OutfitsLazy;
+
+/**
+ * @brief Loads the store graphics of the outfits that need them.
+ */
+static void outfits_imageArrayGfx( const Outfit **outfits, int start, int end )
+{
+   /* Threaded loading of graphics for speed. */
+   int needsgfx = 0;
+   for ( int i = start; i < end; i++ ) {
+      Outfit *o = (Outfit *)outfits[i];
+      if ( !outfit_gfxStoreLoaded( o ) ) {
+         outfit_setProp( o, OUTFIT_PROP_NEEDSGFX );
+         needsgfx = 1;
+      }
+   }
+   if ( needsgfx )
+      outfit_gfxStoreLoadNeeded();
+}
+
+/**
+ * @brief Sets up an image array cell for an outfit, except the alt text.
+ */
+static void outfits_imageArrayCell( ImageArrayCell *cell, const Outfit *o,
+                                    int store )
+{
+   const glColour *c;
+   glTexture      *t;
+
+   cell->image   = gl_dupTexture( o->gfx_store );
+   cell->caption = strdup( outfit_shortname( o ) );
+   if ( !store && outfit_isProp( o, OUTFIT_PROP_UNIQUE ) )
+      cell->quantity = -1; /* Don't display. */
+   else
+      cell->quantity = player_outfitOwned( o );
+   cell->sloticon = sp_icon( o->slot.spid );
+
+   /* Background colour. */
+   c = outfit_slotSizeColour( &o->slot );
+   if ( c == NULL )
+      c = &cBlack;
+   col_blend( &cell->bg, c, &cGrey70, 1 );
+
+   /* Slot type. */
+   if ( ( strcmp( outfit_slotName( o ), "N/A" ) != 0 ) &&
+        ( strcmp( outfit_slotName( o ), "NULL" ) != 0 ) ) {
+      size_t sz            = 0;
+      const char *typename = _( outfit_slotName( o ) );
+      u8_inc( typename, &sz );
+      cell->slottype = malloc( sz + 1 );
+      memcpy( cell->slottype, typename, sz );
+      cell->slottype[sz] = '\0';
+   }
+
+   /* Layers. */
+   cell->layers = gl_copyTexArray( o->gfx_overlays );
+   if ( o->rarity > 0 ) {
+      t            = rarity_texture( o->rarity );
+      cell->layers = gl_addTexArray( cell->layers, t );
+   }
+}
+
+/**
+ * @brief Generates the cells of a lazy outfit image array.
+ */
+static void outfits_imageArrayGen( ImageArrayCell *cells, int start, int end,
+                                   void *data )
+{
+   const OutfitsLazy *lazy = data;
+   outfits_imageArrayGfx( lazy->outfits, start, end );
+   for ( int i = start; i < end; i++ )
+      outfits_imageArrayCell( &cells[i], lazy->outfits[i], lazy->store );
+}
+
+/**
+ * @brief Generates the alt text of a lazy outfit image array cell.
+ */
+static char *outfits_imageArrayAlt( int pos, void *data )
+{
+   const OutfitsLazy *lazy = data;
+   return strdup(
+      pilot_outfitSummaryCached( lazy->pilot(), lazy->outfits[pos], 1 ) );
+}
+
 /**
  * @brief Generates image array cells corresponding to outfits.
  */
@@ -816,65 +918,60 @@ ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits,
       coutfits[0].image   = NULL;
       coutfits[0].caption = strdup( _( "None" ) );
    } else {
-      /* Threaded loading of graphics for speed. */
-      int needsgfx = 0;
+      outfits_imageArrayGfx( outfits, 0, *noutfits );
       for ( int i = 0; i < *noutfits; i++ ) {
-         Outfit *o = (Outfit *)outfits[i];
-         if ( !outfit_gfxStoreLoaded( o ) ) {
-            outfit_setProp( o, OUTFIT_PROP_NEEDSGFX );
-            needsgfx = 1;
-         }
+         outfits_imageArrayCell( &coutfits[i], outfits[i], store );
+         /* Short description. */
+         coutfits[i].alt =
+            strdup( pilot_outfitSummaryCached( p, outfits[i], 1 ) );
       }
-      if ( needsgfx )
-         outfit_gfxStoreLoadNeeded();
-      /* Just to be safe, we assume some ships colud potentially be duplicated.
-       */
-
-      /* Set alt text. */
-      for ( int i = 0; i < *noutfits; i++ ) {
-         const glColour *c;
-         glTexture      *t;
-         const Outfit   *o = outfits[i];
-
-         coutfits[i].image   = gl_dupTexture( o->gfx_store );
-         coutfits[i].caption = strdup( outfit_shortname( o ) );
-         if ( !store && outfit_isProp( o, OUTFIT_PROP_UNIQUE ) )
-            coutfits[i].quantity = -1; /* Don't display. */
-         else
-            coutfits[i].quantity = player_outfitOwned( o );
-         coutfits[i].sloticon = sp_icon( o->slot.spid );
-
-         /* Background colour. */
-         c = outfit_slotSizeColour( &o->slot );
-         if ( c == NULL )
-            c = &cBlack;
-         col_blend( &coutfits[i].bg, c, &cGrey70, 1 );
+   }
+   return coutfits;
+}
 
-         /* Short description. */
-         coutfits[i].alt = strdup( pilot_outfitSummary( p, o, 1 ) );
-
-         /* Slot type. */
-         if ( ( strcmp( outfit_slotName( o ), "N/A" ) != 0 ) &&
-              ( strcmp( outfit_slotName( o ), "NULL" ) != 0 ) ) {
-            size_t sz            = 0;
-            const char *typename = _( outfit_slotName( o ) );
-            u8_inc( typename, &sz );
-            coutfits[i].slottype = malloc( sz + 1 );
-            memcpy( coutfits[i].slottype, typename, sz );
-            coutfits[i].slottype[sz] = '\0';
-         }
+/**
+ * @brief Generates empty image array cells to be filled in lazily.
+ *
+ * Use with outfits_imageArrayLazy() once the image array is created.
+ */
+ImageArrayCell *outfits_imageArrayCellsLazy( int *noutfits )
+{
+   ImageArrayCell *coutfits =
+      calloc( MAX( 1, *noutfits ), sizeof( ImageArrayCell ) );
 
-         /* Layers. */
-         coutfits[i].layers = gl_copyTexArray( o->gfx_overlays );
-         if ( o->rarity > 0 ) {
-            t                  = rarity_texture( o->rarity );
-            coutfits[i].layers = gl_addTexArray( coutfits[i].layers, t );
-         }
-      }
+   if ( *noutfits == 0 ) {
+      *noutfits                = 1;
+      coutfits[0].caption      = strdup( _( "None" ) );
+      coutfits[0].generated    = 1;
+      coutfits[0].altgenerated = 1;
    }
    return coutfits;
 }
 
+/**
+ * @brief Makes an outfit image array only generate the visible cells.
+ *
+ * This avoids loading graphics and running the outfit Lua descriptions of
+ * every outfit in large lists.
+ *
+ *    @param wid Window where the image array is.
+ *    @param name Name of the image array.
+ *    @param outfits Outfits being displayed. Must outlive the image array.
+ *    @param pilot Gets the pilot to describe the outfits for when hovered.
+ *    @param store Whether or not it is a store.
+ */
+void outfits_imageArrayLazy( unsigned int wid, const char *name,
+                             const Outfit **outfits,
+                             const Pilot *( *pilot )( void ), int store )
+{
+   OutfitsLazy *lazy = malloc( sizeof( OutfitsLazy ) );
+   lazy->outfits     = outfits;
+   lazy->pilot       = pilot;
+   lazy->store       = store;
+   toolkit_setImageArrayLazy( wid, name, outfits_imageArrayGen,
+                              outfits_imageArrayAlt, lazy );
+}
+
 /**
  * Functions for the popdown menu (filter outfits by size)
  */
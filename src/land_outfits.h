@@ -17,6 +17,11 @@ int  outfits_filter( const Outfit **outfits, int                     n,
                      int ( *filter )( const Outfit *o ), const char *name );
 ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits,
                                          const Pilot *p, int store );
+ImageArrayCell *outfits_imageArrayCellsLazy( int *noutfits );
+void            outfits_imageArrayLazy( unsigned int wid, const char *name,
+                                        const Outfit **outfits,
+                                        const Pilot *( *pilot )( void ),
+                                        int store );
 int             outfit_canBuy( const Outfit *outfit, int blackmarket );
 int             outfit_canSell( const Outfit *outfit );
 void            outfits_cleanup( void );
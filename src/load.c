@@ -21,6 +21,7 @@
 #include "economy.h"
 #include "event.h"
 #include "faction.h"
+#include "frametime.h"
 #include "gui.h"
 #include "hook.h"
 #include "land.h"
@@ -29,6 +30,7 @@
 #include "mission.h"
 #include "ndata.h"
 #include "news.h"
+#include "nlua_gc.h"
 #include "nlua_var.h"
 #include "nstring.h"
 #include "ntracing.h"
@@ -1419,6 +1421,13 @@ static int load_gameInternalHook( void *data )
 
    xmlFreeDoc( doc );
 
+   /* Loading already stalls, so get rid of the garbage of the previous game
+    * here instead of during play. */
+   nlua_gcFull();
+
+   /* Don't count the loading as a hitch of the new game. */
+   frametime_reset();
+
    if ( misn_failed || evt_failed ) {
       char         buf[STRMAX];
       unsigned int l               = 0;
@@ -33,6 +33,7 @@
 #include "player_fleet.h"
 #include "rng.h"
 #include "space.h"
+#include "trigger.h"
 
 #define XML_MISSION_TAG "mission" /**< XML mission tag. */
 
@@ -48,6 +49,10 @@ static char       **player_missions_failed =
  * mission stack
  */
 static MissionData *mission_stack = NULL; /**< Unmutable after creation */
+static TriggerIndex mission_index[MIS_AVAIL_ENTER +
+                                  1]; /**< Missions by location. */
+static TriggerChapter *mission_chapters =
+   NULL; /**< Cached chapter matches of the mission stack. */
 
 /*
  * prototypes
@@ -64,6 +69,7 @@ static int mission_meetReq( const MissionData *misn, int faction,
                             const Spob *pnt, const StarSystem *sys );
 static int mission_matchFaction( const MissionData *misn, int faction );
 static int mission_location( const char *loc );
+static void missions_buildIndex( void );
 /* Loading. */
 static int missions_cmp( const void *a, const void *b );
 static int mission_parseFile( const char *file, MissionData *temp );
@@ -165,7 +171,7 @@ static int mission_init( Mission *mission, const MissionData *misn, int genid,
    }
 
    /* init Lua */
-   mission->env = nlua_newEnv();
+   mission->env = nlua_newEnv( misn->name );
 
    misn_loadLibs( mission->env ); /* load our custom libraries */
 
@@ -235,23 +241,11 @@ int mission_alreadyRunning( const MissionData *misn )
 static int mission_meetConditionals( const MissionData *misn )
 {
    /* If chapter, must match chapter. */
-   if ( misn->avail.chapter_re != NULL ) {
-      pcre2_match_data *match_data =
-         pcre2_match_data_create_from_pattern( misn->avail.chapter_re, NULL );
-      int rc = pcre2_match( misn->avail.chapter_re, (PCRE2_SPTR)player.chapter,
-                            strlen( player.chapter ), 0, 0, match_data, NULL );
-      pcre2_match_data_free( match_data );
-      if ( rc < 0 ) {
-         switch ( rc ) {
-         case PCRE2_ERROR_NOMATCH:
-            return -1;
-         default:
-            WARN( _( "Matching error %d" ), rc );
-            break;
-         }
-      } else if ( rc == 0 )
-         return 1;
-   }
+   if ( ( misn->avail.chapter_re != NULL ) &&
+        !trigger_chapterMatch( misn->avail.chapter_re,
+                               &mission_chapters[misn - mission_stack],
+                               misn->name ) )
+      return -1;
 
    /* Must not be already done or running if unique. */
    if ( mis_isFlag( misn, MISSION_UNIQUE ) &&
@@ -312,6 +306,21 @@ static int mission_meetReq( const MissionData *misn, int faction,
    return !mission_meetConditionals( misn );
 }
 
+/**
+ * @brief Gets the missions that can be available at a location.
+ *
+ *    @return Frame array (array.h) of indices into the mission stack.
+ */
+static const int *mission_candidates( MissionAvailability loc, int faction,
+                                      const Spob *pnt, const StarSystem *sys )
+{
+   if ( ( loc < 0 ) || ( loc > MIS_AVAIL_ENTER ) )
+      return NULL;
+   return trigger_indexQuery( &mission_index[loc],
+                              ( pnt != NULL ) ? pnt->name : NULL,
+                              ( sys != NULL ) ? sys->name : NULL, faction );
+}
+
 /**
  * @brief Runs missions matching location, all Lua side and one-shot.
  *
@@ -323,17 +332,15 @@ static int mission_meetReq( const MissionData *misn, int faction,
 void missions_run( MissionAvailability loc, int faction, const Spob *pnt,
                    const StarSystem *sys )
 {
-   for ( int i = 0; i < array_size( mission_stack ); i++ ) {
+   const int *cand = mission_candidates( loc, faction, pnt, sys );
+   for ( int c = 0; c < array_size( cand ); c++ ) {
       Mission      mission;
       double       chance;
-      MissionData *misn = &mission_stack[i];
+      MissionData *misn = &mission_stack[cand[c]];
 
       if ( naev_isQuit() )
          return;
 
-      if ( misn->avail.loc != loc )
-         continue;
-
       if ( !mission_meetReq( misn, faction, pnt, sys ) )
          continue;
 
@@ -928,17 +935,17 @@ int mission_compare( const void *arg1, const void *arg2 )
 Mission *missions_genList( int faction, const Spob *pnt, const StarSystem *sys,
                            MissionAvailability loc )
 {
-   int      rep;
-   Mission *tmp = array_create( Mission );
+   int        rep;
+   Mission   *tmp = array_create( Mission );
+   const int *cand;
 
    NTracingZone( _ctx, 1 );
 
    /* Find available missions. */
-   for ( int i = 0; i < array_size( mission_stack ); i++ ) {
+   cand = mission_candidates( loc, faction, pnt, sys );
+   for ( int c = 0; c < array_size( cand ); c++ ) {
       double       chance;
-      MissionData *misn = &mission_stack[i];
-      if ( misn->avail.loc != loc )
-         continue;
+      MissionData *misn = &mission_stack[cand[c]];
 
       /* Must hit chance. */
       chance = (double)( misn->avail.chance % 100 ) / 100.;
@@ -1169,6 +1176,7 @@ int missions_load( void )
     * first. */
    qsort( mission_stack, array_size( mission_stack ), sizeof( MissionData ),
           missions_cmp );
+   missions_buildIndex();
 
 #if DEBUGGING
    if ( conf.devmode ) {
@@ -1185,6 +1193,29 @@ int missions_load( void )
    return 0;
 }
 
+/**
+ * @brief Indexes the missions by where they can be available.
+ */
+static void missions_buildIndex( void )
+{
+   for ( int i = 0; i <= MIS_AVAIL_ENTER; i++ )
+      trigger_indexFree( &mission_index[i] );
+   for ( int i = 0; i < array_size( mission_stack ); i++ ) {
+      const MissionData *misn = &mission_stack[i];
+      if ( ( misn->avail.loc < 0 ) || ( misn->avail.loc > MIS_AVAIL_ENTER ) )
+         continue;
+      trigger_indexAdd( &mission_index[misn->avail.loc], i, misn->avail.spob,
+                        misn->avail.system, misn->avail.factions );
+   }
+   for ( int i = 0; i <= MIS_AVAIL_ENTER; i++ )
+      trigger_indexBuild( &mission_index[i] );
+
+   /* Chapter regexes may have changed too. */
+   free( mission_chapters );
+   mission_chapters =
+      calloc( MAX( 1, array_size( mission_stack ) ), sizeof( TriggerChapter ) );
+}
+
 /**
  * @brief Parses a single mission.
  *
@@ -1284,6 +1315,10 @@ void missions_free( void )
       mission_freeData( &mission_stack[i] );
    array_free( mission_stack );
    mission_stack = NULL;
+   for ( int i = 0; i <= MIS_AVAIL_ENTER; i++ )
+      trigger_indexFree( &mission_index[i] );
+   free( mission_chapters );
+   mission_chapters = NULL;
 
    /* Free the player mission stack. */
    array_free( player_missions );
@@ -1693,9 +1728,11 @@ int mission_reload( const char *name )
       return -1;
    save = *temp;
    res  = mission_parseFile( save.sourcefile, temp );
-   if ( res == 0 )
+   if ( res == 0 ) {
+      /* The index points to the names of the old data. */
+      missions_buildIndex();
       mission_freeData( &save );
-   else
+   } else
       *temp = save;
    return res;
 }
@@ -373,7 +373,7 @@ static int music_luaInit( void )
       music_luaQuit();
 
    /* Reset the environment. */
-   music_env = nlua_newEnv();
+   music_env = nlua_newEnv( "music" );
    nlua_loadStandard( music_env );
    nlua_loadTk( music_env );
 
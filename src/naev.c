@@ -27,6 +27,7 @@
 /** @endcond */
 
 #include "ai.h"
+#include "arena.h"
 #include "background.h"
 #include "camera.h"
 #include "cond.h"
@@ -41,6 +42,7 @@
 #include "event.h"
 #include "faction.h"
 #include "font.h"
+#include "frametime.h"
 #include "gui.h"
 #include "hook.h"
 #include "input.h"
@@ -61,6 +63,7 @@
 #include "nlua_colour.h"
 #include "nlua_data.h"
 #include "nlua_file.h"
+#include "nlua_gc.h"
 #include "nlua_gfx.h"
 #include "nlua_naev.h"
 #include "nlua_rnd.h"
@@ -90,6 +93,7 @@
 #include "tech.h"
 #include "threadpool.h"
 #include "toolkit.h"
+#include "trigger.h"
 #include "unidiff.h"
 #include "weapon.h"
 
@@ -100,6 +104,7 @@ Uint32              SDL_LOOPDONE = 0; /**< For custom event to exit loops. */
 static Uint64       last_t      = 0; /**< used to calculate FPS and movement. */
 static SDL_Surface *naev_icon   = NULL; /**< Icon. */
 static int          fps_skipped = 0;    /**< Skipped last frame? */
+static int          first_frame = 1;    /**< First frame not rendered yet? */
 /* Version stuff. */
 static semver_t version_binary; /**< Naev binary version. */
 
@@ -376,6 +381,12 @@ int main( int argc, char **argv )
    /* Unload load screen. */
    loadscreen_unload();
 
+   /* Get rid of the garbage of loading while we still can. */
+   nlua_gcFull();
+
+   /* Report how much I/O loading took. */
+   ndata_printStats();
+
    /* Start menu. */
    menu_main();
 
@@ -495,6 +506,7 @@ int main( int argc, char **argv )
    lua_exit();        /* Closes Lua state, and invalidates all Lua. */
    sound_exit();      /* Kills the sound */
    gl_exit();         /* Kills video output */
+   arena_free();      /* Frees the frame scratch memory. */
 
    /* Has to be run last or it will mess up sound settings. */
    conf_cleanup(); /* Free some memory the configuration allocated. */
@@ -534,7 +546,7 @@ void loadscreen_load( void )
    int r;
 
    load_mutex = SDL_CreateMutex();
-   load_env   = nlua_newEnv();
+   load_env   = nlua_newEnv( "loadscreen" );
 
    r = nlua_loadStandard( load_env );
    r |= nlua_loadNaev( load_env );
@@ -750,6 +762,7 @@ void unload_all( void )
    dtype_free(); /* gets rid of the damage types */
    missions_free();
    events_exit(); /* Clean up events. */
+   trigger_exit(); /* Clean up chapter matching. */
    factions_free();
    commodity_free();
    var_cleanup(); /* cleans up mission variables */
@@ -762,6 +775,7 @@ void unload_all( void )
 void main_loop( int nested )
 {
    NTracingZone( _ctx, 1 );
+   ArenaMark mark = arena_mark();
 
    /*
     * Control FPS.
@@ -784,8 +798,11 @@ void main_loop( int nested )
 
    /* Safe hook should be run every frame regardless of whether game is paused
     * or not. */
-   if ( !nested )
+   if ( !nested ) {
+      Uint64 t = frametime_now();
       hooks_run( "safe" );
+      frametime_zone( FRAME_ZONE_HOOKS, t );
+   }
 
    /* Checks to see if we want to land. */
    space_checkLand();
@@ -796,14 +813,35 @@ void main_loop( int nested )
    if ( !quit ) { /* So if update sets up a nested main loop, we can end up in a
                      state where things are corrupted when trying to exit the
                      game. Avoid rendering when quitting just in case. */
+      Uint64 t = frametime_now();
       /* Clear buffer. */
       render_all( game_dt, real_dt );
       /* Draw buffer. */
       SDL_GL_SwapWindow( gl_screen.window );
+      frametime_zone( FRAME_ZONE_RENDER, t );
+      gl_statsFrame();
+      /* The rendering smoke test waits for this. */
+      if ( first_frame ) {
+         const glRenderStats *stats = gl_statsLast();
+         LOG( _( "Rendered first frame with %u draws, %u state changes, %u "
+                 "instances and %u glyphs" ),
+              stats->draws, stats->states, stats->instances, stats->glyphs );
+         first_frame = 0;
+      }
+      /* Nested loops, such as dialogues, close their own frames so the frame
+       * that opened them doesn't span the whole dialogue. */
+      frametime_frame();
 
       NTracingFrameMark;
    }
 
+   /* Release the scratch memory of the frame. Nested loops must leave the
+    * memory of the frame that started them alone. */
+   if ( nested )
+      arena_release( mark );
+   else
+      arena_reset();
+
    NTracingZoneEnd( _ctx );
 }
 
@@ -897,16 +935,29 @@ static void fps_control( void )
 #if !SDL_VERSION_ATLEAST( 3, 0, 0 ) && HAS_POSIX
    struct timespec ts;
 #endif /* HAS_POSIX */
+   double slack = 0.;
+   double delay;
+   Uint64 t;
 
    /* dt in s */
    real_dt = fps_elapsed();
    game_dt = real_dt * dt_mod; /* Apply the modifier. */
 
-   /* if fps is limited */
+   /* if fps is limited, we know how much time we have left */
    if ( !conf.vsync && conf.fps_max != 0 ) {
       const double fps_max = 1. / (double)conf.fps_max;
-      if ( real_dt < fps_max ) {
-         double delay = fps_max - real_dt;
+      if ( real_dt < fps_max )
+         slack = fps_max - real_dt;
+   }
+
+   /* Collect Lua garbage in the idle time, so it doesn't get done in the
+    * middle of the next frame. */
+   t     = frametime_now();
+   delay = slack - nlua_gcIdle( slack );
+   t     = frametime_zone( FRAME_ZONE_GC, t );
+
+   if ( slack > 0. ) {
+      if ( delay > 0. ) {
 #if SDL_VERSION_ATLEAST( 3, 0, 0 )
          SDL_DelayNS( delay * 1e9 );
 #elif HAS_POSIX
@@ -916,8 +967,9 @@ static void fps_control( void )
 #else                     /* HAS_POSIX */
          SDL_Delay( (unsigned int)( delay * 1000. ) );
 #endif                    /* HAS_POSIX */
-         fps_dt += delay; /* makes sure it displays the proper fps */
+         frametime_zone( FRAME_ZONE_WAIT, t );
       }
+      fps_dt += slack; /* makes sure it displays the proper fps */
    }
 }
 
@@ -1004,6 +1056,9 @@ static void update_all( int dohooks )
       microdt = game_dt / nf;
       n       = (int)nf;
 
+      /* Idle pilots far away don't need all the steps of time compression. */
+      pilots_setLOD( dt_mod > player_dt_default() );
+
       /* Update as much as needed, evenly. */
       accumdt = 0.;
       for ( int i = 0; i < n; i++ ) {
@@ -1020,6 +1075,8 @@ static void update_all( int dohooks )
             break;
       }
 
+      pilots_setLOD( 0 );
+
       /* Note we don't touch game_dt so that fps_display works well */
    } else /* Standard, just update with the last dt */
       update_routine( game_dt, dohooks );
@@ -1041,6 +1098,7 @@ void update_routine( double dt, int dohooks )
    NTracingZone( _ctx, 1 );
 
    double real_update = dt / dt_mod;
+   Uint64 t;
 
    if ( dohooks ) {
       hook_exclusionStart();
@@ -1050,18 +1108,25 @@ void update_routine( double dt, int dohooks )
    }
 
    /* Clean up dead elements and build quadtrees. */
+   t = frametime_now();
    pilots_updatePurge();
    weapons_updatePurge();
+   t = frametime_zone( FRAME_ZONE_PURGE, t );
 
    /* Core stuff independent of collisions. */
    space_update( dt, real_update );
+   t = frametime_zone( FRAME_ZONE_SPACE, t );
    spfx_update( dt, real_update );
+   t = frametime_zone( FRAME_ZONE_SPFX, t );
 
    if ( dt > 0. ) {
       /* First compute weapon collisions. */
       weapons_updateCollide( dt );
+      t = frametime_zone( FRAME_ZONE_COLLIDE, t );
       pilots_update( dt );
+      t = frametime_zone( FRAME_ZONE_PILOTS, t );
       weapons_update( dt ); /* Has weapons think and update positions. */
+      frametime_zone( FRAME_ZONE_WEAPONS, t );
 
       /* Update camera. */
       cam_update( dt );
@@ -1073,6 +1138,7 @@ void update_routine( double dt, int dohooks )
    if ( dohooks ) {
       NTracingZoneName( _ctx_hook, "hooks[update]", 1 );
       HookParam h[3];
+      t = frametime_now();
       hook_exclusionEnd( dt );
       /* Hook set up. */
       h[0].type  = HOOK_PARAM_NUMBER;
@@ -1082,6 +1148,7 @@ void update_routine( double dt, int dohooks )
       h[2].type  = HOOK_PARAM_SENTINEL;
       /* Run the update hook. */
       hooks_runParam( "update", h );
+      frametime_zone( FRAME_ZONE_HOOKS, t );
       NTracingZoneEnd( _ctx_hook );
    }
 
@@ -0,0 +1,372 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file nameindex.c
+ *
+ * @brief Perfect hashing of names for constant time lookups.
+ *
+ * Registries like the outfit, ship, spob and system stacks don't change once
+ * loaded, so instead of binary searching them with strcmp, we build a minimal
+ * perfect hash of the names using the "hash, displace and compress" scheme:
+ * names are grouped into small buckets, and each bucket gets a displacement
+ * pair so that all the names land in different slots. A lookup is then a
+ * single hash and a single string comparison.
+ */
+/** @cond */
+#include <stdlib.h>
+#include <string.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "nameindex.h"
+
+#include "log.h"
+
+#define NAMEINDEX_BUCKET 4 /**< Average number of names per bucket. */
+#define NAMEINDEX_D0 16    /**< Number of first displacements to try. */
+#define NAMEINDEX_ATTEMPTS 8 /**< Number of seeds to try before giving up. */
+
+/**
+ * @brief Used to sort the buckets by decreasing size.
+ */
+typedef struct NameIndexBucket_ {
+   int size;  /**< Number of names in the bucket. */
+   int start; /**< Position of the first name in the ordered list. */
+   int id;    /**< ID of the bucket. */
+} NameIndexBucket;
+
+/**
+ * @brief Lowers ASCII letters if matching case insensitively.
+ *
+ * We don't use tolower() so the result doesn't depend on the locale.
+ */
+static inline unsigned char nameindex_fold( unsigned char c, int fold )
+{
+   if ( fold && ( c >= 'A' ) && ( c <= 'Z' ) )
+      return c - 'A' + 'a';
+   return c;
+}
+
+/**
+ * @brief Finalizer of MurmurHash3 to mix up the bits.
+ */
+static inline uint64_t nameindex_mix( uint64_t h )
+{
+   h ^= h >> 33;
+   h *= 0xff51afd7ed558ccdULL;
+   h ^= h >> 33;
+   h *= 0xc4ceb9fe1a85ec53ULL;
+   h ^= h >> 33;
+   return h;
+}
+
+/**
+ * @brief Seeded FNV-1a hash of a name.
+ */
+static uint64_t nameindex_hash( const char *name, uint32_t seed, int fold )
+{
+   const unsigned char *c = (const unsigned char *)name;
+   uint64_t             h =
+      0xcbf29ce484222325ULL ^ ( seed * 0x9e3779b97f4a7c15ULL );
+   for ( ; *c != '\0'; c++ ) {
+      h ^= nameindex_fold( *c, fold );
+      h *= 0x100000001b3ULL;
+   }
+   return nameindex_mix( h );
+}
+
+/**
+ * @brief Compares two names.
+ */
+static int nameindex_equal( const char *a, const char *b, int fold )
+{
+   const unsigned char *ca = (const unsigned char *)a;
+   const unsigned char *cb = (const unsigned char *)b;
+   while ( nameindex_fold( *ca, fold ) == nameindex_fold( *cb, fold ) ) {
+      if ( *ca == '\0' )
+         return 1;
+      ca++;
+      cb++;
+   }
+   return 0;
+}
+
+/**
+ * @brief Gets the bucket of a hash.
+ */
+static inline uint32_t nameindex_bucket( const NameIndex *idx, uint64_t h )
+{
+   return (uint32_t)( h >> 32 ) % idx->nbuckets;
+}
+
+/**
+ * @brief Gets the slot of a hash given the displacement pair.
+ */
+static inline uint32_t nameindex_slot( const NameIndex *idx, uint64_t h,
+                                       uint32_t d0, uint32_t d1 )
+{
+   uint64_t g = nameindex_mix( h + 0x9e3779b97f4a7c15ULL );
+   return ( (uint64_t)(uint32_t)g + (uint64_t)d0 * ( g >> 32 ) + d1 ) %
+          idx->nslots;
+}
+
+/**
+ * @brief Sorts buckets by decreasing size.
+ */
+static int nameindex_bucketCmp( const void *p1, const void *p2 )
+{
+   const NameIndexBucket *b1 = p1;
+   const NameIndexBucket *b2 = p2;
+   if ( b1->size != b2->size )
+      return b2->size - b1->size;
+   return b1->id - b2->id;
+}
+
+/**
+ * @brief Tries to place all the names with the current seed.
+ *
+ *    @param idx Index to fill. Must have the slots and buckets allocated.
+ *    @param names Names to place.
+ *    @param n Number of names.
+ *    @param hash Scratch space for n hashes.
+ *    @param order Scratch space for n name positions.
+ *    @param buckets Scratch space for the buckets.
+ *    @param slots Scratch space for the slots of a bucket.
+ *    @return 0 on success, -1 if the seed doesn't work.
+ */
+static int nameindex_place( NameIndex *idx, const char *const *names, int n,
+                            uint64_t *hash, int *order,
+                            NameIndexBucket *buckets, uint32_t *slots )
+{
+   int fold = ( idx->flags & NAMEINDEX_CASE );
+   int pos;
+
+   /* Hash the names and count bucket sizes. */
+   for ( uint32_t b = 0; b < idx->nbuckets; b++ ) {
+      buckets[b].size  = 0;
+      buckets[b].start = 0;
+      buckets[b].id    = b;
+   }
+   for ( int i = 0; i < n; i++ ) {
+      if ( names[i] == NULL )
+         continue;
+      hash[i] = nameindex_hash( names[i], idx->seed, fold );
+      buckets[nameindex_bucket( idx, hash[i] )].size++;
+   }
+
+   /* Group names by bucket, keeping them in their original order. */
+   pos = 0;
+   for ( uint32_t b = 0; b < idx->nbuckets; b++ ) {
+      buckets[b].start = pos;
+      pos += buckets[b].size;
+      buckets[b].size = 0;
+   }
+   for ( int i = 0; i < n; i++ ) {
+      NameIndexBucket *bk;
+      if ( names[i] == NULL )
+         continue;
+      bk = &buckets[nameindex_bucket( idx, hash[i] )];
+      order[bk->start + bk->size] = i;
+      bk->size++;
+   }
+
+   /* Place the largest buckets first, as they're the hardest to fit. */
+   qsort( buckets, idx->nbuckets, sizeof( NameIndexBucket ),
+          nameindex_bucketCmp );
+   for ( uint32_t s = 0; s < idx->nslots; s++ ) {
+      idx->vals[s] = -1;
+      idx->keys[s] = NULL;
+   }
+   memset( idx->disp, 0, 2 * idx->nbuckets * sizeof( uint32_t ) );
+
+   for ( uint32_t b = 0; b < idx->nbuckets; b++ ) {
+      NameIndexBucket *bk  = &buckets[b];
+      int             *mem = &order[bk->start];
+      int              m   = 0;
+      int              found;
+
+      if ( bk->size == 0 )
+         break;
+
+      /* Drop duplicated names, the first one wins. Different names with the
+       * same full hash can't be separated, so we need another seed. */
+      for ( int j = 0; j < bk->size; j++ ) {
+         int dup = 0;
+         for ( int k = 0; k < m; k++ ) {
+            if ( hash[mem[k]] != hash[mem[j]] )
+               continue;
+            if ( !nameindex_equal( names[mem[k]], names[mem[j]], fold ) )
+               return -1;
+            dup = 1;
+            break;
+         }
+         if ( !dup )
+            mem[m++] = mem[j];
+      }
+
+      /* Look for a displacement that puts all the names in free slots. */
+      found = 0;
+      for ( uint32_t d0 = 0; ( d0 < NAMEINDEX_D0 ) && !found; d0++ ) {
+         for ( uint32_t d1 = 0; ( d1 < idx->nslots ) && !found; d1++ ) {
+            found = 1;
+            for ( int j = 0; j < m; j++ ) {
+               slots[j] = nameindex_slot( idx, hash[mem[j]], d0, d1 );
+               if ( idx->vals[slots[j]] >= 0 ) {
+                  found = 0;
+                  break;
+               }
+               for ( int k = 0; k < j; k++ ) {
+                  if ( slots[k] == slots[j] ) {
+                     found = 0;
+                     break;
+                  }
+               }
+               if ( !found )
+                  break;
+            }
+            if ( found ) {
+               uint32_t id           = bk->id;
+               idx->disp[2 * id + 0] = d0;
+               idx->disp[2 * id + 1] = d1;
+            }
+         }
+      }
+      if ( !found )
+         return -1;
+
+      for ( int j = 0; j < m; j++ ) {
+         idx->vals[slots[j]] = mem[j];
+         idx->keys[slots[j]] = names[mem[j]];
+      }
+   }
+
+   return 0;
+}
+
+/**
+ * @brief Builds a name index.
+ *
+ * Any previous contents of the index are freed. The names are not copied and
+ * must outlive the index.
+ *
+ *    @param[out] idx Index to build.
+ *    @param names Names to index. NULL entries are skipped, and only the first
+ * of duplicated names gets indexed.
+ *    @param n Number of names.
+ *    @param flags Flags such as NAMEINDEX_CASE.
+ *    @return 0 on success.
+ */
+int nameindex_build( NameIndex *idx, const char *const *names, int n,
+                     unsigned int flags )
+{
+   uint64_t        *hash;
+   int             *order;
+   NameIndexBucket *buckets;
+   uint32_t        *slots;
+   int              ret;
+
+   nameindex_free( idx );
+   idx->flags = flags;
+   if ( n <= 0 )
+      return 0;
+
+   hash  = malloc( n * sizeof( uint64_t ) );
+   order = malloc( n * sizeof( int ) );
+   slots = malloc( n * sizeof( uint32_t ) );
+
+   idx->nbuckets = n / NAMEINDEX_BUCKET + 1;
+   idx->disp     = malloc( 2 * idx->nbuckets * sizeof( uint32_t ) );
+   buckets       = malloc( idx->nbuckets * sizeof( NameIndexBucket ) );
+
+   /* Try different seeds, and leave more room if that doesn't cut it. */
+   ret = -1;
+   for ( int i = 0; ( i < NAMEINDEX_ATTEMPTS ) && ( ret != 0 ); i++ ) {
+      idx->seed   = i;
+      idx->nslots = ( n + n / 4 + 1 ) << ( i / 2 );
+      idx->keys   = realloc( idx->keys, idx->nslots * sizeof( const char * ) );
+      idx->vals   = realloc( idx->vals, idx->nslots * sizeof( int ) );
+      ret = nameindex_place( idx, names, n, hash, order, buckets, slots );
+   }
+
+   free( hash );
+   free( order );
+   free( slots );
+   free( buckets );
+
+   if ( ret != 0 ) {
+      WARN( _( "Unable to build name index of %d names!" ), n );
+      nameindex_free( idx );
+      return -1;
+   }
+   return 0;
+}
+
+/**
+ * @brief Builds a name index from an array of structures.
+ *
+ * Meant for the usual registries, where each element has a "char *name" field.
+ *
+ *    @param[out] idx Index to build.
+ *    @param base Array of structures.
+ *    @param n Number of elements in the array.
+ *    @param size Size of each element.
+ *    @param offset Offset of the name pointer in each element, see offsetof().
+ *    @param flags Flags such as NAMEINDEX_CASE.
+ *    @return 0 on success.
+ */
+int nameindex_buildStruct( NameIndex *idx, const void *base, int n,
+                           size_t size, size_t offset, unsigned int flags )
+{
+   const char **names = malloc( MAX( n, 1 ) * sizeof( const char * ) );
+   int          ret;
+   for ( int i = 0; i < n; i++ )
+      names[i] = *(const char *const *)( (const char *)base + i * size +
+                                         offset );
+   ret = nameindex_build( idx, names, n, flags );
+   free( names );
+   return ret;
+}
+
+/**
+ * @brief Looks up a name.
+ *
+ *    @param idx Index to look up in.
+ *    @param name Name to look for.
+ *    @return Position of the name in the array the index was built from, or -1
+ * if not found.
+ */
+int nameindex_get( const NameIndex *idx, const char *name )
+{
+   int      fold = ( idx->flags & NAMEINDEX_CASE );
+   uint64_t h;
+   uint32_t b, s;
+
+   if ( ( idx->nslots == 0 ) || ( name == NULL ) )
+      return -1;
+
+   h = nameindex_hash( name, idx->seed, fold );
+   b = nameindex_bucket( idx, h );
+   s = nameindex_slot( idx, h, idx->disp[2 * b + 0], idx->disp[2 * b + 1] );
+   if ( ( idx->vals[s] < 0 ) || !nameindex_equal( idx->keys[s], name, fold ) )
+      return -1;
+   return idx->vals[s];
+}
+
+/**
+ * @brief Frees a name index, leaving it empty.
+ *
+ *    @param idx Index to free.
+ */
+void nameindex_free( NameIndex *idx )
+{
+   free( idx->keys );
+   free( idx->vals );
+   free( idx->disp );
+   idx->keys     = NULL;
+   idx->vals     = NULL;
+   idx->disp     = NULL;
+   idx->nslots   = 0;
+   idx->nbuckets = 0;
+}
@@ -0,0 +1,35 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/** @cond */
+#include <stddef.h>
+#include <stdint.h>
+/** @endcond */
+
+#define NAMEINDEX_CASE ( 1 << 0 ) /**< Match names case insensitively. */
+
+/**
+ * @brief Minimal perfect hash of a frozen set of names.
+ *
+ * Maps each name to its position in the array it was built from. The names are
+ * not copied, so the index has to be rebuilt if any of them change or get
+ * freed.
+ */
+typedef struct NameIndex_ {
+   const char **keys;     /**< Name stored in each slot. */
+   int         *vals;     /**< Index stored in each slot, -1 if empty. */
+   uint32_t    *disp;     /**< Displacement pair of each bucket. */
+   uint32_t     nslots;   /**< Number of slots. */
+   uint32_t     nbuckets; /**< Number of buckets. */
+   uint32_t     seed;     /**< Seed of the hash function. */
+   unsigned int flags;    /**< Flags the index was built with. */
+} NameIndex;
+
+int  nameindex_build( NameIndex *idx, const char *const *names, int n,
+                      unsigned int flags );
+int  nameindex_buildStruct( NameIndex *idx, const void *base, int n,
+                            size_t size, size_t offset, unsigned int flags );
+int  nameindex_get( const NameIndex *idx, const char *name );
+void nameindex_free( NameIndex *idx );
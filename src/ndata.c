@@ -8,10 +8,26 @@
  *        We choose our underlying directories in ndata_setupWriteDir() and
  * ndata_setupReadDirs(). However, conf.c code may have seeded the search path
  * based on command-line arguments.
+ *
+ * Installs can ship ndata packed into a single archive (NDATA_PACK_PATH),
+ * which is preferred over the dat directory. Files in it are looked up by hash
+ * and read straight from memory, see physfs_archiver_npak.c.
+ *
+ * Once everything is mounted, the merged search path is walked once to build a
+ * path table with the search path each visible file comes from. Lookups and
+ * listings then go through the table instead of asking every mount (plugins
+ * included) again. The table has to be invalidated with ndata_invalidate()
+ * whenever the search path changes.
+ *
+ * The write directory is left out of the table, since saves, logs and the like
+ * change all the time but are never looked up through ndata. Anything that
+ * isn't in the table is asked to PhysicsFS, and writes that could hide a file
+ * in the table are reported with ndata_changed().
  */
 /** @cond */
 #include <limits.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdlib.h>
 #if __WIN32__
 #include <windows.h>
@@ -32,17 +48,47 @@
 #include "glue_macos.h"
 #endif /* __MACOSX__ */
 #include "log.h"
+#include "nameindex.h"
 #include "nfile.h"
 #include "nstring.h"
+#include "physfs_archiver_npak.h"
 #include "plugin.h"
 
+/**
+ * @brief Search path that files in the path table come from.
+ */
+typedef struct NdataMount_ {
+   char *dir;    /**< Real directory or archive. */
+   int   native; /**< Whether it is a directory that can be read directly. */
+} NdataMount;
+
+/**
+ * @brief Visible file in the path table.
+ */
+typedef struct NdataPath_ {
+   char   *path;    /**< Path of the file. */
+   int     mount;   /**< Index of the search path the file is read from. */
+   int64_t size;    /**< Size of the file. */
+   int64_t modtime; /**< Modification time of the file. */
+} NdataPath;
+
+static NdataStats   ndata_stats;          /**< Statistics of the accesses. */
+static SDL_SpinLock ndata_stats_lock = 0; /**< Lock of the statistics. */
+static SDL_mutex   *ndata_lock       = NULL; /**< Lock of the path table. */
+static NdataMount  *ndata_mounts     = NULL; /**< Search paths in the table. */
+static NdataPath   *ndata_paths      = NULL; /**< Path table sorted by path. */
+static NameIndex    ndata_index;             /**< Index of the path table. */
+static int ndata_broken = 0; /**< Table can't be built, use PhysFS. */
+
 /*
  * Prototypes.
  */
 static void ndata_testVersion( void );
 static int  ndata_found( void );
+static int  ndata_mountDefault( const char *dir );
 static int  ndata_enumerateCallback( void *data, const char *origdir,
                                      const char *fname );
+static int  ndata_table( void );
 
 /**
  * @brief Checks to see if the physfs search path is enough to find game data.
@@ -56,6 +102,31 @@ static int ndata_found( void )
    return PHYSFS_exists( "VERSION" ) && PHYSFS_exists( START_DATA_PATH );
 }
 
+/**
+ * @brief Mounts the game data from a default location, preferring the packed
+ * archive over the dat directory.
+ *
+ *    @param dir Directory containing the packed archive or dat directory.
+ *    @return Whether the game data was found.
+ */
+static int ndata_mountDefault( const char *dir )
+{
+   char buf[PATH_MAX];
+
+   if ( ( nfile_concatPaths( buf, PATH_MAX, dir, NDATA_PACK_PATH ) >= 0 ) &&
+        nfile_fileExists( buf ) ) {
+      LOG( _( "Trying default packed datapath: %s" ), buf );
+      if ( PHYSFS_mount( buf, NULL, 1 ) && ndata_found() )
+         return 1;
+   }
+
+   if ( nfile_concatPaths( buf, PATH_MAX, dir, "dat" ) >= 0 ) {
+      LOG( _( "Trying default datapath: %s" ), buf );
+      PHYSFS_mount( buf, NULL, 1 );
+   }
+   return ndata_found();
+}
+
 /**
  * @brief Test version to see if it matches.
  */
@@ -117,53 +188,306 @@ void ndata_setupReadDirs( void )
 {
    char buf[PATH_MAX];
 
+   if ( ndata_lock == NULL )
+      ndata_lock = SDL_CreateMutex();
+   ndata_invalidate();
+
+   /* Packed archives can also be given as datapath. */
+   npak_init();
+
    if ( conf.ndata != NULL && PHYSFS_mount( conf.ndata, NULL, 1 ) )
       LOG( _( "Added datapath from conf.lua file: %s" ), conf.ndata );
 
 #if __MACOSX__
    if ( !ndata_found() && macos_isBundle() &&
-        macos_resourcesPath( buf, PATH_MAX - 4 ) >= 0 &&
-        strncat( buf, "/dat", 4 ) ) {
-      LOG( _( "Trying default datapath: %s" ), buf );
-      PHYSFS_mount( buf, NULL, 1 );
-   }
+        macos_resourcesPath( buf, PATH_MAX ) >= 0 )
+      ndata_mountDefault( buf );
 #endif /* __MACOSX__ */
 
    if ( !ndata_found() && env.isAppImage &&
-        nfile_concatPaths( buf, PATH_MAX, env.appdir, PKGDATADIR, "dat" ) >=
-           0 ) {
-      LOG( _( "Trying default datapath: %s" ), buf );
-      PHYSFS_mount( buf, NULL, 1 );
-   }
+        nfile_concatPaths( buf, PATH_MAX, env.appdir, PKGDATADIR ) >= 0 )
+      ndata_mountDefault( buf );
 
-   if ( !ndata_found() &&
-        nfile_concatPaths( buf, PATH_MAX, PKGDATADIR, "dat" ) >= 0 ) {
-      LOG( _( "Trying default datapath: %s" ), buf );
-      PHYSFS_mount( buf, NULL, 1 );
-   }
+   if ( !ndata_found() )
+      ndata_mountDefault( PKGDATADIR );
 
-   if ( !ndata_found() &&
-        nfile_concatPaths( buf, PATH_MAX, PHYSFS_getBaseDir(), "dat" ) >= 0 ) {
-      LOG( _( "Trying default datapath: %s" ), buf );
-      PHYSFS_mount( buf, NULL, 1 );
-   }
+   if ( !ndata_found() )
+      ndata_mountDefault( PHYSFS_getBaseDir() );
 
    PHYSFS_mount( PHYSFS_getWriteDir(), NULL, 0 );
 
    /* Load plugins I guess. */
    plugin_init();
 
+   /* Build the path table now, before anything gets loaded in threads. */
+   ndata_table();
+
    ndata_testVersion();
 }
 
 /**
- * @brief Reads a file from the ndata (will be NUL terminated).
+ * @brief Gets the time since start in seconds.
+ */
+static double ndata_elapsed( Uint64 start )
+{
+   return (double)( SDL_GetPerformanceCounter() - start ) /
+          (double)SDL_GetPerformanceFrequency();
+}
+
+/*
+ * The statistics are updated by the loader threads too, so they are only
+ * modified through these.
+ */
+/**
+ * @brief Increments a counter of the statistics.
+ */
+static void ndata_statsCount( int *counter )
+{
+   SDL_AtomicLock( &ndata_stats_lock );
+   ( *counter )++;
+   SDL_AtomicUnlock( &ndata_stats_lock );
+}
+
+/**
+ * @brief Adds the time since start to a time of the statistics.
+ */
+static void ndata_statsTime( double *total, Uint64 start )
+{
+   double dt = ndata_elapsed( start );
+   SDL_AtomicLock( &ndata_stats_lock );
+   *total += dt;
+   SDL_AtomicUnlock( &ndata_stats_lock );
+}
+
+/**
+ * @brief Adds a file read to the statistics.
+ */
+static void ndata_statsRead( int packed, size_t bytes, Uint64 start )
+{
+   double dt = ndata_elapsed( start );
+   SDL_AtomicLock( &ndata_stats_lock );
+   ndata_stats.reads++;
+   ndata_stats.packed += packed;
+   ndata_stats.bytes += bytes;
+   ndata_stats.time += dt;
+   SDL_AtomicUnlock( &ndata_stats_lock );
+}
+
+/**
+ * @brief Gets the index of a search path in the path table, adding it if new.
+ */
+static int ndata_mountIndex( const char *dir )
+{
+   NdataMount *m;
+
+   for ( int i = array_size( ndata_mounts ) - 1; i >= 0; i-- )
+      if ( strcmp( ndata_mounts[i].dir, dir ) == 0 )
+         return i;
+
+   m         = &array_grow( &ndata_mounts );
+   m->dir    = strdup( dir );
+   m->native = ( nfile_dirExists( dir ) == 1 );
+   return array_size( ndata_mounts ) - 1;
+}
+
+/**
+ * @brief Compares paths in the path table.
+ */
+static int ndata_cmpPath( const void *p1, const void *p2 )
+{
+   const NdataPath *np1 = p1;
+   const NdataPath *np2 = p2;
+   return strcmp( np1->path, np2->path );
+}
+
+/**
+ * @brief Adds all the visible files in a directory to the path table.
  *
- *    @param path Path of the file to read.
+ * Uses PHYSFS_enumerateFiles(), which lists a name once even if it's in many
+ * search paths, so directories shared by plugins only get walked once. Files
+ * and directories that come from the write directory are skipped.
+ *
+ *    @param dir Directory to walk.
+ *    @param write The write directory, or NULL if there is none.
+ */
+static void ndata_tableWalk( const char *dir, const char *write )
+{
+   char **files = PHYSFS_enumerateFiles( dir );
+   if ( files == NULL )
+      return;
+   for ( char **f = files; *f != NULL; f++ ) {
+      char       *path;
+      const char *real;
+      PHYSFS_Stat stat;
+
+      if ( dir[0] == '\0' )
+         path = strdup( *f );
+      else
+         SDL_asprintf( &path, "%s/%s", dir, *f );
+      real = PHYSFS_getRealDir( path );
+      if ( ( real == NULL ) ||
+           ( ( write != NULL ) && ( strcmp( real, write ) == 0 ) ) ) {
+         free( path );
+         continue;
+      }
+      ndata_statsCount( &ndata_stats.stats );
+      if ( !PHYSFS_stat( path, &stat ) ) {
+         WARN( _( "PhysicsFS: Cannot stat %s: %s" ), path,
+               _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+         free( path );
+      } else if ( stat.filetype == PHYSFS_FILETYPE_REGULAR ) {
+         NdataPath *p = &array_grow( &ndata_paths );
+         p->path      = path;
+         p->mount     = ndata_mountIndex( real );
+         p->size      = stat.filesize;
+         p->modtime   = stat.modtime;
+      } else if ( stat.filetype == PHYSFS_FILETYPE_DIRECTORY ) {
+         ndata_tableWalk( path, write );
+         free( path );
+      } else
+         free( path );
+   }
+   PHYSFS_freeList( files );
+}
+
+/**
+ * @brief Makes sure the path table is built.
+ *
+ *    @return 0 if the table can be used, -1 if PhysicsFS has to be asked
+ *            directly.
+ */
+static int ndata_table( void )
+{
+   Uint64 t;
+   int    n;
+
+   /* Not set up yet. */
+   if ( ndata_lock == NULL )
+      return -1;
+
+   SDL_LockMutex( ndata_lock );
+   if ( ( ndata_paths != NULL ) || ndata_broken ) {
+      SDL_UnlockMutex( ndata_lock );
+      return ndata_broken ? -1 : 0;
+   }
+
+   t            = SDL_GetPerformanceCounter();
+   ndata_mounts = array_create( NdataMount );
+   ndata_paths  = array_create( NdataPath );
+   ndata_tableWalk( "", PHYSFS_getWriteDir() );
+   qsort( ndata_paths, array_size( ndata_paths ), sizeof( NdataPath ),
+          ndata_cmpPath );
+
+   n = array_size( ndata_paths );
+   if ( nameindex_buildStruct( &ndata_index, ndata_paths, n,
+                               sizeof( NdataPath ), offsetof( NdataPath, path ),
+                               0 ) ) {
+      WARN( _( "Unable to build the ndata path table, falling back to "
+               "PhysicsFS lookups." ) );
+      ndata_broken = 1;
+   }
+
+   ndata_statsCount( &ndata_stats.tables );
+   ndata_statsTime( &ndata_stats.table_time, t );
+   DEBUG( _( "Built ndata path table with %d files from %d search paths in "
+             "%.0f ms" ),
+          n, array_size( ndata_mounts ), 1e3 * ndata_elapsed( t ) );
+   SDL_UnlockMutex( ndata_lock );
+   return ndata_broken ? -1 : 0;
+}
+
+/**
+ * @brief Throws away the path table, so it gets built again when next needed.
+ *
+ * Has to be called whenever the search path changes. Must not be called while
+ * anything is being loaded in other threads.
+ */
+void ndata_invalidate( void )
+{
+   if ( ndata_lock != NULL )
+      SDL_LockMutex( ndata_lock );
+   for ( int i = 0; i < array_size( ndata_paths ); i++ )
+      free( ndata_paths[i].path );
+   array_free( ndata_paths );
+   ndata_paths = NULL;
+   for ( int i = 0; i < array_size( ndata_mounts ); i++ )
+      free( ndata_mounts[i].dir );
+   array_free( ndata_mounts );
+   ndata_mounts = NULL;
+   nameindex_free( &ndata_index );
+   ndata_broken = 0;
+   if ( ndata_lock != NULL )
+      SDL_UnlockMutex( ndata_lock );
+}
+
+/**
+ * @brief Notes that a file was written or removed in the write directory.
+ *
+ * The write directory isn't in the table, but its files hide the ones of the
+ * search path, so if the path is in the table it gets resolved by PhysicsFS
+ * from now on. Must not be called while anything is being loaded in other
+ * threads.
+ *
+ *    @param path Path of the file.
+ */
+void ndata_changed( const char *path )
+{
+   if ( ndata_lock == NULL )
+      return;
+   SDL_LockMutex( ndata_lock );
+   if ( ( ndata_paths != NULL ) && !ndata_broken ) {
+      int i;
+      while ( path[0] == '/' )
+         path++;
+      i = nameindex_get( &ndata_index, path );
+      if ( i >= 0 )
+         ndata_paths[i].mount = -1;
+   }
+   SDL_UnlockMutex( ndata_lock );
+}
+
+/**
+ * @brief Looks up a file in the path table.
+ *
+ *    @param path Path of the file.
+ *    @return The file in the table or NULL if not found, there is no table or
+ *            it has to be asked to PhysicsFS.
+ */
+static const NdataPath *ndata_lookup( const char *path )
+{
+   int i;
+   if ( ndata_table() )
+      return NULL;
+   while ( path[0] == '/' )
+      path++;
+   i = nameindex_get( &ndata_index, path );
+   if ( ( i < 0 ) || ( ndata_paths[i].mount < 0 ) ) {
+      ndata_statsCount( &ndata_stats.misses );
+      return NULL;
+   }
+   ndata_statsCount( &ndata_stats.hits );
+   return &ndata_paths[i];
+}
+
+/**
+ * @brief Gets a file straight from a packed archive if that's where it would
+ * be read from.
+ *
+ *    @param p File in the path table.
  *    @param[out] filesize Stores the size of the file.
- *    @return The file data or NULL on error.
+ *    @return The NUL terminated data in the archive or NULL if not packed.
  */
-void *ndata_read( const char *path, size_t *filesize )
+static const char *ndata_packed( const NdataPath *p, size_t *filesize )
+{
+   if ( ( p == NULL ) || !npak_mounted() )
+      return NULL;
+   return npak_view( ndata_mounts[p->mount].dir, p->path, filesize );
+}
+
+/**
+ * @brief Reads a file through PhysicsFS.
+ */
+static char *ndata_readFile( const char *path, size_t *filesize )
 {
    char         *buf;
    PHYSFS_file  *file;
@@ -234,6 +558,147 @@ void *ndata_read( const char *path, size_t *filesize )
    return buf;
 }
 
+/**
+ * @brief Reads a file, skipping PhysicsFS if the path table says it's in a
+ * directory on disk.
+ *
+ *    @param p File in the path table or NULL if not in it.
+ *    @param path Path of the file.
+ *    @param[out] filesize Stores the size of the file.
+ *    @return The file data or NULL on error.
+ */
+static char *ndata_readDirect( const NdataPath *p, const char *path,
+                               size_t *filesize )
+{
+   const NdataMount *m;
+   char              buf[PATH_MAX];
+
+   if ( p == NULL )
+      return ndata_readFile( path, filesize );
+   m = &ndata_mounts[p->mount];
+   if ( !m->native ||
+        ( nfile_concatPaths( buf, PATH_MAX, m->dir, p->path ) < 0 ) )
+      return ndata_readFile( path, filesize );
+   return nfile_readFile( filesize, buf );
+}
+
+/**
+ * @brief Reads a file from the ndata (will be NUL terminated).
+ *
+ *    @param path Path of the file to read.
+ *    @param[out] filesize Stores the size of the file.
+ *    @return The file data or NULL on error.
+ */
+void *ndata_read( const char *path, size_t *filesize )
+{
+   Uint64           t = SDL_GetPerformanceCounter();
+   const NdataPath *p = ndata_lookup( path );
+   const char      *data;
+   char            *buf;
+
+   data = ndata_packed( p, filesize );
+   if ( data != NULL ) {
+      buf = malloc( *filesize + 1 );
+      memcpy( buf, data, *filesize + 1 );
+   } else
+      buf = ndata_readDirect( p, path, filesize );
+
+   ndata_statsRead( data != NULL, *filesize, t );
+   return buf;
+}
+
+/**
+ * @brief Gets the contents of a file from the ndata without copying them if
+ * possible.
+ *
+ * Files in packed archives are used directly from memory, while anything else
+ * gets read like with ndata_read(). Either way, the data is read-only, NUL
+ * terminated and must be released with ndata_unview().
+ *
+ *    @param path Path of the file to read.
+ *    @param[out] filesize Stores the size of the file.
+ *    @return The file data or NULL on error.
+ */
+const void *ndata_view( const char *path, size_t *filesize )
+{
+   Uint64           t      = SDL_GetPerformanceCounter();
+   const NdataPath *p      = ndata_lookup( path );
+   const char      *data   = ndata_packed( p, filesize );
+   int              packed = ( data != NULL );
+   if ( !packed )
+      data = ndata_readDirect( p, path, filesize );
+   ndata_statsRead( packed, *filesize, t );
+   return data;
+}
+
+/**
+ * @brief Releases data gotten with ndata_view().
+ *
+ *    @param data Data to release.
+ */
+void ndata_unview( const void *data )
+{
+   if ( !npak_owns( data ) )
+      free( (void *)data );
+}
+
+/**
+ * @brief Checks to see if a regular file is visible in the ndata.
+ *
+ *    @param path Path of the file.
+ *    @return 1 if the file exists, 0 otherwise.
+ */
+int ndata_exists( const char *path )
+{
+   PHYSFS_Stat stat;
+
+   if ( ndata_lookup( path ) != NULL )
+      return 1;
+   /* Could still be in the write directory. */
+   return PHYSFS_stat( path, &stat ) &&
+          ( stat.filetype == PHYSFS_FILETYPE_REGULAR );
+}
+
+/**
+ * @brief Gets the size and modification time of a file in the ndata.
+ *
+ *    @param path Path of the file.
+ *    @param[out] size Size of the file.
+ *    @param[out] modtime Modification time of the file, -1 if unknown.
+ *    @return 0 on success, -1 if the file doesn't exist.
+ */
+int ndata_fileInfo( const char *path, int64_t *size, int64_t *modtime )
+{
+   const NdataPath *p = ndata_lookup( path );
+   PHYSFS_Stat      stat;
+
+   if ( p != NULL ) {
+      *size    = p->size;
+      *modtime = p->modtime;
+      return 0;
+   }
+   if ( !PHYSFS_stat( path, &stat ) ||
+        ( stat.filetype != PHYSFS_FILETYPE_REGULAR ) )
+      return -1;
+   *size    = stat.filesize;
+   *modtime = stat.modtime;
+   return 0;
+}
+
+/**
+ * @brief Checks to see if a directory is in the write directory, where the
+ * path table can't see its files.
+ */
+static int ndata_writeDirHas( const char *path )
+{
+   const char *write = PHYSFS_getWriteDir();
+   char        buf[PATH_MAX];
+   if ( ( write == NULL ) ||
+        ( nfile_concatPaths( buf, PATH_MAX, write, path ) < 0 ) )
+      return 0;
+   return ( nfile_dirExists( buf ) == 1 );
+}
+
 /**
  * @brief Lists all the visible files in a directory, at any depth.
  *
@@ -244,7 +709,42 @@ void *ndata_read( const char *path, size_t *filesize )
  */
 char **ndata_listRecursive( const char *path )
 {
+   Uint64 t     = SDL_GetPerformanceCounter();
    char **files = array_create( char * );
+   char   prefix[PATH_MAX];
+   int    len, lo, hi;
+
+   ndata_statsCount( &ndata_stats.lists );
+   if ( ( ndata_table() == 0 ) && !ndata_writeDirHas( path ) ) {
+      /* Everything under the directory is together in the sorted table. */
+      while ( path[0] == '/' )
+         path++;
+      len = strlen( path );
+      while ( ( len > 0 ) && ( path[len - 1] == '/' ) )
+         len--;
+      if ( len > 0 )
+         snprintf( prefix, sizeof( prefix ), "%.*s/", len, path );
+      else
+         prefix[0] = '\0';
+      len = strlen( prefix );
+
+      lo = 0;
+      hi = array_size( ndata_paths );
+      while ( lo < hi ) {
+         int mid = ( lo + hi ) / 2;
+         if ( strcmp( ndata_paths[mid].path, prefix ) < 0 )
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+      for ( int i = lo; i < array_size( ndata_paths ) &&
+                        strncmp( ndata_paths[i].path, prefix, len ) == 0;
+            i++ )
+         array_push_back( &files, strdup( ndata_paths[i].path ) );
+      ndata_statsTime( &ndata_stats.time, t );
+      return files;
+   }
+
    PHYSFS_enumerate( path, ndata_enumerateCallback, &files );
    /* Ensure unique. PhysicsFS can enumerate a path twice if it's in multiple
     * components of a union. */
@@ -255,6 +755,7 @@ char **ndata_listRecursive( const char *path )
          array_erase( &files, &files[i], &files[i + 1] );
          i--; /* We're not done checking for dups of files[i]. */
       }
+   ndata_statsTime( &ndata_stats.time, t );
    return files;
 }
 
@@ -272,6 +773,7 @@ static int ndata_enumerateCallback( void *data, const char *origdir,
    dir_len = strlen( origdir );
    fmt     = dir_len && origdir[dir_len - 1] == '/' ? "%s%s" : "%s/%s";
    SDL_asprintf( &path, fmt, origdir, fname );
+   ndata_statsCount( &ndata_stats.stats );
    if ( !PHYSFS_stat( path, &stat ) ) {
       WARN( _( "PhysicsFS: Cannot stat %s: %s" ), path,
             _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
@@ -330,6 +832,7 @@ int ndata_copyIfExists( const char *file1, const char *file2 )
    /* Open files. */
    f_in  = PHYSFS_openRead( file1 );
    f_out = PHYSFS_openWrite( file2 );
+   ndata_changed( file2 );
    if ( ( f_in == NULL ) || ( f_out == NULL ) ) {
       WARN( _( "Failure to copy '%s' to '%s': %s" ), file1, file2,
             _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
@@ -412,3 +915,31 @@ int ndata_getPathDefault( char *path, int len, const char *default_path,
       return 1;
    return 0;
 }
+
+/**
+ * @brief Gets the statistics of the ndata accesses since start up.
+ *
+ *    @param[out] stats Statistics to fill.
+ */
+void ndata_getStats( NdataStats *stats )
+{
+   SDL_AtomicLock( &ndata_stats_lock );
+   *stats = ndata_stats;
+   SDL_AtomicUnlock( &ndata_stats_lock );
+}
+
+/**
+ * @brief Logs a report of the ndata accesses since start up.
+ */
+void ndata_printStats( void )
+{
+   NdataStats stats;
+   ndata_getStats( &stats );
+   LOG( _( "ndata: %d files read (%d from packed archives), %.1f MiB in "
+           "%.0f ms, %d directory listings with %d stats" ),
+        stats.reads, stats.packed, (double)stats.bytes / ( 1024. * 1024. ),
+        1e3 * stats.time, stats.lists, stats.stats );
+   LOG( _( "ndata: path table built %d times in %.0f ms, %d hits and %d "
+           "misses" ),
+        stats.tables, 1e3 * stats.table_time, stats.hits, stats.misses );
+}
@@ -3,6 +3,7 @@
  */
 #pragma once
 
+#include <stdint.h>
 #include <stdlib.h>
 
 /*
@@ -80,6 +81,9 @@
 
 #define START_DATA_PATH "start.xml" /**< Path to module start file. */
 
+#define NDATA_PACK_PATH                                                        \
+   "ndata.npak" /**< Packed ndata, next to where the dat directory would be. */
+
 /* Fonts should be defined in start.xml probably. */
 /* Currently our fonts/Cabin-SemiBold.otf lacks many fairly standard glyphs, so
  * we are falling back to the monospace font which has better coverage.
@@ -112,12 +116,36 @@
 #define SAVE_UPDATER_PATH "save_updater.lua"
 #define DIFFICULTY_PATH "difficulty/"
 
-void   ndata_setupWriteDir( void );
-void   ndata_setupReadDirs( void );
-void  *ndata_read( const char *filename, size_t *filesize );
-char **ndata_listRecursive( const char *path );
-int    ndata_backupIfExists( const char *path );
-int    ndata_copyIfExists( const char *path1, const char *path2 );
-int    ndata_matchExt( const char *path, const char *ext );
-int    ndata_getPathDefault( char *path, int len, const char *default_path,
-                             const char *filename );
+/**
+ * @brief Statistics of the ndata accesses.
+ */
+typedef struct NdataStats_ {
+   int    reads;      /**< Files read. */
+   int    packed;     /**< Files read straight from packed archives. */
+   int    lists;      /**< Recursive directory listings. */
+   int    stats;      /**< Paths stat'd while listing or building tables. */
+   size_t bytes;      /**< Bytes read. */
+   double time;       /**< Time spent reading and listing in seconds. */
+   int    tables;     /**< Times the path table was built. */
+   double table_time; /**< Time spent building the path table in seconds. */
+   int    hits;       /**< Lookups found in the path table. */
+   int    misses;     /**< Lookups not found in the path table. */
+} NdataStats;
+
+void        ndata_setupWriteDir( void );
+void        ndata_setupReadDirs( void );
+void       *ndata_read( const char *filename, size_t *filesize );
+const void *ndata_view( const char *filename, size_t *filesize );
+void        ndata_unview( const void *data );
+int         ndata_exists( const char *path );
+int         ndata_fileInfo( const char *path, int64_t *size, int64_t *modtime );
+char      **ndata_listRecursive( const char *path );
+void        ndata_invalidate( void );
+void        ndata_changed( const char *path );
+int         ndata_backupIfExists( const char *path );
+int         ndata_copyIfExists( const char *path1, const char *path2 );
+int         ndata_matchExt( const char *path, const char *ext );
+int         ndata_getPathDefault( char *path, int len, const char *default_path,
+                                  const char *filename );
+void        ndata_getStats( NdataStats *stats );
+void        ndata_printStats( void );
@@ -36,6 +36,7 @@
 #include "nlua_outfit.h"
 #include "nlua_pilot.h"
 #include "nlua_player.h"
+#include "nlua_profiler.h"
 #include "nlua_rnd.h"
 #include "nlua_safelanes.h"
 #include "nlua_shiplog.h"
@@ -229,6 +230,8 @@ static int luaB_loadstring( lua_State *L )
  */
 void lua_exit( void )
 {
+   nlua_profilerStop();
+   nlua_profilerFree();
    lua_clearCache();
    array_free( lua_cache );
    lua_cache = NULL;
@@ -343,8 +346,10 @@ void nlua_pushEnvTable( lua_State *L )
  * @brief Create an new environment in global Lua state.
  *
  * An "environment" is a table used with setfenv for sandboxing.
+ *
+ *    @param name Name of the environment, used to identify it when profiling.
  */
-nlua_env nlua_newEnv( void )
+nlua_env nlua_newEnv( const char *name )
 {
    nlua_env ref;
    lua_newtable( naevL );                      /* t */
@@ -358,10 +363,13 @@ nlua_env nlua_newEnv( void )
    lua_rawset( naevL, -3 );                            /* t, e */
    lua_pop( naevL, 1 );                                /* t */
 
-   /* Metatable */
+   /* Metatable, which also has the name to tell environments apart without
+    * adding a global. */
    lua_newtable( naevL );                    /* t, m */
    lua_pushvalue( naevL, LUA_GLOBALSINDEX ); /* t, m, g */
    lua_setfield( naevL, -2, "__index" );     /* t, m */
+   lua_pushstring( naevL, name );            /* t, m, s */
+   lua_setfield( naevL, -2, "__name" );      /* t, m */
    lua_setmetatable( naevL, -2 );            /* t */
 
    /* Replace require() function with one that considers fenv */
@@ -446,6 +454,7 @@ void nlua_freeEnv( nlua_env env )
 
    /* Unref. */
    luaL_unref( naevL, LUA_REGISTRYINDEX, env );
+   nlua_profilerForget( env );
 }
 
 /*
@@ -615,7 +624,7 @@ static int nlua_package_loader_lua( lua_State *L )
 {
    LuaCache_t *lc;
    size_t      bufsize, l = 0;
-   char       *buf = NULL;
+   const char *buf = NULL;
    char        path_filename[PATH_MAX], tmpname[PATH_MAX], tried_paths[STRMAX];
    const char *packagepath, *start, *end;
    const char *name = luaL_checkstring( L, 1 );
@@ -678,8 +687,8 @@ static int nlua_package_loader_lua( lua_State *L )
       }
 
       /* Try to load the file. */
-      if ( PHYSFS_exists( path_filename ) ) {
-         buf = ndata_read( path_filename, &bufsize );
+      if ( ndata_exists( path_filename ) ) {
+         buf = ndata_view( path_filename, &bufsize );
          if ( buf != NULL )
             break;
       }
@@ -698,7 +707,7 @@ static int nlua_package_loader_lua( lua_State *L )
    /* Try to process the Lua. It will leave a function or message on the stack,
     * as required. */
    luaL_loadbuffer( L, buf, bufsize, path_filename );
-   free( buf );
+   ndata_unview( buf );
 
    /* Cache the result. */
    if ( L == naevL ) {
@@ -949,9 +958,11 @@ int nlua_pcall( nlua_env env, int nargs, int nresults )
 
    prev_env      = __NLUA_CURENV;
    __NLUA_CURENV = env;
+   nlua_profilerEnter( env );
 
    ret = lua_pcall( naevL, nargs, nresults, errf );
 
+   nlua_profilerLeave();
    __NLUA_CURENV = prev_env;
 
 #if DEBUGGING
@@ -19,6 +19,7 @@
 
 #include "array.h"
 #include "nlua_file.h"
+#include "nlua_gc.h"
 #include "nlua_vec2.h"
 #include "nluadef.h"
 #include "nopenal.h"
@@ -40,8 +41,12 @@ typedef struct LuaAudioEfx_s {
  */
 static LuaAudioEfx_t *lua_efx = NULL;
 
-static int stream_thread( void *la_data );
-static int stream_loadBuffer( LuaAudio_t *la, ALuint buffer );
+#define STREAM_BLOCK_SIZE ( 32 * 1024 ) /**< Size of a decoded block. */
+#define STREAM_POOL_SIZE 8   /**< Maximum number of blocks decoded ahead. */
+#define STREAM_RETRY_MS 10   /**< Delay before checking an idle stream. */
+#define STREAM_WAIT_MIN_MS 5 /**< Minimum time the service sleeps. */
+#define STREAM_WAIT_MAX_MS 100 /**< Maximum time the service sleeps. */
+
 static int audio_genSource( ALuint *source );
 
 /* Audio methods. */
@@ -117,68 +122,46 @@ static const luaL_Reg audioL_methods[] = {
    { "soundPlay", audioL_soundPlay }, /* Old API */
    { 0, 0 } };                        /**< AudioLua methods. */
 
-static int stream_thread( void *la_data )
-{
-   LuaAudio_t *la = (LuaAudio_t *)la_data;
-
-   while ( 1 ) {
-      ALint  alstate;
-      ALuint removed;
-
-      soundLock();
-
-      /* Case finished. */
-      if ( la->active < 0 ) {
-         la->th = NULL;
-         SDL_CondBroadcast( la->cond );
-         alSourceStop( la->source );
-         soundUnlock();
-         return 0;
-      }
-
-      alGetSourcei( la->source, AL_BUFFERS_PROCESSED, &alstate );
-      if ( alstate > 0 ) {
-         int ret;
-         /* Refill active buffer */
-         alSourceUnqueueBuffers( la->source, 1, &removed );
-         ret = stream_loadBuffer( la, la->stream_buffers[la->active] );
-         if ( ( la->active < 0 ) || ( ret < 0 ) ) {
-            /* stream_loadBuffer unlocks the sound lock internally, which can
-             * lead to the thread being gc'd and having active = -1. We have to
-             * add a check here to not mess around with stuff. */
-            la->th = NULL;
-            SDL_CondBroadcast( la->cond );
-            alSourceStop( la->source );
-            soundUnlock();
-            return 0;
-         } else {
-            alSourceQueueBuffers( la->source, 1,
-                                  &la->stream_buffers[la->active] );
-            la->active = 1 - la->active;
-         }
-      }
-      al_checkErr(); /* XXX - good or bad idea to log from the thread? */
-      soundUnlock();
+/**
+ * @brief A block of decoded audio waiting to be queued.
+ */
+typedef struct StreamBlock_s {
+   char   data[STREAM_BLOCK_SIZE]; /**< Decoded PCM data. */
+   size_t size;                    /**< Amount of valid data. */
+   int    ret;                     /**< Result of stream_decode. */
+} StreamBlock_t;
 
-      SDL_Delay( 10 );
-   }
-}
+/*
+ * Streaming service. A single thread services all the streaming sources,
+ * always refilling the one closest to running dry first.
+ */
+static SDL_mutex   *stream_lock    = NULL; /**< Protects the service state. */
+static SDL_cond    *stream_cond    = NULL; /**< Signals service changes. */
+static LuaAudio_t **stream_list    = NULL; /**< Registered streams. */
+static LuaAudio_t  *stream_current = NULL; /**< Stream being serviced. */
+static int          stream_running = 0;    /**< Whether the thread is alive. */
+static unsigned int stream_rr      = 0;    /**< Round-robin offset. */
+static StreamBlock_t
+   stream_pool[STREAM_POOL_SIZE]; /**< Bounded pool of prefetch blocks. */
+static int stream_poolUsed[STREAM_POOL_SIZE]; /**< Used pool blocks. */
+static StreamBlock_t stream_scratch; /**< Used when the pool is exhausted. */
 
 /**
- * @brief Loads a buffer.
+ * @brief Decodes audio from a stream.
+ *
+ * Must not be called with soundLock() set.
  *
- * Assumes that soundLock() is set.
+ *    @param la Stream to decode from.
+ *    @param buf Buffer to decode into.
+ *    @param len Size of the buffer.
+ *    @param[out] size Amount of data decoded.
+ *    @return 0 on success, 1 if the end was reached, -2 if there was no data
+ *            left and -1 on error.
  */
-static int stream_loadBuffer( LuaAudio_t *la, ALuint buffer )
+static int stream_decode( LuaAudio_t *la, char *buf, size_t len, size_t *size )
 {
-   int    ret;
-   size_t size;
-   char   buf[32 * 1024];
-
-   soundUnlock();
-   ret  = 0;
-   size = 0;
-   while ( size < sizeof( buf ) ) { /* file up the entire data buffer */
+   *size = 0;
+   while ( *size < len ) { /* fill up the entire data buffer */
       int               section, result;
       rg_filter_param_t param = {
          .rg_scale_factor = la->rg_scale_factor,
@@ -186,29 +169,24 @@ static int stream_loadBuffer( LuaAudio_t *la, ALuint buffer )
       };
 
       SDL_mutexP( la->lock );
-      result =
-         ov_read_filter( &la->stream,          /* stream */
-                         &buf[size],           /* data */
-                         sizeof( buf ) - size, /* amount to read */
-                         ( SDL_BYTEORDER == SDL_BIG_ENDIAN ), 2, /* 16 bit */
-                         1,                                      /* signed */
-                         &section,  /* current bitstream */
-                         rg_filter, /* filter function */
-                         &param );  /* filter parameter */
+      result = ov_read_filter( &la->stream,  /* stream */
+                               &buf[*size],  /* data */
+                               len - *size,  /* amount to read */
+                               ( SDL_BYTEORDER == SDL_BIG_ENDIAN ),
+                               2,         /* 16 bit */
+                               1,         /* signed */
+                               &section,  /* current bitstream */
+                               rg_filter, /* filter function */
+                               &param );  /* filter parameter */
       SDL_mutexV( la->lock );
 
       /* End of file. */
-      if ( result == 0 ) {
-         if ( size == 0 ) {
-            return -2;
-         }
-         ret = 1;
-         break;
-      }
+      if ( result == 0 )
+         return ( *size == 0 ) ? -2 : 1;
       /* Hole error. */
       else if ( result == OV_HOLE ) {
          WARN( _( "OGG: Vorbis hole detected in music!" ) );
-         return 0;
+         continue;
       }
       /* Bad link error. */
       else if ( result == OV_EBADLINK ) {
@@ -216,15 +194,317 @@ static int stream_loadBuffer( LuaAudio_t *la, ALuint buffer )
          return -1;
       }
 
-      size += result;
+      *size += result;
+   }
+   return 0;
+}
+
+/**
+ * @brief Gets the playing time of an amount of decoded data.
+ */
+static Uint32 stream_duration( const LuaAudio_t *la, size_t size )
+{
+   return (Uint32)( (double)size * 1000. /
+                    ( 2. * la->info->channels * la->info->rate ) );
+}
+
+/**
+ * @brief Gets a free block from the pool, or NULL if exhausted.
+ */
+static StreamBlock_t *stream_blockGet( void )
+{
+   StreamBlock_t *blk = NULL;
+   SDL_mutexP( stream_lock );
+   for ( int i = 0; i < STREAM_POOL_SIZE; i++ ) {
+      if ( stream_poolUsed[i] )
+         continue;
+      stream_poolUsed[i] = 1;
+      blk                = &stream_pool[i];
+      break;
    }
+   SDL_mutexV( stream_lock );
+   return blk;
+}
+
+/**
+ * @brief Returns a block to the pool. Assumes stream_lock is set.
+ */
+static void stream_blockFree( StreamBlock_t *blk )
+{
+   if ( ( blk == NULL ) || ( blk == &stream_scratch ) )
+      return;
+   stream_poolUsed[blk - stream_pool] = 0;
+}
+
+/**
+ * @brief Decodes the next block of a stream ahead of time if possible.
+ */
+static void stream_prefetch( LuaAudio_t *la )
+{
+   StreamBlock_t *blk;
+   if ( la->stream_pcm != NULL )
+      return;
+   blk = stream_blockGet();
+   if ( blk == NULL )
+      return;
+   blk->ret = stream_decode( la, blk->data, sizeof( blk->data ), &blk->size );
+   la->stream_pcm = blk;
+}
+
+/**
+ * @brief Refills a single buffer of a stream if it has been processed.
+ *
+ * Decoding is done without soundLock() so that the lock is only held for the
+ * OpenAL calls.
+ *
+ *    @param la Stream to service.
+ *    @param now Current tick.
+ *    @return 1 if the stream is done and should be removed from the service.
+ */
+static int stream_step( LuaAudio_t *la, Uint32 now )
+{
+   ALint          processed, state;
+   ALuint         buffer;
+   StreamBlock_t *blk;
+   int            ret;
+
    soundLock();
+   alGetSourcei( la->source, AL_BUFFERS_PROCESSED, &processed );
+   soundUnlock();
 
-   /* load the buffer up */
-   alBufferData( buffer, la->format, buf, size, la->info->rate );
-   al_checkErr();
+   /* Nothing to do yet (paused or early estimate), use the time to decode. */
+   if ( processed <= 0 ) {
+      la->stream_deadline = now + STREAM_RETRY_MS +
+                            ( AUDIO_STREAM_BUFFERS - 1 ) * la->stream_blockms;
+      stream_prefetch( la );
+      return 0;
+   }
 
-   return ret;
+   /* Use the prefetched block if there is one. */
+   blk            = la->stream_pcm;
+   la->stream_pcm = NULL;
+   if ( blk == NULL ) {
+      blk      = &stream_scratch;
+      blk->ret =
+         stream_decode( la, blk->data, sizeof( blk->data ), &blk->size );
+   }
+   ret = blk->ret;
+
+   if ( ret >= 0 ) {
+      soundLock();
+      alSourceUnqueueBuffers( la->source, 1, &buffer );
+      alBufferData( buffer, la->format, blk->data, blk->size, la->info->rate );
+      alSourceQueueBuffers( la->source, 1, &buffer );
+      /* Recover from running dry. */
+      alGetSourcei( la->source, AL_SOURCE_STATE, &state );
+      if ( state == AL_STOPPED )
+         alSourcePlay( la->source );
+      al_checkErr(); /* XXX - good or bad idea to log from the thread? */
+      soundUnlock();
+
+      if ( (Sint32)( la->stream_deadline - now ) < 0 )
+         la->stream_deadline = now;
+      la->stream_deadline += stream_duration( la, blk->size );
+   }
+
+   SDL_mutexP( stream_lock );
+   stream_blockFree( blk );
+   SDL_mutexV( stream_lock );
+
+   /* Let the source play out what is queued once the data runs out. */
+   if ( ret != 0 )
+      return 1;
+
+   stream_prefetch( la );
+   return 0;
+}
+
+/**
+ * @brief Picks the next stream that needs servicing. Assumes stream_lock is
+ * set.
+ *
+ *    @param now Current tick.
+ *    @param[out] wait Time to wait in milliseconds if nothing is due.
+ *    @return Stream to service or NULL if none is due.
+ */
+static LuaAudio_t *stream_next( Uint32 now, Uint32 *wait )
+{
+   LuaAudio_t *best   = NULL;
+   Sint32      bestdt = 0;
+   int         n      = array_size( stream_list );
+
+   /* Earliest due stream first, starting from the round-robin offset so that
+    * ties are serviced fairly. */
+   for ( int i = 0; i < n; i++ ) {
+      LuaAudio_t *la = stream_list[( stream_rr + i ) % n];
+      Sint32      dt = (Sint32)( la->stream_deadline - now ) -
+                  ( AUDIO_STREAM_BUFFERS - 1 ) * (Sint32)la->stream_blockms;
+      if ( ( best == NULL ) || ( dt < bestdt ) ) {
+         best   = la;
+         bestdt = dt;
+      }
+   }
+   stream_rr++;
+
+   if ( bestdt > 0 ) {
+      *wait = CLAMP( STREAM_WAIT_MIN_MS, STREAM_WAIT_MAX_MS, bestdt );
+      return NULL;
+   }
+   return best;
+}
+
+/**
+ * @brief Thread servicing all the registered streams.
+ */
+static int stream_service( void *unused )
+{
+   (void)unused;
+
+   SDL_mutexP( stream_lock );
+   while ( array_size( stream_list ) > 0 ) {
+      Uint32      wait = 0;
+      Uint32      now  = SDL_GetTicks();
+      LuaAudio_t *la   = stream_next( now, &wait );
+      int         done;
+
+      if ( la == NULL ) {
+         SDL_CondWaitTimeout( stream_cond, stream_lock, wait );
+         continue;
+      }
+
+      /* Service without the lock so streams can be registered meanwhile. */
+      stream_current = la;
+      SDL_mutexV( stream_lock );
+      done = stream_step( la, now );
+      SDL_mutexP( stream_lock );
+      stream_current = NULL;
+
+      if ( done ) {
+         for ( int i = 0; i < array_size( stream_list ); i++ ) {
+            if ( stream_list[i] != la )
+               continue;
+            array_erase( &stream_list, &stream_list[i], &stream_list[i + 1] );
+            break;
+         }
+         stream_blockFree( la->stream_pcm );
+         la->stream_pcm = NULL;
+         la->streaming  = 0;
+      }
+      SDL_CondBroadcast( stream_cond );
+   }
+   stream_running = 0;
+   SDL_mutexV( stream_lock );
+   return 0;
+}
+
+/**
+ * @brief Registers a stream with the streaming service, starting it if needed.
+ *
+ * Must not be called with soundLock() set.
+ */
+static void stream_register( LuaAudio_t *la )
+{
+   if ( stream_lock == NULL ) {
+      stream_lock = SDL_CreateMutex();
+      stream_cond = SDL_CreateCond();
+      stream_list = array_create( LuaAudio_t * );
+   }
+
+   SDL_mutexP( stream_lock );
+   if ( !la->streaming ) {
+      la->streaming = 1;
+      array_push_back( &stream_list, la );
+   }
+   if ( !stream_running ) {
+      SDL_Thread *th =
+         SDL_CreateThread( stream_service, "stream_service", NULL );
+      if ( th != NULL ) {
+         stream_running = 1;
+         SDL_DetachThread( th );
+      } else
+         WARN( _( "Unable to create audio streaming thread: %s" ),
+               SDL_GetError() );
+   }
+   SDL_CondBroadcast( stream_cond );
+   SDL_mutexV( stream_lock );
+}
+
+/**
+ * @brief Removes a stream from the streaming service.
+ *
+ * Waits for the service to be done with the stream and drops any block that
+ * was decoded ahead. Must not be called with soundLock() set.
+ *
+ *    @param la Stream to remove.
+ *    @return 1 if the stream was registered.
+ */
+static int stream_unregister( LuaAudio_t *la )
+{
+   int streaming;
+
+   if ( stream_lock == NULL )
+      return 0;
+
+   SDL_mutexP( stream_lock );
+   while ( stream_current == la )
+      SDL_CondWait( stream_cond, stream_lock );
+   streaming = la->streaming;
+   if ( streaming ) {
+      for ( int i = 0; i < array_size( stream_list ); i++ ) {
+         if ( stream_list[i] != la )
+            continue;
+         array_erase( &stream_list, &stream_list[i], &stream_list[i + 1] );
+         break;
+      }
+      la->streaming = 0;
+   }
+   stream_blockFree( la->stream_pcm );
+   la->stream_pcm = NULL;
+   SDL_mutexV( stream_lock );
+   return streaming;
+}
+
+/**
+ * @brief Fills and queues all the buffers of a stream and registers it with the
+ * streaming service.
+ *
+ *    @param la Stream to start.
+ *    @return 0 on success.
+ */
+static int stream_start( LuaAudio_t *la )
+{
+   ALint  queued;
+   ALuint removed[AUDIO_STREAM_BUFFERS];
+   char   buf[STREAM_BLOCK_SIZE];
+   int    ret = 0;
+   Uint32 now = SDL_GetTicks();
+
+   /* Start from a clean queue. */
+   soundLock();
+   alSourceStop( la->source );
+   alGetSourcei( la->source, AL_BUFFERS_QUEUED, &queued );
+   alSourceUnqueueBuffers( la->source, queued, removed );
+   soundUnlock();
+
+   la->stream_deadline = now;
+   for ( int i = 0; i < AUDIO_STREAM_BUFFERS; i++ ) {
+      size_t size;
+      ret = stream_decode( la, buf, sizeof( buf ), &size );
+      if ( ret < 0 )
+         break;
+      soundLock();
+      alBufferData( la->stream_buffers[i], la->format, buf, size,
+                    la->info->rate );
+      alSourceQueueBuffers( la->source, 1, &la->stream_buffers[i] );
+      soundUnlock();
+      la->stream_deadline += stream_duration( la, size );
+      if ( ret > 0 )
+         break;
+   }
+
+   if ( ret == 0 )
+      stream_register( la );
+   return ( ret < 0 ) ? -1 : 0;
 }
 
 /**
@@ -361,25 +641,12 @@ void audio_cleanup( LuaAudio_t *la )
       break;
 
    case LUA_AUDIO_STREAM:
+      stream_unregister( la );
       soundLock();
-      if ( la->th != NULL ) {
-         la->active = -1;
-         if ( SDL_CondWaitTimeout( la->cond, sound_lock, 3000 ) ==
-              SDL_MUTEX_TIMEDOUT )
-#if DEBUGGING
-            WARN( _( "Timed out while waiting for audio thread of '%s' to "
-                     "finish!" ),
-                  la->name );
-#else  /* DEBUGGING */
-            WARN( _( "Timed out while waiting for audio thread to finish!" ) );
-#endif /* DEBUGGING */
-      }
       if ( alIsSource( la->source ) == AL_TRUE )
          alDeleteSources( 1, &la->source );
       if ( alIsBuffer( la->stream_buffers[0] ) == AL_TRUE )
-         alDeleteBuffers( 2, la->stream_buffers );
-      if ( la->cond != NULL )
-         SDL_DestroyCond( la->cond );
+         alDeleteBuffers( AUDIO_STREAM_BUFFERS, la->stream_buffers );
       if ( la->lock != NULL )
          SDL_DestroyMutex( la->lock );
       ov_clear( &la->stream );
@@ -444,7 +711,7 @@ static int audio_genSource( ALuint *source )
    case AL_OUT_OF_MEMORY:
       /* Assume that we need to collect audio stuff. */
       soundUnlock();
-      lua_gc( naevL, LUA_GCCOLLECT, 0 );
+      nlua_gcFull();
       soundLock();
       /* Try to create source again. */
       alGenSources( 1, source );
@@ -568,10 +835,9 @@ static int audioL_new( lua_State *L )
       else
          la.format = AL_FORMAT_STEREO16;
 
-      la.active = 0;
-      la.lock   = SDL_CreateMutex();
-      la.cond   = SDL_CreateCond();
-      alGenBuffers( 2, la.stream_buffers );
+      la.lock           = SDL_CreateMutex();
+      la.stream_blockms = stream_duration( &la, STREAM_BLOCK_SIZE );
+      alGenBuffers( AUDIO_STREAM_BUFFERS, la.stream_buffers );
       /* Buffers get queued later. */
    }
 
@@ -674,23 +940,10 @@ static int audioL_play( lua_State *L )
    if ( sound_disabled || la->ok )
       return 0;
 
-   if ( ( la->type == LUA_AUDIO_STREAM ) && ( la->th == NULL ) ) {
-      int   ret = 0;
-      ALint alstate;
-      soundLock();
-      alGetSourcei( la->source, AL_BUFFERS_QUEUED, &alstate );
-      while ( alstate < 2 ) {
-         ret = stream_loadBuffer( la, la->stream_buffers[la->active] );
-         if ( ret < 0 )
-            break;
-         alSourceQueueBuffers( la->source, 1, &la->stream_buffers[la->active] );
-         la->active = 1 - la->active;
-         alGetSourcei( la->source, AL_BUFFERS_QUEUED, &alstate );
-      }
-      if ( ret == 0 )
-         la->th = SDL_CreateThread( stream_thread, "stream_thread", la );
-   } else
-      soundLock();
+   /* Streams already being serviced just get resumed. */
+   if ( ( la->type == LUA_AUDIO_STREAM ) && !la->streaming )
+      stream_start( la );
+   soundLock();
    alSourcePlay( la->source );
    al_checkErr();
    soundUnlock();
@@ -739,11 +992,15 @@ static int audioL_isPaused( lua_State *L )
 static int audioL_stop( lua_State *L )
 {
    ALint       alstate;
-   ALuint      removed[2];
+   ALuint      removed[AUDIO_STREAM_BUFFERS];
    LuaAudio_t *la = luaL_checkaudio( L, 1 );
    if ( sound_disabled || la->ok )
       return 0;
 
+   /* Take it out of the streaming service first. */
+   if ( la->type == LUA_AUDIO_STREAM )
+      stream_unregister( la );
+
    soundLock();
    switch ( la->type ) {
    case LUA_AUDIO_NULL:
@@ -753,21 +1010,6 @@ static int audioL_stop( lua_State *L )
       break;
 
    case LUA_AUDIO_STREAM:
-      /* Kill the thread first. */
-      if ( la->th != NULL ) {
-         la->active = -1;
-         if ( SDL_CondWaitTimeout( la->cond, sound_lock, 3000 ) ==
-              SDL_MUTEX_TIMEDOUT )
-#if DEBUGGING
-            WARN( _( "Timed out while waiting for audio thread of '%s' to "
-                     "finish!" ),
-                  la->name );
-#else  /* DEBUGGING */
-            WARN( _( "Timed out while waiting for audio thread to finish!" ) );
-#endif /* DEBUGGING */
-      }
-      la->th = NULL;
-
       /* Stopping a source will make all buffers become processed. */
       alSourceStop( la->source );
 
@@ -817,11 +1059,15 @@ static int audioL_rewind( lua_State *L )
       al_checkErr();
       soundUnlock();
       break;
-   case LUA_AUDIO_STREAM:
+   case LUA_AUDIO_STREAM: {
+      /* Re-registering drops the block decoded ahead at the old position. */
+      int streaming = stream_unregister( la );
       SDL_mutexP( la->lock );
       ov_raw_seek( &la->stream, 0 );
       SDL_mutexV( la->lock );
-      break;
+      if ( streaming )
+         stream_register( la );
+   } break;
    case LUA_AUDIO_NULL:
       break;
    }
@@ -866,7 +1112,9 @@ static int audioL_seek( lua_State *L )
       soundUnlock();
       break;
 
-   case LUA_AUDIO_STREAM:
+   case LUA_AUDIO_STREAM: {
+      /* Re-registering drops the block decoded ahead at the old position. */
+      int streaming = stream_unregister( la );
       SDL_mutexP( la->lock );
       if ( seconds )
          ov_time_seek( &la->stream, offset );
@@ -874,7 +1122,9 @@ static int audioL_seek( lua_State *L )
          ov_pcm_seek( &la->stream, offset );
       SDL_mutexV( la->lock );
       /* TODO force a reset of the buffers. */
-      break;
+      if ( streaming )
+         stream_register( la );
+   } break;
 
    case LUA_AUDIO_NULL:
       break;
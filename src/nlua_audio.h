@@ -12,6 +12,8 @@
 #include "nlua.h"
 
 #define AUDIO_METATABLE "audio" /**< Audio metatable identifier. */
+#define AUDIO_STREAM_BUFFERS                                                   \
+   3 /**< Number of OpenAL buffers queued per stream. */
 
 typedef enum LuaAudioType_e {
    LUA_AUDIO_NULL = 0,
@@ -46,10 +48,11 @@ typedef struct LuaAudio_s {
    ALfloat        rg_scale_factor; /**< Replaygain scale factor. */
    ALfloat
           rg_max_scale; /**< Replaygain maximum scale factor before clipping. */
-   ALuint stream_buffers[2]; /**< Double buffering for streaming. */
-   int    active;            /**< Active buffer. */
-   SDL_Thread *th;           /**< Buffering thread. */
-   SDL_cond   *cond;         /**< For message passing. */
+   ALuint stream_buffers[AUDIO_STREAM_BUFFERS]; /**< Streaming buffers. */
+   struct StreamBlock_s *stream_pcm; /**< Block decoded ahead of time. */
+   Uint32 stream_deadline; /**< Estimated tick when the queue runs dry. */
+   Uint32 stream_blockms;  /**< Duration of a full block in milliseconds. */
+   int    streaming;       /**< Registered with the streaming service. */
 } LuaAudio_t;
 
 /*
@@ -14,6 +14,7 @@
 
 #include "nlua_file.h"
 
+#include "ndata.h"
 #include "nluadef.h"
 #include "physfs.h"
 
@@ -203,11 +204,13 @@ static int fileL_open( lua_State *L )
    const char *mode = luaL_optstring( L, 2, "r" );
 
    /* TODO handle mode. */
-   if ( strcmp( mode, "w" ) == 0 )
+   if ( strcmp( mode, "w" ) == 0 ) {
       lf->rw = PHYSFSRWOPS_openWrite( lf->path );
-   else if ( strcmp( mode, "a" ) == 0 )
+      ndata_changed( lf->path );
+   } else if ( strcmp( mode, "a" ) == 0 ) {
       lf->rw = PHYSFSRWOPS_openAppend( lf->path );
-   else
+      ndata_changed( lf->path );
+   } else
       lf->rw = PHYSFSRWOPS_openRead( lf->path );
    if ( lf->rw == NULL ) {
       lua_pushboolean( L, 0 );
@@ -466,6 +469,7 @@ static int fileL_remove( lua_State *L )
 {
    const char *path = luaL_checkstring( L, 1 );
    int         ret  = PHYSFS_delete( path );
+   ndata_changed( path );
    lua_pushboolean( L, ret );
    if ( ret == 0 ) {
       lua_pushstring( L, PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) );
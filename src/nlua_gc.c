@@ -0,0 +1,160 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file nlua_gc.c
+ *
+ * @brief Schedules the Lua garbage collection.
+ *
+ * Left alone, the Lua collector runs whenever allocating triggers it, which
+ * can be in the middle of a busy frame. Instead, the collector is stepped
+ * incrementally at the end of each frame in the time that would otherwise be
+ * spent waiting for the next one, up to a configurable budget. The automatic
+ * collector is only kept as a backstop by making it wait for the heap to grow
+ * much more than usual. Full collections are only done on loading screens.
+ */
+/** @cond */
+#include "SDL_timer.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "nlua_gc.h"
+
+#include "conf.h"
+#include "nlua.h"
+
+#define GC_PAUSE_DEFAULT 200 /**< Default pause of the Lua collector. */
+#define GC_PAUSE_BACKSTOP                                                      \
+   400 /**< Pause of the automatic collector when stepping in idle time. */
+#define GC_IDLE_GROWTH                                                         \
+   1.5 /**< Heap growth since the last cycle that starts a new one. */
+#define GC_BUDGET_MIN                                                          \
+   0.25e-3 /**< Budget in seconds when there is no idle time to use. */
+
+static int    gc_pause   = 0;  /**< Current collector pause, 0 if unset. */
+static int    gc_cycle   = 0;  /**< Whether a cycle is being stepped. */
+static int    gc_request = 0;  /**< Whether a cycle was requested. */
+static double gc_live    = 0.; /**< Heap size after the last cycle in KiB. */
+static double gc_peak    = 0.; /**< Largest heap size seen in KiB. */
+static double gc_frame   = 0.; /**< Collection time of the last frame. */
+static double gc_total   = 0.; /**< Total collection time in seconds. */
+static int    gc_cycles  = 0;  /**< Cycles finished in idle time. */
+static int    gc_full    = 0;  /**< Full collections. */
+
+/**
+ * @brief Gets the size of the Lua heap in kilobytes.
+ */
+static double gc_heap( void )
+{
+   double kb = lua_gc( naevL, LUA_GCCOUNT, 0 ) +
+               lua_gc( naevL, LUA_GCCOUNTB, 0 ) / 1024.;
+   gc_peak = MAX( gc_peak, kb );
+   return kb;
+}
+
+/**
+ * @brief Gets the time since start in seconds.
+ */
+static double gc_elapsed( Uint64 start )
+{
+   return (double)( SDL_GetPerformanceCounter() - start ) /
+          (double)SDL_GetPerformanceFrequency();
+}
+
+/**
+ * @brief Steps the garbage collection in idle time.
+ *
+ * Meant to be called once at the end of each frame. A new cycle is only
+ * started once the heap has grown enough since the last one, or if one was
+ * requested.
+ *
+ *    @param slack Time in seconds until the next frame has to start, or 0 if
+ * not known.
+ *    @return Time spent collecting in seconds.
+ */
+double nlua_gcIdle( double slack )
+{
+   double budget, spent;
+   Uint64 t;
+   int    pause = ( conf.lua_gc_budget > 0. ) ? GC_PAUSE_BACKSTOP
+                                              : GC_PAUSE_DEFAULT;
+
+   gc_frame = 0.;
+   if ( naevL == NULL )
+      return 0.;
+
+   /* Disabling the budget gives control back to the automatic collector. */
+   if ( pause != gc_pause ) {
+      lua_gc( naevL, LUA_GCSETPAUSE, pause );
+      gc_pause = pause;
+   }
+   if ( conf.lua_gc_budget <= 0. )
+      return 0.;
+
+   /* See if there's anything worth collecting. */
+   if ( !gc_cycle ) {
+      if ( !gc_request && ( gc_heap() < GC_IDLE_GROWTH * gc_live ) )
+         return 0.;
+      gc_cycle   = 1;
+      gc_request = 0;
+   }
+
+   /* Steps are small, so we can check the time after each of them. */
+   budget = MIN( conf.lua_gc_budget * 1e-3, MAX( GC_BUDGET_MIN, slack ) );
+   t      = SDL_GetPerformanceCounter();
+   do {
+      if ( lua_gc( naevL, LUA_GCSTEP, 0 ) ) {
+         gc_cycle = 0;
+         gc_live  = gc_heap();
+         gc_cycles++;
+         break;
+      }
+   } while ( gc_elapsed( t ) < budget );
+   spent = gc_elapsed( t );
+
+   gc_frame = spent;
+   gc_total += spent;
+   return spent;
+}
+
+/**
+ * @brief Requests a garbage collection cycle to be done in idle time soon,
+ * regardless of how much the heap has grown.
+ */
+void nlua_gcRequest( void )
+{
+   gc_request = 1;
+}
+
+/**
+ * @brief Does a full garbage collection.
+ *
+ * This stalls for a long time, so it should only be done on loading screens.
+ */
+void nlua_gcFull( void )
+{
+   Uint64 t = SDL_GetPerformanceCounter();
+   lua_gc( naevL, LUA_GCCOLLECT, 0 );
+   gc_cycle   = 0;
+   gc_request = 0;
+   gc_live    = gc_heap();
+   gc_full++;
+   gc_total += gc_elapsed( t );
+}
+
+/**
+ * @brief Gets the garbage collection statistics.
+ *
+ *    @param[out] stats Statistics to fill.
+ */
+void nlua_gcStats( LuaGCStats *stats )
+{
+   stats->heap   = gc_heap();
+   stats->peak   = gc_peak;
+   stats->live   = gc_live;
+   stats->frame  = gc_frame * 1e3;
+   stats->total  = gc_total * 1e3;
+   stats->cycles = gc_cycles;
+   stats->full   = gc_full;
+}
@@ -0,0 +1,22 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/**
+ * @brief Statistics of the Lua garbage collection.
+ */
+typedef struct LuaGCStats_ {
+   double heap;   /**< Current heap size in kilobytes. */
+   double peak;   /**< Largest heap size seen in kilobytes. */
+   double live;   /**< Heap size after the last finished cycle in kilobytes. */
+   double frame;  /**< Time spent collecting in the last frame in ms. */
+   double total;  /**< Total time spent collecting in ms. */
+   int    cycles; /**< Number of cycles finished in idle time. */
+   int    full;   /**< Number of full collections. */
+} LuaGCStats;
+
+double nlua_gcIdle( double slack );
+void   nlua_gcRequest( void );
+void   nlua_gcFull( void );
+void   nlua_gcStats( LuaGCStats *stats );
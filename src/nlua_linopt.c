@@ -11,6 +11,7 @@
 /** @cond */
 #include "SDL_timer.h"
 #include "physfs.h"
+#include <errno.h>
 #include <glpk.h>
 #include <lauxlib.h>
 
@@ -20,11 +21,94 @@
 #include "nlua_linopt.h"
 
 #include "log.h"
+#include "md5.h"
+#include "nfile.h"
 #include "nluadef.h"
 
 #define LINOPT_MAX_TM                                                          \
    1000 /**< Maximum time to optimize (in ms). Applied to linear relaxation    \
            and MIP independently. */
+#define LINOPT_CACHE_MAX 256 /**< Solutions to keep in memory. */
+#define LINOPT_CACHE_FILES                                                     \
+   1024 /**< Files the disk cache is spread over, which caps its size. */
+#define LINOPT_CACHE_VERSION                                                   \
+   2 /**< Version of the solution cache, bump when the format changes. */
+
+/**
+ * @brief Solver parameters.
+ */
+typedef struct LinOptParams_ {
+   int      ismip; /**< Whether the problem has integer columns. */
+   glp_smcp smcp;  /**< Simplex parameters. */
+   glp_iocp iocp;  /**< Branch and cut parameters, only set if ismip. */
+} LinOptParams;
+
+/**
+ * @brief Solution of a problem.
+ */
+typedef struct LinOptResult_ {
+   const char *err;     /**< Error message, NULL if solved. */
+   int         optimal; /**< Whether the solution is optimal. */
+   double      z;       /**< Value of the objective function. */
+   int         ncols;   /**< Number of columns. */
+   int         nrows;   /**< Number of rows. */
+   double     *x;       /**< Column values. */
+   double     *r;       /**< Row values. */
+} LinOptResult;
+
+/**
+ * @brief Bounds and objective coefficient of a column or row.
+ */
+typedef struct LinOptBound_ {
+   int    type; /**< Type of bounds. */
+   int    kind; /**< Kind of column, 0 for rows. */
+   double lb;   /**< Lower bound. */
+   double ub;   /**< Upper bound. */
+   double coef; /**< Objective coefficient, 0 for rows. */
+} LinOptBound;
+
+/**
+ * @brief Non-zero constraint matrix entry.
+ */
+typedef struct LinOptEntry_ {
+   int    row; /**< Row of the entry. */
+   int    col; /**< Column of the entry. */
+   double val; /**< Value of the entry. */
+} LinOptEntry;
+
+/**
+ * @brief Copy of a problem that is independent of GLPK.
+ */
+typedef struct LinOptProblem_ {
+   int          dir;   /**< Optimization direction. */
+   int          ncols; /**< Number of columns. */
+   int          nrows; /**< Number of rows. */
+   int          nnz;   /**< Number of matrix entries. */
+   LinOptBound *cols;  /**< Columns, 0 holds the objective constant. */
+   LinOptBound *rows;  /**< Rows, 0 is unused. */
+   LinOptEntry *mat;   /**< Matrix entries sorted by row and column. */
+} LinOptProblem;
+
+/**
+ * @brief Cached solution.
+ */
+typedef struct LinOptCache_ {
+   unsigned int used;    /**< When the entry was last used, 0 if unused. */
+   md5_byte_t   key[16]; /**< Hash of the problem and parameters. */
+   LinOptResult res;     /**< Solution. */
+} LinOptCache;
+
+/**
+ * @brief Header of the disk cache files.
+ */
+typedef struct LinOptCacheHeader_ {
+   int32_t    version; /**< LINOPT_CACHE_VERSION. */
+   int32_t    ncols;   /**< Number of columns. */
+   int32_t    nrows;   /**< Number of rows. */
+   int32_t    pad;     /**< Unused. */
+   double     z;       /**< Value of the objective function. */
+   md5_byte_t key[16]; /**< Hash of the problem, files are shared. */
+} LinOptCacheHeader;
 
 /**
  * @brief Our cute little linear program wrapper.
@@ -35,6 +119,10 @@ typedef struct LuaLinOpt_s {
    glp_prob *prob;  /**< Problem structure itself. */
 } LuaLinOpt_t;
 
+static LinOptCache *linopt_cache =
+   NULL; /**< Cached solutions, LINOPT_CACHE_MAX long. */
+static unsigned int linopt_cache_tick = 0; /**< Counter of cache uses. */
+
 /* Optim metatable methods. */
 static int linoptL_gc( lua_State *L );
 static int linoptL_eq( lua_State *L );
@@ -619,143 +707,518 @@ static int opt_onoff( const char *str, int def )
 
 #define GETOPT_IOCP( name, func, def )                                         \
    do {                                                                        \
-      lua_getfield( L, 2, #name );                                             \
-      parm_iocp.name = func( luaL_optstring( L, -1, NULL ), def );             \
+      lua_getfield( L, ind, #name );                                           \
+      par->iocp.name = func( luaL_optstring( L, -1, NULL ), def );             \
       lua_pop( L, 1 );                                                         \
    } while ( 0 )
 #define GETOPT_SMCP( name, func, def )                                         \
    do {                                                                        \
-      lua_getfield( L, 2, #name );                                             \
-      parm_smcp.name = func( luaL_optstring( L, -1, NULL ), def );             \
+      lua_getfield( L, ind, #name );                                           \
+      par->smcp.name = func( luaL_optstring( L, -1, NULL ), def );             \
       lua_pop( L, 1 );                                                         \
    } while ( 0 )
 /**
- * @brief Solves the linear optimization problem.
+ * @brief Loads the solver parameters from a Lua table.
  *
- *    @luatparam LinOpt lp Linear program to modify.
- *    @luatreturn number The value of the primal funcation.
- *    @luatreturn table Table of column values.
- * @luafunc solve
+ *    @param L Lua state.
+ *    @param ind Index of the parameter table, may be nil.
+ *    @param prob Problem that will be solved.
+ *    @param[out] par Parameters to set.
  */
-static int linoptL_solve( lua_State *L )
+static void linopt_params( lua_State *L, int ind, glp_prob *prob,
+                           LinOptParams *par )
 {
-   LuaLinOpt_t *lp = luaL_checklinopt( L, 1 );
-   double       z;
-   int          ret, ismip;
-   glp_iocp     parm_iocp;
-   glp_smcp     parm_smcp;
-#if DEBUGGING
-   Uint64 starttime = SDL_GetTicks64();
-#endif /* DEBUGGING */
-
-   /* Parameters. */
-   ismip = ( glp_get_num_int( lp->prob ) > 0 );
-   glp_init_smcp( &parm_smcp );
-   parm_smcp.msg_lev = GLP_MSG_ERR;
-   parm_smcp.tm_lim  = LINOPT_MAX_TM;
-   if ( ismip ) {
-      glp_init_iocp( &parm_iocp );
-      parm_iocp.msg_lev = GLP_MSG_ERR;
-      parm_iocp.tm_lim  = LINOPT_MAX_TM;
+   memset( par, 0, sizeof( LinOptParams ) );
+   par->ismip = ( glp_get_num_int( prob ) > 0 );
+   glp_init_smcp( &par->smcp );
+   par->smcp.msg_lev = GLP_MSG_ERR;
+   par->smcp.tm_lim  = LINOPT_MAX_TM;
+   if ( par->ismip ) {
+      glp_init_iocp( &par->iocp );
+      par->iocp.msg_lev = GLP_MSG_ERR;
+      par->iocp.tm_lim  = LINOPT_MAX_TM;
    }
 
-   /* Load parameters. */
-   if ( !lua_isnoneornil( L, 2 ) ) {
-      GETOPT_SMCP( meth, opt_meth, METH_DEF );
-      GETOPT_SMCP( pricing, opt_pricing, PRICING_DEF );
-      GETOPT_SMCP( r_test, opt_r_test, R_TEST_DEF );
-      GETOPT_SMCP( presolve, opt_onoff, PRESOLVE_DEF );
-      if ( ismip ) {
-         GETOPT_IOCP( br_tech, opt_br_tech, BR_TECH_DEF );
-         GETOPT_IOCP( bt_tech, opt_bt_tech, BT_TECH_DEF );
-         GETOPT_IOCP( pp_tech, opt_pp_tech, PP_TECH_DEF );
-         GETOPT_IOCP( sr_heur, opt_onoff, SR_HEUR_DEF );
-         GETOPT_IOCP( fp_heur, opt_onoff, FP_HEUR_DEF );
-         GETOPT_IOCP( ps_heur, opt_onoff, PS_HEUR_DEF );
-         GETOPT_IOCP( gmi_cuts, opt_onoff, GMI_CUTS_DEF );
-         GETOPT_IOCP( mir_cuts, opt_onoff, MIR_CUTS_DEF );
-         GETOPT_IOCP( cov_cuts, opt_onoff, COV_CUTS_DEF );
-         GETOPT_IOCP( clq_cuts, opt_onoff, CLQ_CUTS_DEF );
-      }
-   }
-#if 0
-   else {
-      parm_smcp.meth    = METH_DEF;
-      parm_smcp.pricing = PRICING_DEF;
-      parm_smcp.r_test  = R_TEST_DEF;
-      parm_smcp.presolve= PRESOLVE_DEF;
-      if (ismip) {
-         parm_iocp.br_tech  = BR_TECH_DEF;
-         parm_iocp.bt_tech  = BT_TECH_DEF;
-         parm_iocp.pp_tech  = PP_TECH_DEF;
-         parm_iocp.sr_heur  = SR_HEUR_DEF;
-         parm_iocp.fp_heur  = FP_HEUR_DEF;
-         parm_iocp.ps_heur  = PS_HEUR_DEF;
-         parm_iocp.gmi_cuts = GMI_CUTS_DEF;
-         parm_iocp.mir_cuts = MIR_CUTS_DEF;
-         parm_iocp.cov_cuts = COV_CUTS_DEF;
-         parm_iocp.clq_cuts = CLQ_CUTS_DEF;
-      }
+   if ( lua_isnoneornil( L, ind ) )
+      return;
+   GETOPT_SMCP( meth, opt_meth, METH_DEF );
+   GETOPT_SMCP( pricing, opt_pricing, PRICING_DEF );
+   GETOPT_SMCP( r_test, opt_r_test, R_TEST_DEF );
+   GETOPT_SMCP( presolve, opt_onoff, PRESOLVE_DEF );
+   if ( par->ismip ) {
+      GETOPT_IOCP( br_tech, opt_br_tech, BR_TECH_DEF );
+      GETOPT_IOCP( bt_tech, opt_bt_tech, BT_TECH_DEF );
+      GETOPT_IOCP( pp_tech, opt_pp_tech, PP_TECH_DEF );
+      GETOPT_IOCP( sr_heur, opt_onoff, SR_HEUR_DEF );
+      GETOPT_IOCP( fp_heur, opt_onoff, FP_HEUR_DEF );
+      GETOPT_IOCP( ps_heur, opt_onoff, PS_HEUR_DEF );
+      GETOPT_IOCP( gmi_cuts, opt_onoff, GMI_CUTS_DEF );
+      GETOPT_IOCP( mir_cuts, opt_onoff, MIR_CUTS_DEF );
+      GETOPT_IOCP( cov_cuts, opt_onoff, COV_CUTS_DEF );
+      GETOPT_IOCP( clq_cuts, opt_onoff, CLQ_CUTS_DEF );
    }
-#endif
+}
+#undef GETOPT_SMCP
+#undef GETOPT_IOCP
+
+/**
+ * @brief Frees the contents of a result.
+ */
+static void linopt_resultFree( LinOptResult *res )
+{
+   free( res->x );
+   free( res->r );
+   memset( res, 0, sizeof( LinOptResult ) );
+}
+
+/**
+ * @brief Solves a problem.
+ *
+ *    @param prob Problem to solve.
+ *    @param par Parameters to use.
+ *    @param[out] res Result of the optimization.
+ */
+static void linopt_solve( glp_prob *prob, const LinOptParams *par,
+                          LinOptResult *res )
+{
+   glp_smcp parm_smcp = par->smcp;
+   glp_iocp parm_iocp = par->iocp;
+   int      ret, ismip = par->ismip;
+
+   memset( res, 0, sizeof( LinOptResult ) );
+   res->optimal = 1;
 
    /* Optimization. */
    if ( !ismip || !parm_iocp.presolve ) {
-      ret = glp_simplex( lp->prob, &parm_smcp );
+      ret = glp_simplex( prob, &parm_smcp );
       if ( ( ret != 0 ) && ( ret != GLP_ETMLIM ) ) {
-         lua_pushnil( L );
-         lua_pushstring( L, linopt_error( ret ) );
-         return 2;
+         res->err = linopt_error( ret );
+         return;
       }
       /* Check for optimality of continuous problem. */
-      ret = glp_get_status( lp->prob );
+      ret = glp_get_status( prob );
       if ( ( ret != GLP_OPT ) && ( ret != GLP_FEAS ) ) {
-         lua_pushnil( L );
-         lua_pushstring( L, linopt_status( ret ) );
-         return 2;
+         res->err = linopt_status( ret );
+         return;
       }
+      res->optimal = ( ret == GLP_OPT );
    }
    if ( ismip ) {
-      ret = glp_intopt( lp->prob, &parm_iocp );
+      ret = glp_intopt( prob, &parm_iocp );
       if ( ( ret != 0 ) && ( ret != GLP_ETMLIM ) ) {
-         lua_pushnil( L );
-         lua_pushstring( L, linopt_error( ret ) );
-         return 2;
+         res->err = linopt_error( ret );
+         return;
       }
       /* Check for optimality of discrete problem. */
-      ret = glp_mip_status( lp->prob );
+      ret = glp_mip_status( prob );
       if ( ( ret != GLP_OPT ) && ( ret != GLP_FEAS ) ) {
-         lua_pushnil( L );
-         lua_pushstring( L, linopt_status( ret ) );
-         return 2;
+         res->err = linopt_status( ret );
+         return;
       }
+      res->optimal = ( ret == GLP_OPT );
+   }
+
+   /* Store the values. */
+   res->ncols = glp_get_num_cols( prob );
+   res->nrows = glp_get_num_rows( prob );
+   res->z     = glp_get_obj_val( prob );
+   res->x     = malloc( MAX( res->ncols, 1 ) * sizeof( double ) );
+   res->r     = malloc( MAX( res->nrows, 1 ) * sizeof( double ) );
+   for ( int i = 1; i <= res->ncols; i++ )
+      res->x[i - 1] = ismip ? glp_mip_col_val( prob, i )
+                            : glp_get_col_prim( prob, i );
+   for ( int i = 1; i <= res->nrows; i++ )
+      res->r[i - 1] = ismip ? glp_mip_row_val( prob, i )
+                            : glp_get_row_prim( prob, i );
+}
+
+/**
+ * @brief Pushes the result of an optimization like linoptL_solve.
+ */
+static int linopt_pushResult( lua_State *L, const LinOptResult *res )
+{
+   if ( res->err != NULL ) {
+      lua_pushnil( L );
+      lua_pushstring( L, res->err );
+      return 2;
    }
-   z = glp_get_obj_val( lp->prob );
 
    /* Output function value. */
-   lua_pushnumber( L, z );
+   lua_pushnumber( L, res->z );
 
    /* Go over variables and store them. */
    lua_newtable( L ); /* t */
-   for ( int i = 1; i <= lp->ncols; i++ ) {
-      if ( ismip )
-         z = glp_mip_col_val( lp->prob, i );
-      else
-         z = glp_get_col_prim( lp->prob, i );
-      lua_pushnumber( L, z );  /* t, z */
-      lua_rawseti( L, -2, i ); /* t */
+   for ( int i = 0; i < res->ncols; i++ ) {
+      lua_pushnumber( L, res->x[i] ); /* t, z */
+      lua_rawseti( L, -2, i + 1 );    /* t */
    }
 
    /* Go over constraints and store them. */
    lua_newtable( L ); /* t */
-   for ( int i = 1; i <= lp->nrows; i++ ) {
-      if ( ismip )
-         z = glp_mip_row_val( lp->prob, i );
-      else
-         z = glp_get_row_prim( lp->prob, i );
-      lua_pushnumber( L, z );  /* t, z */
-      lua_rawseti( L, -2, i ); /* t */
+   for ( int i = 0; i < res->nrows; i++ ) {
+      lua_pushnumber( L, res->r[i] ); /* t, z */
+      lua_rawseti( L, -2, i + 1 );    /* t */
+   }
+
+   return 3;
+}
+
+/**
+ * @brief Compares matrix entries by column.
+ */
+static int linopt_entryCmp( const void *p1, const void *p2 )
+{
+   const LinOptEntry *e1 = p1;
+   const LinOptEntry *e2 = p2;
+   return e1->col - e2->col;
+}
+
+/**
+ * @brief Copies a problem into plain arrays.
+ *
+ * The copy can be hashed and checked against cached solutions. Names are left
+ * out as they don't change the solution.
+ *
+ *    @param[out] snap Copy to fill.
+ *    @param prob Problem to copy.
+ */
+static void linopt_snapshot( LinOptProblem *snap, glp_prob *prob )
+{
+   int    *ind;
+   double *val;
+   int     n;
+
+   snap->dir   = glp_get_obj_dir( prob );
+   snap->ncols = glp_get_num_cols( prob );
+   snap->nrows = glp_get_num_rows( prob );
+   snap->cols  = malloc( ( snap->ncols + 1 ) * sizeof( LinOptBound ) );
+   snap->rows  = malloc( ( snap->nrows + 1 ) * sizeof( LinOptBound ) );
+   snap->mat =
+      malloc( MAX( glp_get_num_nz( prob ), 1 ) * sizeof( LinOptEntry ) );
+
+   /* The objective constant goes in column 0. */
+   memset( &snap->cols[0], 0, sizeof( LinOptBound ) );
+   snap->cols[0].coef = glp_get_obj_coef( prob, 0 );
+   for ( int j = 1; j <= snap->ncols; j++ ) {
+      LinOptBound *b = &snap->cols[j];
+      b->type        = glp_get_col_type( prob, j );
+      b->kind        = glp_get_col_kind( prob, j );
+      b->lb          = glp_get_col_lb( prob, j );
+      b->ub          = glp_get_col_ub( prob, j );
+      b->coef        = glp_get_obj_coef( prob, j );
+   }
+
+   /* Rows along with their matrix entries, sorted so the hash is stable. */
+   ind       = malloc( ( snap->ncols + 1 ) * sizeof( int ) );
+   val       = malloc( ( snap->ncols + 1 ) * sizeof( double ) );
+   snap->nnz = 0;
+   memset( &snap->rows[0], 0, sizeof( LinOptBound ) );
+   for ( int i = 1; i <= snap->nrows; i++ ) {
+      LinOptBound *b = &snap->rows[i];
+      LinOptEntry *e = &snap->mat[snap->nnz];
+      memset( b, 0, sizeof( LinOptBound ) );
+      b->type = glp_get_row_type( prob, i );
+      b->lb   = glp_get_row_lb( prob, i );
+      b->ub   = glp_get_row_ub( prob, i );
+      n       = glp_get_mat_row( prob, i, ind, val );
+      for ( int k = 1; k <= n; k++ ) {
+         e[k - 1].row = i;
+         e[k - 1].col = ind[k];
+         e[k - 1].val = val[k];
+      }
+      qsort( e, n, sizeof( LinOptEntry ), linopt_entryCmp );
+      snap->nnz += n;
+   }
+   free( ind );
+   free( val );
+}
+
+/**
+ * @brief Frees a problem copy.
+ */
+static void linopt_snapshotFree( LinOptProblem *snap )
+{
+   free( snap->cols );
+   free( snap->rows );
+   free( snap->mat );
+   memset( snap, 0, sizeof( LinOptProblem ) );
+}
+
+/**
+ * @brief Hashes a problem along with the parameters that affect the solution.
+ *
+ * The time limit is left out, as only optimal solutions get cached.
+ *
+ *    @param snap Problem copy to hash.
+ *    @param par Solver parameters.
+ *    @param[out] key Hash of the problem.
+ */
+static void linopt_hash( const LinOptProblem *snap, const LinOptParams *par,
+                         md5_byte_t key[16] )
+{
+   md5_state_t md5;
+   int         opts[16];
+   int         n = 0;
+
+   md5_init( &md5 );
+   opts[n++] = LINOPT_CACHE_VERSION;
+   opts[n++] = par->ismip;
+   opts[n++] = par->smcp.meth;
+   opts[n++] = par->smcp.pricing;
+   opts[n++] = par->smcp.r_test;
+   opts[n++] = par->smcp.presolve;
+   if ( par->ismip ) {
+      opts[n++] = par->iocp.br_tech;
+      opts[n++] = par->iocp.bt_tech;
+      opts[n++] = par->iocp.pp_tech;
+      opts[n++] = par->iocp.sr_heur;
+      opts[n++] = par->iocp.fp_heur;
+      opts[n++] = par->iocp.ps_heur;
+      opts[n++] = par->iocp.gmi_cuts;
+      opts[n++] = par->iocp.mir_cuts;
+      opts[n++] = par->iocp.cov_cuts;
+      opts[n++] = par->iocp.clq_cuts;
+   }
+   md5_append( &md5, (const md5_byte_t *)opts, n * sizeof( int ) );
+   md5_append( &md5, (const md5_byte_t *)&snap->dir, sizeof( int ) );
+   md5_append( &md5, (const md5_byte_t *)&snap->ncols, sizeof( int ) );
+   md5_append( &md5, (const md5_byte_t *)&snap->nrows, sizeof( int ) );
+   md5_append( &md5, (const md5_byte_t *)snap->cols,
+               ( snap->ncols + 1 ) * sizeof( LinOptBound ) );
+   md5_append( &md5, (const md5_byte_t *)snap->rows,
+               ( snap->nrows + 1 ) * sizeof( LinOptBound ) );
+   md5_append( &md5, (const md5_byte_t *)snap->mat,
+               snap->nnz * sizeof( LinOptEntry ) );
+   md5_finish( &md5, key );
+}
+
+/**
+ * @brief Gets the path of the disk cache file of a problem.
+ *
+ * Problems are spread over LINOPT_CACHE_FILES files by their hash, so the
+ * cache can't grow past that. A new solution replaces whatever was in its
+ * file.
+ */
+static char *linopt_cacheFile( const md5_byte_t key[16] )
+{
+   char *path;
+   int   n = ( ( key[0] << 8 ) | key[1] ) % LINOPT_CACHE_FILES;
+   SDL_asprintf( &path, "%slinopt/%04x", nfile_cachePath(), n );
+   return path;
+}
+
+/**
+ * @brief Checks to see if a result is worth caching.
+ */
+static int linopt_cacheable( const LinOptResult *res )
+{
+   /* Time limited solutions could be improved on later. */
+   return ( res->err == NULL ) && res->optimal;
+}
+
+/**
+ * @brief Copies a result into the in-memory cache.
+ *
+ * Replaces the least recently used entry once the cache is full.
+ */
+static void linopt_cacheStore( const md5_byte_t key[16],
+                               const LinOptResult *res )
+{
+   LinOptCache *c = NULL;
+
+   if ( linopt_cache == NULL )
+      linopt_cache = calloc( LINOPT_CACHE_MAX, sizeof( LinOptCache ) );
+
+   /* Reuse the entry of the same problem, otherwise the least recently used
+    * one. */
+   for ( int i = 0; i < LINOPT_CACHE_MAX; i++ ) {
+      LinOptCache *ci = &linopt_cache[i];
+      if ( ci->used && ( memcmp( ci->key, key, sizeof( ci->key ) ) == 0 ) ) {
+         c = ci;
+         break;
+      }
+      if ( ( c == NULL ) || ( ci->used < c->used ) )
+         c = ci;
+   }
+   linopt_resultFree( &c->res );
+   memcpy( c->key, key, sizeof( c->key ) );
+   c->res   = *res;
+   c->res.x = malloc( MAX( res->ncols, 1 ) * sizeof( double ) );
+   c->res.r = malloc( MAX( res->nrows, 1 ) * sizeof( double ) );
+   memcpy( c->res.x, res->x, res->ncols * sizeof( double ) );
+   memcpy( c->res.r, res->r, res->nrows * sizeof( double ) );
+   c->used = ++linopt_cache_tick;
+}
+
+/**
+ * @brief Looks up the solution of a problem in the cache.
+ *
+ *    @param key Hash of the problem.
+ *    @param snap Problem, used to validate the cached data.
+ *    @param[out] res Copy of the cached solution if found.
+ *    @return 1 if the solution was found.
+ */
+static int linopt_cacheGet( const md5_byte_t key[16],
+                            const LinOptProblem *snap, LinOptResult *res )
+{
+   LinOptCacheHeader hdr;
+   char             *path, *data;
+   size_t            size, xsize, rsize;
+
+   memset( res, 0, sizeof( LinOptResult ) );
+
+   /* Memory first. */
+   for ( int i = 0; ( linopt_cache != NULL ) && ( i < LINOPT_CACHE_MAX );
+         i++ ) {
+      LinOptCache *c = &linopt_cache[i];
+      if ( !c->used || ( memcmp( c->key, key, sizeof( c->key ) ) != 0 ) )
+         continue;
+      c->used = ++linopt_cache_tick;
+      *res    = c->res;
+      res->x  = malloc( MAX( res->ncols, 1 ) * sizeof( double ) );
+      res->r  = malloc( MAX( res->nrows, 1 ) * sizeof( double ) );
+      memcpy( res->x, c->res.x, res->ncols * sizeof( double ) );
+      memcpy( res->r, c->res.r, res->nrows * sizeof( double ) );
+      return 1;
+   }
+
+   /* Try the disk cache from previous runs. */
+   path = linopt_cacheFile( key );
+   data = NULL;
+   if ( nfile_fileExists( path ) )
+      data = nfile_readFile( &size, path );
+   free( path );
+   if ( data == NULL )
+      return 0;
+
+   /* Consider cached data invalid if it doesn't match the problem. */
+   xsize = snap->ncols * sizeof( double );
+   rsize = snap->nrows * sizeof( double );
+   if ( size != sizeof( hdr ) + xsize + rsize ) {
+      free( data );
+      return 0;
+   }
+   memcpy( &hdr, data, sizeof( hdr ) );
+   if ( ( hdr.version != LINOPT_CACHE_VERSION ) ||
+        ( memcmp( hdr.key, key, sizeof( hdr.key ) ) != 0 ) ||
+        ( hdr.ncols != snap->ncols ) || ( hdr.nrows != snap->nrows ) ) {
+      free( data );
+      return 0;
+   }
+
+   res->optimal = 1;
+   res->z       = hdr.z;
+   res->ncols   = hdr.ncols;
+   res->nrows   = hdr.nrows;
+   res->x       = malloc( MAX( xsize, sizeof( double ) ) );
+   res->r       = malloc( MAX( rsize, sizeof( double ) ) );
+   memcpy( res->x, &data[sizeof( hdr )], xsize );
+   memcpy( res->r, &data[sizeof( hdr ) + xsize], rsize );
+   free( data );
+
+   linopt_cacheStore( key, res );
+   return 1;
+}
+
+/**
+ * @brief Saves the solution of a problem to the disk cache.
+ *
+ * The file is written under a temporary name and then moved into place, so
+ * that another game sharing the cache never reads a partially written file.
+ *
+ *    @param key Hash of the problem.
+ *    @param res Solution to save.
+ */
+static void linopt_cacheWrite( const md5_byte_t key[16],
+                               const LinOptResult *res )
+{
+   LinOptCacheHeader hdr;
+   char             *data, *path, *tmppath;
+   char              dirpath[PATH_MAX];
+   size_t            size, xsize, rsize;
+
+   memset( &hdr, 0, sizeof( hdr ) );
+   memcpy( hdr.key, key, sizeof( hdr.key ) );
+   hdr.version = LINOPT_CACHE_VERSION;
+   hdr.ncols   = res->ncols;
+   hdr.nrows   = res->nrows;
+   hdr.z       = res->z;
+   xsize       = res->ncols * sizeof( double );
+   rsize       = res->nrows * sizeof( double );
+   size        = sizeof( hdr ) + xsize + rsize;
+   data        = malloc( size );
+   memcpy( data, &hdr, sizeof( hdr ) );
+   memcpy( &data[sizeof( hdr )], res->x, xsize );
+   memcpy( &data[sizeof( hdr ) + xsize], res->r, rsize );
+
+   snprintf( dirpath, sizeof( dirpath ), "%s/%s", nfile_cachePath(),
+             "linopt/" );
+   nfile_dirMakeExist( dirpath );
+   path = linopt_cacheFile( key );
+   SDL_asprintf( &tmppath, "%s.tmp", path );
+   if ( nfile_writeFile( data, size, tmppath ) == 0 ) {
+#if __WIN32__
+      /* Windows won't rename over an existing file. */
+      remove( path );
+#endif /* __WIN32__ */
+      if ( rename( tmppath, path ) != 0 ) {
+         WARN( _( "Error occurred while renaming '%s' to '%s': %s" ), tmppath,
+               path, strerror( errno ) );
+         remove( tmppath );
+      }
    }
+   free( tmppath );
+   free( path );
+   free( data );
+}
+
+/**
+ * @brief Solves the linear optimization problem.
+ *
+ * Optimal solutions are cached in memory and on disk, so solving the exact
+ * same problem again, even in a later session, is nearly free.
+ *
+ *    @luatparam LinOpt lp Linear program to modify.
+ *    @luatparam[opt=nil] table params Table of solver parameters.
+ *    @luatreturn number The value of the primal funcation.
+ *    @luatreturn table Table of column values.
+ *    @luatreturn table Table of row values.
+ * @luafunc solve
+ */
+static int linoptL_solve( lua_State *L )
+{
+   LuaLinOpt_t  *lp = luaL_checklinopt( L, 1 );
+   LinOptParams  par;
+   LinOptProblem snap;
+   LinOptResult  res;
+   md5_byte_t    key[16];
+   int           ret;
+#if DEBUGGING
+   Uint64 starttime = SDL_GetTicks64();
+#endif /* DEBUGGING */
+
+   /* Parameters. */
+   linopt_params( L, 2, lp->prob, &par );
+
+   /* See if it has already been solved. */
+   linopt_snapshot( &snap, lp->prob );
+   linopt_hash( &snap, &par, key );
+   if ( linopt_cacheGet( key, &snap, &res ) ) {
+      linopt_snapshotFree( &snap );
+      ret = linopt_pushResult( L, &res );
+      linopt_resultFree( &res );
+      return ret;
+   }
+   linopt_snapshotFree( &snap );
+
+   /* Optimization. */
+   linopt_solve( lp->prob, &par, &res );
+   if ( linopt_cacheable( &res ) ) {
+      linopt_cacheStore( key, &res );
+      linopt_cacheWrite( key, &res );
+   }
+   ret = linopt_pushResult( L, &res );
+   linopt_resultFree( &res );
 
    /* Complain about time. */
 #if DEBUGGING
@@ -763,9 +1226,8 @@ static int linoptL_solve( lua_State *L )
       WARN( _( "glpk: too over 1 second to optimize!" ) );
 #endif /* DEBUGGING */
 
-   return 3;
+   return ret;
 }
-#undef GETOPT_IOCP
 
 /**
  * @brief Reads an optimization problem from a file for debugging purposes.
@@ -7,6 +7,7 @@
  * @brief Contains Naev generic Lua bindings.
  */
 /** @cond */
+#include "physfs.h"
 #include <lauxlib.h>
 
 #include "naev.h"
@@ -18,15 +19,19 @@
 #include "console.h"
 #include "debug.h"
 #include "event.h"
+#include "frametime.h"
 #include "hook.h"
 #include "info.h"
 #include "input.h"
 #include "land.h"
 #include "log.h"
 #include "menu.h"
+#include "nlua_gc.h"
 #include "nlua_misn.h"
+#include "nlua_profiler.h"
 #include "nlua_system.h"
 #include "nluadef.h"
+#include "opengl.h"
 #include "pause.h"
 #include "player.h"
 #include "plugin.h"
@@ -43,6 +48,13 @@ static int naevL_ticks( lua_State *L );
 static int naevL_ticksGame( lua_State *L );
 static int naevL_clock( lua_State *L );
 static int naevL_fps( lua_State *L );
+static int naevL_renderStats( lua_State *L );
+static int naevL_frameStats( lua_State *L );
+static int naevL_frameDump( lua_State *L );
+static int naevL_gcStats( lua_State *L );
+static int naevL_profileStart( lua_State *L );
+static int naevL_profileStop( lua_State *L );
+static int naevL_profileDump( lua_State *L );
 static int naevL_keyGet( lua_State *L );
 static int naevL_keyEnable( lua_State *L );
 static int naevL_keyEnableAll( lua_State *L );
@@ -85,6 +97,13 @@ static const luaL_Reg naev_methods[] = {
    { "ticksGame", naevL_ticksGame },
    { "clock", naevL_clock },
    { "fps", naevL_fps },
+   { "renderStats", naevL_renderStats },
+   { "frameStats", naevL_frameStats },
+   { "frameDump", naevL_frameDump },
+   { "gcStats", naevL_gcStats },
+   { "profileStart", naevL_profileStart },
+   { "profileStop", naevL_profileStop },
+   { "profileDump", naevL_profileDump },
    { "keyGet", naevL_keyGet },
    { "keyEnable", naevL_keyEnable },
    { "keyEnableAll", naevL_keyEnableAll },
@@ -277,6 +296,234 @@ static int naevL_fps( lua_State *L )
    return 1;
 }
 
+/**
+ * @brief Gets the rendering statistics of the last frame.
+ *
+ * Useful for checking batching with a software renderer.
+ *
+ *    @luatreturn table Table with the number of "draws" (draw calls of
+ * batched renderers), "states" (program and texture changes they made),
+ * "instances" (batched sprites and effects) and "glyphs" (glyphs rendered).
+ * @luafunc renderStats
+ */
+static int naevL_renderStats( lua_State *L )
+{
+   const glRenderStats *stats = gl_statsLast();
+   lua_newtable( L );
+   lua_pushinteger( L, stats->draws );
+   lua_setfield( L, -2, "draws" );
+   lua_pushinteger( L, stats->states );
+   lua_setfield( L, -2, "states" );
+   lua_pushinteger( L, stats->instances );
+   lua_setfield( L, -2, "instances" );
+   lua_pushinteger( L, stats->glyphs );
+   lua_setfield( L, -2, "glyphs" );
+   return 1;
+}
+
+/**
+ * @brief Pushes a frame time summary as a table.
+ */
+static void naevL_pushFrameTimeStats( lua_State *L, const FrameTimeStats *s )
+{
+   lua_newtable( L );
+   lua_pushnumber( L, s->p50 );
+   lua_setfield( L, -2, "p50" );
+   lua_pushnumber( L, s->p95 );
+   lua_setfield( L, -2, "p95" );
+   lua_pushnumber( L, s->p99 );
+   lua_setfield( L, -2, "p99" );
+   lua_pushnumber( L, s->max );
+   lua_setfield( L, -2, "max" );
+}
+
+/**
+ * @brief Gets the frame time statistics of the recent frames.
+ *
+ * All times are in milliseconds.
+ *
+ * @usage print( naev.frameStats().total.p99 )
+ *
+ *    @luatreturn table Table with the number of "frames" recorded, the "total"
+ * frame time and the time of each of the "zones" as tables with the "p50",
+ * "p95", "p99" and "max" percentiles, the heap "allocs" per frame in the same
+ * format, and the recent "hitches" as a list of tables with the "frame",
+ * "ticks", "total" time and "top" zones.
+ * @luafunc frameStats
+ */
+static int naevL_frameStats( lua_State *L )
+{
+   FrameTimeStats total, zones[FRAME_ZONE_SENTINEL], allocs;
+   int            n = frametime_stats( &total, zones, &allocs );
+
+   lua_newtable( L );
+   lua_pushinteger( L, n );
+   lua_setfield( L, -2, "frames" );
+   naevL_pushFrameTimeStats( L, &total );
+   lua_setfield( L, -2, "total" );
+   lua_newtable( L );
+   for ( int z = 0; z < FRAME_ZONE_SENTINEL; z++ ) {
+      naevL_pushFrameTimeStats( L, &zones[z] );
+      lua_setfield( L, -2, frametime_zoneName( z ) );
+   }
+   lua_setfield( L, -2, "zones" );
+   naevL_pushFrameTimeStats( L, &allocs );
+   lua_setfield( L, -2, "allocs" );
+
+   lua_newtable( L );
+   for ( int i = 0; i < frametime_nhitches(); i++ ) {
+      const FrameHitch *h = frametime_hitch( i );
+      lua_newtable( L );
+      lua_pushinteger( L, h->frame );
+      lua_setfield( L, -2, "frame" );
+      lua_pushinteger( L, h->ticks );
+      lua_setfield( L, -2, "ticks" );
+      lua_pushnumber( L, h->total );
+      lua_setfield( L, -2, "total" );
+      lua_newtable( L );
+      for ( int k = 0; k < FRAMETIME_TOP; k++ ) {
+         lua_newtable( L );
+         lua_pushstring( L, frametime_zoneName( h->top[k] ) );
+         lua_setfield( L, -2, "zone" );
+         lua_pushnumber( L, h->topms[k] );
+         lua_setfield( L, -2, "ms" );
+         lua_rawseti( L, -2, k + 1 );
+      }
+      lua_setfield( L, -2, "top" );
+      lua_rawseti( L, -2, i + 1 );
+   }
+   lua_setfield( L, -2, "hitches" );
+   return 1;
+}
+
+/**
+ * @brief Dumps the recent frame times to the logs directory.
+ *
+ * @usage naev.frameDump( "json" )
+ *
+ *    @luatparam[opt="csv"] string format Either "csv" or "json".
+ *    @luatreturn string|nil Path the frame times were written to, relative to
+ * the write directory, or nil on failure.
+ * @luafunc frameDump
+ */
+static int naevL_frameDump( lua_State *L )
+{
+   const char *fmt  = luaL_optstring( L, 1, "csv" );
+   int         json = ( strcmp( fmt, "json" ) == 0 );
+   const char *path = json ? "logs/frametime.json" : "logs/frametime.csv";
+   if ( !json && ( strcmp( fmt, "csv" ) != 0 ) )
+      return NLUA_ERROR( L, _( "Unknown frame dump format '%s'!" ), fmt );
+   PHYSFS_mkdir( "logs" );
+   if ( frametime_dump( path, json ) )
+      return 0;
+   lua_pushstring( L, path );
+   return 1;
+}
+
+/**
+ * @brief Gets the Lua garbage collection statistics.
+ *
+ * Most of the collection is done in the idle time at the end of the frames,
+ * which is also recorded as the "gc" zone of naev.frameStats().
+ *
+ * @usage print( naev.gcStats().heap )
+ *
+ *    @luatreturn table Table with the current "heap" size, the "peak" heap
+ * size and the "live" heap size after the last cycle in kilobytes, the time
+ * spent collecting in the last "frame" and in "total" in milliseconds, and the
+ * number of "cycles" finished in idle time and "full" collections done.
+ * @luafunc gcStats
+ */
+static int naevL_gcStats( lua_State *L )
+{
+   LuaGCStats s;
+   nlua_gcStats( &s );
+   lua_newtable( L );
+   lua_pushnumber( L, s.heap );
+   lua_setfield( L, -2, "heap" );
+   lua_pushnumber( L, s.peak );
+   lua_setfield( L, -2, "peak" );
+   lua_pushnumber( L, s.live );
+   lua_setfield( L, -2, "live" );
+   lua_pushnumber( L, s.frame );
+   lua_setfield( L, -2, "frame" );
+   lua_pushnumber( L, s.total );
+   lua_setfield( L, -2, "total" );
+   lua_pushinteger( L, s.cycles );
+   lua_setfield( L, -2, "cycles" );
+   lua_pushinteger( L, s.full );
+   lua_setfield( L, -2, "full" );
+   return 1;
+}
+
+/**
+ * @brief Starts profiling the Lua code, clearing previous results.
+ *
+ * The Lua stack gets sampled every count instructions. LuaJIT compilation is
+ * disabled while profiling, so everything runs slower.
+ *
+ * @usage naev.profileStart() -- Weigh samples by time
+ * @usage naev.profileStart( "count", 100 ) -- Sample every 100 instructions
+ *
+ *    @luatparam[opt="time"] string mode Either "time" to weigh samples by the
+ * time since the previous one, or "count" to weigh them all the same.
+ *    @luatparam[opt=1000] number count Number of instructions between samples.
+ * @luafunc profileStart
+ */
+static int naevL_profileStart( lua_State *L )
+{
+   const char     *smode = luaL_optstring( L, 1, "time" );
+   int             count = luaL_optinteger( L, 2, 1000 );
+   LuaProfilerMode mode;
+   if ( strcmp( smode, "time" ) == 0 )
+      mode = LUA_PROFILER_TIME;
+   else if ( strcmp( smode, "count" ) == 0 )
+      mode = LUA_PROFILER_COUNT;
+   else
+      return NLUA_ERROR( L, _( "Unknown profiler mode '%s'!" ), smode );
+   nlua_profilerStart( mode, count );
+   return 0;
+}
+
+/**
+ * @brief Stops profiling the Lua code, see naev.profileDump to get the
+ * results.
+ *
+ * @luafunc profileStop
+ */
+static int naevL_profileStop( lua_State *L )
+{
+   (void)L;
+   nlua_profilerStop();
+   return 0;
+}
+
+/**
+ * @brief Dumps the results of profiling the Lua code to the logs directory.
+ *
+ * Writes the sampled stacks in the folded format used by flame graph tools,
+ * each starting with the environment they ran in (AI profile, mission, event,
+ * outfit, etc.). Also writes the time spent in each environment as CSV.
+ *
+ * @usage stacks, envs = naev.profileDump()
+ *
+ *    @luatreturn string|nil Path of the folded stacks, relative to the write
+ * directory, or nil on failure.
+ *    @luatreturn string Path of the environment times.
+ * @luafunc profileDump
+ */
+static int naevL_profileDump( lua_State *L )
+{
+   const char *stacks = "logs/luaprof.folded";
+   const char *envs   = "logs/luaprof.csv";
+   PHYSFS_mkdir( "logs" );
+   if ( nlua_profilerDump( stacks, envs ) )
+      return 0;
+   lua_pushstring( L, stacks );
+   lua_pushstring( L, envs );
+   return 2;
+}
+
 /**
  * @brief Gets a human-readable name for the key bound to a function.
  *
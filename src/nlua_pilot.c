@@ -114,7 +114,9 @@ static int pilotL_outfitToggle( lua_State *L );
 static int pilotL_outfitReady( lua_State *L );
 static int pilotL_rename( lua_State *L );
 static int pilotL_position( lua_State *L );
+static int pilotL_positionXY( lua_State *L );
 static int pilotL_velocity( lua_State *L );
+static int pilotL_velocityXY( lua_State *L );
 static int pilotL_isStopped( lua_State *L );
 static int pilotL_dir( lua_State *L );
 static int pilotL_signature( lua_State *L );
@@ -304,7 +306,9 @@ static const luaL_Reg pilotL_methods[] = {
    { "outfitReady", pilotL_outfitReady },
    { "rename", pilotL_rename },
    { "pos", pilotL_position },
+   { "posxy", pilotL_positionXY },
    { "vel", pilotL_velocity },
+   { "velxy", pilotL_velocityXY },
    { "isStopped", pilotL_isStopped },
    { "dir", pilotL_dir },
    { "signature", pilotL_signature },
@@ -496,6 +500,11 @@ static int pilotL_setFlagWrapper( lua_State *L, int flag )
    else
       pilot_rmFlag( p, flag );
 
+   /* Visibility changes who can sense the pilot. */
+   if ( ( flag == PILOT_HIDE ) || ( flag == PILOT_VISIBLE ) ||
+        ( flag == PILOT_VISPLAYER ) )
+      pilot_sensorInvalidate( flag == PILOT_HIDE );
+
    return 0;
 }
 
@@ -512,85 +521,6 @@ static int pilotL_setFlagWrapper( lua_State *L, int flag )
  *
  * @luamod pilot
  */
-/**
- * @brief Gets pilot at index.
- *
- *    @param L Lua state to get pilot from.
- *    @param ind Index position to find the pilot.
- *    @return Pilot found at the index in the state.
- */
-LuaPilot lua_topilot( lua_State *L, int ind )
-{
-   return *( (LuaPilot *)lua_touserdata( L, ind ) );
-}
-/**
- * @brief Gets pilot at index or raises error if there is no pilot at index.
- *
- *    @param L Lua state to get pilot from.
- *    @param ind Index position to find pilot.
- *    @return Pilot found at the index in the state.
- */
-LuaPilot luaL_checkpilot( lua_State *L, int ind )
-{
-   if ( lua_ispilot( L, ind ) )
-      return lua_topilot( L, ind );
-   luaL_typerror( L, ind, PILOT_METATABLE );
-   return 0;
-}
-/**
- * @brief Makes sure the pilot is valid or raises a Lua error.
- *
- *    @param L State currently running.
- *    @param ind Index of the pilot to validate.
- *    @return The pilot (doesn't return if fails - raises Lua error ).
- */
-Pilot *luaL_validpilot( lua_State *L, int ind )
-{
-   Pilot *p = pilot_get( luaL_checkpilot( L, ind ) );
-   if ( p == NULL ) {
-      NLUA_ERROR( L, _( "Pilot is invalid." ) );
-      return NULL;
-   }
-   return p;
-}
-/**
- * @brief Pushes a pilot on the stack.
- *
- *    @param L Lua state to push pilot into.
- *    @param pilot Pilot to push.
- *    @return Newly pushed pilot.
- */
-LuaPilot *lua_pushpilot( lua_State *L, LuaPilot pilot )
-{
-   LuaPilot *p = (LuaPilot *)lua_newuserdata( L, sizeof( LuaPilot ) );
-   *p          = pilot;
-   luaL_getmetatable( L, PILOT_METATABLE );
-   lua_setmetatable( L, -2 );
-   return p;
-}
-/**
- * @brief Checks to see if ind is a pilot.
- *
- *    @param L Lua state to check.
- *    @param ind Index position to check.
- *    @return 1 if ind is a pilot.
- */
-int lua_ispilot( lua_State *L, int ind )
-{
-   int ret;
-
-   if ( lua_getmetatable( L, ind ) == 0 )
-      return 0;
-   lua_getfield( L, LUA_REGISTRYINDEX, PILOT_METATABLE );
-
-   ret = 0;
-   if ( lua_rawequal( L, -1, -2 ) ) /* does it have the correct mt? */
-      ret = 1;
-
-   lua_pop( L, 2 ); /* remove both metatables */
-   return ret;
-}
-
 /**
  * @brief Returns a suitable jumpin spot for a given pilot.
  * @usage point = pilot.choosePoint( f, i, g )
@@ -1034,11 +964,11 @@ static int pilotL_getPilots( lua_State *L )
    if ( lua_istable( L, 1 ) || lua_isfaction( L, 1 ) ) {
       int *factions;
       if ( lua_isfaction( L, 1 ) ) {
-         factions = array_create( int );
+         factions = array_create_frame( int, 1 );
          array_push_back( &factions, lua_tofaction( L, 1 ) );
       } else {
          /* Get table length and preallocate. */
-         factions = array_create_size( int, lua_objlen( L, 1 ) );
+         factions = array_create_frame( int, lua_objlen( L, 1 ) );
          /* Load up the table. */
          lua_pushnil( L );
          while ( lua_next( L, 1 ) != 0 ) {
@@ -1062,9 +992,6 @@ static int pilotL_getPilots( lua_State *L )
             }
          }
       }
-
-      /* clean up. */
-      array_free( factions );
    } else if ( ( lua_isnil( L, 1 ) ) || ( lua_gettop( L ) == 0 ) ) {
       /* Now put all the matching pilots in a table. */
       lua_newtable( L );
@@ -1187,7 +1114,24 @@ static int pilotL_getFriendOrFoe( lua_State *L, int friend )
    pilot_stack = pilot_getAll();
    lua_newtable( L );
    k = 1;
-   if ( dist >= 0. && dist < INFINITY ) {
+   if ( ( p != NULL ) && inrange && ( v == &p->solid.pos ) &&
+        ( dist != 0. ) ) {
+      /* Only sensed pilots can match, and they are sorted by distance. */
+      int                n;
+      const PilotSensed *sensed = pilot_sensed( p, &n );
+      for ( int i = 0; i < n; i++ ) {
+         const Pilot *plt = sensed[i].p;
+
+         if ( ( dd >= 0. ) && ( sensed[i].dist2 > dd ) )
+            break;
+
+         if ( getFriendOrFoeTest( p, plt, friend, dd, inrange, dis, fighters, v,
+                                  lf ) ) {
+            lua_pushpilot( L, plt->id ); /* value */
+            lua_rawseti( L, -2, k++ );   /* table[key] = value */
+         }
+      }
+   } else if ( dist >= 0. && dist < INFINITY ) {
       int            x, y, r;
       const IntList *qt;
       x  = round( v->x );
@@ -1271,10 +1215,7 @@ static int pilotL_getEnemies( lua_State *L )
 }
 
 /**
- * @brief Gets visible pilots to a pilot.
- *
- * @note This function can not use quadtrees and is much slower than getEnemies,
- * getAllies, or getInrange.
+ * @brief Gets visible pilots to a pilot, nearest first.
  *
  *    @luatparam Pilot pilot Pilot to get visible pilots of.
  *    @luatparam[opt=false] boolean disabled Whether or not to count disabled
@@ -1287,28 +1228,26 @@ static int pilotL_getEnemies( lua_State *L )
  */
 static int pilotL_getVisible( lua_State *L )
 {
-   int           k;
-   const Pilot  *p   = luaL_validpilot( L, 1 );
-   int           dis = lua_toboolean( L, 2 );
-   Pilot *const *pilot_stack;
+   int                k, n;
+   const Pilot       *p   = luaL_validpilot( L, 1 );
+   int                dis = lua_toboolean( L, 2 );
+   const PilotSensed *sensed;
 
    /* Now put all the matching pilots in a table. */
-   pilot_stack = pilot_getAll();
+   sensed = pilot_sensed( p, &n );
    lua_newtable( L );
    k = 1;
-   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
-      /* Check if dead. */
-      if ( pilot_isFlag( pilot_stack[i], PILOT_DELETE ) )
-         continue;
+   for ( int i = 0; i < n; i++ ) {
+      const Pilot *plt = sensed[i].p;
       /* Check if disabled. */
-      if ( dis && pilot_isDisabled( pilot_stack[i] ) )
+      if ( dis && pilot_isDisabled( plt ) )
          continue;
-      /* Check visibilitiy. */
-      if ( !pilot_validTarget( p, pilot_stack[i] ) )
+      /* Check visibilitiy, range is already known. */
+      if ( !pilot_canTarget( plt ) )
          continue;
 
-      lua_pushpilot( L, pilot_stack[i]->id ); /* value */
-      lua_rawseti( L, -2, k++ );              /* table[key] = value */
+      lua_pushpilot( L, plt->id ); /* value */
+      lua_rawseti( L, -2, k++ );   /* table[key] = value */
    }
 
    return 1;
@@ -2840,6 +2779,27 @@ static int pilotL_position( lua_State *L )
    return 1;
 }
 
+/**
+ * @brief Gets the pilot's position as numbers.
+ *
+ * Unlike pos, this doesn't create a vector, so it is better suited for code
+ * that runs every frame.
+ *
+ * @usage x, y = p:posxy()
+ *
+ *    @luatparam Pilot p Pilot to get the position of.
+ *    @luatreturn number X coordinate of the pilot's current position.
+ *    @luatreturn number Y coordinate of the pilot's current position.
+ * @luafunc posxy
+ */
+static int pilotL_positionXY( lua_State *L )
+{
+   const Pilot *p = luaL_validpilot( L, 1 );
+   lua_pushnumber( L, p->solid.pos.x );
+   lua_pushnumber( L, p->solid.pos.y );
+   return 2;
+}
+
 /**
  * @brief Gets the pilot's velocity.
  *
@@ -2856,6 +2816,26 @@ static int pilotL_velocity( lua_State *L )
    return 1;
 }
 
+/**
+ * @brief Gets the pilot's velocity as numbers.
+ *
+ * Unlike vel, this doesn't create a vector.
+ *
+ * @usage vx, vy = p:velxy()
+ *
+ *    @luatparam Pilot p Pilot to get the velocity of.
+ *    @luatreturn number X component of the pilot's current velocity.
+ *    @luatreturn number Y component of the pilot's current velocity.
+ * @luafunc velxy
+ */
+static int pilotL_velocityXY( lua_State *L )
+{
+   const Pilot *p = luaL_validpilot( L, 1 );
+   lua_pushnumber( L, p->solid.vel.x );
+   lua_pushnumber( L, p->solid.vel.y );
+   return 2;
+}
+
 /**
  * @brief Checks to see if a pilot is stopped.
  *
@@ -4286,7 +4266,7 @@ static int pilotL_effectClear( lua_State *L )
    else
       effect_clearSpecific( &p->effects, !keepdebuffs, !keepbuffs,
                             !keepothers );
-   pilot_calcStats( p );
+   pilot_calcStatsLayer( p, PILOT_STATS_EFFECTS );
    return 0;
 }
 
@@ -4310,7 +4290,7 @@ static int pilotL_effectAdd( lua_State *L )
    const EffectData *efx        = effect_get( effectname );
    if ( efx != NULL ) {
       if ( !effect_add( &p->effects, efx, duration, scale, p->id ) )
-         pilot_calcStats( p );
+         pilot_calcStatsLayer( p, PILOT_STATS_EFFECTS );
       lua_pushboolean( L, 1 );
    } else
       lua_pushboolean( L, 0 );
@@ -4333,14 +4313,14 @@ static int pilotL_effectRm( lua_State *L )
    if ( lua_isnumber( L, 2 ) ) {
       int idx = lua_tointeger( L, 2 );
       if ( effect_rm( &p->effects, idx ) )
-         pilot_calcStats( p );
+         pilot_calcStatsLayer( p, PILOT_STATS_EFFECTS );
    } else {
       const char       *effectname = luaL_checkstring( L, 2 );
       int               all        = lua_toboolean( L, 3 );
       const EffectData *efx        = effect_get( effectname );
       if ( efx != NULL ) {
          if ( effect_rmType( &p->effects, efx, all ) )
-            pilot_calcStats( p );
+            pilot_calcStatsLayer( p, PILOT_STATS_EFFECTS );
       }
    }
    return 0;
@@ -10,6 +10,8 @@
 #include "pilot.h"
 
 #define PILOT_METATABLE "pilot" /**< Pilot metatable identifier. */
+#define PILOT_HANDLES                                                          \
+   "__pilot_handles" /**< Registry field of the interned pilot handles. */
 
 /* Helper. */
 #define luaL_optpilot( L, ind, def )                                           \
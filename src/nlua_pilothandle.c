@@ -0,0 +1,123 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file nlua_pilothandle.c
+ *
+ * @brief Handles the Lua pilot handles.
+ *
+ * Kept apart from the pilot bindings so that it can be linked on its own.
+ */
+/** @cond */
+#include <lauxlib.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "nlua_pilot.h"
+
+#include "nluadef.h"
+
+/**
+ * @brief Gets pilot at index.
+ *
+ *    @param L Lua state to get pilot from.
+ *    @param ind Index position to find the pilot.
+ *    @return Pilot found at the index in the state.
+ */
+LuaPilot lua_topilot( lua_State *L, int ind )
+{
+   return *( (LuaPilot *)lua_touserdata( L, ind ) );
+}
+/**
+ * @brief Gets pilot at index or raises error if there is no pilot at index.
+ *
+ *    @param L Lua state to get pilot from.
+ *    @param ind Index position to find pilot.
+ *    @return Pilot found at the index in the state.
+ */
+LuaPilot luaL_checkpilot( lua_State *L, int ind )
+{
+   if ( lua_ispilot( L, ind ) )
+      return lua_topilot( L, ind );
+   luaL_typerror( L, ind, PILOT_METATABLE );
+   return 0;
+}
+/**
+ * @brief Makes sure the pilot is valid or raises a Lua error.
+ *
+ *    @param L State currently running.
+ *    @param ind Index of the pilot to validate.
+ *    @return The pilot (doesn't return if fails - raises Lua error ).
+ */
+Pilot *luaL_validpilot( lua_State *L, int ind )
+{
+   Pilot *p = pilot_get( luaL_checkpilot( L, ind ) );
+   if ( p == NULL ) {
+      NLUA_ERROR( L, _( "Pilot is invalid." ) );
+      return NULL;
+   }
+   return p;
+}
+/**
+ * @brief Pushes a pilot on the stack.
+ *
+ *    @param L Lua state to push pilot into.
+ *    @param pilot Pilot to push.
+ *    @return Newly pushed pilot.
+ */
+LuaPilot *lua_pushpilot( lua_State *L, LuaPilot pilot )
+{
+   LuaPilot *p;
+
+   /* Handles are interned in a weak table, so pushing a pilot that is already
+    * referenced from Lua doesn't create garbage. */
+   lua_getfield( L, LUA_REGISTRYINDEX, PILOT_HANDLES ); /* t */
+   if ( lua_isnil( L, -1 ) ) {
+      lua_pop( L, 1 );                                     /* */
+      lua_newtable( L );                                   /* t */
+      lua_newtable( L );                                   /* t, mt */
+      lua_pushstring( L, "v" );                            /* t, mt, "v" */
+      lua_setfield( L, -2, "__mode" );                     /* t, mt */
+      lua_setmetatable( L, -2 );                           /* t */
+      lua_pushvalue( L, -1 );                              /* t, t */
+      lua_setfield( L, LUA_REGISTRYINDEX, PILOT_HANDLES ); /* t */
+   }
+   lua_rawgeti( L, -1, pilot ); /* t, u */
+   if ( !lua_isnil( L, -1 ) ) {
+      lua_remove( L, -2 ); /* u */
+      return (LuaPilot *)lua_touserdata( L, -1 );
+   }
+   lua_pop( L, 1 ); /* t */
+
+   p  = (LuaPilot *)lua_newuserdata( L, sizeof( LuaPilot ) ); /* t, u */
+   *p = pilot;
+   luaL_getmetatable( L, PILOT_METATABLE );
+   lua_setmetatable( L, -2 );
+   lua_pushvalue( L, -1 );      /* t, u, u */
+   lua_rawseti( L, -3, pilot ); /* t, u */
+   lua_remove( L, -2 );         /* u */
+   return p;
+}
+/**
+ * @brief Checks to see if ind is a pilot.
+ *
+ *    @param L Lua state to check.
+ *    @param ind Index position to check.
+ *    @return 1 if ind is a pilot.
+ */
+int lua_ispilot( lua_State *L, int ind )
+{
+   int ret;
+
+   if ( lua_getmetatable( L, ind ) == 0 )
+      return 0;
+   lua_getfield( L, LUA_REGISTRYINDEX, PILOT_METATABLE );
+
+   ret = 0;
+   if ( lua_rawequal( L, -1, -2 ) ) /* does it have the correct mt? */
+      ret = 1;
+
+   lua_pop( L, 2 ); /* remove both metatables */
+   return ret;
+}
@@ -0,0 +1,445 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file nlua_profiler.c
+ *
+ * @brief Sampling profiler for the Lua code.
+ *
+ * Uses a count hook to periodically sample the Lua stack, which gets stored
+ * as folded stacks that can be turned into flame graphs. Each stack starts
+ * with the name of the environment it ran in, such as the AI profile or the
+ * mission. Furthermore, the time spent in each environment is measured
+ * exactly when calling into it with nlua_pcall().
+ *
+ * Hooks are not run by code compiled by LuaJIT, so the JIT compiler is turned
+ * off while profiling to sample everything the same way as with PUC Lua.
+ */
+/** @cond */
+#include "physfs.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#if HAVE_LUAJIT
+#include <luajit.h>
+#endif /* HAVE_LUAJIT */
+
+#include "naev.h"
+/** @endcond */
+
+#include "nlua_profiler.h"
+
+#include "array.h"
+#include "log.h"
+#include "nstring.h"
+
+#define PROFILER_DEPTH 64       /**< Maximum stack depth sampled. */
+#define PROFILER_NEST 128       /**< Maximum environment nesting tracked. */
+#define PROFILER_STACKS_MIN 256 /**< Initial size of the stack table. */
+
+/**
+ * @brief Time spent in an environment.
+ */
+typedef struct ProfilerEnv_ {
+   char  *name;  /**< Name of the environment. */
+   double self;  /**< Time spent in the environment itself, in seconds. */
+   double total; /**< Time including other environments it called into. */
+   int    calls; /**< Number of calls into the environment. */
+} ProfilerEnv;
+
+/**
+ * @brief A sampled stack.
+ */
+typedef struct ProfilerStack_ {
+   uint64_t hash;   /**< Hash of the stack, 0 if the slot is empty. */
+   char    *stack;  /**< Folded stack. */
+   double   weight; /**< Accumulated weight. */
+} ProfilerStack;
+
+/**
+ * @brief Call into an environment being measured.
+ */
+typedef struct ProfilerCall_ {
+   int    slot;  /**< Environment slot. */
+   Uint64 start; /**< Counter when the call started. */
+   double child; /**< Time spent in nested calls. */
+} ProfilerCall;
+
+static int             prof_active = 0; /**< Whether profiling. */
+static LuaProfilerMode prof_mode;       /**< How samples are weighed. */
+static Uint64          prof_last; /**< Counter at the last sample or call. */
+static ProfilerEnv    *prof_envs = NULL; /**< Array (array.h): Environments. */
+static int *prof_slots = NULL; /**< Array (array.h): Slot of each env ref. */
+static ProfilerStack *prof_stacks  = NULL; /**< Hash table of stacks. */
+static int            prof_nstacks = 0;    /**< Size of the hash table. */
+static int            prof_nused   = 0;    /**< Used slots in the table. */
+static ProfilerCall   prof_calls[PROFILER_NEST]; /**< Calls being measured. */
+static int            prof_depth = 0; /**< Depth of nested calls. */
+
+/**
+ * @brief Converts a counter difference to seconds.
+ */
+static double prof_seconds( Uint64 dt )
+{
+   return (double)dt / (double)SDL_GetPerformanceFrequency();
+}
+
+/**
+ * @brief Gets the slot of an environment, creating it if necessary.
+ */
+static int prof_envSlot( nlua_env env )
+{
+   ProfilerEnv *pe;
+   const char  *name;
+
+   if ( env < 0 )
+      return -1;
+   if ( prof_slots == NULL ) {
+      prof_slots = array_create( int );
+      prof_envs  = array_create( ProfilerEnv );
+   }
+   while ( array_size( prof_slots ) <= env )
+      array_push_back( &prof_slots, -1 );
+   if ( prof_slots[env] >= 0 )
+      return prof_slots[env];
+
+   /* The name is kept in the metatable of the environment. */
+   nlua_pushenv( naevL, env );
+   if ( !lua_getmetatable( naevL, -1 ) )
+      lua_pushnil( naevL );
+   else {
+      lua_pushstring( naevL, "__name" );
+      lua_rawget( naevL, -2 );
+      lua_remove( naevL, -2 );
+   }
+   name = lua_tostring( naevL, -1 );
+
+   pe        = &array_grow( &prof_envs );
+   pe->name  = strdup( ( name != NULL ) ? name : "?" );
+   pe->self  = 0.;
+   pe->total = 0.;
+   pe->calls = 0;
+   lua_pop( naevL, 2 );
+
+   prof_slots[env] = array_size( prof_envs ) - 1;
+   return prof_slots[env];
+}
+
+/**
+ * @brief FNV-1a hash of a string.
+ */
+static uint64_t prof_hash( const char *s )
+{
+   uint64_t h = 14695981039346656037ULL;
+   for ( ; *s != '\0'; s++ ) {
+      h ^= (unsigned char)*s;
+      h *= 1099511628211ULL;
+   }
+   return ( h == 0 ) ? 1 : h;
+}
+
+/**
+ * @brief Finds the slot of a stack in the hash table.
+ */
+static ProfilerStack *prof_stackFind( ProfilerStack *table, int n,
+                                      uint64_t hash, const char *stack )
+{
+   int i = hash % n;
+   while ( ( table[i].hash != 0 ) &&
+           ( ( table[i].hash != hash ) ||
+             ( ( stack != NULL ) && ( strcmp( table[i].stack, stack ) ) ) ) )
+      i = ( i + 1 ) % n;
+   return &table[i];
+}
+
+/**
+ * @brief Adds weight to a stack.
+ */
+static void prof_stackAdd( const char *stack, double weight )
+{
+   uint64_t       hash = prof_hash( stack );
+   ProfilerStack *ps;
+
+   /* Keep the table at most half full. */
+   if ( 2 * ( prof_nused + 1 ) > prof_nstacks ) {
+      int            n     = MAX( PROFILER_STACKS_MIN, 2 * prof_nstacks );
+      ProfilerStack *table = calloc( n, sizeof( ProfilerStack ) );
+      for ( int i = 0; i < prof_nstacks; i++ ) {
+         if ( prof_stacks[i].hash == 0 )
+            continue;
+         *prof_stackFind( table, n, prof_stacks[i].hash, NULL ) =
+            prof_stacks[i];
+      }
+      free( prof_stacks );
+      prof_stacks  = table;
+      prof_nstacks = n;
+   }
+
+   ps = prof_stackFind( prof_stacks, prof_nstacks, hash, stack );
+   if ( ps->hash == 0 ) {
+      ps->hash  = hash;
+      ps->stack = strdup( stack );
+      prof_nused++;
+   }
+   ps->weight += weight;
+}
+
+/**
+ * @brief Samples the Lua stack.
+ */
+static void prof_hook( lua_State *L, lua_Debug *ar )
+{
+   lua_Debug   frames[PROFILER_DEPTH];
+   char        buf[STRMAX];
+   int         n, l;
+   double      weight;
+   Uint64      t     = SDL_GetPerformanceCounter();
+   int         depth = MIN( prof_depth, PROFILER_NEST );
+   int         slot  = ( depth > 0 ) ? prof_calls[depth - 1].slot : -1;
+   const char *env   = ( slot >= 0 ) ? prof_envs[slot].name : "?";
+   (void)ar;
+
+   if ( prof_mode == LUA_PROFILER_TIME )
+      weight = prof_seconds( t - prof_last ) * 1e6;
+   else
+      weight = 1.;
+   prof_last = t;
+
+   /* Walk the stack from the top. */
+   for ( n = 0; n < PROFILER_DEPTH; n++ ) {
+      if ( !lua_getstack( L, n, &frames[n] ) )
+         break;
+      lua_getinfo( L, "Sn", &frames[n] );
+   }
+
+   /* Folded stacks go from the root. */
+   l = scnprintf( buf, sizeof( buf ), "%s", env );
+   for ( int i = n - 1; i >= 0; i-- ) {
+      const lua_Debug *f    = &frames[i];
+      const char      *name = ( f->name != NULL ) ? f->name : "?";
+      if ( strcmp( f->what, "C" ) == 0 )
+         l += scnprintf( &buf[l], sizeof( buf ) - l, ";%s [C]", name );
+      else
+         l += scnprintf( &buf[l], sizeof( buf ) - l, ";%s (%s:%d)", name,
+                         f->short_src, f->linedefined );
+   }
+   prof_stackAdd( buf, weight );
+}
+
+/**
+ * @brief Starts profiling the Lua code, clearing previous results.
+ *
+ *    @param mode How to weigh the samples.
+ *    @param count Number of Lua instructions between samples.
+ *    @return 0 on success.
+ */
+int nlua_profilerStart( LuaProfilerMode mode, int count )
+{
+   if ( prof_active )
+      nlua_profilerStop();
+   nlua_profilerFree();
+
+   prof_mode   = mode;
+   prof_active = 1;
+   prof_depth  = 0;
+   prof_last   = SDL_GetPerformanceCounter();
+#if HAVE_LUAJIT
+   luaJIT_setmode( naevL, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF );
+#endif /* HAVE_LUAJIT */
+   lua_sethook( naevL, prof_hook, LUA_MASKCOUNT, MAX( 1, count ) );
+   return 0;
+}
+
+/**
+ * @brief Stops profiling the Lua code, keeping the results.
+ */
+void nlua_profilerStop( void )
+{
+   if ( !prof_active )
+      return;
+   lua_sethook( naevL, NULL, 0, 0 );
+#if HAVE_LUAJIT
+   luaJIT_setmode( naevL, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_ON );
+#endif /* HAVE_LUAJIT */
+   prof_active = 0;
+}
+
+/**
+ * @brief Checks to see if the Lua code is being profiled.
+ */
+int nlua_profilerActive( void )
+{
+   return prof_active;
+}
+
+/**
+ * @brief Starts measuring a call into an environment.
+ */
+void nlua_profilerEnter( nlua_env env )
+{
+   if ( !prof_active )
+      return;
+   if ( prof_depth < PROFILER_NEST ) {
+      ProfilerCall *pc = &prof_calls[prof_depth];
+      pc->slot         = prof_envSlot( env );
+      pc->start        = SDL_GetPerformanceCounter();
+      pc->child        = 0.;
+      prof_last        = pc->start;
+   }
+   prof_depth++;
+}
+
+/**
+ * @brief Stops measuring the last call into an environment.
+ */
+void nlua_profilerLeave( void )
+{
+   const ProfilerCall *pc;
+   double              dt;
+
+   /* Calls may be unbalanced if profiling started in the middle of one. */
+   if ( prof_depth <= 0 )
+      return;
+   prof_depth--;
+   if ( !prof_active || ( prof_depth >= PROFILER_NEST ) )
+      return;
+
+   pc        = &prof_calls[prof_depth];
+   prof_last = SDL_GetPerformanceCounter();
+   dt        = prof_seconds( prof_last - pc->start );
+   if ( ( pc->slot >= 0 ) && ( pc->slot < array_size( prof_envs ) ) ) {
+      ProfilerEnv *pe = &prof_envs[pc->slot];
+      pe->self += dt - pc->child;
+      pe->total += dt;
+      pe->calls++;
+   }
+   if ( prof_depth > 0 )
+      prof_calls[prof_depth - 1].child += dt;
+}
+
+/**
+ * @brief Forgets an environment that is being freed, as its reference may be
+ * reused by another one.
+ */
+void nlua_profilerForget( nlua_env env )
+{
+   if ( ( env >= 0 ) && ( env < array_size( prof_slots ) ) )
+      prof_slots[env] = -1;
+}
+
+/**
+ * @brief Compares environments by name for qsort.
+ */
+static int prof_envCmp( const void *p1, const void *p2 )
+{
+   const ProfilerEnv *e1 = p1;
+   const ProfilerEnv *e2 = p2;
+   return strcmp( e1->name, e2->name );
+}
+
+/**
+ * @brief Compares environments by self time for qsort.
+ */
+static int prof_envCmpSelf( const void *p1, const void *p2 )
+{
+   const ProfilerEnv *e1 = p1;
+   const ProfilerEnv *e2 = p2;
+   return ( e1->self < e2->self ) - ( e1->self > e2->self );
+}
+
+/**
+ * @brief Writes a formatted string to a PhysicsFS file.
+ */
+PRINTF_FORMAT( 2, 3 )
+static void prof_write( PHYSFS_File *f, const char *fmt, ... )
+{
+   char    buf[STRMAX];
+   va_list ap;
+   int     n;
+
+   va_start( ap, fmt );
+   n = vsnprintf( buf, sizeof( buf ), fmt, ap );
+   va_end( ap );
+   PHYSFS_writeBytes( f, buf, MIN( n, (int)sizeof( buf ) - 1 ) );
+}
+
+/**
+ * @brief Dumps the profiling results.
+ *
+ * Environments with the same name, such as different instances of a mission,
+ * get merged.
+ *
+ *    @param stacks Path to write the folded stacks to, relative to the write
+ * directory. Weights are in microseconds or number of samples depending on the
+ * mode.
+ *    @param envs Path to write the time of each environment to as CSV.
+ *    @return 0 on success.
+ */
+int nlua_profilerDump( const char *stacks, const char *envs )
+{
+   PHYSFS_File *f;
+   ProfilerEnv *merged;
+
+   f = PHYSFS_openWrite( stacks );
+   if ( f == NULL ) {
+      WARN( _( "Unable to open '%s' for writing: %s" ), stacks,
+            _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+      return -1;
+   }
+   for ( int i = 0; i < prof_nstacks; i++ ) {
+      const ProfilerStack *ps = &prof_stacks[i];
+      if ( ps->hash != 0 )
+         prof_write( f, "%s %.0f\n", ps->stack, MAX( 1., ps->weight ) );
+   }
+   PHYSFS_close( f );
+
+   f = PHYSFS_openWrite( envs );
+   if ( f == NULL ) {
+      WARN( _( "Unable to open '%s' for writing: %s" ), envs,
+            _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+      return -1;
+   }
+   merged = array_create_size( ProfilerEnv, array_size( prof_envs ) );
+   if ( array_size( prof_envs ) > 0 ) {
+      ProfilerEnv *sorted = array_copy( ProfilerEnv, prof_envs );
+      qsort( sorted, array_size( sorted ), sizeof( ProfilerEnv ), prof_envCmp );
+      for ( int i = 0; i < array_size( sorted ); i++ ) {
+         if ( ( array_size( merged ) > 0 ) &&
+              ( strcmp( array_back( merged ).name, sorted[i].name ) == 0 ) ) {
+            ProfilerEnv *pe = &array_back( merged );
+            pe->self += sorted[i].self;
+            pe->total += sorted[i].total;
+            pe->calls += sorted[i].calls;
+         } else
+            array_push_back( &merged, sorted[i] );
+      }
+      array_free( sorted );
+      qsort( merged, array_size( merged ), sizeof( ProfilerEnv ),
+             prof_envCmpSelf );
+   }
+   prof_write( f, "env,calls,self_ms,total_ms\n" );
+   for ( int i = 0; i < array_size( merged ); i++ )
+      prof_write( f, "\"%s\",%d,%.3f,%.3f\n", merged[i].name, merged[i].calls,
+                  merged[i].self * 1e3, merged[i].total * 1e3 );
+   array_free( merged );
+   PHYSFS_close( f );
+   return 0;
+}
+
+/**
+ * @brief Frees the profiling results.
+ */
+void nlua_profilerFree( void )
+{
+   for ( int i = 0; i < array_size( prof_envs ); i++ )
+      free( prof_envs[i].name );
+   array_free( prof_envs );
+   prof_envs = NULL;
+   array_free( prof_slots );
+   prof_slots = NULL;
+   for ( int i = 0; i < prof_nstacks; i++ )
+      free( prof_stacks[i].stack );
+   free( prof_stacks );
+   prof_stacks  = NULL;
+   prof_nstacks = 0;
+   prof_nused   = 0;
+}
@@ -0,0 +1,25 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+#include "nlua.h"
+
+/**
+ * @brief How the Lua profiler weighs its samples.
+ */
+typedef enum LuaProfilerMode_ {
+   LUA_PROFILER_TIME,  /**< Samples weigh the time since the previous one. */
+   LUA_PROFILER_COUNT, /**< Samples weigh the same. */
+} LuaProfilerMode;
+
+int  nlua_profilerStart( LuaProfilerMode mode, int count );
+void nlua_profilerStop( void );
+int  nlua_profilerActive( void );
+int  nlua_profilerDump( const char *stacks, const char *envs );
+void nlua_profilerFree( void );
+
+/* Called by nlua. */
+void nlua_profilerEnter( nlua_env env );
+void nlua_profilerLeave( void );
+void nlua_profilerForget( nlua_env env );
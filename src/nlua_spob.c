@@ -261,10 +261,9 @@ static int spobL_getBackend( lua_State *L, int system, int landable )
    }
    /* Get a spob by faction */
    else if ( lua_isfaction( L, 1 ) ) {
-      int *factions = array_create( int );
+      int *factions = array_create_frame( int, 1 );
       array_push_back( &factions, lua_tofaction( L, 1 ) );
       spobs = space_getFactionSpob( factions, landable );
-      array_free( factions );
    }
    /* Get a spob by name */
    else if ( lua_isstring( L, 1 ) ) {
@@ -285,7 +284,7 @@ static int spobL_getBackend( lua_State *L, int system, int landable )
    /* Get a spob from faction list */
    else if ( lua_istable( L, 1 ) ) {
       /* Get table length and preallocate. */
-      int *factions = array_create_size( int, lua_objlen( L, 1 ) );
+      int *factions = array_create_frame( int, lua_objlen( L, 1 ) );
       /* Load up the table. */
       lua_pushnil( L );
       while ( lua_next( L, -2 ) != 0 ) {
@@ -296,7 +295,6 @@ static int spobL_getBackend( lua_State *L, int system, int landable )
 
       /* get the spobs */
       spobs = space_getFactionSpob( factions, landable );
-      array_free( factions );
    }
    /* Just get a spob. */
    else if ( lua_isspob( L, 1 ) ) {
@@ -271,7 +271,8 @@ static int vectorL_tostring( lua_State *L )
  * @brief Adds two vectors or a vector and some cartesian coordinates.
  *
  * If x is a vector it adds both vectors, otherwise it adds cartesian
- * coordinates to the vector.
+ * coordinates to the vector. The method form modifies the vector in place and
+ * returns it, which avoids creating garbage in hot code.
  *
  * @usage my_vec = my_vec + your_vec
  * @usage my_vec:add( your_vec )
@@ -336,9 +337,9 @@ static int vectorL_add__( lua_State *L )
          y = x;
    }
 
-   /* Actually add it */
+   /* Actually add it, in place so no new vector is made. */
    vec2_cset( v1, v1->x + x, v1->y + y );
-   lua_pushvector( L, *v1 );
+   lua_pushvalue( L, 1 );
 
    return 1;
 }
@@ -347,7 +348,8 @@ static int vectorL_add__( lua_State *L )
  * @brief Subtracts two vectors or a vector and some cartesian coordinates.
  *
  * If x is a vector it subtracts both vectors, otherwise it subtracts cartesian
- * coordinates to the vector.
+ * coordinates to the vector. The method form modifies the vector in place and
+ * returns it.
  *
  * @usage my_vec = my_vec - your_vec
  * @usage my_vec:sub( your_vec )
@@ -407,15 +409,17 @@ static int vectorL_sub__( lua_State *L )
          y = x;
    }
 
-   /* Actually add it */
+   /* Actually subtract it, in place so no new vector is made. */
    vec2_cset( v1, v1->x - x, v1->y - y );
-   lua_pushvector( L, *v1 );
+   lua_pushvalue( L, 1 );
    return 1;
 }
 
 /**
  * @brief Multiplies a vector by a number.
  *
+ * The method form modifies the vector in place and returns it.
+ *
  * @usage my_vec = my_vec * 3
  * @usage my_vec:mul( 3 )
  *
@@ -459,14 +463,16 @@ static int vectorL_mul__( lua_State *L )
       vec2_cset( v1, v1->x * v2->x, v1->y * v2->y );
    }
 
-   /* Actually add it */
-   lua_pushvector( L, *v1 );
+   /* Modified in place so no new vector is made. */
+   lua_pushvalue( L, 1 );
    return 1;
 }
 
 /**
  * @brief Divides a vector by a number.
  *
+ * The method form modifies the vector in place and returns it.
+ *
  * @usage my_vec = my_vec / 3
  * @usage my_vec:div(3)
  *
@@ -501,7 +507,8 @@ static int vectorL_div__( lua_State *L )
       vec2_cset( v1, v1->x / v2->x, v1->y / v2->y );
    }
 
-   lua_pushvector( L, *v1 );
+   /* Modified in place so no new vector is made. */
+   lua_pushvalue( L, 1 );
    return 1;
 }
 static int vectorL_unm( lua_State *L )
@@ -720,10 +727,10 @@ static int vectorL_angle( lua_State *L )
 }
 
 /**
- * @brief Normalizes a vector.
+ * @brief Normalizes a vector in place.
  *    @luatparam Vec2 v Vector to normalize.
  *    @luatparam[opt=1] number n Length to normalize the vector to.
- *    @luatreturn Vec2 Normalized vector.
+ *    @luatreturn Vec2 The same vector, now normalized.
  * @luafunc normalize
  */
 static int vectorL_normalize( lua_State *L )
@@ -733,7 +740,7 @@ static int vectorL_normalize( lua_State *L )
    double m = n / MAX( VMOD( *v ), DOUBLE_TOL );
    v->x *= m;
    v->y *= m;
-   lua_pushvector( L, *v );
+   lua_pushvalue( L, 1 );
    return 1;
 }
 
@@ -0,0 +1,22 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file ntracing.c
+ *
+ * @brief Allocation counting, always available unlike the Tracy tracing.
+ */
+#include "ntracing.h"
+
+SDL_atomic_t ntracing_nallocs = { 0 }; /**< Number of heap allocations. */
+
+/**
+ * @brief Gets the number of heap allocations done through nmalloc, ncalloc
+ * and nrealloc since start up.
+ *
+ * Only differences are meaningful, as the counter can wrap around.
+ */
+int ntracing_allocs( void )
+{
+   return SDL_AtomicGet( &ntracing_nallocs );
+}
@@ -3,6 +3,15 @@
  */
 #pragma once
 
+/** @cond */
+#include "SDL_atomic.h"
+/** @endcond */
+
+/* Heap allocations done through nmalloc, ncalloc and nrealloc. */
+extern SDL_atomic_t ntracing_nallocs;
+#define NTracingCountAlloc() SDL_AtomicAdd( &ntracing_nallocs, 1 )
+int ntracing_allocs( void );
+
 #if HAVE_TRACY
 #include "attributes.h"
 #include "tracy/TracyC.h"
@@ -27,6 +36,7 @@
    } while ( 0 )
 ALWAYS_INLINE static inline void *nmalloc( size_t size )
 {
+   NTracingCountAlloc();
    void *ptr = malloc( size );
    NTracingAlloc( ptr, size );
    return ptr;
@@ -38,12 +48,14 @@ ALWAYS_INLINE static inline void nfree( void *ptr )
 }
 ALWAYS_INLINE static inline void *ncalloc( size_t nmemb, size_t size )
 {
+   NTracingCountAlloc();
    void *ptr = calloc( nmemb, size );
    NTracingAlloc( ptr, nmemb * size );
    return ptr;
 }
 ALWAYS_INLINE static inline void *nrealloc( void *ptr, size_t size )
 {
+   NTracingCountAlloc();
    NTracingFree( ptr );
    void *newptr = realloc( ptr, size );
    NTracingAlloc( newptr, size );
@@ -63,10 +75,10 @@ ALWAYS_INLINE static inline void *nrealloc( void *ptr, size_t size )
 #define NTracingZoneEnd( ctx )
 #define NTracingAlloc( ptr, size )
 #define NTracingFree( ptr )
-#define nmalloc( size ) malloc( size )
-#define ncalloc( nmemb, size ) calloc( nmemb, size )
+#define nmalloc( size ) ( NTracingCountAlloc(), malloc( size ) )
+#define ncalloc( nmemb, size ) ( NTracingCountAlloc(), calloc( nmemb, size ) )
 #define nfree( ptr ) free( ptr )
-#define nrealloc( ptr, size ) realloc( ptr, size )
+#define nrealloc( ptr, size ) ( NTracingCountAlloc(), realloc( ptr, size ) )
 #define NTracingMessageL( msg )
 #define NTracingPlot( name, val )
 #define NTracingPlotF( name, val )
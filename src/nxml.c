@@ -68,29 +68,219 @@ void xmlw_setParams( xmlTextWriterPtr writer )
  */
 xmlDocPtr xml_parsePhysFS( const char *filename )
 {
-   char     *buf;
-   size_t    bufsize;
-   xmlDocPtr doc;
+   const char *buf;
+   size_t      bufsize;
+   xmlDocPtr   doc;
 
    /* @TODO: Don't slurp?
-    * Can we directly create an InputStream backed by PHYSFS_*, or use SAX? */
-   buf = ndata_read( filename, &bufsize );
+    * Can we directly create an InputStream backed by PHYSFS_*, or use SAX?
+    * Packed ndata is at least parsed straight from memory without copying. */
+   buf = ndata_view( filename, &bufsize );
    if ( buf == NULL ) {
       WARN( _( "Unable to read data from '%s'" ), filename );
       return NULL;
    }
    /* Empty file, we ignore these. */
    if ( bufsize == 0 ) {
-      free( buf );
+      ndata_unview( buf );
       return NULL;
    }
    doc = xmlParseMemory( buf, bufsize );
    if ( doc == NULL )
       WARN( _( "Unable to parse document '%s'" ), filename );
-   free( buf );
+   ndata_unview( buf );
    return doc;
 }
 
+/**
+ * @brief Data a stream reader is reading from.
+ */
+typedef struct XmlReaderInput_ {
+   const char *buf; /**< File data from ndata_view(). */
+   size_t      len; /**< Length of the file data. */
+   size_t      pos; /**< Current reading position. */
+} XmlReaderInput;
+
+/**
+ * @brief Feeds file data to a stream reader.
+ */
+static int xml_readerRead( void *ctx, char *buffer, int len )
+{
+   XmlReaderInput *in = ctx;
+   size_t          n  = in->len - in->pos;
+   if ( n > (size_t)len )
+      n = len;
+   memcpy( buffer, &in->buf[in->pos], n );
+   in->pos += n;
+   return n;
+}
+
+/**
+ * @brief Releases the file data of a stream reader.
+ */
+static int xml_readerClose( void *ctx )
+{
+   XmlReaderInput *in = ctx;
+   ndata_unview( in->buf );
+   free( in );
+   return 0;
+}
+
+/**
+ * @brief Opens a file for streaming reading, analogous to xml_parsePhysFS().
+ *
+ * Unlike parsing into a document, no tree is built for the file as a whole:
+ * the reader is walked with xml_readerRoot() and xml_readerNextChild(), and
+ * elements that are easier to handle as a tree can be expanded one at a time
+ * with xmlTextReaderExpand(). Expanded nodes are only valid until the reader
+ * moves past them.
+ *
+ *    @param filename PhysFS file name.
+ *    @return reader (must xmlFreeTextReader) on success, NULL on failure (will
+ *            warn user).
+ */
+xmlTextReaderPtr xml_readerPhysFS( const char *filename )
+{
+   const char      *buf;
+   size_t           bufsize;
+   XmlReaderInput  *in;
+   xmlTextReaderPtr reader;
+
+   buf = ndata_view( filename, &bufsize );
+   if ( buf == NULL ) {
+      WARN( _( "Unable to read data from '%s'" ), filename );
+      return NULL;
+   }
+   /* Empty file, we ignore these. */
+   if ( bufsize == 0 ) {
+      ndata_unview( buf );
+      return NULL;
+   }
+   in      = malloc( sizeof( XmlReaderInput ) );
+   in->buf = buf;
+   in->len = bufsize;
+   in->pos = 0;
+   /* The close callback is run on failure too. */
+   reader = xmlReaderForIO( xml_readerRead, xml_readerClose, in, filename,
+                            NULL, 0 );
+   if ( reader == NULL )
+      WARN( _( "Unable to parse document '%s'" ), filename );
+   return reader;
+}
+
+/**
+ * @brief Moves a stream reader to the root element.
+ *
+ *    @param reader Reader to move.
+ *    @param name Name the root element must have, or NULL for any.
+ *    @return 0 if the reader is on a matching root element.
+ */
+int xml_readerRoot( xmlTextReaderPtr reader, const char *name )
+{
+   while ( xmlTextReaderRead( reader ) == 1 ) {
+      if ( xmlTextReaderNodeType( reader ) != XML_READER_TYPE_ELEMENT )
+         continue;
+      if ( ( name == NULL ) || xmls_isNode( reader, name ) )
+         return 0;
+      return -1;
+   }
+   return -1;
+}
+
+/**
+ * @brief Moves a stream reader to the next child element of an element.
+ *
+ * Call it first with the reader on the parent, and then with the reader on
+ * the previous child, or on the closing tag of the previous child if the
+ * caller went inside it. Whatever is left of the previous child is skipped
+ * without being built.
+ *
+ * @code
+ * int depth = xmlTextReaderDepth( reader );
+ * while ( xml_readerNextChild( reader, depth ) > 0 ) {
+ *    xmls_strd( reader, "name", name );
+ *    ...
+ * }
+ * @endcode
+ *
+ *    @param reader Reader to move.
+ *    @param depth Depth of the parent element.
+ *    @return 1 if the reader is on the next child, 0 if there are no more
+ *            children and -1 on error, in which case the document is
+ *            malformed and the caller should not trust what was read.
+ */
+int xml_readerNextChild( xmlTextReaderPtr reader, int depth )
+{
+   int ret;
+
+   /* Keep failing once an error was found, even in the callers of nested
+    * loops. */
+   if ( xmlTextReaderReadState( reader ) == XML_TEXTREADER_MODE_ERROR )
+      return -1;
+
+   if ( xmlTextReaderDepth( reader ) == depth ) {
+      /* On the parent, go inside unless it has no children or was already
+       * left. */
+      if ( ( xmlTextReaderNodeType( reader ) != XML_READER_TYPE_ELEMENT ) ||
+           xmlTextReaderIsEmptyElement( reader ) )
+         return 0;
+      ret = xmlTextReaderRead( reader );
+   } else
+      ret = xmlTextReaderNext( reader );
+
+   while ( ret == 1 ) {
+      int d = xmlTextReaderDepth( reader );
+      if ( d <= depth )
+         return 0;
+      if ( ( d == depth + 1 ) &&
+           ( xmlTextReaderNodeType( reader ) == XML_READER_TYPE_ELEMENT ) )
+         return 1;
+      ret = xmlTextReaderNext( reader );
+   }
+   return ( ret < 0 ) ? -1 : 0;
+}
+
+/**
+ * @brief Gets the text of the element a stream reader is on.
+ *
+ *    @param reader Reader to get text from.
+ *    @return Newly allocated text or NULL if the element is empty.
+ */
+char *xmls_getStrd( xmlTextReaderPtr reader )
+{
+   char *str;
+   if ( xmlTextReaderIsEmptyElement( reader ) )
+      return NULL;
+   str = nxml_trace_strdup( xmlTextReaderReadString( reader ) );
+   if ( ( str != NULL ) && ( str[0] == '\0' ) ) {
+      free( str );
+      return NULL;
+   }
+   return str;
+}
+
+/**
+ * @brief Gets the text of the element a stream reader is on as an integer.
+ */
+int xmls_getInt( xmlTextReaderPtr reader )
+{
+   char *str = xmls_getStrd( reader );
+   int   i   = ( str == NULL ) ? 0 : strtol( str, NULL, 10 );
+   free( str );
+   return i;
+}
+
+/**
+ * @brief Gets the text of the element a stream reader is on as a float.
+ */
+double xmls_getFloat( xmlTextReaderPtr reader )
+{
+   char  *str = xmls_getStrd( reader );
+   double f   = ( str == NULL ) ? 0. : strtod( str, NULL );
+   free( str );
+   return f;
+}
+
 int xmlw_saveTime( xmlTextWriterPtr writer, const char *name, time_t t )
 {
    xmlw_elem( writer, name, "%lu", t );
@@ -18,6 +18,7 @@
 #endif
 
 #include "libxml/parser.h"
+#include "libxml/xmlreader.h"
 #include "libxml/xmlwriter.h"
 /** @endcond */
 
@@ -188,6 +189,57 @@ static inline char *nxml_trace_strdup( void *ptr )
 #define xmlr_attr_ulong_opt( n, s, a ) xmlr_attr_ulong_def( n, s, a, a )
 #define xmlr_attr_float_opt( n, s, a ) xmlr_attr_float_def( n, s, a, a )
 
+/*
+ * stream reader crap, see xml_readerPhysFS()
+ */
+/* checks to see if the reader is on an element of name s */
+#define xmls_isNode( r, s )                                                    \
+   ( ( xmlTextReaderNodeType( r ) == XML_READER_TYPE_ELEMENT ) &&              \
+     ( strcmp( (const char *)xmlTextReaderConstName( r ), s ) == 0 ) )
+#define xmls_int( r, s, i )                                                    \
+   {                                                                           \
+      if ( xmls_isNode( r, s ) ) {                                             \
+         i = xmls_getInt( r );                                                 \
+         continue;                                                             \
+      }                                                                        \
+   }
+#define xmls_float( r, s, f )                                                  \
+   {                                                                           \
+      if ( xmls_isNode( r, s ) ) {                                             \
+         f = xmls_getFloat( r );                                               \
+         continue;                                                             \
+      }                                                                        \
+   }
+#define xmls_strd( r, s, str )                                                 \
+   {                                                                           \
+      if ( xmls_isNode( r, s ) ) {                                             \
+         if ( str != NULL ) {                                                  \
+            WARN( "Node '%s' already loaded and being replaced from '%s'", s,  \
+                  str );                                                       \
+            free( str );                                                       \
+         }                                                                     \
+         str = xmls_getStrd( r );                                              \
+         continue;                                                             \
+      }                                                                        \
+   }
+/* Attribute reader (allocates memory). */
+#define xmls_attr_strd( r, s, a )                                              \
+   a = nxml_trace_strdup( xmlTextReaderGetAttribute( r, (xmlChar *)s ) )
+#define xmls_attr_int_def( r, s, a, def )                                      \
+   do {                                                                        \
+      xmls_attr_strd( r, s, char *T );                                         \
+      a = T == NULL ? def : strtol( T, NULL, 10 );                             \
+      free( T );                                                               \
+   } while ( 0 )
+#define xmls_attr_float_def( r, s, a, def )                                    \
+   do {                                                                        \
+      xmls_attr_strd( r, s, char *T );                                         \
+      a = T == NULL ? def : strtod( T, NULL );                                 \
+      free( T );                                                               \
+   } while ( 0 )
+#define xmls_attr_int( r, s, a ) xmls_attr_int_def( r, s, a, 0 )
+#define xmls_attr_float( r, s, a ) xmls_attr_float_def( r, s, a, 0. )
+
 /*
  * writer crap
  */
@@ -267,6 +319,16 @@ USE_RESULT glTexture *xml_parseTexture( xmlNodePtr node, const char *path,
                                         const unsigned int flags );
 int                   xml_parseTime( xmlNodePtr node, time_t *t );
 
+/*
+ * Functions for streaming reading.
+ */
+xmlTextReaderPtr xml_readerPhysFS( const char *filename );
+int              xml_readerRoot( xmlTextReaderPtr reader, const char *name );
+int              xml_readerNextChild( xmlTextReaderPtr reader, int depth );
+char            *xmls_getStrd( xmlTextReaderPtr reader );
+int              xmls_getInt( xmlTextReaderPtr reader );
+double           xmls_getFloat( xmlTextReaderPtr reader );
+
 /*
  * Functions for generic complex writing.
  */
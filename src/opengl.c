@@ -61,6 +61,12 @@ static int gl_view_w      = 0; /* Viewport width. */
 static int gl_view_h      = 0; /* Viewport height. */
 mat4       gl_view_matrix = { { { { 0 } } } };
 
+/*
+ * Render statistics.
+ */
+glRenderStats        gl_stats;      /**< Counters of the current frame. */
+static glRenderStats gl_stats_last; /**< Counters of the last full frame. */
+
 /*
  * prototypes
  */
@@ -752,6 +758,27 @@ void gl_colourblind( void )
    }
 }
 
+/**
+ * @brief Marks the end of a frame for the render statistics.
+ *
+ * Should be called once per frame after swapping buffers.
+ */
+void gl_statsFrame( void )
+{
+   gl_stats_last = gl_stats;
+   memset( &gl_stats, 0, sizeof( glRenderStats ) );
+}
+
+/**
+ * @brief Gets the render statistics of the last full frame.
+ *
+ *    @return The render statistics of the last frame.
+ */
+const glRenderStats *gl_statsLast( void )
+{
+   return &gl_stats_last;
+}
+
 /**
  * @brief Cleans up OpenGL, the works.
  */
@@ -771,6 +798,7 @@ void gl_exit( void )
    /* Exit the OpenGL subsystems. */
    gltf_exit();
    gl_exitRender();
+   gl_exitBatch();
    gl_exitVBO();
    gl_exitTextures();
 
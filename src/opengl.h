@@ -15,6 +15,7 @@
 #include "colour.h"
 /* We put all the other opengl stuff here to only have to include one header. */
 #include "mat4.h"
+#include "opengl_batch.h"
 #include "opengl_render.h"
 #include "opengl_shader.h"
 #include "opengl_tex.h"
@@ -84,6 +85,17 @@ extern glInfo gl_screen; /* local structure set with gl_init and co */
 
 extern mat4 gl_view_matrix;
 
+/**
+ * @brief Rendering counters, reset every frame.
+ */
+typedef struct glRenderStats_ {
+   unsigned int draws;     /**< Draw calls issued by batched renderers. */
+   unsigned int states;    /**< Program and texture changes they made. */
+   unsigned int instances; /**< Number of batched sprites and effects. */
+   unsigned int glyphs;    /**< Number of glyphs drawn. */
+} glRenderStats;
+extern glRenderStats gl_stats; /* counters of the frame being rendered */
+
 #define SCREEN_X gl_screen.x /**< Screen X offset. */
 #define SCREEN_Y gl_screen.y /**< Screen Y offset. */
 #define SCREEN_W gl_screen.w /**< Screen width. */
@@ -120,6 +132,12 @@ void gl_defViewport( void );
 void gl_setDefViewport( int x, int y, int w, int h );
 int  gl_setupFullscreen( void );
 
+/*
+ * Render statistics.
+ */
+void                 gl_statsFrame( void );
+const glRenderStats *gl_statsLast( void );
+
 /*
  * misc
  */
@@ -0,0 +1,324 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file opengl_batch.c
+ *
+ * @brief Batches up sprites so they can be drawn with few draw calls.
+ *
+ * Between gl_batchBegin() and gl_batchEnd(), sprites are not drawn but stored
+ * in buckets by texture. When the batch ends, all the quads are uploaded to a
+ * single streaming VBO and each bucket is drawn with one call. This means that
+ * the drawing order is only kept within sprites sharing textures, which is fine
+ * for things like particles and projectiles that live on the same layer.
+ *
+ * When no batch is active, the sprites are drawn right away like with the
+ * gl_renderSprite*() functions.
+ */
+/** @cond */
+#include "naev.h"
+/** @endcond */
+
+#include "opengl_batch.h"
+
+#include "array.h"
+#include "camera.h"
+#include "opengl.h"
+
+/**
+ * @brief Vertex of a batched quad.
+ */
+typedef struct glBatchVertex_ {
+   GLfloat  x, y;  /**< Position in screen coordinates. */
+   GLfloat  s, t;  /**< Texture coordinates. */
+   GLfloat  inter; /**< Interpolation between textures A and B. */
+   glColour c;     /**< Colour to modulate with. */
+} glBatchVertex;
+
+/**
+ * @brief Quads using the same textures.
+ */
+typedef struct glBatchBucket_ {
+   GLuint         ta;        /**< Texture A. */
+   GLuint         tb;        /**< Texture B, same as A if not interpolating. */
+   glBatchVertex *vertices;  /**< Vertices of the quads (array.h). */
+   unsigned int   instances; /**< Number of quads. */
+} glBatchBucket;
+
+static int            batch_active   = 0;    /**< Whether batching. */
+static glBatchBucket *batch_buckets  = NULL; /**< Buckets (array.h). */
+static int            batch_nbuckets = 0;    /**< Buckets in use. */
+static gl_vbo        *batch_vbo      = NULL; /**< Streaming VBO. */
+static GLsizei        batch_vbo_size = 0;    /**< Size of batch_vbo in bytes. */
+
+/**
+ * @brief Gets the bucket for a pair of textures, creating it if necessary.
+ */
+static glBatchBucket *gl_batchBucket( GLuint ta, GLuint tb )
+{
+   glBatchBucket *b;
+
+   /* Few textures per layer, so a linear search is fine. */
+   for ( int i = batch_nbuckets - 1; i >= 0; i-- ) {
+      b = &batch_buckets[i];
+      if ( ( b->ta == ta ) && ( b->tb == tb ) )
+         return b;
+   }
+
+   /* Reuse buckets from previous batches to keep their memory. */
+   if ( batch_nbuckets >= array_size( batch_buckets ) ) {
+      b           = &array_grow( &batch_buckets );
+      b->vertices = array_create( glBatchVertex );
+   }
+   b            = &batch_buckets[batch_nbuckets++];
+   b->ta        = ta;
+   b->tb        = tb;
+   b->instances = 0;
+   return b;
+}
+
+/**
+ * @brief Adds a textured quad to the batch.
+ *
+ * Parameters are the same as gl_renderTextureRaw(), except the quad samples
+ * texture A and B and interpolates between them.
+ */
+static void gl_batchQuad( GLuint ta, GLuint tb, double inter, uint8_t flags,
+                          double x, double y, double w, double h, double tx,
+                          double ty, double tw, double th, const glColour *c,
+                          double angle )
+{
+   /* Order to turn the quad's triangle strip into two triangles. */
+   static const int tri[6] = { 0, 1, 2, 2, 1, 3 };
+   glBatchBucket   *b      = gl_batchBucket( ta, tb );
+   double           hw     = w * 0.5;
+   double           hh     = h * 0.5;
+   double           ca     = cos( angle );
+   double           sa     = sin( angle );
+
+   if ( c == NULL )
+      c = &cWhite;
+
+   for ( int i = 0; i < 6; i++ ) {
+      glBatchVertex *v = &array_grow( &b->vertices );
+      double         u = tri[i] & 1;
+      double         t = tri[i] >> 1;
+      double         px, py;
+
+      /* Rotate around the center like gl_renderTextureRaw(). */
+      px   = u * w - hw;
+      py   = t * h - hh;
+      v->x = x + hw + ca * px - sa * py;
+      v->y = y + hh + sa * px + ca * py;
+      v->s = tx + u * tw;
+      v->t = ty + t * th;
+      if ( flags & OPENGL_TEX_VFLIP )
+         v->t = 1. - v->t;
+      v->inter = inter;
+      v->c     = *c;
+   }
+   b->instances++;
+}
+
+/**
+ * @brief Starts batching sprites.
+ */
+void gl_batchBegin( void )
+{
+   batch_active = 1;
+}
+
+/**
+ * @brief Draws all the batched sprites and stops batching.
+ */
+void gl_batchEnd( void )
+{
+   GLsizei size, offset;
+   GLint   first;
+
+   batch_active = 0;
+   if ( batch_nbuckets == 0 )
+      return;
+
+   /* Upload everything into a freshly orphaned buffer. */
+   size = 0;
+   for ( int i = 0; i < batch_nbuckets; i++ )
+      size += array_size( batch_buckets[i].vertices ) * sizeof( glBatchVertex );
+   if ( batch_vbo == NULL ) {
+      batch_vbo_size = size;
+      batch_vbo      = gl_vboCreateStream( size, NULL );
+   } else {
+      batch_vbo_size = MAX( size, batch_vbo_size );
+      gl_vboData( batch_vbo, batch_vbo_size, NULL );
+   }
+   offset = 0;
+   for ( int i = 0; i < batch_nbuckets; i++ ) {
+      const glBatchBucket *b = &batch_buckets[i];
+      GLsizei bsize = array_size( b->vertices ) * sizeof( glBatchVertex );
+      gl_vboSubData( batch_vbo, offset, bsize, b->vertices );
+      offset += bsize;
+   }
+
+   /* Set up the shader once for all the buckets. */
+   glUseProgram( shaders.texture_batch.program );
+   glUniform1i( shaders.texture_batch.sampler1, 0 );
+   glUniform1i( shaders.texture_batch.sampler2, 1 );
+   gl_uniformMat4( shaders.texture_batch.projection, &gl_view_matrix );
+   glEnableVertexAttribArray( shaders.texture_batch.vertex );
+   glEnableVertexAttribArray( shaders.texture_batch.tex_coord );
+   glEnableVertexAttribArray( shaders.texture_batch.vertex_inter );
+   glEnableVertexAttribArray( shaders.texture_batch.vertex_colour );
+   gl_vboActivateAttribOffset( batch_vbo, shaders.texture_batch.vertex,
+                               offsetof( glBatchVertex, x ), 2, GL_FLOAT,
+                               sizeof( glBatchVertex ) );
+   gl_vboActivateAttribOffset( batch_vbo, shaders.texture_batch.tex_coord,
+                               offsetof( glBatchVertex, s ), 2, GL_FLOAT,
+                               sizeof( glBatchVertex ) );
+   gl_vboActivateAttribOffset( batch_vbo, shaders.texture_batch.vertex_inter,
+                               offsetof( glBatchVertex, inter ), 1, GL_FLOAT,
+                               sizeof( glBatchVertex ) );
+   gl_vboActivateAttribOffset( batch_vbo, shaders.texture_batch.vertex_colour,
+                               offsetof( glBatchVertex, c ), 4, GL_FLOAT,
+                               sizeof( glBatchVertex ) );
+   gl_stats.states++;
+
+   /* One draw per bucket. */
+   first = 0;
+   for ( int i = 0; i < batch_nbuckets; i++ ) {
+      glBatchBucket *b = &batch_buckets[i];
+      GLsizei        n = array_size( b->vertices );
+
+      glActiveTexture( GL_TEXTURE1 );
+      glBindTexture( GL_TEXTURE_2D, b->tb );
+      glActiveTexture( GL_TEXTURE0 );
+      glBindTexture( GL_TEXTURE_2D, b->ta );
+      /* Always end with TEXTURE0 active. */
+
+      glDrawArrays( GL_TRIANGLES, first, n );
+      first += n;
+
+      gl_stats.draws++;
+      gl_stats.states++;
+      gl_stats.instances += b->instances;
+      array_erase( &b->vertices, array_begin( b->vertices ),
+                   array_end( b->vertices ) );
+   }
+   batch_nbuckets = 0;
+
+   /* Clear state. */
+   glDisableVertexAttribArray( shaders.texture_batch.vertex );
+   glDisableVertexAttribArray( shaders.texture_batch.tex_coord );
+   glDisableVertexAttribArray( shaders.texture_batch.vertex_inter );
+   glDisableVertexAttribArray( shaders.texture_batch.vertex_colour );
+   glUseProgram( 0 );
+
+   /* anything failed? */
+   gl_checkErr();
+}
+
+/**
+ * @brief Batches a sprite, see gl_renderSprite().
+ */
+void gl_batchSprite( const glTexture *sprite, double bx, double by, int sx,
+                     int sy, const glColour *c )
+{
+   gl_batchSpriteScaleRotate( sprite, bx, by, 1., 1., 0., sx, sy, c );
+}
+
+/**
+ * @brief Batches a scaled and rotated sprite, see
+ * gl_renderSpriteScaleRotate().
+ */
+void gl_batchSpriteScaleRotate( const glTexture *sprite, double bx, double by,
+                                double scalew, double scaleh, double angle,
+                                int sx, int sy, const glColour *c )
+{
+   double x, y, w, h, tx, ty, z;
+
+   if ( !batch_active ) {
+      gl_renderSpriteScaleRotate( sprite, bx, by, scalew, scaleh, angle, sx, sy,
+                                  c );
+      return;
+   }
+
+   /* Translate coords. */
+   z = cam_getZoom();
+   gl_gameToScreenCoords( &x, &y, bx - sprite->sw * 0.5,
+                          by - sprite->sh * 0.5 );
+
+   /* Scaled sprite dimensions. */
+   w = sprite->sw * z * scalew;
+   h = sprite->sh * z * scaleh;
+
+   /* check if inbounds */
+   if ( ( x < -w ) || ( x > SCREEN_W + w ) || ( y < -h ) ||
+        ( y > SCREEN_H + h ) )
+      return;
+
+   /* texture coords */
+   tx = sprite->sw * (double)( sx ) / sprite->w;
+   ty = sprite->sh * ( sprite->sy - (double)sy - 1 ) / sprite->h;
+
+   gl_batchQuad( sprite->texture, sprite->texture, 1., sprite->flags, x, y, w,
+                 h, tx, ty, sprite->srw, sprite->srh, c, angle );
+}
+
+/**
+ * @brief Batches an interpolated sprite, see gl_renderSpriteInterpolate().
+ */
+void gl_batchSpriteInterpolate( const glTexture *sa, const glTexture *sb,
+                                double inter, double bx, double by, int sx,
+                                int sy, const glColour *c )
+{
+   double x, y, w, h, tx, ty, z;
+   GLuint ta, tb;
+
+   if ( !batch_active ) {
+      gl_renderSpriteInterpolate( sa, sb, inter, bx, by, sx, sy, c );
+      return;
+   }
+
+   /* Translate coords. */
+   gl_gameToScreenCoords( &x, &y, bx - sa->sw * 0.5, by - sa->sh * 0.5 );
+
+   /* Scaled sprite dimensions. */
+   z = cam_getZoom();
+   w = sa->sw * z;
+   h = sa->sh * z;
+
+   /* check if inbounds */
+   if ( ( x < -w ) || ( x > SCREEN_W + w ) || ( y < -h ) ||
+        ( y > SCREEN_H + h ) )
+      return;
+
+   /* texture coords */
+   tx = sa->sw * (double)( sx ) / sa->w;
+   ty = sa->sh * ( sa->sy - (double)sy - 1 ) / sa->h;
+
+   /* Only use one texture when possible so buckets get shared. */
+   ta = sa->texture;
+   tb = sb->texture;
+   if ( inter >= 1. )
+      tb = ta;
+   else if ( inter <= 0. )
+      ta = tb;
+   if ( ta == tb )
+      inter = 1.;
+
+   gl_batchQuad( ta, tb, inter, sa->flags, x, y, w, h, tx, ty, sa->srw,
+                 sa->srh, c, 0. );
+}
+
+/**
+ * @brief Cleans up the batching.
+ */
+void gl_exitBatch( void )
+{
+   for ( int i = 0; i < array_size( batch_buckets ); i++ )
+      array_free( batch_buckets[i].vertices );
+   array_free( batch_buckets );
+   batch_buckets  = NULL;
+   batch_nbuckets = 0;
+   gl_vboDestroy( batch_vbo );
+   batch_vbo = NULL;
+}
@@ -0,0 +1,26 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+#include "colour.h"
+#include "opengl_tex.h"
+
+/*
+ * Cleanup.
+ */
+void gl_exitBatch( void );
+
+/*
+ * Batching.
+ */
+void gl_batchBegin( void );
+void gl_batchEnd( void );
+void gl_batchSprite( const glTexture *sprite, double bx, double by, int sx,
+                     int sy, const glColour *c );
+void gl_batchSpriteScaleRotate( const glTexture *sprite, double bx, double by,
+                                double scalew, double scaleh, double angle,
+                                int sx, int sy, const glColour *c );
+void gl_batchSpriteInterpolate( const glTexture *sa, const glTexture *sb,
+                                double inter, double bx, double by, int sx,
+                                int sy, const glColour *c );
@@ -24,6 +24,7 @@
 #include "damagetype.h"
 #include "log.h"
 #include "mapData.h"
+#include "nameindex.h"
 #include "ndata.h"
 #include "nlua.h"
 #include "nlua_camera.h"
@@ -63,6 +64,12 @@ typedef struct OutfitThreadData_ {
 static Outfit *outfit_stack  = NULL; /**< Stack of outfits. */
 static char  **license_stack = NULL; /**< Stack of available licenses. */
 
+/*
+ * Name lookups.
+ */
+static NameIndex outfit_index;      /**< Name index of outfit_stack. */
+static NameIndex outfit_index_case; /**< Case insensitive outfit_index. */
+
 /*
  * Helper stuff for setting up short descriptions for outfits.
  */
@@ -234,9 +241,8 @@ const Outfit *outfit_get( const char *name )
  */
 const Outfit *outfit_getW( const char *name )
 {
-   const Outfit s = { .name = (char *)name };
-   return bsearch( &s, outfit_stack, array_size( outfit_stack ),
-                   sizeof( Outfit ), outfit_cmp );
+   int i = nameindex_get( &outfit_index, name );
+   return ( i < 0 ) ? NULL : &outfit_stack[i];
 }
 
 /**
@@ -252,10 +258,8 @@ const Outfit *outfit_getAll( void )
  */
 const char *outfit_existsCase( const char *name )
 {
-   for ( int i = 0; i < array_size( outfit_stack ); i++ )
-      if ( strcasecmp( name, outfit_stack[i].name ) == 0 )
-         return outfit_stack[i].name;
-   return NULL;
+   int i = nameindex_get( &outfit_index_case, name );
+   return ( i < 0 ) ? NULL : outfit_stack[i].name;
 }
 
 /**
@@ -3056,6 +3060,13 @@ int outfit_load( void )
                outfit_stack[i].name );
 #endif /* DEBUGGING */
 
+   /* The stack is frozen now, so index the names. */
+   nameindex_buildStruct( &outfit_index, outfit_stack, noutfits,
+                          sizeof( Outfit ), offsetof( Outfit, name ), 0 );
+   nameindex_buildStruct( &outfit_index_case, outfit_stack, noutfits,
+                          sizeof( Outfit ), offsetof( Outfit, name ),
+                          NAMEINDEX_CASE );
+
    /* Second pass. */
    for ( int i = 0; i < noutfits; i++ ) {
       Outfit *o = &outfit_stack[i];
@@ -3071,7 +3082,7 @@ int outfit_load( void )
          continue;
       }
 
-      env        = nlua_newEnv();
+      env        = nlua_newEnv( o->name );
       o->lua_env = env;
       /* TODO limit libraries here. */
       nlua_loadStandard( env );
@@ -3346,6 +3357,9 @@ int outfit_licenseExists( const char *name )
  */
 void outfit_free( void )
 {
+   /* Cached descriptions point to the outfits. */
+   pilot_outfitDescCacheClear();
+
    for ( int i = 0; i < array_size( outfit_stack ); i++ ) {
       Outfit *o = &outfit_stack[i];
 
@@ -3416,6 +3430,8 @@ void outfit_free( void )
 
    array_free( outfit_stack );
    array_free( license_stack );
+   nameindex_free( &outfit_index );
+   nameindex_free( &outfit_index_case );
 }
 
 /**
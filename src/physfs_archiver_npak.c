@@ -0,0 +1,603 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file physfs_archiver_npak.c
+ *
+ * @brief Archiver for packed ndata archives.
+ *
+ * These archives are made at build time by utils/build/pack_ndata.py and hold
+ * all of ndata in a single file with a hashed index of the paths. They get
+ * mapped into memory, so looking files up doesn't touch the filesystem and
+ * reading them is just copying from the mapping, or not even that with
+ * npak_view().
+ *
+ * All numbers are little endian. The archive is made of:
+ *  - The header (NpakHeader).
+ *  - The entries (NpakEntry), with the root directory first. The children of
+ *    each directory are a linked list of entries, and always come after it.
+ *  - The hash table, with the index of an entry plus one in each slot, or 0 if
+ *    the slot is empty. Collisions are handled by linear probing.
+ *  - The NUL terminated paths of the entries.
+ *  - The file data. Each file is followed by a NUL so it can be used directly
+ *    as a string.
+ */
+/** @cond */
+#include "physfs.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#if HAS_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* HAS_POSIX */
+
+#include "naev.h"
+/** @endcond */
+
+#include "physfs_archiver_npak.h"
+
+#include "array.h"
+#include "log.h"
+
+#define NPAK_MAGIC "NPAK" /**< Magic the archives start with. */
+#define NPAK_VERSION 1    /**< Version of the format. */
+#define NPAK_DIR 1        /**< Entry flag for directories. */
+
+/**
+ * @brief Header of a packed archive.
+ */
+typedef struct NpakHeader_ {
+   char     magic[4]; /**< NPAK_MAGIC. */
+   uint32_t version;  /**< NPAK_VERSION. */
+   uint32_t nentries; /**< Number of entries. */
+   uint32_t nslots;   /**< Size of the hash table, a power of two. */
+   uint64_t entries;  /**< Offset of the entries. */
+   uint64_t slots;    /**< Offset of the hash table. */
+} NpakHeader;
+static_assert( sizeof( NpakHeader ) == 32, "" );
+
+/**
+ * @brief File or directory in a packed archive.
+ */
+typedef struct NpakEntry_ {
+   uint64_t hash;   /**< FNV-1a hash of the path. */
+   uint64_t offset; /**< Offset of the data. */
+   uint64_t size;   /**< Size of the data, without the trailing NUL. */
+   uint32_t name;   /**< Offset of the path. */
+   uint32_t child;  /**< First child plus one, or 0. */
+   uint32_t next;   /**< Next sibling plus one, or 0. */
+   uint32_t flags;  /**< Entry flags. */
+} NpakEntry;
+static_assert( sizeof( NpakEntry ) == 40, "" );
+
+/**
+ * @brief A mounted packed archive.
+ */
+typedef struct NpakArchive_ {
+   char            *name;     /**< Name it was mounted as. */
+   PHYSFS_Io       *io;       /**< Where it was opened from. */
+   const char      *data;     /**< Contents of the whole archive. */
+   size_t           size;     /**< Size of the archive. */
+   int              mapped;   /**< Whether data is mapped or allocated. */
+   const NpakEntry *entries;  /**< Entries. */
+   const uint32_t  *slots;    /**< Hash table. */
+   uint32_t         nentries; /**< Number of entries. */
+   uint32_t         nslots;   /**< Size of the hash table. */
+} NpakArchive;
+
+/**
+ * @brief A file opened for reading.
+ */
+typedef struct NpakFile_ {
+   const char   *data; /**< Data of the file. */
+   PHYSFS_uint64 size; /**< Size of the file. */
+   PHYSFS_uint64 pos;  /**< Position being read. */
+} NpakFile;
+
+static NpakArchive **npak_archives = NULL; /**< Mounted archives. */
+
+/*
+ * Prototypes.
+ */
+static PHYSFS_Io *npak_unsupportedIO( void *opaque, const char *filename );
+static int        npak_unsupported( void *opaque, const char *name );
+static void *npak_openArchive( PHYSFS_Io *io, const char *name, int forWrite,
+                               int *claimed );
+static PHYSFS_EnumerateCallbackResult
+npak_enumerate( void *opaque, const char *dirname, PHYSFS_EnumerateCallback cb,
+                const char *origdir, void *callbackdata );
+static PHYSFS_Io *npak_openRead( void *opaque, const char *fnm );
+static int        npak_stat( void *opaque, const char *fn, PHYSFS_Stat *stat );
+static void       npak_closeArchive( void *opaque );
+
+/**
+ * @brief The archiver for packed archives.
+ */
+static const PHYSFS_Archiver npak_archiver = {
+   .version = 0,
+   .info =
+      {
+         .extension        = "npak",
+         .description      = "Naev packed ndata archiver.",
+         .author           = "Naev DevTeam",
+         .url              = "https://naev.org",
+         .supportsSymlinks = 0,
+      },
+   .openArchive  = npak_openArchive,
+   .enumerate    = npak_enumerate,
+   .openRead     = npak_openRead,
+   .openWrite    = npak_unsupportedIO,
+   .openAppend   = npak_unsupportedIO,
+   .remove       = npak_unsupported,
+   .mkdir        = npak_unsupported,
+   .stat         = npak_stat,
+   .closeArchive = npak_closeArchive,
+};
+
+/*
+ * Memory file I/O.
+ */
+static PHYSFS_sint64     npak_read( struct PHYSFS_Io *io, void *buf,
+                                    PHYSFS_uint64 len );
+static PHYSFS_sint64     npak_write( struct PHYSFS_Io *io, const void *buffer,
+                                     PHYSFS_uint64 len );
+static int               npak_seek( struct PHYSFS_Io *io,
+                                    PHYSFS_uint64     offset );
+static PHYSFS_sint64     npak_tell( struct PHYSFS_Io *io );
+static PHYSFS_sint64     npak_length( struct PHYSFS_Io *io );
+static struct PHYSFS_Io *npak_duplicate( struct PHYSFS_Io *io );
+static int               npak_flush( struct PHYSFS_Io *io );
+static void              npak_destroy( struct PHYSFS_Io *io );
+
+/**
+ * @brief Template for the I/O of opened files.
+ */
+static const PHYSFS_Io npak_io = {
+   .version   = 0,
+   .opaque    = NULL,
+   .read      = npak_read,
+   .write     = npak_write,
+   .seek      = npak_seek,
+   .tell      = npak_tell,
+   .length    = npak_length,
+   .duplicate = npak_duplicate,
+   .flush     = npak_flush,
+   .destroy   = npak_destroy,
+};
+
+/**
+ * @brief Registers the archiver for packed archives with PhysicsFS.
+ *
+ *    @return 0 on success.
+ */
+int npak_init( void )
+{
+   if ( !PHYSFS_registerArchiver( &npak_archiver ) ) {
+      WARN( _( "Unable to register the packed ndata archiver: %s" ),
+            _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+      return -1;
+   }
+   return 0;
+}
+
+/**
+ * @brief Checks whether there are any packed archives mounted.
+ */
+int npak_mounted( void )
+{
+   return array_size( npak_archives ) > 0;
+}
+
+/**
+ * @brief Hashes a path the same way as the packer.
+ */
+static uint64_t npak_hash( const char *path )
+{
+   uint64_t h = 0xcbf29ce484222325ULL;
+   for ( const unsigned char *c = (const unsigned char *)path; *c != '\0';
+         c++ ) {
+      h ^= *c;
+      h *= 0x100000001b3ULL;
+   }
+   return h;
+}
+
+/**
+ * @brief Gets the path of an entry.
+ */
+static const char *npak_name( const NpakArchive *a, const NpakEntry *e )
+{
+   return &a->data[PHYSFS_swapULE32( e->name )];
+}
+
+/**
+ * @brief Looks up an entry by path.
+ *
+ *    @param a Archive to look in.
+ *    @param path Path in the archive, without leading slash.
+ *    @return The entry or NULL if not found.
+ */
+static const NpakEntry *npak_find( const NpakArchive *a, const char *path )
+{
+   uint64_t h    = npak_hash( path );
+   uint32_t mask = a->nslots - 1;
+   for ( uint32_t i = h & mask;; i = ( i + 1 ) & mask ) {
+      uint32_t         s = PHYSFS_swapULE32( a->slots[i] );
+      const NpakEntry *e;
+      if ( s == 0 )
+         return NULL;
+      e = &a->entries[s - 1];
+      if ( ( PHYSFS_swapULE64( e->hash ) == h ) &&
+           ( strcmp( npak_name( a, e ), path ) == 0 ) )
+         return e;
+   }
+}
+
+/**
+ * @brief Makes sure all the offsets of an archive are within it, and that
+ * looking things up can't loop forever.
+ */
+static int npak_validate( NpakArchive *a )
+{
+   const NpakHeader *hdr = (const NpakHeader *)a->data;
+   uint64_t          entries, slots;
+   uint32_t          used = 0;
+
+   if ( ( a->size < sizeof( NpakHeader ) ) ||
+        ( memcmp( hdr->magic, NPAK_MAGIC, 4 ) != 0 ) ||
+        ( PHYSFS_swapULE32( hdr->version ) != NPAK_VERSION ) )
+      return -1;
+   a->nentries = PHYSFS_swapULE32( hdr->nentries );
+   a->nslots   = PHYSFS_swapULE32( hdr->nslots );
+   entries     = PHYSFS_swapULE64( hdr->entries );
+   slots       = PHYSFS_swapULE64( hdr->slots );
+   if ( ( a->nentries == 0 ) || ( a->nslots <= a->nentries ) ||
+        ( ( a->nslots & ( a->nslots - 1 ) ) != 0 ) ||
+        ( entries % sizeof( uint64_t ) != 0 ) ||
+        ( slots % sizeof( uint32_t ) != 0 ) ||
+        ( entries + (uint64_t)a->nentries * sizeof( NpakEntry ) > a->size ) ||
+        ( slots + (uint64_t)a->nslots * sizeof( uint32_t ) > a->size ) )
+      return -1;
+   a->entries = (const NpakEntry *)&a->data[entries];
+   a->slots   = (const uint32_t *)&a->data[slots];
+
+   for ( uint32_t i = 0; i < a->nentries; i++ ) {
+      const NpakEntry *e      = &a->entries[i];
+      uint64_t         offset = PHYSFS_swapULE64( e->offset );
+      uint64_t         size   = PHYSFS_swapULE64( e->size );
+      uint32_t         name   = PHYSFS_swapULE32( e->name );
+      uint32_t         child  = PHYSFS_swapULE32( e->child );
+      uint32_t         next   = PHYSFS_swapULE32( e->next );
+      /* Data of files has to be followed by a NUL. */
+      if ( !( PHYSFS_swapULE32( e->flags ) & NPAK_DIR ) &&
+           ( ( offset > a->size ) || ( size >= a->size - offset ) ||
+             ( a->data[offset + size] != '\0' ) ) )
+         return -1;
+      if ( ( name >= a->size ) ||
+           ( memchr( &a->data[name], '\0', a->size - name ) == NULL ) )
+         return -1;
+      /* Links only go forward, so there can be no cycles. */
+      if ( ( child > a->nentries ) || ( next > a->nentries ) ||
+           ( ( child != 0 ) && ( child <= i + 1 ) ) ||
+           ( ( next != 0 ) && ( next <= i + 1 ) ) )
+         return -1;
+   }
+   for ( uint32_t i = 0; i < a->nslots; i++ ) {
+      uint32_t s = PHYSFS_swapULE32( a->slots[i] );
+      if ( s > a->nentries )
+         return -1;
+      used += ( s != 0 );
+   }
+   /* The table must have empty slots for lookups to end. */
+   if ( used >= a->nslots )
+      return -1;
+   return 0;
+}
+
+/**
+ * @brief Gets the contents of an archive into memory, mapping it if possible.
+ */
+static int npak_load( NpakArchive *a, PHYSFS_Io *io, const char *name )
+{
+#if HAS_POSIX
+   int fd = open( name, O_RDONLY );
+   if ( fd >= 0 ) {
+      struct stat st;
+      if ( ( fstat( fd, &st ) == 0 ) && ( (size_t)st.st_size == a->size ) ) {
+         void *data = mmap( NULL, a->size, PROT_READ, MAP_PRIVATE, fd, 0 );
+         if ( data != MAP_FAILED ) {
+            a->data   = data;
+            a->mapped = 1;
+         }
+      }
+      close( fd );
+      if ( a->mapped )
+         return 0;
+   }
+#endif /* HAS_POSIX */
+
+   /* Fall back to reading it all at once. */
+   char *data = malloc( a->size );
+   if ( data == NULL )
+      return -1;
+   a->data = data;
+   if ( !io->seek( io, 0 ) )
+      return -1;
+   for ( size_t n = 0; n < a->size; ) {
+      PHYSFS_sint64 r = io->read( io, &data[n], a->size - n );
+      if ( r <= 0 )
+         return -1;
+      n += r;
+   }
+   return 0;
+}
+
+/**
+ * @brief Frees an archive, but not where it was opened from.
+ */
+static void npak_free( NpakArchive *a )
+{
+#if HAS_POSIX
+   if ( a->mapped )
+      munmap( (void *)a->data, a->size );
+   else
+#endif /* HAS_POSIX */
+      free( (void *)a->data );
+   free( a->name );
+   free( a );
+}
+
+static void *npak_openArchive( PHYSFS_Io *io, const char *name, int forWrite,
+                               int *claimed )
+{
+   char          magic[4];
+   NpakArchive  *a;
+   PHYSFS_sint64 len;
+
+   if ( ( io->read( io, magic, sizeof( magic ) ) != sizeof( magic ) ) ||
+        ( memcmp( magic, NPAK_MAGIC, sizeof( magic ) ) != 0 ) ) {
+      PHYSFS_setErrorCode( PHYSFS_ERR_UNSUPPORTED );
+      return NULL;
+   }
+   *claimed = 1;
+   if ( forWrite ) {
+      PHYSFS_setErrorCode( PHYSFS_ERR_READ_ONLY );
+      return NULL;
+   }
+   len = io->length( io );
+   if ( len <= 0 ) {
+      PHYSFS_setErrorCode( PHYSFS_ERR_CORRUPT );
+      return NULL;
+   }
+
+   a       = calloc( 1, sizeof( NpakArchive ) );
+   a->size = len;
+   if ( npak_load( a, io, name ) || npak_validate( a ) ) {
+      WARN( _( "Packed ndata archive '%s' is invalid!" ), name );
+      npak_free( a );
+      PHYSFS_setErrorCode( PHYSFS_ERR_CORRUPT );
+      return NULL;
+   }
+   a->io   = io;
+   a->name = strdup( name );
+
+   if ( npak_archives == NULL )
+      npak_archives = array_create( NpakArchive * );
+   array_push_back( &npak_archives, a );
+   return a;
+}
+
+static PHYSFS_EnumerateCallbackResult
+npak_enumerate( void *opaque, const char *dirname, PHYSFS_EnumerateCallback cb,
+                const char *origdir, void *callbackdata )
+{
+   const NpakArchive             *a = opaque;
+   const NpakEntry               *e = npak_find( a, dirname );
+   PHYSFS_EnumerateCallbackResult retval = PHYSFS_ENUM_OK;
+
+   if ( ( e == NULL ) || !( PHYSFS_swapULE32( e->flags ) & NPAK_DIR ) ) {
+      PHYSFS_setErrorCode( PHYSFS_ERR_NOT_FOUND );
+      return PHYSFS_ENUM_ERROR;
+   }
+
+   for ( uint32_t c = PHYSFS_swapULE32( e->child ); c != 0;
+         c          = PHYSFS_swapULE32( a->entries[c - 1].next ) ) {
+      const char *path = npak_name( a, &a->entries[c - 1] );
+      const char *base = strrchr( path, '/' );
+      retval = cb( callbackdata, origdir, ( base != NULL ) ? base + 1 : path );
+      if ( retval == PHYSFS_ENUM_ERROR )
+         PHYSFS_setErrorCode( PHYSFS_ERR_APP_CALLBACK );
+      if ( retval != PHYSFS_ENUM_OK )
+         break;
+   }
+   return retval;
+}
+
+static PHYSFS_Io *npak_openRead( void *opaque, const char *fnm )
+{
+   const NpakArchive *a = opaque;
+   const NpakEntry   *e = npak_find( a, fnm );
+   NpakFile          *f;
+   PHYSFS_Io         *io;
+
+   if ( e == NULL ) {
+      PHYSFS_setErrorCode( PHYSFS_ERR_NOT_FOUND );
+      return NULL;
+   }
+   if ( PHYSFS_swapULE32( e->flags ) & NPAK_DIR ) {
+      PHYSFS_setErrorCode( PHYSFS_ERR_NOT_A_FILE );
+      return NULL;
+   }
+
+   f          = malloc( sizeof( NpakFile ) );
+   f->data    = &a->data[PHYSFS_swapULE64( e->offset )];
+   f->size    = PHYSFS_swapULE64( e->size );
+   f->pos     = 0;
+   io         = malloc( sizeof( PHYSFS_Io ) );
+   *io        = npak_io;
+   io->opaque = f;
+   return io;
+}
+
+static int npak_stat( void *opaque, const char *fn, PHYSFS_Stat *stat )
+{
+   const NpakArchive *a = opaque;
+   const NpakEntry   *e = npak_find( a, fn );
+   int                dir;
+
+   if ( e == NULL ) {
+      PHYSFS_setErrorCode( PHYSFS_ERR_NOT_FOUND );
+      return 0;
+   }
+   dir              = PHYSFS_swapULE32( e->flags ) & NPAK_DIR;
+   stat->filesize   = dir ? 0 : (PHYSFS_sint64)PHYSFS_swapULE64( e->size );
+   stat->modtime    = -1;
+   stat->createtime = -1;
+   stat->accesstime = -1;
+   stat->filetype = dir ? PHYSFS_FILETYPE_DIRECTORY : PHYSFS_FILETYPE_REGULAR;
+   stat->readonly = 1;
+   return 1;
+}
+
+static void npak_closeArchive( void *opaque )
+{
+   NpakArchive *a = opaque;
+   for ( int i = 0; i < array_size( npak_archives ); i++ ) {
+      if ( npak_archives[i] != a )
+         continue;
+      array_erase( &npak_archives, &npak_archives[i], &npak_archives[i + 1] );
+      break;
+   }
+   if ( array_size( npak_archives ) == 0 ) {
+      array_free( npak_archives );
+      npak_archives = NULL;
+   }
+   a->io->destroy( a->io );
+   npak_free( a );
+}
+
+static PHYSFS_Io *npak_unsupportedIO( void *opaque, const char *filename )
+{
+   (void)opaque;
+   (void)filename;
+   PHYSFS_setErrorCode( PHYSFS_ERR_READ_ONLY );
+   return NULL;
+}
+
+static int npak_unsupported( void *opaque, const char *filename )
+{
+   (void)opaque;
+   (void)filename;
+   PHYSFS_setErrorCode( PHYSFS_ERR_READ_ONLY );
+   return 0;
+}
+
+/**
+ * @brief Gets the data of a file in a mounted packed archive without copying.
+ *
+ *    @param archive Name the archive was mounted as, such as given by
+ * PHYSFS_getRealDir().
+ *    @param path Path of the file in the archive.
+ *    @param[out] size Size of the file.
+ *    @return The NUL terminated data of the file, which stays valid as long as
+ * the archive is mounted, or NULL if not found.
+ */
+const void *npak_view( const char *archive, const char *path, size_t *size )
+{
+   for ( int i = 0; i < array_size( npak_archives ); i++ ) {
+      const NpakArchive *a = npak_archives[i];
+      const NpakEntry   *e;
+      if ( strcmp( a->name, archive ) != 0 )
+         continue;
+      e = npak_find( a, path );
+      if ( ( e == NULL ) || ( PHYSFS_swapULE32( e->flags ) & NPAK_DIR ) )
+         return NULL;
+      *size = PHYSFS_swapULE64( e->size );
+      return &a->data[PHYSFS_swapULE64( e->offset )];
+   }
+   return NULL;
+}
+
+/**
+ * @brief Checks whether some data belongs to a mounted packed archive.
+ */
+int npak_owns( const void *data )
+{
+   const char *d = data;
+   for ( int i = 0; i < array_size( npak_archives ); i++ ) {
+      const NpakArchive *a = npak_archives[i];
+      if ( ( d >= a->data ) && ( d < a->data + a->size ) )
+         return 1;
+   }
+   return 0;
+}
+
+static PHYSFS_sint64 npak_read( struct PHYSFS_Io *io, void *buf,
+                                PHYSFS_uint64 len )
+{
+   NpakFile *f = io->opaque;
+   len         = MIN( len, f->size - f->pos );
+   memcpy( buf, &f->data[f->pos], len );
+   f->pos += len;
+   return len;
+}
+
+static PHYSFS_sint64 npak_write( struct PHYSFS_Io *io, const void *buffer,
+                                 PHYSFS_uint64 len )
+{
+   (void)io;
+   (void)buffer;
+   (void)len;
+   PHYSFS_setErrorCode( PHYSFS_ERR_READ_ONLY );
+   return -1;
+}
+
+static int npak_seek( struct PHYSFS_Io *io, PHYSFS_uint64 offset )
+{
+   NpakFile *f = io->opaque;
+   if ( offset > f->size ) {
+      PHYSFS_setErrorCode( PHYSFS_ERR_PAST_EOF );
+      return 0;
+   }
+   f->pos = offset;
+   return 1;
+}
+
+static PHYSFS_sint64 npak_tell( struct PHYSFS_Io *io )
+{
+   const NpakFile *f = io->opaque;
+   return f->pos;
+}
+
+static PHYSFS_sint64 npak_length( struct PHYSFS_Io *io )
+{
+   const NpakFile *f = io->opaque;
+   return f->size;
+}
+
+static struct PHYSFS_Io *npak_duplicate( struct PHYSFS_Io *io )
+{
+   const NpakFile *f   = io->opaque;
+   NpakFile       *dup = malloc( sizeof( NpakFile ) );
+   PHYSFS_Io      *ret = malloc( sizeof( PHYSFS_Io ) );
+   *dup                = *f;
+   dup->pos            = 0;
+   *ret                = npak_io;
+   ret->opaque         = dup;
+   return ret;
+}
+
+static int npak_flush( struct PHYSFS_Io *io )
+{
+   (void)io;
+   return 1;
+}
+
+static void npak_destroy( struct PHYSFS_Io *io )
+{
+   free( io->opaque );
+   free( io );
+}
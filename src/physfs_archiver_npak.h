@@ -0,0 +1,13 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+int         npak_init( void );
+int         npak_mounted( void );
+const void *npak_view( const char *archive, const char *path, size_t *size );
+int         npak_owns( const void *data );
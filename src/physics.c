@@ -8,8 +8,10 @@
 #include "naev.h"
 /** @endcond */
 
+#include "array.h"
 #include "log.h"
 #include "physics.h"
+#include "physics_simd.h"
 
 /**
  * Lists of names for some internal units we use. These just translate them
@@ -293,3 +295,112 @@ void solid_init( Solid *dest, double mass, double dir, const vec2 *pos,
       break;
    }
 }
+
+/**
+ * @brief Adds a solid to a batch to be updated with solid_batchUpdate.
+ *
+ * The solid must stay valid until the batch is updated or cleared.
+ *
+ *    @param b Batch to add to.
+ *    @param s Solid to add.
+ */
+void solid_batchAdd( SolidBatch *b, Solid *s )
+{
+   int i;
+
+   /* Only the Euler update is vectorized. */
+   if ( s->update != solid_update_euler ) {
+      if ( b->other == NULL )
+         b->other = array_create( Solid * );
+      array_push_back( &b->other, s );
+      return;
+   }
+
+   /* Grow as necessary. */
+   if ( b->n >= b->m ) {
+      b->m       = MAX( 2 * b->m, 128 );
+      b->owner   = realloc( b->owner, b->m * sizeof( Solid * ) );
+      b->px      = realloc( b->px, b->m * sizeof( double ) );
+      b->py      = realloc( b->py, b->m * sizeof( double ) );
+      b->vx      = realloc( b->vx, b->m * sizeof( double ) );
+      b->vy      = realloc( b->vy, b->m * sizeof( double ) );
+      b->dir     = realloc( b->dir, b->m * sizeof( double ) );
+      b->dir_vel = realloc( b->dir_vel, b->m * sizeof( double ) );
+      b->accel   = realloc( b->accel, b->m * sizeof( double ) );
+      b->s       = realloc( b->s, b->m * sizeof( double ) );
+      b->c       = realloc( b->c, b->m * sizeof( double ) );
+   }
+
+   i             = b->n++;
+   b->owner[i]   = s;
+   b->px[i]      = s->pos.x;
+   b->py[i]      = s->pos.y;
+   b->vx[i]      = s->vel.x;
+   b->vy[i]      = s->vel.y;
+   b->dir[i]     = s->dir;
+   b->dir_vel[i] = s->dir_vel;
+   b->accel[i]   = s->accel;
+}
+
+/**
+ * @brief Updates all the solids in a batch and writes the results back.
+ *
+ * The batch is cleared afterwards.
+ *
+ *    @param b Batch to update.
+ *    @param dt Current delta tick.
+ */
+void solid_batchUpdate( SolidBatch *b, double dt )
+{
+   physics_eulerBatch( b->n, dt, b->px, b->py, b->vx, b->vy, b->dir,
+                       b->dir_vel, b->accel, b->s, b->c );
+
+   /* Feed the results back into the solids. */
+   for ( int i = 0; i < b->n; i++ ) {
+      Solid *s = b->owner[i];
+      s->pre   = s->pos;
+      s->dir   = b->dir[i];
+      vec2_cset( &s->vel, b->vx[i], b->vy[i] );
+      vec2_cset( &s->pos, b->px[i], b->py[i] );
+   }
+
+   /* Whatever couldn't be batched. */
+   for ( int i = 0; i < array_size( b->other ); i++ ) {
+      Solid *s = b->other[i];
+      s->update( s, dt );
+   }
+
+   solid_batchClear( b );
+}
+
+/**
+ * @brief Removes all the solids from a batch without freeing memory.
+ *
+ *    @param b Batch to clear.
+ */
+void solid_batchClear( SolidBatch *b )
+{
+   b->n = 0;
+   array_erase( &b->other, array_begin( b->other ), array_end( b->other ) );
+}
+
+/**
+ * @brief Frees all the memory used by a batch.
+ *
+ *    @param b Batch to free.
+ */
+void solid_batchFree( SolidBatch *b )
+{
+   free( b->owner );
+   free( b->px );
+   free( b->py );
+   free( b->vx );
+   free( b->vy );
+   free( b->dir );
+   free( b->dir_vel );
+   free( b->accel );
+   free( b->s );
+   free( b->c );
+   array_free( b->other );
+   memset( b, 0, sizeof( SolidBatch ) );
+}
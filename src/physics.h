@@ -54,6 +54,28 @@ typedef struct Solid_ {
    void ( *update )( struct Solid_ *, double ); /**< Update method. */
 } Solid;
 
+/**
+ * @brief Structure-of-arrays batch of solids integrated together.
+ *
+ * Solids using the Euler update are gathered into flat arrays and integrated
+ * in a single pass, the rest fall back to their own update function.
+ */
+typedef struct SolidBatch_ {
+   int     n;       /**< Number of batched solids. */
+   int     m;       /**< Allocated size of the arrays. */
+   Solid **owner;   /**< Solids the batched data belongs to. */
+   double *px;      /**< X positions. */
+   double *py;      /**< Y positions. */
+   double *vx;      /**< X velocities. */
+   double *vy;      /**< Y velocities. */
+   double *dir;     /**< Directions. */
+   double *dir_vel; /**< Rotation velocities. */
+   double *accel;   /**< Accelerations. */
+   double *s;       /**< Scratch for the direction sines. */
+   double *c;       /**< Scratch for the direction cosines. */
+   Solid **other;   /**< Solids that can't be batched (array.h). */
+} SolidBatch;
+
 /*
  * solid manipulation
  */
@@ -61,6 +83,14 @@ double solid_maxspeed( const Solid *s, double speed, double accel );
 void   solid_init( Solid *dest, double mass, double dir, const vec2 *pos,
                    const vec2 *vel, int update );
 
+/*
+ * batched updates
+ */
+void solid_batchAdd( SolidBatch *b, Solid *s );
+void solid_batchUpdate( SolidBatch *b, double dt );
+void solid_batchClear( SolidBatch *b );
+void solid_batchFree( SolidBatch *b );
+
 /*
  * misc
  */
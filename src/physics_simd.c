@@ -0,0 +1,110 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file physics_simd.c
+ *
+ * @brief Structure-of-arrays kernels for integrating many solids at once.
+ *
+ * These are kept free of any engine state and are built with full
+ * optimization so the compiler can vectorize the loops, see meson.build.
+ */
+/** @cond */
+#include <math.h>
+/** @endcond */
+
+#include "physics_simd.h"
+
+/*
+ * Taylor coefficients of the sine up to the 13th degree.
+ */
+#define SIN_C3 ( -1. / 6. )
+#define SIN_C5 ( 1. / 120. )
+#define SIN_C7 ( -1. / 5040. )
+#define SIN_C9 ( 1. / 362880. )
+#define SIN_C11 ( -1. / 39916800. )
+#define SIN_C13 ( 1. / 6227020800. )
+
+/**
+ * @brief Polynomial sine approximation valid in [-M_PI/2, M_PI/2].
+ */
+static inline double sin_poly( double x )
+{
+   double x2 = x * x;
+   return x *
+          ( 1. +
+            x2 * ( SIN_C3 +
+                   x2 * ( SIN_C5 +
+                          x2 * ( SIN_C7 +
+                                 x2 * ( SIN_C9 +
+                                        x2 * ( SIN_C11 + x2 * SIN_C13 ) ) ) ) ) );
+}
+
+/**
+ * @brief Computes the sine and cosine of a whole array of angles.
+ *
+ * The loop is branchless so it can be vectorized. The error is bounded by
+ * PHYSICS_SINCOS_ERR for angles in [0, 2*M_PI], which is the range solids keep
+ * their direction in.
+ *
+ *    @param[out] s Sines of the angles.
+ *    @param[out] c Cosines of the angles.
+ *    @param x Angles to compute.
+ *    @param n Number of angles.
+ */
+void physics_sincosv( double *restrict s, double *restrict c,
+                      const double *restrict x, int n )
+{
+   for ( int i = 0; i < n; i++ ) {
+      /* Shift to [-pi, pi], so sin(x) = -sin(y) and cos(x) = -cos(y). */
+      double y = x[i] - M_PI;
+      /* Fold into [-pi/2, pi/2] using sin(y) = sin(pi-y). */
+      double a = ( y > M_PI_2 ) ? M_PI - y : y;
+      a        = ( a < -M_PI_2 ) ? -M_PI - a : a;
+      s[i]     = -sin_poly( a );
+      /* cos(y) = sin(pi/2-|y|) which is already in [-pi/2, pi/2]. */
+      c[i] = -sin_poly( M_PI_2 - fabs( y ) );
+   }
+}
+
+/**
+ * @brief Symplectic Euler update of a batch of solids.
+ *
+ * Does exactly the same as the scalar Euler update in physics.c, except the
+ * direction sine and cosine are approximated with physics_sincosv().
+ *
+ *    @param n Number of solids.
+ *    @param dt Time step.
+ *    @param[in,out] px X positions.
+ *    @param[in,out] py Y positions.
+ *    @param[in,out] vx X velocities.
+ *    @param[in,out] vy Y velocities.
+ *    @param[in,out] dir Directions.
+ *    @param dir_vel Rotation velocities.
+ *    @param accel Accelerations.
+ *    @param s Scratch space for n sines.
+ *    @param c Scratch space for n cosines.
+ */
+void physics_eulerBatch( int n, double dt, double *restrict px,
+                         double *restrict py, double *restrict vx,
+                         double *restrict vy, double *restrict dir,
+                         const double *restrict dir_vel,
+                         const double *restrict accel, double *restrict s,
+                         double *restrict c )
+{
+   /* Make sure angle doesn't flip */
+   for ( int i = 0; i < n; i++ ) {
+      double d = dir[i] + dir_vel[i] * dt;
+      d        = ( d >= 2. * M_PI ) ? d - 2. * M_PI : d;
+      dir[i]   = ( d < 0. ) ? d + 2. * M_PI : d;
+   }
+
+   physics_sincosv( s, c, dir, n );
+
+   for ( int i = 0; i < n; i++ ) {
+      vx[i] += accel[i] * c[i] * dt;
+      vy[i] += accel[i] * s[i] * dt;
+      px[i] += vx[i] * dt;
+      py[i] += vy[i] * dt;
+   }
+}
@@ -0,0 +1,18 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/**
+ * @brief Maximum absolute error of physics_sincosv() for inputs in [0, 2*M_PI].
+ *
+ * Comes from truncating the Taylor series of the sine at the 13th degree
+ * after folding the argument into [-M_PI/2, M_PI/2], so the first omitted
+ * term bounds it: (M_PI/2)^15 / 15! ~= 6.7e-10.
+ */
+#define PHYSICS_SINCOS_ERR 7e-10
+
+void physics_sincosv( double *s, double *c, const double *x, int n );
+void physics_eulerBatch( int n, double dt, double *px, double *py, double *vx,
+                         double *vy, double *dir, const double *dir_vel,
+                         const double *accel, double *s, double *c );
@@ -19,6 +19,7 @@
 #include "array.h"
 #include "board.h"
 #include "camera.h"
+#include "conf.h"
 #include "damagetype.h"
 #include "debris.h"
 #include "debug.h"
@@ -51,9 +52,15 @@ static Pilot **pilot_stack =
             e.g. backup ships.) */
 static Quadtree pilot_quadtree; /**< Quadtree for the pilots. */
 static IntList  pilot_qtquery;  /**< Quadtree query. */
-static int      qt_init = 0;
+static int      qt_init       = 0;
+static int      pilot_qtvalid = 0; /**< Quadtree matches the stack. */
+static unsigned int *pilot_qtids =
+   NULL; /**< Array (array.h): Ids of the pilots the quadtree was built with,
+            by stack position. */
 /* A simple grid search procedure was used to determine the following
  * parameters. */
+static int pilot_lod = 0; /**< Whether to simulate idle pilots coarsely. */
+
 static int qt_max_elem = 2;
 static int qt_depth    = 5;
 
@@ -75,12 +82,13 @@ static void pilot_init( Pilot *dest, const Ship *ship, const char *name,
 static void pilot_hyperspace( Pilot *pilot, double dt );
 static void pilot_refuel( Pilot *p, double dt );
 static void pilot_updateSolid( Pilot *p, double dt );
+static int    pilot_lodEligible( const Pilot *p );
+static double pilot_lodStep( Pilot *p, double dt );
 /* Clean up. */
 static void pilot_erase( Pilot *p );
 /* Misc. */
 static void pilot_renderFramebufferBase( Pilot *p, GLuint fbo, double fw,
                                          double fh );
-static int  pilot_getStackPos( unsigned int id );
 static void pilot_init_trails( Pilot *p );
 static int  pilot_trail_generated( Pilot *p, int generator );
 
@@ -109,7 +117,7 @@ static int pilot_cmp( const void *ptr1, const void *ptr2 )
  *    @param id ID of the pilot to get.
  *    @return Position of pilot in stack or -1 if not found.
  */
-static int pilot_getStackPos( unsigned int id )
+int pilot_getStackPos( unsigned int id )
 {
    const Pilot  pid    = { .id = id };
    const Pilot *pidptr = &pid;
@@ -327,23 +335,14 @@ int pilot_validEnemy( const Pilot *p, const Pilot *target )
  */
 unsigned int pilot_getNearestEnemy( const Pilot *p )
 {
-   unsigned int tp = 0;
-   double       d  = 0.;
+   int                n;
+   const PilotSensed *sensed = pilot_sensed( p, &n );
 
-   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
-      double td;
-
-      if ( !pilot_validEnemy( p, pilot_stack[i] ) )
-         continue;
-
-      /* Check distance. */
-      td = vec2_dist2( &pilot_stack[i]->solid.pos, &p->solid.pos );
-      if ( !tp || ( td < d ) ) {
-         d  = td;
-         tp = pilot_stack[i]->id;
-      }
-   }
-   return tp;
+   /* Contacts are sorted by distance so the first valid one is the nearest. */
+   for ( int i = 0; i < n; i++ )
+      if ( pilot_validEnemy( p, sensed[i].p ) )
+         return sensed[i].p->id;
+   return 0;
 }
 
 /**
@@ -358,28 +357,21 @@ unsigned int pilot_getNearestEnemy( const Pilot *p )
 unsigned int pilot_getNearestEnemy_size( const Pilot *p, double target_mass_LB,
                                          double target_mass_UB )
 {
-   unsigned int tp = 0;
-   double       d  = 0.;
+   int                n;
+   const PilotSensed *sensed = pilot_sensed( p, &n );
 
-   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
-      double td;
+   for ( int i = 0; i < n; i++ ) {
+      const Pilot *target = sensed[i].p;
 
-      if ( !pilot_validEnemy( p, pilot_stack[i] ) )
+      if ( target->solid.mass < target_mass_LB ||
+           target->solid.mass > target_mass_UB )
          continue;
 
-      if ( pilot_stack[i]->solid.mass < target_mass_LB ||
-           pilot_stack[i]->solid.mass > target_mass_UB )
-         continue;
-
-      /* Check distance. */
-      td = vec2_dist2( &pilot_stack[i]->solid.pos, &p->solid.pos );
-      if ( !tp || ( td < d ) ) {
-         d  = td;
-         tp = pilot_stack[i]->id;
-      }
+      if ( pilot_validEnemy( p, target ) )
+         return target->id;
    }
 
-   return tp;
+   return 0;
 }
 
 /**
@@ -400,18 +392,20 @@ unsigned int pilot_getNearestEnemy_heuristic( const Pilot *p,
                                               double       damage_factor,
                                               double       range_factor )
 {
-   unsigned int tp                      = 0;
-   double       current_heuristic_value = 10e3;
+   unsigned int       tp                      = 0;
+   double             current_heuristic_value = 10e3;
+   int                n;
+   const PilotSensed *sensed = pilot_sensed( p, &n );
 
-   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
-      double temp;
-      Pilot *target = pilot_stack[i];
+   for ( int i = 0; i < n; i++ ) {
+      double       temp;
+      const Pilot *target = sensed[i].p;
 
       if ( !pilot_validEnemy( p, target ) )
          continue;
 
       /* Check distance. */
-      temp = range_factor * vec2_dist2( &target->solid.pos, &p->solid.pos ) +
+      temp = range_factor * sensed[i].dist2 +
              FABS( pilot_relsize( p, target ) - mass_factor ) +
              FABS( pilot_relhp( p, target ) - health_factor ) +
              FABS( pilot_reldps( p, target ) - damage_factor );
@@ -502,6 +496,43 @@ unsigned int pilot_getBoss( const Pilot *p )
    return t;
 }
 
+/**
+ * @brief Query used to find the nearest pilot to a position.
+ */
+typedef struct PilotNearest_ {
+   const Pilot *p;        /**< Pilot doing the query. */
+   double       x;        /**< X position to calculate from. */
+   double       y;        /**< Y position to calculate from. */
+   int          disabled; /**< Whether to return disabled pilots. */
+} PilotNearest;
+
+/**
+ * @brief Quadtree filter for pilot_getNearestPosPilot.
+ */
+static double pilot_nearestFilter( void *data, int id )
+{
+   const PilotNearest *pn = data;
+   const Pilot        *t = pilot_stack[id];
+
+   /* Must not be self. */
+   if ( t == pn->p )
+      return -1.;
+
+   /* Player doesn't select escorts (unless disabled is active). */
+   if ( !pn->disabled && pilot_isPlayer( pn->p ) && pilot_isWithPlayer( t ) )
+      return -1.;
+
+   /* Shouldn't be disabled. */
+   if ( !pn->disabled && pilot_isDisabled( t ) )
+      return -1.;
+
+   /* Must be a valid target. */
+   if ( !pilot_validTarget( pn->p, t ) )
+      return -1.;
+
+   return pow2( pn->x - t->solid.pos.x ) + pow2( pn->y - t->solid.pos.y );
+}
+
 /**
  * @brief Get the nearest pilot to a pilot from a certain position.
  *
@@ -515,36 +546,14 @@ unsigned int pilot_getBoss( const Pilot *p )
 double pilot_getNearestPosPilot( const Pilot *p, Pilot **tp, double x, double y,
                                  int disabled )
 {
-   double d = 0.;
-   *tp      = NULL;
-   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
-      double td;
-
-      /* Must not be self. */
-      if ( pilot_stack[i] == p )
-         continue;
-
-      /* Player doesn't select escorts (unless disabled is active). */
-      if ( !disabled && pilot_isPlayer( p ) &&
-           pilot_isWithPlayer( pilot_stack[i] ) )
-         continue;
-
-      /* Shouldn't be disabled. */
-      if ( !disabled && pilot_isDisabled( pilot_stack[i] ) )
-         continue;
-
-      /* Must be a valid target. */
-      if ( !pilot_validTarget( p, pilot_stack[i] ) )
-         continue;
-
-      /* Minimum distance. */
-      td = pow2( x - pilot_stack[i]->solid.pos.x ) +
-           pow2( y - pilot_stack[i]->solid.pos.y );
-      if ( ( ( *tp == NULL ) || ( td < d ) ) ) {
-         d   = td;
-         *tp = pilot_stack[i];
-      }
+   PilotNearest pn = { .p = p, .x = x, .y = y, .disabled = disabled };
+   double       d  = 0.;
+   int i = pilot_collideNearest( x, y, -1., pilot_nearestFilter, &pn, &d );
+   if ( i < 0 ) {
+      *tp = NULL;
+      return 0.;
    }
+   *tp = pilot_stack[i];
    return d;
 }
 
@@ -582,43 +591,41 @@ double pilot_getNearestPos( const Pilot *p, unsigned int *tp, double x,
 double pilot_getNearestAng( const Pilot *p, unsigned int *tp, double ang,
                             int disabled )
 {
-   double a = ang + M_PI;
+   double             a = ang + M_PI;
+   int                n;
+   const PilotSensed *sensed = pilot_sensed( p, &n );
 
+   /* Only sensed pilots can be in range. */
    *tp = PLAYER_ID;
-   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
-      double rx, ry, ta;
-      int    inrange;
+   for ( int i = 0; i < n; i++ ) {
+      double       rx, ry, ta;
+      const Pilot *t = sensed[i].p;
 
       /* Must not be self. */
-      if ( pilot_stack[i] == p )
+      if ( t == p )
          continue;
 
       /* Player doesn't select escorts (unless disabled is active). */
-      if ( !disabled && pilot_isPlayer( p ) &&
-           pilot_isWithPlayer( pilot_stack[i] ) )
+      if ( !disabled && pilot_isPlayer( p ) && pilot_isWithPlayer( t ) )
          continue;
 
       /* Shouldn't be disabled. */
-      if ( !disabled && pilot_isDisabled( pilot_stack[i] ) )
+      if ( !disabled && pilot_isDisabled( t ) )
          continue;
 
       /* Must be a valid target. */
-      if ( !pilot_validTargetRange( p, pilot_stack[i], &inrange ) )
-         continue;
-
-      /* Must be in range. */
-      if ( !inrange )
+      if ( !pilot_canTarget( t ) )
          continue;
 
       /* Only allow selection if off-screen. */
-      if ( gui_onScreenPilot( &rx, &ry, pilot_stack[i] ) )
+      if ( gui_onScreenPilot( &rx, &ry, t ) )
          continue;
 
-      ta = atan2( p->solid.pos.y - pilot_stack[i]->solid.pos.y,
-                  p->solid.pos.x - pilot_stack[i]->solid.pos.x );
+      ta = atan2( p->solid.pos.y - t->solid.pos.y,
+                  p->solid.pos.x - t->solid.pos.x );
       if ( ABS( angle_diff( ang, ta ) ) < ABS( angle_diff( ang, a ) ) ) {
          a   = ta;
-         *tp = pilot_stack[i]->id;
+         *tp = t->id;
       }
    }
    return a;
@@ -810,6 +817,90 @@ void pilot_collideQueryIL( IntList *il, int x1, int y1, int x2, int y2 )
    qt_query( &pilot_quadtree, il, x1, y1, x2, y2 );
 }
 
+/**
+ * @brief Filter used to check the quadtree still points at the same pilots.
+ */
+typedef struct PilotCollideNearest_ {
+   QtNearFunc *func; /**< Filter of the caller. */
+   void       *data; /**< User data of the caller. */
+} PilotCollideNearest;
+
+/**
+ * @brief Quadtree filter that skips ids no longer matching the stack.
+ */
+static double pilot_collideNearestFilter( void *data, int id )
+{
+   const PilotCollideNearest *cn = data;
+   if ( ( id >= array_size( pilot_qtids ) ) ||
+        ( id >= array_size( pilot_stack ) ) ||
+        ( pilot_stack[id]->id != pilot_qtids[id] ) )
+      return -1.;
+   return cn->func( cn->data, id );
+}
+
+/**
+ * @brief Gets the nearest pilot in the quadtree that passes a filter.
+ *
+ * If the stack changed since the quadtree was built, the stack is searched
+ * linearly instead.
+ *
+ *    @param x X position to look from.
+ *    @param y Y position to look from.
+ *    @param max_dist2 Maximum squared distance or negative for no limit.
+ *    @param func Filter that gets the position of a pilot in the stack and
+ * returns its squared distance, or a negative value to skip it.
+ *    @param data User data for the filter.
+ *    @param[out] dist2 Squared distance to the nearest pilot.
+ *    @return Position in the stack of the nearest pilot or -1 if none found.
+ */
+int pilot_collideNearest( double x, double y, double max_dist2,
+                          QtNearFunc *func, void *data, double *dist2 )
+{
+   double best;
+   int    id;
+
+   if ( pilot_qtvalid ) {
+      PilotCollideNearest cn = { .func = func, .data = data };
+      return qt_nearest( &pilot_quadtree, x, y, max_dist2,
+                         pilot_collideNearestFilter, &cn, dist2 );
+   }
+
+   /* Quadtree is stale, so do it the slow way. */
+   best = max_dist2;
+   id   = -1;
+   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
+      double d = func( data, i );
+      if ( ( d < 0. ) || ( ( best >= 0. ) && ( d > best ) ) )
+         continue;
+      best = d;
+      id   = i;
+   }
+   if ( ( id >= 0 ) && ( dist2 != NULL ) )
+      *dist2 = best;
+   return id;
+}
+
+/**
+ * @brief Marks the quadtree as not matching the pilot stack anymore.
+ *
+ * Quadtree elements are stack positions, so it can't be used once pilots are
+ * added or removed until it is rebuilt.
+ */
+void pilot_collideInvalidate( void )
+{
+   pilot_qtvalid = 0;
+}
+
+/**
+ * @brief Checks to see if the quadtree matches the pilot stack.
+ *
+ *    @return 1 if the quadtree can be used, 0 otherwise.
+ */
+int pilot_collideValid( void )
+{
+   return pilot_qtvalid;
+}
+
 /**
  * @brief Tries to turn the pilot to face dir.
  *
@@ -933,7 +1024,7 @@ void pilot_cooldown( Pilot *p, int dochecks )
 
    /* Disable active outfits. */
    if ( pilot_outfitOffAll( p ) > 0 )
-      pilot_calcStats( p );
+      pilot_calcStatsLayer( p, PILOT_STATS_OUTFITS );
 
    /* Calculate the ship's overall heat. */
    heat_capacity = p->heat_C;
@@ -1609,7 +1700,10 @@ void pilot_updateDisable( Pilot *p, unsigned int shooter )
       /* Clear other active states. */
       pilot_rmFlag( p, PILOT_COOLDOWN_BRAKE );
       pilot_rmFlag( p, PILOT_BRAKING );
-      pilot_rmFlag( p, PILOT_STEALTH );
+      if ( pilot_isFlag( p, PILOT_STEALTH ) ) {
+         pilot_rmFlag( p, PILOT_STEALTH );
+         pilot_sensorInvalidate( 0 );
+      }
 
       /* Clear hyperspace flags. */
       pilot_rmFlag( p, PILOT_HYP_PREP );
@@ -1632,7 +1726,7 @@ void pilot_updateDisable( Pilot *p, unsigned int shooter )
 
       /* Disable active outfits. */
       if ( pilot_outfitOffAll( p ) > 0 )
-         pilot_calcStats( p );
+         pilot_calcStatsLayer( p, PILOT_STATS_OUTFITS );
 
       pilot_setFlag( p, PILOT_DISABLED ); /* set as disabled */
       if ( pilot_isPlayer( p ) )
@@ -2621,17 +2715,19 @@ void pilot_update( Pilot *pilot, double dt )
    }
 
    /* Update effects. */
-   nchg += effect_update( &pilot->effects, dt );
+   if ( nchg > 0 )
+      pilot_calcStatsDefer( pilot, PILOT_STATS_OUTFITS );
+   if ( effect_update( &pilot->effects, dt ) > 0 )
+      pilot_calcStatsDefer( pilot, PILOT_STATS_EFFECTS );
    if ( pilot_isFlag( pilot, PILOT_DELETE ) )
       return; /* It's possible for effects to remove the pilot causing future
                  Lua to be unhappy. */
 
-   /* Must recalculate stats because something changed state. */
-   if ( nchg > 0 )
-      pilot_calcStats( pilot );
-
    /* purpose fallthrough to get the movement like disabled */
    if ( pilot_isDisabled( pilot ) || cooling ) {
+      /* Must recalculate stats if something changed state this frame. */
+      pilot_calcStatsFlush( pilot );
+
       /* Do the slow brake thing */
       pilot->solid.speed_max = 0.;
       pilot_setAccel( pilot, 0. );
@@ -2662,6 +2758,8 @@ void pilot_update( Pilot *pilot, double dt )
                        for the outfit to remove the pilot. */
          pilot->otimer -= PILOT_OUTFIT_LUA_UPDATE_DT;
       }
+      /* The Lua may have toggled outfits too. */
+      pilot_calcStatsFlush( pilot );
       return;
    }
 
@@ -2692,6 +2790,10 @@ void pilot_update( Pilot *pilot, double dt )
    /* Update weapons. */
    pilot_weapSetUpdate( pilot );
 
+   /* Must recalculate stats if something changed state this frame, including
+    * the weapon sets, before the speed and acceleration get used. */
+   pilot_calcStatsFlush( pilot );
+
    if ( !pilot_isFlag( pilot, PILOT_HYPERSPACE ) ) { /* limit the speed */
 
       /* pilot is afterburning */
@@ -2778,6 +2880,9 @@ void pilot_update( Pilot *pilot, double dt )
                     the outfit to remove the pilot. */
       pilot->otimer -= PILOT_OUTFIT_LUA_UPDATE_DT;
    }
+
+   /* The Lua may have toggled outfits too. */
+   pilot_calcStatsFlush( pilot );
 }
 
 /**
@@ -3277,6 +3382,7 @@ static void pilot_init( Pilot *pilot, const Ship *ship, const char *name,
    pilot->dockpilot    = dockpilot;
    pilot->parent = dockpilot; /* leader will default to mothership if exists. */
    pilot->dockslot = dockslot;
+   pilot->lod_step = -1.; /* Worked out when first updated. */
 
    /* Basic information. */
    pilot->ship = ship;
@@ -3487,6 +3593,7 @@ Pilot *pilot_create( const Ship *ship, const char *name, int faction,
 
    /* Set the pilot in the stack -- must be there before initializing */
    array_push_back( &pilot_stack, p );
+   pilot_sensorInvalidate( 1 );
 
    /* Load ship graphics. */
    ship_gfxLoad( (Ship *)ship ); /* TODO no casting. */
@@ -3599,6 +3706,7 @@ unsigned int pilot_addStack( Pilot *p )
    pilot_setFlag( p, PILOT_NOFREE );
 
    array_push_back( &pilot_stack, p );
+   pilot_sensorInvalidate( 1 );
 
    /* Load ship graphics. */
    ship_gfxLoad( (Ship *)p->ship ); /* TODO no casting. */
@@ -3653,6 +3761,7 @@ Pilot *pilot_setPlayer( Pilot *after )
    after->id = PLAYER_ID;
    qsort( pilot_stack, array_size( pilot_stack ), sizeof( Pilot * ),
           pilot_cmp );
+   pilot_sensorInvalidate( 1 );
 
    /* Load graphics if necessary. */
    ship_gfxLoad( (Ship *)after->ship );
@@ -3696,8 +3805,8 @@ void pilot_choosePoint( vec2 *vp, Spob **spob, JumpPoint **jump, int lf,
    *jump = NULL;
    vectnull( vp );
 
-   /* Build landable spob table. */
-   ind = array_create_size( int, array_size( cur_system->spobs ) );
+   /* Build landable spob table, in scratch memory of the frame. */
+   ind = array_create_frame( int, array_size( cur_system->spobs ) );
    for ( int i = 0; i < array_size( cur_system->spobs ); i++ ) {
       const Spob *pnt = cur_system->spobs[i];
       if ( spob_hasService( pnt, SPOB_SERVICE_INHABITED ) &&
@@ -3707,7 +3816,7 @@ void pilot_choosePoint( vec2 *vp, Spob **spob, JumpPoint **jump, int lf,
 
    /* Build jumpable jump table. */
    validJumpPoints =
-      array_create_size( JumpPoint *, array_size( cur_system->jumps ) );
+      array_create_frame( JumpPoint *, array_size( cur_system->jumps ) );
    if ( array_size( cur_system->jumps ) > 0 ) {
       for ( int i = 0; i < array_size( cur_system->jumps ); i++ ) {
          /* The jump into the system must not be exit-only, and unless
@@ -3792,10 +3901,6 @@ void pilot_choosePoint( vec2 *vp, Spob **spob, JumpPoint **jump, int lf,
       else if ( array_size( ind ) != 0 )
          *spob = cur_system->spobs[ind[RNG_BASE( 0, array_size( ind ) - 1 )]];
    }
-
-   /* Free memory allocated. */
-   array_free( ind );
-   array_free( validJumpPoints );
 }
 
 /**
@@ -3888,6 +3993,7 @@ static void pilot_erase( Pilot *p )
    int i = pilot_getStackPos( p->id );
    pilot_free( p );
    array_erase( &pilot_stack, &pilot_stack[i], &pilot_stack[i + 1] );
+   pilot_sensorInvalidate( 1 );
 }
 
 /**
@@ -3903,6 +4009,7 @@ void pilot_stackRemove( Pilot *p )
 #endif /* DEBUGGING */
    p->id = 0;
    array_erase( &pilot_stack, &pilot_stack[i], &pilot_stack[i + 1] );
+   pilot_sensorInvalidate( 1 );
 }
 
 /**
@@ -3912,6 +4019,7 @@ void pilots_init( void )
 {
    pilot_stack = array_create_size( Pilot *, PILOT_SIZE_MIN );
    il_create( &pilot_qtquery, 1 );
+   pilot_sensorInit();
 }
 
 /**
@@ -3943,6 +4051,10 @@ void pilots_free( void )
    /* Clean up quadtree. */
    qt_destroy( &pilot_quadtree );
    il_destroy( &pilot_qtquery );
+   array_free( pilot_qtids );
+   pilot_qtids   = NULL;
+   pilot_qtvalid = 0;
+   pilot_sensorFree();
 }
 
 /**
@@ -3994,6 +4106,7 @@ void pilots_clean( int persist )
    }
    array_erase( &pilot_stack, &pilot_stack[persist_count],
                 array_end( pilot_stack ) );
+   pilot_sensorInvalidate( 1 );
 
    /* Init AI on the remaining pilots, has to be done here so the pilot_stack is
     * consistent. */
@@ -4028,6 +4141,7 @@ void pilots_newSystem( void )
       qt_destroy( &pilot_quadtree );
    qt_create( &pilot_quadtree, -r, -r, r, r, qt_max_elem, qt_depth );
    qt_init = 1;
+   pilot_sensorInvalidate( 1 );
 
    NTracingZoneEnd( _ctx );
 }
@@ -4056,6 +4170,7 @@ void pilots_cleanAll( void )
    }
    array_erase( &pilot_stack, array_begin( pilot_stack ),
                 array_end( pilot_stack ) );
+   pilot_sensorInvalidate( 1 );
 }
 
 /**
@@ -4079,10 +4194,15 @@ void pilots_updatePurge( void )
 
    /* Second loop sets up quadtrees. */
    qt_clear( &pilot_quadtree ); /* Empty it. */
+   if ( pilot_qtids == NULL )
+      pilot_qtids = array_create( unsigned int );
+   array_resize( &pilot_qtids, array_size( pilot_stack ) );
    for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
       Pilot *p = pilot_stack[i];
       int    x, y, w2, h2, px, py;
 
+      pilot_qtids[i] = p->id;
+
       /* Ignore pilots being deleted. */
       if ( pilot_isFlag( p, PILOT_DELETE ) )
          continue;
@@ -4101,9 +4221,83 @@ void pilots_updatePurge( void )
                  MAX( x, px ) + w2, MAX( y, py ) + h2 );
    }
 
+   /* Sensor contacts are recomputed on demand with the new quadtree. */
+   pilot_qtvalid = 1;
+   pilot_sensorFrame();
+
    NTracingZoneEnd( _ctx );
 }
 
+/**
+ * @brief Sets whether or not idle pilots far from the player get simulated
+ * with larger time steps.
+ *
+ * Meant for time compression, where the update is chopped into many small
+ * steps, and for the simulation of a system before the player arrives.
+ *
+ *    @param enable Whether to enable the coarse simulation.
+ */
+void pilots_setLOD( int enable )
+{
+   pilot_lod = enable;
+}
+
+/**
+ * @brief Checks to see if a pilot can be simulated coarsely.
+ */
+static int pilot_lodEligible( const Pilot *p )
+{
+   if ( !pilot_lod || ( conf.lod_distance <= 0. ) || ( player.p == NULL ) )
+      return 0;
+
+   /* Player and friends always get full updates. */
+   if ( pilot_isPlayer( p ) || pilot_isWithPlayer( p ) ||
+        ( player.p->target == p->id ) )
+      return 0;
+
+   /* Anything going on needs full updates. */
+   if ( pilot_isFlag( p, PILOT_COMBAT ) || ( p->stimer > 0. ) ||
+        ( p->lockons > 0 ) || ( p->projectiles > 0 ) ||
+        pilot_isFlag( p, PILOT_MANUAL_CONTROL ) ||
+        pilot_isFlag( p, PILOT_HYP_PREP ) || pilot_isFlag( p, PILOT_HYP_END ) ||
+        pilot_isFlag( p, PILOT_BOARDING ) ||
+        pilot_isFlag( p, PILOT_REFUELBOARDING ) ||
+        pilot_isFlag( p, PILOT_LANDING ) || pilot_isFlag( p, PILOT_TAKEOFF ) )
+      return 0;
+
+   /* The player isn't in the system yet while it is being simulated. */
+   if ( space_isSimulation() )
+      return 1;
+
+   return ( vec2_dist2( &p->solid.pos, &player.p->solid.pos ) >
+            pow2( conf.lod_distance ) );
+}
+
+/**
+ * @brief Gets the time step of a pilot for the current update.
+ *
+ *    @param p Pilot to get time step of.
+ *    @param dt Time step of the update.
+ *    @return Time step to update the pilot with, or 0. to skip the pilot.
+ */
+static double pilot_lodStep( Pilot *p, double dt )
+{
+   /* Catch up on any time skipped while simulated coarsely. */
+   if ( !pilot_lodEligible( p ) ) {
+      dt += p->lod_dt;
+      p->lod_dt = 0.;
+      return dt;
+   }
+
+   /* Accumulate until a coarse step is due. */
+   p->lod_dt += dt;
+   if ( p->lod_dt < conf.lod_dt )
+      return 0.;
+   dt        = p->lod_dt;
+   p->lod_dt = 0.;
+   return dt;
+}
+
 /**
  * @brief Updates all the pilots.
  *
@@ -4114,10 +4308,24 @@ void pilots_update( double dt )
    NTracingZone( _ctx, 1 );
    NTracingPlotI( "pilots", array_size( pilot_stack ) );
 
+   /* Work out which pilots get updated and how much. */
+   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
+      Pilot *p    = pilot_stack[i];
+      p->lod_step = pilot_lodStep( p, dt );
+   }
+
    /* Have all the pilots think. */
    for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
       Pilot *p = pilot_stack[i];
 
+      /* Pilots added during the update haven't got a time step yet. */
+      if ( p->lod_step < 0. )
+         p->lod_step = pilot_lodStep( p, dt );
+
+      /* Being simulated coarsely. */
+      if ( p->lod_step <= 0. )
+         continue;
+
       /* Invisible, not doing anything. */
       if ( pilot_isFlag( p, PILOT_HIDE ) )
          continue;
@@ -4136,8 +4344,8 @@ void pilots_update( double dt )
       /* Hyperspace gets special treatment */
       if ( pilot_isFlag( p, PILOT_HYP_PREP ) ) {
          if ( !pilot_isFlag( p, PILOT_HYPERSPACE ) )
-            ai_think( p, dt, 0 );
-         pilot_hyperspace( p, dt );
+            ai_think( p, p->lod_step, 0 );
+         pilot_hyperspace( p, p->lod_step );
       }
       /* Entering hyperspace. */
       else if ( pilot_isFlag( p, PILOT_HYP_END ) ) {
@@ -4155,9 +4363,9 @@ void pilots_update( double dt )
                 /* Must not be jumping in. */
                 !pilot_isFlag( p, PILOT_HYP_END ) ) {
          if ( pilot_isFlag( p, PILOT_PLAYER ) )
-            player_think( p, dt );
+            player_think( p, p->lod_step );
          else
-            ai_think( p, dt, 1 );
+            ai_think( p, p->lod_step, 1 );
       }
    }
 
@@ -4173,11 +4381,19 @@ void pilots_update( double dt )
       if ( pilot_isFlag( p, PILOT_HIDE ) )
          continue;
 
+      /* Pilots added during the update haven't got a time step yet. */
+      if ( p->lod_step < 0. )
+         p->lod_step = pilot_lodStep( p, dt );
+
+      /* Being simulated coarsely. */
+      if ( p->lod_step <= 0. )
+         continue;
+
       /* Just update the pilot. */
       if ( pilot_isFlag( p, PILOT_PLAYER ) )
-         player_update( p, dt );
+         player_update( p, p->lod_step );
       else
-         pilot_update( p, dt );
+         pilot_update( p, p->lod_step );
    }
 
    NTracingZoneEnd( _ctx );
@@ -86,6 +86,14 @@ typedef enum PilotHookType_ {
    0.09                           /**< Point at which pilot becomes hostile. */
 #define PILOT_HOSTILE_DECAY 0.005 /**< Rate at which hostility decays. */
 
+/* Stat layers, see pilot_calcStats(). */
+#define PILOT_STATS_OUTFITS ( 1 << 0 ) /**< Outfit stats need recomputing. */
+#define PILOT_STATS_EFFECTS ( 1 << 1 ) /**< Effect stats need recomputing. */
+#define PILOT_STATS_PENDING                                                    \
+   ( 1 << 2 ) /**< Stats have to be recalculated before the next update. */
+#define PILOT_STATS_ALL                                                        \
+   ( PILOT_STATS_OUTFITS | PILOT_STATS_EFFECTS ) /**< All the layers. */
+
 /* Makes life easier */
 #define pilot_isPlayer( p )                                                    \
    pilot_isFlag( p, PILOT_PLAYER ) /**< Checks if pilot is a player. */
@@ -256,6 +264,18 @@ typedef struct Escort_s {
    int persist; /**< True if escort should respawn on takeoff/landing */
 } Escort_t;
 
+/**
+ * @brief Cached contribution of the outfits to the pilot's stats.
+ */
+typedef struct PilotStatsOutfits_ {
+   ShipStats stats;       /**< Stat delta of the outfits and intrinsics. */
+   int       cpu;         /**< CPU used by the outfits (negative). */
+   double    mass;        /**< Mass of the outfits, without their ammo. */
+   double    mass_core;   /**< Mass of the required outfits. */
+   double    energy_loss; /**< Energy loss of the active outfits. */
+   int       lupdate;     /**< Whether an outfit has a Lua update script. */
+} PilotStatsOutfits;
+
 /**
  * @brief The representation of an in-game pilot.
  */
@@ -345,6 +365,9 @@ typedef struct Pilot_ {
                                      on the fly. */
    ShipStats
       stats; /**< Pilot's copy of ship statistics, used for comparisons.. */
+   PilotStatsOutfits stats_outfits; /**< Stat layer of the outfits. */
+   ShipStats         stats_effects; /**< Stat layer of the effects. */
+   unsigned int      stats_dirty;   /**< Stat layers to recompute. */
 
    /* Ship effects. */
    Effect *effects; /**< Pilot's current activated effects. */
@@ -432,6 +455,8 @@ typedef struct Pilot_ {
    double     dtimer_accum;  /**< Accumulated disable timer. */
    double     otimer;        /**< Lua outfit timer. */
    double     scantimer;     /**< Electronic warfare scanning timer. */
+   double     lod_dt;        /**< Time accumulated while simulated coarsely. */
+   double     lod_step;      /**< Time step of the update, <0 if unset. */
    int        hail_pos;      /**< Hail animation position. */
    int    lockons; /**< Stores how many seeking weapons are targeting pilot */
    int    projectiles;   /**< Stores how many weapons are after the pilot */
@@ -455,6 +480,7 @@ typedef struct Pilot_ {
 /* Getting pilot stuff. */
 Pilot *const *pilot_getAll( void );
 Pilot        *pilot_get( unsigned int id );
+int           pilot_getStackPos( unsigned int id );
 Pilot        *pilot_getTarget( Pilot *p );
 unsigned int  pilot_getNextID( unsigned int id, int mode );
 unsigned int  pilot_getPrevID( unsigned int id, int mode );
@@ -545,6 +571,7 @@ void pilot_setTurn( Pilot *p, double turn );
 void pilot_update( Pilot *pilot, double dt );
 void pilots_updatePurge( void );
 void pilots_update( double dt );
+void pilots_setLOD( int enable );
 void pilot_renderFramebuffer( Pilot *p, GLuint fbo, double fw, double fh );
 void pilots_render( void );
 void pilots_renderOverlay( void );
@@ -585,4 +612,8 @@ void    pilot_untargetAsteroid( int anchor, int asteroid );
 PilotOutfitSlot *pilot_getDockSlot( Pilot *p );
 const IntList   *pilot_collideQuery( int x1, int y1, int x2, int y2 );
 void pilot_collideQueryIL( IntList *il, int x1, int y1, int x2, int y2 );
+int  pilot_collideNearest( double x, double y, double max_dist2,
+                           QtNearFunc *func, void *data, double *dist2 );
+void pilot_collideInvalidate( void );
+int  pilot_collideValid( void );
 void pilot_quadtreeParams( int max_elem, int depth );
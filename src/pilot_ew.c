@@ -8,6 +8,8 @@
  */
 /** @cond */
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "naev.h"
 /** @endcond */
@@ -21,6 +23,33 @@
 
 static double ew_interference = 1.; /**< Interference factor. */
 
+/**
+ * @brief Slice of the sensor contact pool belonging to one observer.
+ */
+typedef struct SensorNode_ {
+   unsigned int gen;   /**< Generation the slice was built at. */
+   int          start; /**< Offset of the first contact in sensor_pool. */
+   int          n;     /**< Number of contacts. */
+} SensorNode;
+
+/**
+ * @brief Above this radius the quadtree query is no better than a full scan.
+ */
+#define SENSOR_QT_MAX 1e7
+
+static unsigned int sensor_gen    = 1;  /**< Current sensor generation. */
+static unsigned int sensor_built  = 0;  /**< Generation of sensor_pool. */
+static double       sensor_maxsig = 0.; /**< Largest signature around. */
+static double       sensor_maxdet = 0.; /**< Largest detection around. */
+static double       sensor_slack  = 0.; /**< Furthest a pilot moves a frame. */
+static SensorNode  *sensor_nodes =
+   NULL; /**< Array (array.h): Observer slices, by stack position. */
+static PilotSensed *sensor_pool =
+   NULL; /**< Array (array.h): Contacts of all the observers. */
+static Pilot **sensor_omni =
+   NULL; /**< Array (array.h): Pilots that can be sensed from anywhere. */
+static IntList sensor_qtquery; /**< Quadtree query. */
+
 /*
  * Prototypes.
  */
@@ -91,6 +120,10 @@ static void pilot_ewUpdate( Pilot *p )
    p->ew_stealth =
       MAX( 1000., p->ew_mass * p->stats.ew_hide * 0.25 * p->stats.ew_stealth ) *
       p->ew_asteroid * ew_interference * p->ew_jumppoint;
+
+   /* Keep the sensor cache search radius an upper bound. */
+   sensor_maxsig = MAX( sensor_maxsig, p->ew_signature );
+   sensor_maxdet = MAX( sensor_maxdet, p->ew_detection );
 }
 
 /**
@@ -395,6 +428,221 @@ int pilot_inRangeJump( const Pilot *p, int i )
    return 0;
 }
 
+/**
+ * @brief Initializes the sensor cache.
+ */
+void pilot_sensorInit( void )
+{
+   sensor_nodes = array_create( SensorNode );
+   sensor_pool  = array_create( PilotSensed );
+   sensor_omni  = array_create( Pilot * );
+   il_create( &sensor_qtquery, 1 );
+}
+
+/**
+ * @brief Frees the sensor cache.
+ */
+void pilot_sensorFree( void )
+{
+   array_free( sensor_nodes );
+   array_free( sensor_pool );
+   array_free( sensor_omni );
+   sensor_nodes = NULL;
+   sensor_pool  = NULL;
+   sensor_omni  = NULL;
+   il_destroy( &sensor_qtquery );
+}
+
+/**
+ * @brief Starts a new sensor frame once the pilot quadtree has been rebuilt.
+ */
+void pilot_sensorFrame( void )
+{
+   pilot_sensorInvalidate( 0 );
+}
+
+/**
+ * @brief Throws away all the cached sensor contacts.
+ *
+ * Has to be called whenever something changes who can see who outside of the
+ * normal movement of pilots, such as stealth or visibility flags.
+ *
+ *    @param restack Whether or not the pilot stack itself changed, in which
+ * case the quadtree can not be used until the next frame.
+ */
+void pilot_sensorInvalidate( int restack )
+{
+   if ( ++sensor_gen == 0 )
+      sensor_gen = 1;
+   if ( restack )
+      pilot_collideInvalidate();
+}
+
+/**
+ * @brief Checks to see if a pilot can be sensed regardless of distance.
+ */
+static int pilot_sensorIsOmni( const Pilot *t )
+{
+   return ( pilot_isFlag( t, PILOT_VISPLAYER ) ||
+            pilot_isFlag( t, PILOT_VISIBLE ) || ( t->parent != 0 ) );
+}
+
+/**
+ * @brief Checks to see if a pilot can be sensed at all.
+ */
+static int pilot_sensorIsSensable( const Pilot *t )
+{
+   return ( !pilot_isFlag( t, PILOT_DELETE ) &&
+            !pilot_isFlag( t, PILOT_HIDE ) );
+}
+
+/**
+ * @brief Compares sensor contacts by distance.
+ */
+static int pilot_sensorCmp( const void *ptr1, const void *ptr2 )
+{
+   const PilotSensed *s1 = ptr1;
+   const PilotSensed *s2 = ptr2;
+   if ( s1->dist2 < s2->dist2 )
+      return -1;
+   else if ( s1->dist2 > s2->dist2 )
+      return +1;
+   return s1->p->id - s2->p->id;
+}
+
+/**
+ * @brief Clears the contact pool and gathers the per-generation data.
+ */
+static void pilot_sensorBegin( void )
+{
+   Pilot *const *pstk = pilot_getAll();
+   int           n    = array_size( pstk );
+
+   array_resize( &sensor_nodes, n );
+   memset( sensor_nodes, 0, n * sizeof( SensorNode ) );
+   array_erase( &sensor_pool, array_begin( sensor_pool ),
+                array_end( sensor_pool ) );
+   array_erase( &sensor_omni, array_begin( sensor_omni ),
+                array_end( sensor_omni ) );
+
+   /* Largest values bound the radius any pilot can be sensed at. They only
+    * grow during the frame, see pilot_ewUpdate. */
+   sensor_maxsig = 0.;
+   sensor_maxdet = 0.;
+   sensor_slack  = 0.;
+   for ( int i = 0; i < n; i++ ) {
+      Pilot *t = pstk[i];
+      double v;
+      if ( !pilot_sensorIsSensable( t ) )
+         continue;
+      sensor_maxsig = MAX( sensor_maxsig, t->ew_signature );
+      sensor_maxdet = MAX( sensor_maxdet, t->ew_detection );
+      /* Pilots may have moved since they were put in the quadtree. */
+      v = MAX( VMOD( t->solid.vel ),
+               solid_maxspeed( &t->solid, t->speed, t->accel ) );
+      sensor_slack = MAX( sensor_slack, v * MAX( 0., t->lod_step ) );
+      if ( pilot_sensorIsOmni( t ) )
+         array_push_back( &sensor_omni, t );
+   }
+
+   sensor_built = sensor_gen;
+}
+
+/**
+ * @brief Adds a pilot to the contacts of an observer if it can be sensed.
+ */
+static void pilot_sensorAdd( const Pilot *p, Pilot *t )
+{
+   PilotSensed s;
+   if ( !pilot_sensorIsSensable( t ) )
+      return;
+   s.inrange = pilot_inRangePilot( p, t, &s.dist2 );
+   if ( s.inrange == 0 )
+      return;
+   s.p = t;
+   array_push_back( &sensor_pool, s );
+}
+
+/**
+ * @brief Builds the contacts of an observer.
+ */
+static void pilot_sensorBuild( const Pilot *p, SensorNode *node )
+{
+   Pilot *const *pstk = pilot_getAll();
+   double        r;
+
+   /* Nothing can be further away than this and still be sensed. */
+   r = MAX( 0., p->stats.ew_detect * MAX( p->stats.ew_track * sensor_maxsig,
+                                          sensor_maxdet ) );
+
+   node->start = array_size( sensor_pool );
+   if ( pilot_collideValid() && ( r < SENSOR_QT_MAX ) ) {
+      int x  = round( p->solid.pos.x );
+      int y  = round( p->solid.pos.y );
+      int ir = ceil( r + sensor_slack );
+      pilot_collideQueryIL( &sensor_qtquery, x - ir, y - ir, x + ir, y + ir );
+      for ( int i = 0; i < il_size( &sensor_qtquery ); i++ ) {
+         Pilot *t = pstk[il_get( &sensor_qtquery, i, 0 )];
+         /* Added below so they don't get added twice. */
+         if ( pilot_sensorIsOmni( t ) )
+            continue;
+         pilot_sensorAdd( p, t );
+      }
+      for ( int i = 0; i < array_size( sensor_omni ); i++ )
+         pilot_sensorAdd( p, sensor_omni[i] );
+   } else {
+      for ( int i = 0; i < array_size( pstk ); i++ )
+         pilot_sensorAdd( p, pstk[i] );
+   }
+   node->n = array_size( sensor_pool ) - node->start;
+   qsort( &sensor_pool[node->start], node->n, sizeof( PilotSensed ),
+          pilot_sensorCmp );
+   node->gen = sensor_gen;
+}
+
+/**
+ * @brief Gets all the pilots a pilot can sense, nearest first.
+ *
+ * The contacts are computed once per frame with the same rules as
+ * pilot_inRangePilot and shared by the AI and Lua. They only include pilots
+ * that are in range (fuzzy or not), so callers still have to check that the
+ * pilots are valid targets for what they want to do.
+ *
+ * The contacts and the pilots they point to are only valid until the next
+ * call or until the pilot stack changes, so keep the pilot ids instead of the
+ * pointers to use them any later.
+ *
+ *    @param p Pilot to get contacts of.
+ *    @param[out] n Number of contacts.
+ *    @return The contacts.
+ */
+const PilotSensed *pilot_sensed( const Pilot *p, int *n )
+{
+   SensorNode *node;
+   int         pos = pilot_getStackPos( p->id );
+
+   /* Not on the stack, shouldn't really happen. */
+   if ( pos < 0 ) {
+      *n = 0;
+      return NULL;
+   }
+
+   if ( sensor_built != sensor_gen )
+      pilot_sensorBegin();
+   /* Pilots added this frame are not there yet. */
+   else if ( pos >= array_size( sensor_nodes ) ) {
+      pilot_sensorInvalidate( 1 );
+      pilot_sensorBegin();
+   }
+
+   node = &sensor_nodes[pos];
+   if ( node->gen != sensor_gen )
+      pilot_sensorBuild( p, node );
+
+   *n = node->n;
+   return &sensor_pool[node->start];
+}
+
 /**
  * @brief Calculates the weapon lead (1. is 100%, 0. is 0%)..
  *
@@ -558,6 +806,7 @@ int pilot_stealth( Pilot *p )
       pilot_rmFlag( p, PILOT_STEALTH );
       return 0;
    }
+   pilot_sensorInvalidate( 0 );
 
    /* Turn off all weapon sets. */
    pilot_weapSetAIClear( p );
@@ -585,6 +834,7 @@ void pilot_destealth( Pilot *p )
    if ( !pilot_isFlag( p, PILOT_STEALTH ) )
       return;
    pilot_rmFlag( p, PILOT_STEALTH );
+   pilot_sensorInvalidate( 0 );
    p->ew_stealth_timer = 0.;
    if ( !pilot_outfitLOnstealth( p ) )
       pilot_calcStats( p );
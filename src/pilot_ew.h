@@ -11,6 +11,15 @@
 #define EW_JUMPDETECT_DIST 7.5e3
 #define EW_SPOBDETECT_DIST 20e3 /* TODO something better than this. */
 
+/**
+ * @brief A pilot picked up by another pilot's sensors.
+ */
+typedef struct PilotSensed_ {
+   Pilot *p;       /**< Sensed pilot. */
+   double dist2;   /**< Squared distance to the sensed pilot. */
+   int    inrange; /**< Result of pilot_inRangePilot, either 1 or -1. */
+} PilotSensed;
+
 /*
  * Sensors and range.
  */
@@ -22,6 +31,15 @@ int    pilot_inRangeSpob( const Pilot *p, int target );
 int    pilot_inRangeAsteroid( const Pilot *p, int ast, int fie );
 int    pilot_inRangeJump( const Pilot *p, int target );
 
+/*
+ * Per-frame sensor cache.
+ */
+void               pilot_sensorInit( void );
+void               pilot_sensorFree( void );
+void               pilot_sensorFrame( void );
+void               pilot_sensorInvalidate( int restack );
+const PilotSensed *pilot_sensed( const Pilot *p, int *n );
+
 /*
  * Weapon tracking.
  */
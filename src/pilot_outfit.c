@@ -25,15 +25,34 @@
 #include "pilot.h"
 #include "player.h"
 #include "slots.h"
+#include "sound.h"
 #include "space.h"
 
+#define OUTFIT_DESC_CACHE 512 /**< Number of cached description extras. */
+
+/**
+ * @brief Cached result of running the Lua description extra of an outfit.
+ */
+typedef struct OutfitDescCache_ {
+   const Outfit *o;     /**< Outfit the description belongs to. */
+   uint64_t      key;   /**< Hash of the pilot state it was computed for. */
+   char         *extra; /**< Description extra, or NULL if there is none. */
+} OutfitDescCache;
+
 static int stealth_break = 0; /**< Whether or not to break stealth. */
+static OutfitDescCache
+   outfit_descCache[OUTFIT_DESC_CACHE]; /**< Description extra cache. */
 
 /*
  * Prototypes.
  */
-static void        pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot );
+static void        pilot_calcStatsSlotStats( ShipStats             *s,
+                                             const PilotOutfitSlot *slot );
+static void        pilot_calcStatsSlot( Pilot *pilot, PilotStatsOutfits *out,
+                                        PilotOutfitSlot *slot );
+static void        pilot_calcStatsUpdate( Pilot *pilot );
 static const char *outfitkeytostr( OutfitKey key );
+static void        pilot_outfitPrefetch( const Outfit *o );
 
 /**
  * @brief Updates the lockons on the pilot's launchers
@@ -339,9 +358,34 @@ int pilot_addOutfitRaw( Pilot *pilot, const Outfit *outfit, PilotOutfitSlot *s )
    /* Initialize if active thingy if necessary. */
    pilot_outfitLAdd( pilot, s );
 
+   /* Get the sounds ready before the outfit gets used. */
+   pilot_outfitPrefetch( outfit );
+
    return 0;
 }
 
+/**
+ * @brief Starts decoding the sounds of an outfit in the background.
+ */
+static void pilot_outfitPrefetch( const Outfit *o )
+{
+   if ( outfit_isBolt( o ) ) {
+      sound_prefetch( o->u.blt.sound );
+      sound_prefetch( o->u.blt.sound_hit );
+   } else if ( outfit_isBeam( o ) ) {
+      sound_prefetch( o->u.bem.sound_warmup );
+      sound_prefetch( o->u.bem.sound );
+      sound_prefetch( o->u.bem.sound_off );
+   } else if ( outfit_isLauncher( o ) ) {
+      sound_prefetch( o->u.lau.sound );
+      sound_prefetch( o->u.lau.sound_hit );
+   } else if ( outfit_isAfterburner( o ) ) {
+      sound_prefetch( o->u.afb.sound_on );
+      sound_prefetch( o->u.afb.sound );
+      sound_prefetch( o->u.afb.sound_off );
+   }
+}
+
 /**
  * @brief Tests to see if an outfit can be added.
  *
@@ -929,90 +973,282 @@ double pilot_outfitRange( const Pilot *p, const Outfit *o )
    return -1.;
 }
 
+/**
+ * @brief Merges the stats a pilot's slot provides.
+ */
+static void pilot_calcStatsSlotStats( ShipStats             *s,
+                                      const PilotOutfitSlot *slot )
+{
+   const Outfit *o = slot->outfit;
+
+   /* Outfit must exist. */
+   if ( o == NULL )
+      return;
+
+   /* Lua mods apply their stats. */
+   if ( slot->lua_mem != LUA_NOREF )
+      ss_statsMergeFromList( s, slot->lua_stats );
+
+   /* Active modifications and afterburners must be on to affect stuff. */
+   if ( ( outfit_isMod( o ) || outfit_isAfterburner( o ) ) &&
+        ( slot->flags & PILOTOUTFIT_ACTIVE ) &&
+        !( slot->state == PILOT_OUTFIT_ON ) )
+      return;
+
+   /* Add stats. */
+   ss_statsMergeFromList( s, o->stats );
+}
+
 /**
  * @brief Computes the stats for a pilot's slot.
  */
-static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot )
+static void pilot_calcStatsSlot( Pilot *pilot, PilotStatsOutfits *out,
+                                 PilotOutfitSlot *slot )
 {
    const Outfit *o = slot->outfit;
-   ShipStats    *s = &pilot->stats;
 
    /* Outfit must exist. */
    if ( o == NULL )
       return;
 
    /* Modify CPU. */
-   pilot->cpu += outfit_cpu( o );
+   out->cpu += outfit_cpu( o );
 
    /* Add mass. */
-   pilot->mass_outfit += o->mass;
+   out->mass += o->mass;
 
    /* Keep a separate counter for required (core) outfits. */
    if ( sp_required( o->slot.spid ) )
-      pilot->base_mass += o->mass;
-
-   /* Add ammo mass. */
-   if ( outfit_isLauncher( o ) )
-      pilot->mass_outfit += slot->u.ammo.quantity * o->u.lau.ammo_mass;
-   else if ( outfit_isFighterBay( o ) )
-      pilot->mass_outfit += slot->u.ammo.quantity * o->u.bay.ship_mass;
+      out->mass_core += o->mass;
 
    if ( outfit_isAfterburner( o ) ) /* Afterburner */
       pilot->afterburner = slot;    /* Set afterburner */
 
-   /* Lua mods apply their stats. */
-   if ( slot->lua_mem != LUA_NOREF )
-      ss_statsMergeFromList( &pilot->stats, slot->lua_stats );
-
    /* Has update function. */
    if ( o->lua_update != LUA_NOREF )
-      pilot->outfitlupdate = 1;
+      out->lupdate = 1;
 
    /* Apply modifications. */
-   if ( outfit_isMod( o ) ) { /* Modification */
-      /* Active outfits must be on to affect stuff. */
-      if ( ( slot->flags & PILOTOUTFIT_ACTIVE ) &&
-           !( slot->state == PILOT_OUTFIT_ON ) )
-         return;
-      /* Add stats. */
-      ss_statsMergeFromList( s, o->stats );
+   pilot_calcStatsSlotStats( &out->stats, slot );
 
-   } else if ( outfit_isAfterburner( o ) ) { /* Afterburner */
-      /* Active outfits must be on to affect stuff. */
-      if ( ( slot->flags & PILOTOUTFIT_ACTIVE ) &&
-           !( slot->state == PILOT_OUTFIT_ON ) )
-         return;
-      /* Add stats. */
-      ss_statsMergeFromList( s, o->stats );
+   /* Afterburners that are on also drain energy. */
+   if ( outfit_isAfterburner( o ) &&
+        ( !( slot->flags & PILOTOUTFIT_ACTIVE ) ||
+          ( slot->state == PILOT_OUTFIT_ON ) ) ) {
       pilot_setFlag(
          pilot,
          PILOT_AFTERBURNER ); /* We use old school flags for this still... */
-      pilot->energy_loss +=
-         pilot->afterburner->outfit->u.afb.energy; /* energy loss */
-   } else {
-      /* Always add stats for non mod/afterburners. */
-      ss_statsMergeFromList( s, o->stats );
+      out->energy_loss += o->u.afb.energy; /* energy loss */
    }
 }
 
+/**
+ * @brief Computes the stat layer of the outfits.
+ *
+ * Also includes the stats set by the ship's Lua and the intrinsic stats.
+ */
+static void pilot_calcStatsOutfits( Pilot *pilot, PilotStatsOutfits *out )
+{
+   memset( out, 0, sizeof( PilotStatsOutfits ) );
+   ss_statsInitDelta( &out->stats );
+   for ( int i = 0; i < array_size( pilot->outfit_intrinsic ); i++ )
+      pilot_calcStatsSlot( pilot, out, &pilot->outfit_intrinsic[i] );
+   for ( int i = 0; i < array_size( pilot->outfits ); i++ )
+      pilot_calcStatsSlot( pilot, out, pilot->outfits[i] );
+   ss_statsMergeFromList( &out->stats, pilot->ship_stats );
+   ss_statsMergeFromList( &out->stats, pilot->intrinsic_stats );
+}
+
+/**
+ * @brief Gets the mass of the ammo and fighters carried by a slot.
+ */
+static double pilot_calcStatsSlotAmmo( const PilotOutfitSlot *slot )
+{
+   const Outfit *o = slot->outfit;
+   if ( ( o == NULL ) ||
+        ( !outfit_isLauncher( o ) && !outfit_isFighterBay( o ) ) )
+      return 0.;
+   return slot->u.ammo.quantity * outfit_ammoMass( o );
+}
+
+/**
+ * @brief Gets the mass of the ammo and fighters carried by the pilot.
+ *
+ * Ammo changes all the time without the outfit layer getting recomputed, so it
+ * is kept out of the layer and added up on every recalculation instead.
+ */
+static double pilot_calcStatsAmmo( const Pilot *pilot )
+{
+   double mass = 0.;
+   for ( int i = 0; i < array_size( pilot->outfit_intrinsic ); i++ )
+      mass += pilot_calcStatsSlotAmmo( &pilot->outfit_intrinsic[i] );
+   for ( int i = 0; i < array_size( pilot->outfits ); i++ )
+      mass += pilot_calcStatsSlotAmmo( pilot->outfits[i] );
+   return mass;
+}
+
+/**
+ * @brief Applies the stat modifiers that don't belong to any layer.
+ */
+static void pilot_calcStatsTail( const Pilot *pilot, ShipStats *s )
+{
+   /* Apply system effects. */
+   ss_statsMergeFromList( s, cur_system->stats );
+
+   /* Apply stealth malus. */
+   if ( pilot_isFlag( pilot, PILOT_STEALTH ) ) {
+      s->accel_mod *= 0.8;
+      s->turn_mod *= 0.8;
+      s->speed_mod *= 0.5;
+   }
+}
+
+#ifdef DEBUG_PARANOID
+/**
+ * @brief Adds a slot to the full recompute of pilot_calcStatsCheck().
+ */
+static void pilot_calcStatsCheckSlot( ShipStats *s, int *cpu, double *mass,
+                                      double *mass_core,
+                                      const PilotOutfitSlot *slot )
+{
+   const Outfit *o = slot->outfit;
+   if ( o == NULL )
+      return;
+   *cpu += outfit_cpu( o );
+   *mass += o->mass + pilot_calcStatsSlotAmmo( slot );
+   if ( sp_required( o->slot.spid ) )
+      *mass_core += o->mass;
+   pilot_calcStatsSlotStats( s, slot );
+}
+
+/**
+ * @brief Checks the layered stats against merging everything from scratch.
+ *
+ * Catches places that change outfits, ammo or effects without marking their
+ * layer as dirty. Since ammo can change between recalculations, an effect
+ * expiring after some ammo was used is checked against the current ammo too.
+ */
+static void pilot_calcStatsCheck( const Pilot *pilot )
+{
+   ShipStats     s         = pilot->ship->stats_array;
+   int           cpu       = 0;
+   double        mass      = 0.;
+   double        mass_core = 0.;
+   ShipStatsType type;
+
+   if ( pilot_isPlayer( pilot ) )
+      difficulty_apply( &s );
+   for ( int i = 0; i < array_size( pilot->outfit_intrinsic ); i++ )
+      pilot_calcStatsCheckSlot( &s, &cpu, &mass, &mass_core,
+                                &pilot->outfit_intrinsic[i] );
+   for ( int i = 0; i < array_size( pilot->outfits ); i++ )
+      pilot_calcStatsCheckSlot( &s, &cpu, &mass, &mass_core,
+                                pilot->outfits[i] );
+   ss_statsMergeFromList( &s, pilot->ship_stats );
+   ss_statsMergeFromList( &s, pilot->intrinsic_stats );
+   effect_compute( &s, pilot->effects );
+   pilot_calcStatsTail( pilot, &s );
+
+   type = ss_statsDiff( &s, &pilot->stats, 1e-9 );
+   if ( type != SS_TYPE_NIL )
+      WARN( _( "Pilot '%s' has stat '%s' out of sync with a full recompute!" ),
+            pilot->name, ss_nameFromType( type ) );
+   if ( cpu != pilot->cpu )
+      WARN( _( "Pilot '%s' has CPU %d instead of %d from a full recompute!" ),
+            pilot->name, pilot->cpu, cpu );
+   if ( fabs( mass - pilot->mass_outfit ) > 1e-6 )
+      WARN( _( "Pilot '%s' has outfit mass %f instead of %f from a full "
+               "recompute!" ),
+            pilot->name, pilot->mass_outfit, mass );
+   if ( fabs( pilot->ship->mass + mass_core - pilot->base_mass ) > 1e-6 )
+      WARN( _( "Pilot '%s' has base mass %f instead of %f from a full "
+               "recompute!" ),
+            pilot->name, pilot->base_mass, pilot->ship->mass + mass_core );
+}
+#endif /* DEBUG_PARANOID */
+
 /**
  * @brief Recalculates the pilot's stats based on his outfits.
  *
+ * All the layers are recomputed, use pilot_calcStatsLayer() when it is known
+ * what changed.
+ *
  *    @param pilot Pilot to recalculate his stats.
  */
 void pilot_calcStats( Pilot *pilot )
 {
-   double     ac, sc, ec, tm; /* temporary health coefficients to set */
-   ShipStats *s;
+   pilot_calcStatsLayer( pilot, PILOT_STATS_ALL );
+}
+
+/**
+ * @brief Recalculates the pilot's stats, only recomputing some layers.
+ *
+ * The stats are kept in layers: the ship base, the outfits (along with the
+ * intrinsic stats) and the effects. Layers that didn't change are merged from
+ * their cached values instead of going over all their stat lists again.
+ *
+ *    @param pilot Pilot to recalculate stats of.
+ *    @param layers Layers that changed (PILOT_STATS_OUTFITS and/or
+ * PILOT_STATS_EFFECTS).
+ */
+void pilot_calcStatsLayer( Pilot *pilot, unsigned int layers )
+{
+   pilot->stats_dirty |= layers;
+   pilot_calcStatsUpdate( pilot );
+}
+
+/**
+ * @brief Marks layers as changed, recalculating the stats at the next update.
+ *
+ * Lets many changes in a frame, such as toggling outfits, get merged into a
+ * single recalculation by pilot_calcStatsFlush().
+ *
+ *    @param pilot Pilot to recalculate stats of.
+ *    @param layers Layers that changed.
+ */
+void pilot_calcStatsDefer( Pilot *pilot, unsigned int layers )
+{
+   pilot->stats_dirty |= layers | PILOT_STATS_PENDING;
+}
+
+/**
+ * @brief Recalculates the stats if there were deferred changes.
+ *
+ *    @param pilot Pilot to recalculate stats of.
+ */
+void pilot_calcStatsFlush( Pilot *pilot )
+{
+   if ( pilot->stats_dirty != 0 )
+      pilot_calcStatsUpdate( pilot );
+}
+
+/**
+ * @brief Recomputes the dirty stat layers and merges them.
+ */
+static void pilot_calcStatsUpdate( Pilot *pilot )
+{
+   double                   ac, sc, ec, tm; /* temporary health coefficients */
+   ShipStats               *s;
+   const PilotStatsOutfits *out = &pilot->stats_outfits;
+
+   /* Recompute the layers that changed. */
+   if ( pilot->stats_dirty & PILOT_STATS_OUTFITS )
+      pilot_calcStatsOutfits( pilot, &pilot->stats_outfits );
+   if ( pilot->stats_dirty & PILOT_STATS_EFFECTS ) {
+      ss_statsInitDelta( &pilot->stats_effects );
+      effect_compute( &pilot->stats_effects, pilot->effects );
+   }
+   pilot->stats_dirty = 0;
 
    /*
     * Set up the basic stuff
     */
    /* mass */
-   pilot->solid.mass = pilot->ship->mass;
-   pilot->base_mass  = pilot->solid.mass;
+   pilot->solid.mass  = pilot->ship->mass;
+   pilot->base_mass   = pilot->solid.mass + out->mass_core;
+   pilot->mass_outfit = out->mass + pilot_calcStatsAmmo( pilot );
    /* cpu */
-   pilot->cpu = 0.;
+   pilot->cpu = out->cpu;
    /* movement */
    pilot->accel_base = pilot->ship->accel;
    pilot->turn_base  = pilot->ship->turn;
@@ -1037,9 +1273,9 @@ void pilot_calcStats( Pilot *pilot )
    /* Energy. */
    pilot->energy_max   = pilot->ship->energy;
    pilot->energy_regen = pilot->ship->energy_regen;
-   pilot->energy_loss  = 0.; /* Initially no net loss. */
+   pilot->energy_loss  = out->energy_loss;
    /* Misc. */
-   pilot->outfitlupdate = 0;
+   pilot->outfitlupdate = out->lupdate;
    /* Stats. */
    s  = &pilot->stats;
    tm = s->time_mod;
@@ -1049,29 +1285,14 @@ void pilot_calcStats( Pilot *pilot )
    if ( pilot_isPlayer( pilot ) )
       difficulty_apply( s );
 
-   /* Now add outfit changes */
-   pilot->mass_outfit = 0.;
-   for ( int i = 0; i < array_size( pilot->outfit_intrinsic ); i++ )
-      pilot_calcStatsSlot( pilot, &pilot->outfit_intrinsic[i] );
-   for ( int i = 0; i < array_size( pilot->outfits ); i++ )
-      pilot_calcStatsSlot( pilot, pilot->outfits[i] );
-
-   /* Merge stats. */
-   ss_statsMergeFromList( &pilot->stats, pilot->ship_stats );
-   ss_statsMergeFromList( &pilot->stats, pilot->intrinsic_stats );
+   /* Merge the layers. */
+   ss_statsMergeDelta( s, &out->stats );
+   ss_statsMergeDelta( s, &pilot->stats_effects );
+   pilot_calcStatsTail( pilot, s );
 
-   /* Compute effects. */
-   effect_compute( &pilot->stats, pilot->effects );
-
-   /* Apply system effects. */
-   ss_statsMergeFromList( &pilot->stats, cur_system->stats );
-
-   /* Apply stealth malus. */
-   if ( pilot_isFlag( pilot, PILOT_STEALTH ) ) {
-      s->accel_mod *= 0.8;
-      s->turn_mod *= 0.8;
-      s->speed_mod *= 0.5;
-   }
+#ifdef DEBUG_PARANOID
+   pilot_calcStatsCheck( pilot );
+#endif /* DEBUG_PARANOID */
 
    /*
     * Absolute increases.
@@ -1283,7 +1504,7 @@ static void pilot_outfitLRun( Pilot *p,
    }
    /* Recalculate if anything changed. */
    if ( pilotoutfit_modified )
-      pilot_calcStats( p );
+      pilot_calcStatsLayer( p, PILOT_STATS_OUTFITS );
 }
 static void outfitLRunWarning( const Pilot *p, const Outfit *o,
                                const char *name, const char *error )
@@ -1322,13 +1543,80 @@ static void pilot_outfitLunmem( nlua_env env, int oldmem )
    luaL_unref( naevL, LUA_REGISTRYINDEX, oldmem );
 }
 
-static const char *pilot_outfitLDescExtra( const Pilot *p, const Outfit *o )
+/**
+ * @brief Hashes the state of a pilot that outfit descriptions may depend on.
+ */
+static uint64_t pilot_outfitDescHash( const Pilot *p )
 {
-   static char descextra[STRMAX];
-   const char *de;
+   const unsigned char *c;
+   uint64_t             h = 0xcbf29ce484222325ULL;
+
+   if ( p == NULL )
+      return h;
+
+#define DESC_HASH( ptr, size )                                                 \
+   do {                                                                        \
+      c = (const unsigned char *)( ptr );                                      \
+      for ( size_t _i = 0; _i < ( size ); _i++ ) {                             \
+         h ^= c[_i];                                                           \
+         h *= 0x100000001b3ULL;                                                \
+      }                                                                        \
+   } while ( 0 )
+   DESC_HASH( &p->id, sizeof( p->id ) );
+   DESC_HASH( &p->ship, sizeof( p->ship ) );
+   DESC_HASH( &p->stats, sizeof( p->stats ) );
+   for ( int i = 0; i < array_size( p->outfits ); i++ )
+      DESC_HASH( &p->outfits[i]->outfit, sizeof( p->outfits[i]->outfit ) );
+#undef DESC_HASH
+
+   return h;
+}
+
+/**
+ * @brief Clears the outfit description cache.
+ *
+ * Descriptions are cached per outfit and pilot state, but Lua descriptions can
+ * depend on other things, so this has to be called whenever the lists using
+ * pilot_outfitSummaryCached get rebuilt.
+ */
+void pilot_outfitDescCacheClear( void )
+{
+   for ( int i = 0; i < OUTFIT_DESC_CACHE; i++ ) {
+      free( outfit_descCache[i].extra );
+      outfit_descCache[i].extra = NULL;
+      outfit_descCache[i].o     = NULL;
+   }
+}
+
+/**
+ * @brief Gets the description extra of an outfit, running its Lua if needed.
+ *
+ *    @param p Pilot to get the description extra for (or NULL for no pilot).
+ *    @param o Outfit to get the description extra of.
+ *    @param cache Whether to use the description cache.
+ *    @return The description extra or NULL if there is none.
+ */
+static const char *pilot_outfitLDescExtra( const Pilot *p, const Outfit *o,
+                                           int cache )
+{
+   static char      descextra[STRMAX];
+   const char      *de;
+   uint64_t         key;
+   OutfitDescCache *dc;
    if ( o->lua_descextra == LUA_NOREF )
       return ( o->desc_extra != NULL ) ? _( o->desc_extra ) : NULL;
 
+   /* Try the cache first, since running Lua can be slow. */
+   key = pilot_outfitDescHash( p );
+   dc  = &outfit_descCache[( key ^ ( (uintptr_t)o * 0x9e3779b97f4a7c15ULL ) ) %
+                         OUTFIT_DESC_CACHE];
+   if ( cache && ( dc->o == o ) && ( dc->key == key ) ) {
+      if ( dc->extra == NULL )
+         return NULL;
+      strncpy( descextra, dc->extra, sizeof( descextra ) - 1 );
+      return descextra;
+   }
+
    /* Set up the function: init( p, po ) */
    lua_rawgeti( naevL, LUA_REGISTRYINDEX, o->lua_descextra ); /* f */
    if ( ( p != NULL ) && ( p->id > 0 ) ) /* Needs valid ID. */
@@ -1345,12 +1633,20 @@ static const char *pilot_outfitLDescExtra( const Pilot *p, const Outfit *o )
    /* Case no return we just pass nothing. */
    if ( lua_isnoneornil( naevL, -1 ) ) {
       lua_pop( naevL, 1 );
-      return NULL;
+      de = NULL;
+   } else {
+      de = luaL_checkstring( naevL, -1 );
+      strncpy( descextra, de, sizeof( descextra ) - 1 );
+      lua_pop( naevL, 1 );
+      de = descextra;
    }
-   de = luaL_checkstring( naevL, -1 );
-   strncpy( descextra, de, sizeof( descextra ) - 1 );
-   lua_pop( naevL, 1 );
-   return descextra;
+   if ( cache ) {
+      free( dc->extra );
+      dc->o     = o;
+      dc->key   = key;
+      dc->extra = ( de != NULL ) ? strdup( de ) : NULL;
+   }
+   return de;
 }
 
 /**
@@ -1365,7 +1661,7 @@ static const char *pilot_outfitLDescExtra( const Pilot *p, const Outfit *o )
 const char *pilot_outfitDescription( const Pilot *p, const Outfit *o )
 {
    static char o_description[STRMAX];
-   const char *de = pilot_outfitLDescExtra( p, o );
+   const char *de = pilot_outfitLDescExtra( p, o, 0 );
    if ( de == NULL )
       return _( o->desc_raw );
    snprintf( o_description, sizeof( o_description ), "%s\n%s", _( o->desc_raw ),
@@ -1374,19 +1670,12 @@ const char *pilot_outfitDescription( const Pilot *p, const Outfit *o )
 }
 
 /**
- * @brief Gets the summary of an outfit for a give pilot.
- *
- * Note: the returned string can get overwritten by subsequent calls.
- *
- *    @param p Pilot to get the outfit summary of (or NULL for no pilot).
- *    @param o Outfit to get summary of.
- *    @param withname Whether or not to show the name too.
- *    @return The summary of the outfit.
+ * @brief Puts together the summary of an outfit.
  */
-const char *pilot_outfitSummary( const Pilot *p, const Outfit *o, int withname )
+static const char *pilot_outfitSummaryExtra( const Outfit *o, const char *de,
+                                             int withname )
 {
    static char o_summary[STRMAX];
-   const char *de = pilot_outfitLDescExtra( p, o );
    if ( de == NULL ) {
       if ( withname )
          snprintf( o_summary, sizeof( o_summary ), "%s\n%s", _( o->name ),
@@ -1404,6 +1693,42 @@ const char *pilot_outfitSummary( const Pilot *p, const Outfit *o, int withname )
    return o_summary;
 }
 
+/**
+ * @brief Gets the summary of an outfit for a give pilot.
+ *
+ * Note: the returned string can get overwritten by subsequent calls.
+ *
+ *    @param p Pilot to get the outfit summary of (or NULL for no pilot).
+ *    @param o Outfit to get summary of.
+ *    @param withname Whether or not to show the name too.
+ *    @return The summary of the outfit.
+ */
+const char *pilot_outfitSummary( const Pilot *p, const Outfit *o, int withname )
+{
+   return pilot_outfitSummaryExtra( o, pilot_outfitLDescExtra( p, o, 0 ),
+                                    withname );
+}
+
+/**
+ * @brief Gets the summary of an outfit for a given pilot, using the cache.
+ *
+ * Only meant for the outfit image arrays, which clear the cache with
+ * pilot_outfitDescCacheClear when they are rebuilt. The Lua description
+ * extras can depend on things outside the pilot, such as the current system,
+ * so anything else should use pilot_outfitSummary.
+ *
+ *    @param p Pilot to get the outfit summary of (or NULL for no pilot).
+ *    @param o Outfit to get summary of.
+ *    @param withname Whether or not to show the name too.
+ *    @return The summary of the outfit.
+ */
+const char *pilot_outfitSummaryCached( const Pilot *p, const Outfit *o,
+                                       int withname )
+{
+   return pilot_outfitSummaryExtra( o, pilot_outfitLDescExtra( p, o, 1 ),
+                                    withname );
+}
+
 /**
  * @brief Runs the pilot's Lua outfits init script.
  *
@@ -21,6 +21,9 @@ typedef enum OutfitKey_ {
 const char *pilot_outfitDescription( const Pilot *pilot, const Outfit *o );
 const char *pilot_outfitSummary( const Pilot *p, const Outfit *o,
                                  int withname );
+const char *pilot_outfitSummaryCached( const Pilot *p, const Outfit *o,
+                                       int withname );
+void        pilot_outfitDescCacheClear( void );
 
 /* Raw changes. */
 int pilot_addOutfitRaw( Pilot *pilot, const Outfit *outfit,
@@ -64,6 +67,9 @@ void pilot_lockClear( Pilot *p );
 
 /* Other. */
 void             pilot_calcStats( Pilot *pilot );
+void             pilot_calcStatsLayer( Pilot *pilot, unsigned int layers );
+void             pilot_calcStatsDefer( Pilot *pilot, unsigned int layers );
+void             pilot_calcStatsFlush( Pilot *pilot );
 double           pilot_massFactor( const Pilot *pilot );
 void             pilot_updateMass( Pilot *pilot );
 void             pilot_healLanded( Pilot *pilot );
@@ -193,7 +193,7 @@ void pilot_weapSetUpdateOutfitState( Pilot *p )
       if ( pilot_isFlag( p, PILOT_STEALTH ) && ( non > 0 ) )
          pilot_destealth( p );
       else
-         pilot_calcStats( p );
+         pilot_calcStatsDefer( p, PILOT_STATS_OUTFITS );
    }
 }
 
@@ -300,7 +300,7 @@ void pilot_weapSetUpdate( Pilot *p )
       if ( pilot_isFlag( p, PILOT_STEALTH ) && ( n > 0 ) )
          pilot_destealth( p );
       else
-         pilot_calcStats( p );
+         pilot_calcStatsDefer( p, PILOT_STATS_OUTFITS );
 
       /* Firing stuff aborts active cooldown. */
       if ( pilot_isFlag( p, PILOT_COOLDOWN ) && ( nweap > 0 ) )
@@ -1637,7 +1637,7 @@ void pilot_afterburn( Pilot *p )
       p->afterburner->state  = PILOT_OUTFIT_ON;
       p->afterburner->stimer = outfit_duration( p->afterburner->outfit );
       pilot_setFlag( p, PILOT_AFTERBURNER );
-      pilot_calcStats( p );
+      pilot_calcStatsLayer( p, PILOT_STATS_OUTFITS );
       pilot_destealth( p ); /* No afterburning stealth. */
 
       /* @todo Make this part of a more dynamic activated outfit sound system.
@@ -1665,7 +1665,7 @@ void pilot_afterburnOver( Pilot *p )
    if ( p->afterburner->state == PILOT_OUTFIT_ON ) {
       p->afterburner->state = PILOT_OUTFIT_OFF;
       pilot_rmFlag( p, PILOT_AFTERBURNER );
-      pilot_calcStats( p );
+      pilot_calcStatsLayer( p, PILOT_STATS_OUTFITS );
 
       /* @todo Make this part of a more dynamic activated outfit sound system.
        */
@@ -930,6 +930,17 @@ static void player_initSound( void )
    snd_hypPowDown   = sound_get( "hyperspace_powerdown" );
    snd_hypPowUpJump = sound_get( "hyperspace_powerupjump" );
    snd_hypJump      = sound_get( "hyperspace_jump" );
+
+   /* Get them decoded before the player needs them. */
+   sound_prefetch( snd_target );
+   sound_prefetch( snd_jump );
+   sound_prefetch( snd_nav );
+   sound_prefetch( snd_hail );
+   sound_prefetch( snd_hypPowUp );
+   sound_prefetch( snd_hypEng );
+   sound_prefetch( snd_hypPowDown );
+   sound_prefetch( snd_hypPowUpJump );
+   sound_prefetch( snd_hypJump );
 }
 
 /**
@@ -3745,7 +3756,7 @@ static int player_runUpdaterScript( const char *type, const char *name, int q )
 
    /* Load env if necessary. */
    if ( player_updater_env == LUA_NOREF ) {
-      player_updater_env = nlua_newEnv();
+      player_updater_env = nlua_newEnv( "updater" );
       size_t bufsize;
       char  *buf = ndata_read( SAVE_UPDATER_PATH, &bufsize );
       if ( nlua_dobufenv( player_updater_env, buf, bufsize,
@@ -53,7 +53,7 @@ static int player_autonavSetup( void );
  */
 int player_autonavInit( void )
 {
-   nlua_env env = nlua_newEnv();
+   nlua_env env = nlua_newEnv( "autonav" );
    nlua_loadStandard( env );
    nlua_loadAI( env );
 
@@ -19,6 +19,7 @@
 
 #include "array.h"
 #include "log.h"
+#include "ndata.h"
 #include "nfile.h"
 #include "nxml.h"
 #include "physfs_archiver_blacklist.h"
@@ -198,6 +199,7 @@ int plugin_init( void )
       /* Remount. */
       for ( int i = n - 1; i >= 0; i-- ) /* Reverse order as we prepend. */
          PHYSFS_mount( plugins[i].mountpoint, NULL, 0 );
+      ndata_invalidate();
 
       if ( n > 0 ) {
          DEBUG( "Loaded plugins:" );
@@ -13,6 +13,7 @@
  * BY-SA 4.0: https://creativecommons.org/licenses/by-sa/4.0/
  */
 #include "quadtree.h"
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -229,6 +230,8 @@ void qt_create( Quadtree *qt, int x1, int y1, int x2, int y2, int max_elements,
    qt->max_depth    = max_depth;
    qt->temp         = NULL;
    qt->temp_size    = 0;
+   qt->near         = NULL;
+   qt->near_cap     = 0;
    il_create( &qt->nodes, node_num );
    il_create( &qt->elts, elt_num );
    il_create( &qt->enodes, enode_num );
@@ -266,6 +269,7 @@ void qt_destroy( Quadtree *qt )
    il_destroy( &qt->elts );
    il_destroy( &qt->enodes );
    free( qt->temp );
+   free( qt->near );
 }
 
 int qt_insert( Quadtree *qt, int id, int x1, int y1, int x2, int y2 )
@@ -384,6 +388,205 @@ void qt_query( Quadtree *qt, IntList *out, int qlft, int qtop, int qrgt,
    }
 }
 
+// Entry of the priority queue used by nearest neighbour queries. Nodes are
+// keyed by a lower bound of the distance to their elements, and elements by
+// their actual distance.
+struct QtNearItem {
+   double d;
+   int    node;   // Node index, or -1 for elements.
+   int    id;     // Element ID if this is an element.
+   int    mx, my, sx, sy;
+   int    border; // Which sides of the node lie on the tree's border.
+};
+
+enum {
+   near_lft = 1 << 0,
+   near_top = 1 << 1,
+   near_rgt = 1 << 2,
+   near_btm = 1 << 3,
+};
+
+static void near_push( Quadtree *qt, int *n, const QtNearItem *item )
+{
+   int i;
+   if ( *n >= qt->near_cap ) {
+      qt->near_cap = ( qt->near_cap > 0 ) ? 2 * qt->near_cap : 64;
+      qt->near     = realloc( qt->near, qt->near_cap * sizeof( *qt->near ) );
+   }
+
+   // Sift up.
+   i = ( *n )++;
+   while ( i > 0 ) {
+      const int parent = ( i - 1 ) >> 1;
+      if ( qt->near[parent].d <= item->d )
+         break;
+      qt->near[i] = qt->near[parent];
+      i           = parent;
+   }
+   qt->near[i] = *item;
+}
+
+static QtNearItem near_pop( Quadtree *qt, int *n )
+{
+   const QtNearItem top  = qt->near[0];
+   const QtNearItem last = qt->near[--( *n )];
+   int              i    = 0;
+
+   // Sift the last item down from the root.
+   while ( *n > 0 ) {
+      int c = 2 * i + 1;
+      if ( c >= *n )
+         break;
+      if ( c + 1 < *n && qt->near[c + 1].d < qt->near[c].d )
+         ++c;
+      if ( last.d <= qt->near[c].d )
+         break;
+      qt->near[i] = qt->near[c];
+      i           = c;
+   }
+   if ( *n > 0 )
+      qt->near[i] = last;
+   return top;
+}
+
+static double rect_dist2( double x, double y, double l, double t, double r,
+                          double b )
+{
+   const double dx = ( x < l ) ? l - x : ( ( x > r ) ? x - r : 0. );
+   const double dy = ( y < t ) ? t - y : ( ( y > b ) ? y - b : 0. );
+   return dx * dx + dy * dy;
+}
+
+static void near_push_node( Quadtree *qt, int *n, double x, double y,
+                            int node, int mx, int my, int sx, int sy,
+                            int border )
+{
+   QtNearItem item;
+   // Elements outside the tree extents end up in the nodes along the border,
+   // so those are unbounded on that side. The extra unit covers rounding of
+   // the child extents.
+   const double l = ( border & near_lft ) ? -HUGE_VAL : mx - sx - 1;
+   const double t = ( border & near_top ) ? -HUGE_VAL : my - sy - 1;
+   const double r = ( border & near_rgt ) ? HUGE_VAL : mx + sx + 1;
+   const double b = ( border & near_btm ) ? HUGE_VAL : my + sy + 1;
+
+   item.d      = rect_dist2( x, y, l, t, r, b );
+   item.node   = node;
+   item.id     = -1;
+   item.mx     = mx;
+   item.my     = my;
+   item.sx     = sx;
+   item.sy     = sy;
+   item.border = border;
+   near_push( qt, n, &item );
+}
+
+static int near_query( Quadtree *qt, IntList *out, double x, double y, int k,
+                       double max_dist2, QtNearFunc *func, void *user_data,
+                       double *dist2 )
+{
+   IntList   seen    = { 0 };
+   const int elt_cap = il_size( &qt->elts );
+   int       n       = 0;
+   int       found   = 0;
+
+   if ( qt->temp_size < elt_cap ) {
+      qt->temp_size = elt_cap;
+      qt->temp      = realloc( qt->temp, qt->temp_size * sizeof( *qt->temp ) );
+      memset( qt->temp, 0, qt->temp_size * sizeof( *qt->temp ) );
+   }
+
+   il_create( &seen, 1 );
+   near_push_node( qt, &n, x, y, 0, qt->root_mx, qt->root_my, qt->root_sx,
+                   qt->root_sy, near_lft | near_top | near_rgt | near_btm );
+   while ( n > 0 && found < k ) {
+      const QtNearItem item = near_pop( qt, &n );
+      if ( max_dist2 >= 0. && item.d > max_dist2 )
+         break;
+
+      // Elements come out in order of distance.
+      if ( item.node < 0 ) {
+         if ( out != NULL )
+            il_set( out, il_push_back( out ), 0, item.id );
+         if ( dist2 != NULL )
+            *dist2 = item.d;
+         ++found;
+         continue;
+      }
+
+      if ( il_get( &qt->nodes, item.node, node_idx_num ) != -1 ) {
+         // Measure the elements of the leaf not seen yet.
+         int elt_node_index = il_get( &qt->nodes, item.node, node_idx_fc );
+         while ( elt_node_index != -1 ) {
+            const int element =
+               il_get( &qt->enodes, elt_node_index, enode_idx_elt );
+            elt_node_index =
+               il_get( &qt->enodes, elt_node_index, enode_idx_next );
+            if ( qt->temp[element] )
+               continue;
+            qt->temp[element] = 1;
+            il_set( &seen, il_push_back( &seen ), 0, element );
+
+            QtNearItem eitem;
+            eitem.node = -1;
+            eitem.id   = il_get( &qt->elts, element, elt_idx_id );
+            if ( func != NULL )
+               eitem.d = func( user_data, eitem.id );
+            else {
+               const int lft = il_get( &qt->elts, element, elt_idx_lft );
+               const int top = il_get( &qt->elts, element, elt_idx_top );
+               const int rgt = il_get( &qt->elts, element, elt_idx_rgt );
+               const int btm = il_get( &qt->elts, element, elt_idx_btm );
+               eitem.d       = rect_dist2( x, y, lft, top, rgt, btm );
+            }
+            if ( eitem.d < 0. || ( max_dist2 >= 0. && eitem.d > max_dist2 ) )
+               continue;
+            near_push( qt, &n, &eitem );
+         }
+      } else {
+         // Otherwise queue up the children.
+         const int fc = il_get( &qt->nodes, item.node, node_idx_fc );
+         const int hx = item.sx >> 1, hy = item.sy >> 1;
+         const int l = item.mx - hx, t = item.my - hy, r = item.mx + hx,
+                   b = item.my + hy;
+         const int bd = item.border;
+         near_push_node( qt, &n, x, y, fc + 0, l, t, hx, hy,
+                         bd & ( near_lft | near_top ) );
+         near_push_node( qt, &n, x, y, fc + 1, r, t, hx, hy,
+                         bd & ( near_rgt | near_top ) );
+         near_push_node( qt, &n, x, y, fc + 2, l, b, hx, hy,
+                         bd & ( near_lft | near_btm ) );
+         near_push_node( qt, &n, x, y, fc + 3, r, b, hx, hy,
+                         bd & ( near_rgt | near_btm ) );
+      }
+   }
+
+   // Unmark the elements that were measured.
+   for ( int j = 0; j < il_size( &seen ); ++j )
+      qt->temp[il_get( &seen, j, 0 )] = 0;
+   il_destroy( &seen );
+   return found;
+}
+
+int qt_knn( Quadtree *qt, IntList *out, double x, double y, int k,
+            double max_dist2, QtNearFunc *func, void *user_data )
+{
+   il_clear( out );
+   return near_query( qt, out, x, y, k, max_dist2, func, user_data, NULL );
+}
+
+int qt_nearest( Quadtree *qt, double x, double y, double max_dist2,
+                QtNearFunc *func, void *user_data, double *dist2 )
+{
+   IntList out = { 0 };
+   int     id  = -1;
+   il_create( &out, 1 );
+   if ( near_query( qt, &out, x, y, 1, max_dist2, func, user_data, dist2 ) > 0 )
+      id = il_get( &out, 0, 0 );
+   il_destroy( &out );
+   return id;
+}
+
 void qt_cleanup( Quadtree *qt )
 {
    IntList to_process = { 0 };
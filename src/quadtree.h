@@ -16,7 +16,8 @@
 
 #include "intlist.h"
 
-typedef struct Quadtree Quadtree;
+typedef struct Quadtree   Quadtree;
+typedef struct QtNearItem QtNearItem;
 
 struct Quadtree {
    // Stores all the nodes in the quadtree. The first node in this
@@ -45,6 +46,12 @@ struct Quadtree {
 
    // Stores the size of the temporary buffer.
    int temp_size;
+
+   // Priority queue used for nearest neighbour queries.
+   QtNearItem *near;
+
+   // Stores the capacity of the priority queue.
+   int near_cap;
 };
 
 // Function signature used for traversing a tree node.
@@ -75,6 +82,26 @@ void qt_cleanup( Quadtree *qt );
 // Outputs a list of elements found in the specified rectangle.
 void qt_query( Quadtree *qt, IntList *out, int x1, int y1, int x2, int y2 );
 
+// Function signature used to filter and measure elements in nearest
+// neighbour queries. Returns the squared distance from the query point to the
+// element with the given ID, or a negative value to skip the element. The
+// distance must not be smaller than the distance to the element's rectangle,
+// which holds for any point inside it.
+typedef double QtNearFunc( void *user_data, int id );
+
+// Outputs the IDs of the (up to) k elements nearest to the specified point,
+// nearest first, by doing a best-first search over the nodes. Elements farther
+// than max_dist2 (squared) are ignored unless it's negative. If 'func' is NULL,
+// the distance to the element rectangles is used. Returns the number found.
+int qt_knn( Quadtree *qt, IntList *out, double x, double y, int k,
+            double max_dist2, QtNearFunc *func, void *user_data );
+
+// Returns the ID of the nearest element to the specified point as in qt_knn,
+// or -1 if there is none. The squared distance is stored in 'dist2' if not
+// NULL.
+int qt_nearest( Quadtree *qt, double x, double y, double max_dist2,
+                QtNearFunc *func, void *user_data, double *dist2 );
+
 // Traverses all the nodes in the tree, calling 'branch' for branch nodes and
 // 'leaf' for leaf nodes.
 void qt_traverse( Quadtree *qt, void *user_data, QtNodeFunc *branch,
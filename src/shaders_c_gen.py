@@ -71,10 +71,10 @@ SHADERS = [
    ),
    Shader(
       name = "trail",
-      vs_path = "project_pos.vert",
+      vs_path = "trail.vert",
       fs_path = "trail.frag",
-      attributes = ["vertex"],
-      uniforms = ["projection", "c1", "c2", "t1", "t2", "dt", "pos1", "pos2", "r", "nebu_col" ],
+      attributes = ["vertex", "vertex_pos", "vertex_colour", "vertex_time", "vertex_thick", "vertex_param"],
+      uniforms = ["projection", "nebu_col" ],
       subroutines = {
         "trail_func" : [
             "trail_default",
@@ -127,6 +127,14 @@ SHADERS = [
       uniforms = ["projection", "colour", "tex_mat", "sampler1", "sampler2", "inter"],
       subroutines = {},
    ),
+   Shader(
+      name = "texture_batch",
+      vs_path = "texture_batch.vert",
+      fs_path = "texture_batch.frag",
+      attributes = ["vertex", "tex_coord", "vertex_colour", "vertex_inter"],
+      uniforms = ["projection", "sampler1", "sampler2"],
+      subroutines = {},
+   ),
    Shader(
       name = "texturesdf",
       vs_path = "texturesdf.vert",
@@ -183,6 +191,14 @@ SHADERS = [
       uniforms = ["projection"],
       subroutines = {},
    ),
+   Shader(
+      name = "asteroidmarkers",
+      vs_path = "markers.vert",
+      fs_path = "asteroidmarkers.frag",
+      attributes = ["vertex", "vertex_colour"],
+      uniforms = ["projection", "size", "dimensions"],
+      subroutines = {},
+   ),
    Shader(
       name = "dust",
       vs_path = "dust.vert",
@@ -204,8 +220,8 @@ SHADERS = [
       name = "font",
       vs_path = "font.vert",
       fs_path = "font.frag",
-      attributes = ["vertex", "tex_coord"],
-      uniforms = ["projection", "m", "colour", "outline_colour"],
+      attributes = ["vertex", "tex_coord", "vertex_m", "vertex_colour"],
+      uniforms = ["outline_colour"],
       subroutines = {},
    ),
    Shader(
@@ -18,6 +18,7 @@
 #include "colour.h"
 #include "conf.h"
 #include "log.h"
+#include "nameindex.h"
 #include "ndata.h"
 #include "nlua.h"
 #include "nlua_camera.h"
@@ -54,6 +55,9 @@ typedef struct ShipThreadData_ {
 
 static Ship *ship_stack = NULL; /**< Stack of ships available in the game. */
 
+static NameIndex ship_index;      /**< Name index of ship_stack. */
+static NameIndex ship_index_case; /**< Case insensitive ship_index. */
+
 #define SHIP_FBO 3
 static double       max_size            = 0.;
 static double       ship_fbos           = 0.;
@@ -104,9 +108,8 @@ const Ship *ship_get( const char *name )
  */
 const Ship *ship_getW( const char *name )
 {
-   const Ship s = { .name = (char *)name };
-   return bsearch( &s, ship_stack, array_size( ship_stack ), sizeof( Ship ),
-                   ship_cmp );
+   int i = nameindex_get( &ship_index, name );
+   return ( i < 0 ) ? NULL : &ship_stack[i];
 }
 
 /**
@@ -114,10 +117,8 @@ const Ship *ship_getW( const char *name )
  */
 const char *ship_existsCase( const char *name )
 {
-   for ( int i = 0; i < array_size( ship_stack ); i++ )
-      if ( strcasecmp( name, ship_stack[i].name ) == 0 )
-         return ship_stack[i].name;
-   return NULL;
+   int i = nameindex_get( &ship_index_case, name );
+   return ( i < 0 ) ? NULL : ship_stack[i].name;
 }
 
 /**
@@ -1284,6 +1285,13 @@ int ships_load( void )
    /* Shrink stack. */
    array_shrink( &ship_stack );
 
+   /* The stack is frozen now, so index the names. */
+   nameindex_buildStruct( &ship_index, ship_stack, array_size( ship_stack ),
+                          sizeof( Ship ), offsetof( Ship, name ), 0 );
+   nameindex_buildStruct( &ship_index_case, ship_stack,
+                          array_size( ship_stack ), sizeof( Ship ),
+                          offsetof( Ship, name ), NAMEINDEX_CASE );
+
    /* Second pass to load Lua. */
    for ( int i = 0; i < array_size( ship_stack ); i++ ) {
       Ship *s = &ship_stack[i];
@@ -1301,7 +1309,7 @@ int ships_load( void )
          continue;
       }
 
-      env        = nlua_newEnv();
+      env        = nlua_newEnv( s->name );
       s->lua_env = env;
       /* TODO limit libraries here. */
       nlua_loadStandard( env );
@@ -1441,6 +1449,8 @@ void ships_free( void )
 
    array_free( ship_stack );
    ship_stack = NULL;
+   nameindex_free( &ship_index );
+   nameindex_free( &ship_index_case );
 }
 
 static void ship_freeSlot( ShipOutfitSlot *s )
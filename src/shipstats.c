@@ -562,6 +562,141 @@ int ss_statsMerge( ShipStats *dest, const ShipStats *src )
    return 0;
 }
 
+/**
+ * @brief Initializes a stat structure to be used as a delta.
+ *
+ * Stat lists merged into a delta accumulate their changes, which can then be
+ * applied to another stat structure with ss_statsMergeDelta(). Since relative
+ * stats are added and inverted ones are multiplied, this gives the same result
+ * as merging all the lists into the stat structure directly, barring rounding
+ * differences.
+ *
+ *    @param stats Stat structure to initialize.
+ *    @return 0 on success.
+ */
+int ss_statsInitDelta( ShipStats *stats )
+{
+   char *ptr;
+
+   memset( stats, 0, sizeof( ShipStats ) );
+
+   ptr = (char *)stats;
+   for ( int i = 0; i < SS_TYPE_SENTINEL; i++ ) {
+      const ShipStatsLookup *sl = &ss_lookup[i];
+      double                *dbl;
+
+      if ( ( sl->name == NULL ) || ( sl->data != SS_DATA_TYPE_DOUBLE ) ||
+           !sl->inverted )
+         continue;
+
+      /* Inverted stats are multiplicative, see ss_adjustDoubleStat(). */
+      dbl  = (double *)(void *)&ptr[sl->offset];
+      *dbl = 1.0;
+   }
+
+   return 0;
+}
+
+/**
+ * @brief Applies a delta built with ss_statsInitDelta() to a stat structure.
+ *
+ *    @param dest Stat structure to modify.
+ *    @param delta Delta to apply.
+ *    @return 0 on success.
+ */
+int ss_statsMergeDelta( ShipStats *dest, const ShipStats *delta )
+{
+   char       *destptr = (char *)dest;
+   const char *srcptr  = (const char *)delta;
+
+   for ( int i = 0; i < SS_TYPE_SENTINEL; i++ ) {
+      const ShipStatsLookup *sl = &ss_lookup[i];
+      double                *destdbl;
+      const double          *srcdbl;
+      int                   *destint;
+      const int             *srcint;
+
+      if ( sl->name == NULL )
+         continue;
+
+      switch ( sl->data ) {
+      case SS_DATA_TYPE_DOUBLE:
+         destdbl = (double *)(void *)&destptr[sl->offset];
+         srcdbl  = (const double *)(const void *)&srcptr[sl->offset];
+         if ( sl->inverted )
+            *destdbl *= *srcdbl;
+         else
+            *destdbl += *srcdbl;
+         break;
+
+      case SS_DATA_TYPE_DOUBLE_ABSOLUTE:
+      case SS_DATA_TYPE_DOUBLE_ABSOLUTE_PERCENT:
+         destdbl = (double *)(void *)&destptr[sl->offset];
+         srcdbl  = (const double *)(const void *)&srcptr[sl->offset];
+         *destdbl += *srcdbl;
+         break;
+
+      case SS_DATA_TYPE_INTEGER:
+         destint = (int *)&destptr[sl->offset];
+         srcint  = (const int *)&srcptr[sl->offset];
+         *destint += *srcint;
+         break;
+
+      case SS_DATA_TYPE_BOOLEAN:
+         destint  = (int *)&destptr[sl->offset];
+         srcint   = (const int *)&srcptr[sl->offset];
+         *destint = !!( ( *destint ) + ( *srcint ) );
+         break;
+      }
+   }
+
+   return 0;
+}
+
+/**
+ * @brief Looks for a difference between two stat structures.
+ *
+ *    @param a Stat structure to compare.
+ *    @param b Stat structure to compare with.
+ *    @param tol Relative tolerance for floating point stats.
+ *    @return The first stat that differs or SS_TYPE_NIL if they match.
+ */
+ShipStatsType ss_statsDiff( const ShipStats *a, const ShipStats *b, double tol )
+{
+   const char *aptr = (const char *)a;
+   const char *bptr = (const char *)b;
+
+   for ( int i = 0; i < SS_TYPE_SENTINEL; i++ ) {
+      const ShipStatsLookup *sl = &ss_lookup[i];
+      double                 da, db;
+      int                    ia, ib;
+
+      if ( sl->name == NULL )
+         continue;
+
+      switch ( sl->data ) {
+      case SS_DATA_TYPE_DOUBLE:
+      case SS_DATA_TYPE_DOUBLE_ABSOLUTE:
+      case SS_DATA_TYPE_DOUBLE_ABSOLUTE_PERCENT:
+         memcpy( &da, &aptr[sl->offset], sizeof( double ) );
+         memcpy( &db, &bptr[sl->offset], sizeof( double ) );
+         if ( FABS( da - db ) > tol * MAX( 1., MAX( FABS( da ), FABS( db ) ) ) )
+            return sl->type;
+         break;
+
+      case SS_DATA_TYPE_INTEGER:
+      case SS_DATA_TYPE_BOOLEAN:
+         memcpy( &ia, &aptr[sl->offset], sizeof( int ) );
+         memcpy( &ib, &bptr[sl->offset], sizeof( int ) );
+         if ( ia != ib )
+            return sl->type;
+         break;
+      }
+   }
+
+   return SS_TYPE_NIL;
+}
+
 /**
  * @brief Modifies a stat structure using a single element.
  *
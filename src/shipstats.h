@@ -356,6 +356,10 @@ void          ss_free( ShipStatList *ll );
  */
 int ss_statsInit( ShipStats *stats );
 int ss_statsMerge( ShipStats *dest, const ShipStats *src );
+int ss_statsInitDelta( ShipStats *stats );
+int ss_statsMergeDelta( ShipStats *dest, const ShipStats *delta );
+ShipStatsType ss_statsDiff( const ShipStats *a, const ShipStats *b,
+                            double tol );
 int ss_statsMergeSingle( ShipStats *stats, const ShipStatList *list );
 int ss_statsMergeSingleScale( ShipStats *stats, const ShipStatList *list,
                               double scale );
@@ -13,8 +13,9 @@
  *    source - openal object that plays sound
  *    voice - virtual object that wants to play sound
  *
- * 1) First we allocate all the buffers based on what we find inside the
- * datafile.
+ * 1) First we register all the sounds we find inside the datafile. They only
+ * get decoded into buffers when first played or when prefetched in the
+ * background with sound_prefetch().
  * 2) Then we allocate all the possible sources (giving the music system
  * what it needs).
  * 3) Now we allow the user to dynamically create voices, these voices will
@@ -46,11 +47,14 @@
 #include "camera.h"
 #include "conf.h"
 #include "log.h"
+#include "md5.h"
 #include "music.h"
 #include "ndata.h"
+#include "nfile.h"
 #include "nlua_spfx.h"
 #include "nopenal.h"
 #include "pilot.h"
+#include "threadpool.h"
 
 #define SOUND_FADEOUT 100
 #define SOUND_VOICES                                                           \
@@ -59,21 +63,59 @@
 
 #define SOUND_SUFFIX_WAV ".wav" /**< Suffix of sounds. */
 #define SOUND_SUFFIX_OGG ".ogg" /**< Suffix of sounds. */
+#define SOUND_CACHE_VERSION                                                    \
+   1 /**< Version of the decoded sound cache, bump when the format changes. */
 
 #define voiceLock() SDL_LockMutex( voice_mutex )
 #define voiceUnlock() SDL_UnlockMutex( voice_mutex )
 
+/**
+ * @brief Loading state of a sound.
+ */
+typedef enum SoundLoad_ {
+   SOUND_LOAD_NONE,    /**< Not loaded yet. */
+   SOUND_LOAD_QUEUED,  /**< Being decoded in the background. */
+   SOUND_LOAD_DECODED, /**< Decoded, waiting to be uploaded to OpenAL. */
+   SOUND_LOAD_DONE,    /**< Buffer is ready to play. */
+   SOUND_LOAD_FAILED,  /**< Failed to load. */
+} SoundLoad;
+
+/**
+ * @brief Decoded PCM data of a sound.
+ */
+typedef struct alSoundData_ {
+   void  *data;     /**< PCM samples. */
+   size_t len;      /**< Length of the samples in bytes. */
+   int    freq;     /**< Sample rate. */
+   int    channels; /**< Number of channels. */
+   int    bits;     /**< Bits per sample. */
+   int    wav;      /**< Whether data has to be freed with SDL_FreeWAV. */
+} alSoundData;
+
+/**
+ * @brief Header of the decoded sound cache files.
+ */
+typedef struct alSoundCacheHeader_ {
+   uint32_t version;  /**< SOUND_CACHE_VERSION. */
+   int32_t  freq;     /**< Sample rate. */
+   int32_t  channels; /**< Number of channels. */
+   int32_t  bits;     /**< Bits per sample. */
+   uint64_t len;      /**< Length of the samples in bytes. */
+} alSoundCacheHeader;
+
 /**
  * @struct alSound
  *
  * @brief Contains a sound buffer.
  */
 typedef struct alSound_ {
-   char  *filename; /**< Name of the file loaded from. */
-   char  *name;     /**< Buffer's name. */
-   double length;   /**< Length of the buffer. */
-   int    channels; /**< Number of channels of the buffer. */
-   ALuint buf;      /**< Buffer data. */
+   char       *filename; /**< Name of the file loaded from. */
+   char       *name;     /**< Buffer's name. */
+   double      length;   /**< Length of the buffer. */
+   int         channels; /**< Number of channels of the buffer. */
+   ALuint      buf;      /**< Buffer data. */
+   SoundLoad   load;     /**< Loading state, protected by sound_loadLock. */
+   alSoundData pcm;      /**< Data decoded in the background. */
 } alSound;
 
 /**
@@ -134,6 +176,11 @@ static int sound_initialized = 0; /**< Whether or not sound is initialized. */
  * Sound list.
  */
 static alSound *sound_list = NULL; /**< List of available sounds. */
+static SDL_mutex *sound_loadLock =
+   NULL; /**< Lock for the loading state of the sounds. */
+static SDL_cond *sound_loadCond =
+   NULL; /**< Signalled when a sound is done decoding. */
+static int sound_nloading = 0; /**< Sounds being decoded in the background. */
 
 /*
  * Voices.
@@ -156,6 +203,8 @@ static double snd_compression_gain = 0.; /**< Current compression gain. */
 /* General. */
 static int  sound_makeList( void );
 static void sound_free( alSound *snd );
+static int  sound_load( int sound );
+static int  sound_loadWorker( void *data );
 /* Voices. */
 
 /*
@@ -217,11 +266,16 @@ static int         al_enableEFX( void );
 /*
  * General.
  */
-static int al_playVoice( alVoice *v, alSound *s, ALfloat px, ALfloat py,
-                         ALfloat vx, ALfloat vy, ALint relative );
-static int al_load( alSound *snd, SDL_RWops *rw, const char *name );
-static int al_loadWav( ALuint *buf, SDL_RWops *rw );
-static int al_loadOgg( ALuint *buf, OggVorbis_File *vf );
+static int  al_playVoice( alVoice *v, alSound *s, ALfloat px, ALfloat py,
+                          ALfloat vx, ALfloat vy, ALint relative );
+static int  al_load( alSound *snd, SDL_RWops *rw, const char *name );
+static int  al_decode( alSoundData *sd, SDL_RWops *rw, const char *name );
+static int  al_decodeFile( alSoundData *sd, const char *filename );
+static int  al_decodeWav( alSoundData *sd, SDL_RWops *rw );
+static int  al_decodeOgg( alSoundData *sd, OggVorbis_File *vf );
+static void al_upload( ALuint *buf, const alSoundData *sd );
+static void al_setSound( alSound *snd, alSoundData *sd, const char *name );
+static void al_freeData( alSoundData *sd );
 /*
  * Pausing.
  */
@@ -635,6 +689,8 @@ int sound_init( void )
       WARN( _( "Unable to create voice mutex." ) );
 
    /* Load available sounds. */
+   sound_loadLock = SDL_CreateMutex();
+   sound_loadCond = SDL_CreateCond();
    sound_makeList();
 
    /* Set volume. */
@@ -656,6 +712,7 @@ int sound_init( void )
 
    /* Load compression noise. */
    snd_compression = sound_get( "compression" );
+   sound_prefetch( snd_compression );
    if ( snd_compression >= 0 ) {
       snd_compressionG = sound_createGroup( 1 );
       sound_speedGroup( snd_compressionG, 0 );
@@ -673,6 +730,12 @@ void sound_exit( void )
    if ( sound_disabled || !sound_initialized )
       return;
 
+   /* Wait for sounds being decoded. */
+   SDL_LockMutex( sound_loadLock );
+   while ( sound_nloading > 0 )
+      SDL_CondWait( sound_loadCond, sound_loadLock );
+   SDL_UnlockMutex( sound_loadLock );
+
    if ( voice_mutex != NULL ) {
       voiceLock();
       /* free the voices. */
@@ -747,6 +810,10 @@ void sound_exit( void )
    soundUnlock();
 
    SDL_DestroyMutex( sound_lock );
+   SDL_DestroyMutex( sound_loadLock );
+   SDL_DestroyCond( sound_loadCond );
+   sound_loadLock = NULL;
+   sound_loadCond = NULL;
 
    /* Sound is done. */
    sound_initialized = 0;
@@ -771,6 +838,108 @@ int sound_get( const char *name )
    return -1;
 }
 
+/**
+ * @brief Starts decoding a sound in the background if it isn't loaded.
+ *
+ * Use as a hint for sounds that are likely to be played soon, so that they
+ * don't have to be decoded when played.
+ *
+ *    @param sound Sound to prefetch.
+ */
+void sound_prefetch( int sound )
+{
+   int queue = 0;
+
+   if ( sound_disabled )
+      return;
+
+   if ( ( sound < 0 ) || ( sound >= array_size( sound_list ) ) )
+      return;
+
+   SDL_LockMutex( sound_loadLock );
+   if ( sound_list[sound].load == SOUND_LOAD_NONE ) {
+      sound_list[sound].load = SOUND_LOAD_QUEUED;
+      sound_nloading++;
+      queue = 1;
+   }
+   SDL_UnlockMutex( sound_loadLock );
+
+   if ( queue )
+      threadpool_run( sound_loadWorker, (void *)(intptr_t)sound );
+}
+
+/**
+ * @brief Decodes a sound in the background.
+ */
+static int sound_loadWorker( void *data )
+{
+   int         sound = (intptr_t)data;
+   alSoundData sd;
+   char       *filename;
+   int         ret;
+
+   /* The list can be reallocated, so only access it with the lock. */
+   SDL_LockMutex( sound_loadLock );
+   filename = strdup( sound_list[sound].filename );
+   SDL_UnlockMutex( sound_loadLock );
+
+   ret = al_decodeFile( &sd, filename );
+   free( filename );
+
+   /* Uploading is left for the main thread. */
+   SDL_LockMutex( sound_loadLock );
+   sound_list[sound].pcm  = sd;
+   sound_list[sound].load = ( ret == 0 ) ? SOUND_LOAD_DECODED
+                                         : SOUND_LOAD_FAILED;
+   sound_nloading--;
+   SDL_CondBroadcast( sound_loadCond );
+   SDL_UnlockMutex( sound_loadLock );
+
+   return ret;
+}
+
+/**
+ * @brief Makes sure a sound is loaded, decoding it if necessary.
+ *
+ *    @param sound Sound to load.
+ *    @return 0 if the sound can be played.
+ */
+static int sound_load( int sound )
+{
+   alSound    *s = &sound_list[sound];
+   alSoundData sd;
+   SoundLoad   load;
+   int         ret;
+
+   /* Already loaded, only the main thread changes the state from here. */
+   if ( s->load == SOUND_LOAD_DONE )
+      return 0;
+
+   /* Wait for it if it's being prefetched. */
+   SDL_LockMutex( sound_loadLock );
+   while ( s->load == SOUND_LOAD_QUEUED )
+      SDL_CondWait( sound_loadCond, sound_loadLock );
+   load = s->load;
+   sd   = s->pcm;
+   memset( &s->pcm, 0, sizeof( alSoundData ) );
+   SDL_UnlockMutex( sound_loadLock );
+
+   if ( load == SOUND_LOAD_FAILED )
+      return -1;
+
+   /* Not prefetched, so we have to decode it now. */
+   ret = 0;
+   if ( load == SOUND_LOAD_NONE )
+      ret = al_decodeFile( &sd, s->filename );
+   if ( ret == 0 )
+      al_setSound( s, &sd, s->name );
+
+   SDL_LockMutex( sound_loadLock );
+   s->load = ( ret == 0 ) ? SOUND_LOAD_DONE : SOUND_LOAD_FAILED;
+   SDL_UnlockMutex( sound_loadLock );
+   return ret;
+}
+
 /**
  * @brief Gets the length of the sound buffer.
  *
@@ -782,6 +951,9 @@ double sound_getLength( int sound )
    if ( sound_disabled )
       return 0.;
 
+   if ( sound_load( sound ) )
+      return 0.;
+
    return sound_list[sound].length;
 }
 
@@ -802,6 +974,9 @@ int sound_play( int sound )
    if ( ( sound < 0 ) || ( sound >= array_size( sound_list ) ) )
       return -1;
 
+   if ( sound_load( sound ) )
+      return -1;
+
    /* Gets a new voice. */
    v = voice_new();
 
@@ -860,6 +1035,9 @@ int sound_playPos( int sound, double px, double py, double vx, double vy )
          return 0;
    }
 
+   if ( sound_load( sound ) )
+      return -1;
+
    /* Gets a new voice. */
    v = voice_new();
 
@@ -1209,6 +1387,7 @@ static int sound_makeList( void )
 {
    char **files;
    int    suflen;
+   char   path[PATH_MAX];
 
    if ( sound_disabled )
       return 0;
@@ -1219,13 +1398,12 @@ static int sound_makeList( void )
    /* Create the list. */
    sound_list = array_create( alSound );
 
-   /* load the profiles */
+   /* Only register the sounds, they get decoded when needed. */
    suflen = strlen( SOUND_SUFFIX_WAV );
    for ( size_t i = 0; files[i] != NULL; i++ ) {
-      int        len;
-      char       path[PATH_MAX];
-      SDL_RWops *rw;
-      int        flen = strlen( files[i] );
+      int      len;
+      alSound *snd;
+      int      flen = strlen( files[i] );
 
       /* Must be longer than suffix. */
       if ( flen < suflen )
@@ -1238,21 +1416,25 @@ static int sound_makeList( void )
              0 ) )
          continue;
 
-      /* Load the sound. */
       snprintf( path, sizeof( path ), SOUND_PATH "%s", files[i] );
-      rw = PHYSFSRWOPS_openRead( path );
 
       /* remove the suffix */
       len           = flen - suflen;
       files[i][len] = '\0';
 
-      source_newRW( rw, files[i], 0 );
-      SDL_RWclose( rw );
+      snd = &array_grow( &sound_list );
+      memset( snd, 0, sizeof( alSound ) );
+      snd->filename = strdup( path );
+      snd->name     = strdup( files[i] );
    }
 
-   DEBUG( n_( "Loaded %d Sound", "Loaded %d Sounds", array_size( sound_list ) ),
+   DEBUG( n_( "Found %d Sound", "Found %d Sounds", array_size( sound_list ) ),
           array_size( sound_list ) );
 
+   /* Decoded sounds get cached here. */
+   snprintf( path, sizeof( path ), "%s/%s", nfile_cachePath(), "sounds/" );
+   nfile_dirMakeExist( path );
+
    /* Clean up. */
    PHYSFS_freeList( files );
 
@@ -1319,8 +1501,11 @@ static void sound_free( alSound *snd )
    /* Free general stuff. */
    free( snd->name );
    free( snd->filename );
+   al_freeData( &snd->pcm );
 
    /* Free internals. */
+   if ( snd->load != SOUND_LOAD_DONE )
+      return;
    soundLock();
 
    alDeleteBuffers( 1, &snd->buf );
@@ -1417,6 +1602,9 @@ int sound_playGroup( int group, int sound, int once )
    if ( ( sound < 0 ) || ( sound >= array_size( sound_list ) ) )
       return -1;
 
+   if ( sound_load( sound ) )
+      return -1;
+
    s = &sound_list[sound];
    for ( int i = 0; i < al_ngroups; i++ ) {
       alGroup_t *g;
@@ -1805,12 +1993,17 @@ int source_newRW( SDL_RWops *rw, const char *name, unsigned int flags )
    ret = al_load( &snd, rw, name );
    if ( ret )
       return -1;
+   snd.load = SOUND_LOAD_DONE;
 
+   /* Background decoding may be accessing the list. */
+   SDL_LockMutex( sound_loadLock );
    sndl = &array_grow( &sound_list );
    memcpy( sndl, &snd, sizeof( alSound ) );
    sndl->name = strdup( name );
+   ret        = sndl - sound_list;
+   SDL_UnlockMutex( sound_loadLock );
 
-   return sndl - sound_list;
+   return ret;
 }
 
 /**
@@ -1865,19 +2058,17 @@ static alGroup_t *al_getGroup( int group )
 }
 
 /**
- * @brief Loads a wav file from the rw if possible.
- *
- * @note Closes the rw.
+ * @brief Decodes a wav file from the rw if possible.
  *
- *    @param buf Buffer to load wav into.
+ *    @param[out] sd Decoded data.
  *    @param rw Data for the wave.
  */
-static int al_loadWav( ALuint *buf, SDL_RWops *rw )
+static int al_decodeWav( alSoundData *sd, SDL_RWops *rw )
 {
    SDL_AudioSpec wav_spec;
    Uint32        wav_length;
    Uint8        *wav_buffer;
-   ALenum        format;
+   int           bits;
 
    SDL_RWseek( rw, 0, SEEK_SET );
 
@@ -1891,33 +2082,29 @@ static int al_loadWav( ALuint *buf, SDL_RWops *rw )
    switch ( wav_spec.format ) {
    case AUDIO_U8:
    case AUDIO_S8:
-      format = ( wav_spec.channels == 1 ) ? AL_FORMAT_MONO8 : AL_FORMAT_STEREO8;
+      bits = 8;
       break;
    case AUDIO_U16LSB:
    case AUDIO_S16LSB:
-      format =
-         ( wav_spec.channels == 1 ) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+      bits = 16;
       break;
    case AUDIO_U16MSB:
    case AUDIO_S16MSB:
       WARN( _( "Big endian WAVs unsupported!" ) );
+      SDL_FreeWAV( wav_buffer );
       return -1;
    default:
       WARN( _( "Invalid WAV format!" ) );
+      SDL_FreeWAV( wav_buffer );
       return -1;
    }
 
-   /* Load into openal. */
-   soundLock();
-   /* Create new buffer. */
-   alGenBuffers( 1, buf );
-   /* Put into the buffer. */
-   alBufferData( *buf, format, wav_buffer, wav_length, wav_spec.freq );
-   al_checkErr();
-   soundUnlock();
-
-   /* Clean up. */
-   SDL_FreeWAV( wav_buffer );
+   sd->data     = wav_buffer;
+   sd->len      = wav_length;
+   sd->freq     = wav_spec.freq;
+   sd->channels = wav_spec.channels;
+   sd->bits     = bits;
+   sd->wav      = 1;
    return 0;
 }
 
@@ -1995,18 +2182,17 @@ void rg_filter( float **pcm, long channels, long samples, void *filter_param )
 }
 
 /**
- * @brief Loads an ogg file from a tested format if possible.
+ * @brief Decodes an ogg file from a tested format if possible.
  *
- *    @param buf Buffer to load ogg into.
+ *    @param[out] sd Decoded data.
  *    @param vf Vorbisfile containing the song.
  */
-static int al_loadOgg( ALuint *buf, OggVorbis_File *vf )
+static int al_decodeOgg( alSoundData *sd, OggVorbis_File *vf )
 {
    int               ret;
    long              i;
    int               section;
    vorbis_info      *info;
-   ALenum            format;
    ogg_int64_t       len;
    char             *data;
    long              bytes_read;
@@ -2024,9 +2210,8 @@ static int al_loadOgg( ALuint *buf, OggVorbis_File *vf )
    }
 
    /* Get file information. */
-   info   = ov_info( vf, -1 );
-   format = ( info->channels == 1 ) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
-   len    = ov_pcm_total( vf, -1 ) * info->channels * sizeof( short );
+   info = ov_info( vf, -1 );
+   len  = ov_pcm_total( vf, -1 ) * info->channels * sizeof( short );
 
    /* Replaygain information. */
    vc            = ov_comment( vf, -1 );
@@ -2058,36 +2243,38 @@ static int al_loadOgg( ALuint *buf, OggVorbis_File *vf )
       i += bytes_read;
    }
 
-   soundLock();
-   /* Create new buffer. */
-   alGenBuffers( 1, buf );
-   /* Put into buffer. */
-   alBufferData( *buf, format, data, len, info->rate );
-   al_checkErr();
-   soundUnlock();
+   sd->data     = data;
+   sd->len      = len;
+   sd->freq     = info->rate;
+   sd->channels = info->channels;
+   sd->bits     = 16;
+   sd->wav      = 0;
 
    /* Clean up. */
-   free( data );
    ov_clear( vf );
 
    return 0;
 }
 
 /**
- * @brief Loads the sound.
+ * @brief Decodes a sound.
  *
- *    @param buf Buffer to load.
+ * Doesn't use OpenAL so it can be run from any thread.
+ *
+ *    @param[out] sd Decoded data.
  *    @param rw File to load from.
  *    @param name Name for debugging purposes.
  */
-int sound_al_buffer( ALuint *buf, SDL_RWops *rw, const char *name )
+static int al_decode( alSoundData *sd, SDL_RWops *rw, const char *name )
 {
    int            ret;
    OggVorbis_File vf;
 
+   memset( sd, 0, sizeof( alSoundData ) );
+
    /* Check to see if it's an Ogg. */
    if ( ov_test_callbacks( rw, &vf, NULL, 0, sound_al_ovcall_noclose ) == 0 )
-      ret = al_loadOgg( buf, &vf );
+      ret = al_decodeOgg( sd, &vf );
 
    /* Otherwise try WAV. */
    else {
@@ -2095,60 +2282,236 @@ int sound_al_buffer( ALuint *buf, SDL_RWops *rw, const char *name )
       ov_clear( &vf );
 
       /* Try to load Wav. */
-      ret = al_loadWav( buf, rw );
+      ret = al_decodeWav( sd, rw );
    }
 
    /* Failed to load. */
-   if ( ret != 0 ) {
+   if ( ret != 0 )
       WARN( _( "Failed to load sound file '%s'." ), name );
-      return ret;
-   }
 
-   soundLock();
+   return ret;
+}
 
-   /* Check for errors. */
-   al_checkErr();
+/**
+ * @brief Gets the path of the decoded cache file of a sound.
+ *
+ * Keyed by path, size and modification time, so changed files get decoded
+ * again.
+ */
+static char *al_cacheFile( const char *filename )
+{
+   PHYSFS_Stat stat;
+   md5_state_t md5;
+   md5_byte_t  key[16];
+   char        digest[33];
+   char       *path;
 
-   soundUnlock();
+   if ( !PHYSFS_stat( filename, &stat ) )
+      return NULL;
+
+   md5_init( &md5 );
+   md5_append( &md5, (const md5_byte_t *)filename, strlen( filename ) );
+   md5_append( &md5, (const md5_byte_t *)&stat.filesize,
+               sizeof( stat.filesize ) );
+   md5_append( &md5, (const md5_byte_t *)&stat.modtime,
+               sizeof( stat.modtime ) );
+   md5_finish( &md5, key );
+   for ( int i = 0; i < 16; i++ )
+      snprintf( &digest[i * 2], 3, "%02x", key[i] );
+
+   SDL_asprintf( &path, "%ssounds/%s", nfile_cachePath(), digest );
+   return path;
+}
+
+/**
+ * @brief Tries to load decoded samples from the cache.
+ */
+static int al_cacheRead( alSoundData *sd, const char *cachefile )
+{
+   alSoundCacheHeader hdr;
+   char              *data;
+   size_t             size;
+
+   if ( !nfile_fileExists( cachefile ) )
+      return -1;
+   data = nfile_readFile( &size, cachefile );
+   if ( data == NULL )
+      return -1;
 
+   /* Consider cached data invalid if the header doesn't match. */
+   if ( size < sizeof( hdr ) ) {
+      free( data );
+      return -1;
+   }
+   memcpy( &hdr, data, sizeof( hdr ) );
+   if ( ( hdr.version != SOUND_CACHE_VERSION ) ||
+        ( hdr.len != size - sizeof( hdr ) ) ) {
+      free( data );
+      return -1;
+   }
+
+   /* Reuse the memory for the samples. */
+   memmove( data, &data[sizeof( hdr )], hdr.len );
+   sd->data     = data;
+   sd->len      = hdr.len;
+   sd->freq     = hdr.freq;
+   sd->channels = hdr.channels;
+   sd->bits     = hdr.bits;
+   sd->wav      = 0;
    return 0;
 }
 
 /**
- * @brief Loads the sound.
+ * @brief Saves decoded samples to the cache.
+ */
+static void al_cacheWrite( const alSoundData *sd, const char *cachefile )
+{
+   alSoundCacheHeader hdr;
+   char              *data;
+
+   memset( &hdr, 0, sizeof( hdr ) );
+   hdr.version  = SOUND_CACHE_VERSION;
+   hdr.freq     = sd->freq;
+   hdr.channels = sd->channels;
+   hdr.bits     = sd->bits;
+   hdr.len      = sd->len;
+
+   data = malloc( sizeof( hdr ) + sd->len );
+   memcpy( data, &hdr, sizeof( hdr ) );
+   memcpy( &data[sizeof( hdr )], sd->data, sd->len );
+   nfile_writeFile( data, sizeof( hdr ) + sd->len, cachefile );
+   free( data );
+}
+
+/**
+ * @brief Decodes a sound file from ndata.
  *
- *    @param snd Sound to load.
- *    @param rw File to load from.
- *    @param name Name for debugging purposes.
+ * Ogg files are slow to decode, so their samples are cached on disk. Can be
+ * run from any thread.
+ *
+ *    @param[out] sd Decoded data.
+ *    @param filename Path of the file in ndata.
+ *    @return 0 on success.
  */
-int al_load( alSound *snd, SDL_RWops *rw, const char *name )
+static int al_decodeFile( alSoundData *sd, const char *filename )
 {
-   ALint freq, bits, channels, size;
-   int   ret = sound_al_buffer( &snd->buf, rw, name );
-   if ( ret != 0 ) {
-      WARN( _( "Failed to load sound file '%s'." ), name );
-      return ret;
+   SDL_RWops *rw;
+   char      *cachefile = NULL;
+   int        ret, ogg;
+
+   memset( sd, 0, sizeof( alSoundData ) );
+
+   /* WAV files are already PCM, so no point in caching them. */
+   ogg = ( strstr( filename, SOUND_SUFFIX_OGG ) != NULL );
+   if ( ogg ) {
+      cachefile = al_cacheFile( filename );
+      if ( ( cachefile != NULL ) && ( al_cacheRead( sd, cachefile ) == 0 ) ) {
+         free( cachefile );
+         return 0;
+      }
    }
 
+   rw = PHYSFSRWOPS_openRead( filename );
+   if ( rw == NULL ) {
+      WARN( _( "Failed to open sound file '%s'." ), filename );
+      free( cachefile );
+      return -1;
+   }
+   ret = al_decode( sd, rw, filename );
+   SDL_RWclose( rw );
+
+   if ( ( ret == 0 ) && ( cachefile != NULL ) )
+      al_cacheWrite( sd, cachefile );
+   free( cachefile );
+
+   return ret;
+}
+
+/**
+ * @brief Uploads decoded samples to a new OpenAL buffer.
+ */
+static void al_upload( ALuint *buf, const alSoundData *sd )
+{
+   ALenum format;
+
+   if ( sd->bits == 8 )
+      format = ( sd->channels == 1 ) ? AL_FORMAT_MONO8 : AL_FORMAT_STEREO8;
+   else
+      format = ( sd->channels == 1 ) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+
    soundLock();
+   /* Create new buffer. */
+   alGenBuffers( 1, buf );
+   /* Put into buffer. */
+   alBufferData( *buf, format, sd->data, sd->len, sd->freq );
+   al_checkErr();
+   soundUnlock();
+}
+
+/**
+ * @brief Frees decoded samples.
+ */
+static void al_freeData( alSoundData *sd )
+{
+   if ( sd->wav )
+      SDL_FreeWAV( sd->data );
+   else
+      free( sd->data );
+   memset( sd, 0, sizeof( alSoundData ) );
+}
+
+/**
+ * @brief Uploads decoded samples to a sound, freeing them.
+ */
+static void al_setSound( alSound *snd, alSoundData *sd, const char *name )
+{
+   double bytes = (double)sd->freq * ( sd->bits / 8 ) * sd->channels;
+
+   al_upload( &snd->buf, sd );
 
    /* Get the length of the sound. */
-   alGetBufferi( snd->buf, AL_FREQUENCY, &freq );
-   alGetBufferi( snd->buf, AL_BITS, &bits );
-   alGetBufferi( snd->buf, AL_CHANNELS, &channels );
-   alGetBufferi( snd->buf, AL_SIZE, &size );
-   if ( ( freq == 0 ) || ( bits == 0 ) || ( channels == 0 ) ) {
+   if ( bytes <= 0. ) {
       WARN( _( "Something went wrong when loading sound file '%s'." ), name );
       snd->length = 0;
    } else
-      snd->length = (double)size / (double)( freq * ( bits / 8 ) * channels );
-   snd->channels = channels;
+      snd->length = (double)sd->len / bytes;
+   snd->channels = sd->channels;
 
-   /* Check for errors. */
-   al_checkErr();
+   al_freeData( sd );
+}
 
-   soundUnlock();
+/**
+ * @brief Loads the sound.
+ *
+ *    @param buf Buffer to load.
+ *    @param rw File to load from.
+ *    @param name Name for debugging purposes.
+ */
+int sound_al_buffer( ALuint *buf, SDL_RWops *rw, const char *name )
+{
+   alSoundData sd;
+   int         ret = al_decode( &sd, rw, name );
+   if ( ret != 0 )
+      return ret;
+   al_upload( buf, &sd );
+   al_freeData( &sd );
+   return 0;
+}
 
+/**
+ * @brief Loads the sound.
+ *
+ *    @param snd Sound to load.
+ *    @param rw File to load from.
+ *    @param name Name for debugging purposes.
+ */
+int al_load( alSound *snd, SDL_RWops *rw, const char *name )
+{
+   alSoundData sd;
+   int         ret = al_decode( &sd, rw, name );
+   if ( ret != 0 )
+      return ret;
+   al_setSound( snd, &sd, name );
    return 0;
 }
 
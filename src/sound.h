@@ -84,6 +84,7 @@ int source_new( const char *filename, unsigned int flags );
  * sound sample management
  */
 int    sound_get( const char *name );
+void   sound_prefetch( int sound );
 double sound_getLength( int sound );
 
 /*
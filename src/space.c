@@ -20,6 +20,7 @@
 #include "background.h"
 #include "conf.h"
 #include "damagetype.h"
+#include "datacache.h"
 #include "dev_uniedit.h"
 #include "economy.h"
 #include "gatherable.h"
@@ -32,6 +33,7 @@
 #include "menu.h"
 #include "mission.h"
 #include "music.h"
+#include "nameindex.h"
 #include "ndata.h"
 #include "nebula.h"
 #include "nlua.h"
@@ -90,15 +92,26 @@ static char **systemname_stack =
 StarSystem         *systems_stack = NULL; /**< Star system stack. */
 static Spob        *spob_stack    = NULL; /**< Spob stack. */
 static VirtualSpob *vspob_stack   = NULL; /**< Virtual spob stack. */
-/* TODO get rid of the stack_changed stuff, and just redo all the id/pointer
- * stuff. Main issue will be redoing the Lua system/spob modules to handle such
- * a case, but can be done with  the weapon module as a referenc. */
-static int systemstack_changed =
-   0; /**< Whether or not the systems_stack was changed after loading. */
-static int spobstack_changed =
-   0; /**< Whether or not the spob_stack was changed after loading. */
 static MapShader **mapshaders = NULL; /**< Map shaders. */
 
+/*
+ * Name lookups, rebuilt lazily whenever the stacks change.
+ */
+static NameIndex systems_index;       /**< Name index of systems_stack. */
+static NameIndex systems_index_case;  /**< Case insensitive systems_index. */
+static NameIndex systems_index_trans; /**< Translated system names. */
+static NameIndex spobs_index;         /**< Name index of spob_stack. */
+static NameIndex spobs_index_case;    /**< Case insensitive spobs_index. */
+static NameIndex spobs_index_trans;   /**< Translated spob names. */
+
+static int systems_index_dirty = 1; /**< Whether systems_stack changed. */
+static int spobs_index_dirty   = 1; /**< Whether spob_stack changed. */
+static int systems_index_n     = 0; /**< Systems in the indices. */
+static int spobs_index_n       = 0; /**< Spobs in the indices. */
+
+static const char *systems_index_lang = NULL; /**< Language of the index. */
+static const char *spobs_index_lang   = NULL; /**< Language of the index. */
+
 /*
  * Misc.
  */
@@ -121,9 +134,13 @@ int space_spawn = 1; /**< Spawn enabled by default. */
  * Internal Prototypes.
  */
 /* spob load */
-static int spob_parse( Spob *spob, const char *filename, Commodity **stdList );
-static int space_parseSpobs( xmlNodePtr parent, StarSystem *sys );
-static int spob_parsePresence( xmlNodePtr node, SpobPresence *ap );
+static void spob_clear( Spob *spob );
+static int  spob_parse( Spob *spob, const char *filename, Commodity **stdList );
+static int  space_parseSpobs( xmlNodePtr parent, StarSystem *sys );
+static int  spob_parsePresence( xmlNodePtr node, SpobPresence *ap );
+static void spob_pack( DataCache *dc, const Spob *spob );
+static int  spob_unpack( DataCache *dc, Spob *spob );
+static void spob_free( Spob *spob );
 /* system load */
 static void system_init( StarSystem *sys );
 static int  systems_load( void );
@@ -462,12 +479,95 @@ int spob_rename( Spob *p, char *newname )
    free( p->name );
    p->name = newname;
 
-   /* Order changed, so no more bsearch for us. */
-   spobstack_changed = 1;
+   /* Name changed, so the index has to be redone. */
+   spobs_index_dirty = 1;
 
    return 0;
 }
 
+/**
+ * @brief Renames a system.
+ *
+ *    @param sys System to rename.
+ *    @param newname New name to give the system.
+ *    @return 0 on success.
+ */
+int system_rename( StarSystem *sys, char *newname )
+{
+   free( sys->name );
+   sys->name = newname;
+
+   /* Name changed, so the index has to be redone. */
+   systems_index_dirty = 1;
+
+   return 0;
+}
+
+/**
+ * @brief Builds the translated name index of a stack.
+ *
+ * Translations are never freed, so their pointers stay valid.
+ */
+static void space_indexTrans( NameIndex *idx, const void *base, int n,
+                              size_t size, size_t offset )
+{
+   const char **names = malloc( MAX( n, 1 ) * sizeof( const char * ) );
+   for ( int i = 0; i < n; i++ ) {
+      const char *name =
+         *(const char *const *)( (const char *)base + i * size + offset );
+      names[i] = ( name == NULL ) ? NULL : _( name );
+   }
+   nameindex_build( idx, names, n, NAMEINDEX_CASE );
+   free( names );
+}
+
+/**
+ * @brief Makes sure the system name indices are up to date.
+ */
+static void systems_updateIndex( void )
+{
+   const char *lang = gettext_getLanguage();
+   int         n    = array_size( systems_stack );
+   if ( systems_index_dirty || ( n != systems_index_n ) ) {
+      nameindex_buildStruct( &systems_index, systems_stack,
+                             array_size( systems_stack ), sizeof( StarSystem ),
+                             offsetof( StarSystem, name ), 0 );
+      nameindex_buildStruct( &systems_index_case, systems_stack,
+                             array_size( systems_stack ), sizeof( StarSystem ),
+                             offsetof( StarSystem, name ), NAMEINDEX_CASE );
+   }
+   if ( systems_index_dirty || ( n != systems_index_n ) ||
+        ( lang != systems_index_lang ) )
+      space_indexTrans( &systems_index_trans, systems_stack, n,
+                        sizeof( StarSystem ), offsetof( StarSystem, name ) );
+   systems_index_dirty = 0;
+   systems_index_n     = n;
+   systems_index_lang  = lang;
+}
+
+/**
+ * @brief Makes sure the spob name indices are up to date.
+ */
+static void spobs_updateIndex( void )
+{
+   const char *lang = gettext_getLanguage();
+   int         n    = array_size( spob_stack );
+   if ( spobs_index_dirty || ( n != spobs_index_n ) ) {
+      nameindex_buildStruct( &spobs_index, spob_stack, array_size( spob_stack ),
+                             sizeof( Spob ), offsetof( Spob, name ), 0 );
+      nameindex_buildStruct( &spobs_index_case, spob_stack,
+                             array_size( spob_stack ), sizeof( Spob ),
+                             offsetof( Spob, name ), NAMEINDEX_CASE );
+   }
+   if ( spobs_index_dirty || ( n != spobs_index_n ) ||
+        ( lang != spobs_index_lang ) )
+      space_indexTrans( &spobs_index_trans, spob_stack, n, sizeof( Spob ),
+                        offsetof( Spob, name ) );
+   spobs_index_dirty = 0;
+   spobs_index_n     = n;
+   spobs_index_lang  = lang;
+}
+
 /**
  * @brief Distance at which a pilot can jump.
  */
@@ -699,6 +799,35 @@ const char *space_getRndSpob( int landable, unsigned int services,
    return res;
 }
 
+/**
+ * @brief Query used to find the nearest asteroid in system_getClosest.
+ */
+typedef struct AsteroidNearest_ {
+   const AsteroidAnchor *field; /**< Asteroid field being looked in. */
+   int                   id;    /**< Index of the field. */
+   double                x;     /**< X position to get closest from. */
+   double                y;     /**< Y position to get closest from. */
+} AsteroidNearest;
+
+/**
+ * @brief Filters out asteroids that can't be targeted by the player.
+ */
+static double system_closestAsteroid( void *data, int id )
+{
+   const AsteroidNearest *an = data;
+   const Asteroid        *as = &an->field->asteroids[id];
+
+   /* Skip non-interactive asteroids. */
+   if ( as->state != ASTEROID_FG )
+      return -1.;
+
+   /* Skip out of range asteroids */
+   if ( !pilot_inRangeAsteroid( player.p, id, an->id ) )
+      return -1.;
+
+   return pow2( an->x - as->sol.pos.x ) + pow2( an->y - as->sol.pos.y );
+}
+
 /**
  * @brief Gets the closest feature to a position in the system.
  *
@@ -737,28 +866,18 @@ double system_getClosest( const StarSystem *sys, int *pnt, int *jp, int *ast,
       }
    }
 
-   /* Asteroids. */
+   /* Asteroids, only the foreground ones are in the quadtree. */
    for ( int i = 0; i < array_size( sys->asteroids ); i++ ) {
-      AsteroidAnchor *f = &sys->asteroids[i];
-      for ( int k = 0; k < array_size( f->asteroids ); k++ ) {
-         double    td;
-         Asteroid *as = &f->asteroids[k];
-
-         /* Skip non-interactive asteroids. */
-         if ( as->state != ASTEROID_FG )
-            continue;
-
-         /* Skip out of range asteroids */
-         if ( !pilot_inRangeAsteroid( player.p, k, i ) )
-            continue;
-
-         td = pow2( x - as->sol.pos.x ) + pow2( y - as->sol.pos.y );
-         if ( td < d ) {
-            *pnt = -1; /* We must clear spob target as asteroid is closer. */
-            *ast = k;
-            *fie = i;
-            d    = td;
-         }
+      AsteroidAnchor *f  = &sys->asteroids[i];
+      AsteroidNearest an = { .field = f, .id = i, .x = x, .y = y };
+      double          td;
+      int k = asteroid_collideNearest( f, x, y, d, system_closestAsteroid, &an,
+                                       &td );
+      if ( ( k >= 0 ) && ( td < d ) ) {
+         *pnt = -1; /* We must clear spob target as asteroid is closer. */
+         *ast = k;
+         *fie = i;
+         d    = td;
       }
    }
 
@@ -925,10 +1044,12 @@ StarSystem *system_getAll( void )
  */
 const char *system_existsCase( const char *sysname )
 {
-   for ( int i = 0; i < array_size( systems_stack ); i++ )
-      if ( strcasecmp( sysname, systems_stack[i].name ) == 0 )
-         return systems_stack[i].name;
-   return NULL;
+   int i;
+   systems_updateIndex();
+   i = nameindex_get( &systems_index_case, sysname );
+   if ( i < 0 )
+      i = nameindex_get( &systems_index_trans, sysname );
+   return ( i < 0 ) ? NULL : systems_stack[i].name;
 }
 
 /**
@@ -996,24 +1117,15 @@ static int system_cmp( const void *p1, const void *p2 )
  */
 StarSystem *system_get( const char *sysname )
 {
+   int i;
+
    if ( sysname == NULL )
       return NULL;
 
-   /* Somethig was added, and since we store IDs too, everything can't be sorted
-    * anymore by name... */
-   if ( systemstack_changed ) {
-      for ( int i = 0; i < array_size( systems_stack ); i++ )
-         if ( strcmp( systems_stack[i].name, sysname ) == 0 )
-            return &systems_stack[i];
-      WARN( _( "System '%s' not found in stack" ), sysname );
-      return NULL;
-   }
-
-   const StarSystem s = { .name = (char *)sysname };
-   StarSystem *found  = bsearch( &s, systems_stack, array_size( systems_stack ),
-                                 sizeof( StarSystem ), system_cmp );
-   if ( found != NULL )
-      return found;
+   systems_updateIndex();
+   i = nameindex_get( &systems_index, sysname );
+   if ( i >= 0 )
+      return &systems_stack[i];
 
    WARN( _( "System '%s' not found in stack" ), sysname );
    return NULL;
@@ -1088,26 +1200,17 @@ static int spob_cmp( const void *p1, const void *p2 )
  */
 Spob *spob_get( const char *spobname )
 {
+   int i;
+
    if ( spobname == NULL ) {
       WARN( _( "Trying to find NULL spob…" ) );
       return NULL;
    }
 
-   /* Somethig was added, and since we store IDs too, everything can't be sorted
-    * anymore by name... */
-   if ( spobstack_changed ) {
-      for ( int i = 0; i < array_size( spob_stack ); i++ )
-         if ( strcmp( spob_stack[i].name, spobname ) == 0 )
-            return &spob_stack[i];
-      WARN( _( "Spob '%s' not found in the universe" ), spobname );
-      return NULL;
-   }
-
-   const Spob p     = { .name = (char *)spobname };
-   Spob      *found = bsearch( &p, spob_stack, array_size( spob_stack ),
-                               sizeof( Spob ), spob_cmp );
-   if ( found != NULL )
-      return found;
+   spobs_updateIndex();
+   i = nameindex_get( &spobs_index, spobname );
+   if ( i >= 0 )
+      return &spob_stack[i];
 
    WARN( _( "Spob '%s' not found in the universe" ), spobname );
    return NULL;
@@ -1166,10 +1269,8 @@ void spob_setKnown( Spob *p )
  */
 int spob_exists( const char *spobname )
 {
-   for ( int i = 0; i < array_size( spob_stack ); i++ )
-      if ( strcmp( spob_stack[i].name, spobname ) == 0 )
-         return 1;
-   return 0;
+   spobs_updateIndex();
+   return ( nameindex_get( &spobs_index, spobname ) >= 0 );
 }
 
 /**
@@ -1180,10 +1281,12 @@ int spob_exists( const char *spobname )
  */
 const char *spob_existsCase( const char *spobname )
 {
-   for ( int i = 0; i < array_size( spob_stack ); i++ )
-      if ( strcasecmp( spob_stack[i].name, spobname ) == 0 )
-         return spob_stack[i].name;
-   return NULL;
+   int i;
+   spobs_updateIndex();
+   i = nameindex_get( &spobs_index_case, spobname );
+   if ( i < 0 )
+      i = nameindex_get( &spobs_index_trans, spobname );
+   return ( i < 0 ) ? NULL : spob_stack[i].name;
 }
 
 /**
@@ -1716,6 +1819,8 @@ void space_init( const char *sysname, int do_simulate )
       s              = sound_disabled;
       sound_disabled = 1;
       ntime_allowUpdate( 0 );
+      /* The player isn't there yet, so idle pilots can take coarse steps. */
+      pilots_setLOD( 1 );
       n = SYSTEM_SIMULATE_TIME_PRE / fps_min_simulation;
       for ( int i = 0; i < n; i++ )
          update_routine( fps_min_simulation, 0 );
@@ -1723,6 +1828,7 @@ void space_init( const char *sysname, int do_simulate )
       n                        = SYSTEM_SIMULATE_TIME_POST / fps_min_simulation;
       for ( int i = 0; i < n; i++ )
          update_routine( fps_min_simulation, 0 );
+      pilots_setLOD( 0 );
       ntime_allowUpdate( 1 );
       sound_disabled = s;
    }
@@ -1735,6 +1841,8 @@ void space_init( const char *sysname, int do_simulate )
          if ( pilot_isWithPlayer( p ) )
             pilot_rmFlag( p, PILOT_HIDE );
       }
+      /* They weren't put in the quadtree while hidden. */
+      pilot_sensorInvalidate( 1 );
    }
    space_simulating_effects = 1;
    space_simulating         = 0;
@@ -1777,8 +1885,7 @@ Spob *spob_new( void )
    Spob *p, *old_stack;
    int   realloced;
 
-   if ( !systems_loading )
-      spobstack_changed = 1;
+   spobs_index_dirty = 1;
 
    /* Grow and initialize memory. */
    old_stack = spob_stack;
@@ -1822,15 +1929,116 @@ const char *spob_name( const Spob *p )
    return _( p->name );
 }
 
+/**
+ * @brief Parses the spob files, adding them to a stack.
+ *
+ *    @param[in,out] stack Stack to add the spobs to.
+ *    @param spob_files Files to parse.
+ *    @param[in] stdList The array of standard commodities.
+ */
+static void spobs_parse( Spob **stack, char *const *spob_files,
+                         Commodity **stdList )
+{
+   for ( int i = 0; i < array_size( spob_files ); i++ ) {
+      Spob s;
+      if ( !ndata_matchExt( spob_files[i], "xml" ) )
+         continue;
+      if ( spob_parse( &s, spob_files[i], stdList ) == 0 ) {
+         s.id = array_size( *stack );
+         array_push_back( stack, s );
+      }
+
+      /* Render if necessary. */
+      naev_renderLoadscreen();
+   }
+   qsort( *stack, array_size( *stack ), sizeof( Spob ), spob_cmp );
+}
+
+/**
+ * @brief Adds the spobs stored in a data snapshot to the spob stack.
+ *
+ *    @param dc Snapshot to read from.
+ *    @return 0 on success, -1 if the snapshot is corrupt and nothing was added.
+ */
+static int spobs_unpack( DataCache *dc )
+{
+   int start = array_size( spob_stack );
+   int n     = datacache_readInt( dc );
+   for ( int i = 0; i < n; i++ ) {
+      Spob s;
+      int  ret = spob_unpack( dc, &s );
+      s.id     = array_size( spob_stack );
+      array_push_back( &spob_stack, s );
+      if ( ret == 0 )
+         continue;
+
+      WARN( _( "Data snapshot '%s' is corrupt, parsing the data files "
+               "instead." ),
+            dc->name );
+      for ( int j = start; j < array_size( spob_stack ); j++ )
+         spob_free( &spob_stack[j] );
+      array_resize( &spob_stack, start );
+      return -1;
+   }
+   return 0;
+}
+
+/**
+ * @brief Checks that the spobs loaded from a snapshot match parsing the data
+ * files.
+ *
+ *    @param spob_files Files to parse.
+ *    @param[in] stdList The array of standard commodities.
+ */
+static void spobs_verify( char *const *spob_files, Commodity **stdList )
+{
+   Spob *fresh = array_create( Spob );
+   int   n, bad = 0;
+
+   spobs_parse( &fresh, spob_files, stdList );
+   n = array_size( fresh );
+   if ( n != array_size( spob_stack ) ) {
+      WARN( _( "Data snapshot has %d spobs, but the data files have %d!" ),
+            array_size( spob_stack ), n );
+      bad++;
+   }
+   for ( int i = 0; i < MIN( n, array_size( spob_stack ) ); i++ ) {
+      DataCache dc1, dc2;
+      datacache_init( &dc1, "verify" );
+      datacache_init( &dc2, "verify" );
+      spob_pack( &dc1, &spob_stack[i] );
+      spob_pack( &dc2, &fresh[i] );
+      if ( !datacache_equal( &dc1, &dc2 ) ) {
+         WARN( _( "Spob '%s' in the data snapshot does not match the data "
+                  "files!" ),
+               spob_stack[i].name );
+         bad++;
+      }
+      datacache_free( &dc1 );
+      datacache_free( &dc2 );
+   }
+   for ( int i = 0; i < n; i++ )
+      spob_free( &fresh[i] );
+   array_free( fresh );
+
+   if ( bad == 0 )
+      DEBUG( _( "Verified %d spobs from the data snapshot" ), n );
+}
+
 /**
  * @brief Loads all the spobs in the game.
  *
+ * The parsed spobs are stored in a data snapshot, which is used instead of
+ * parsing on the next start if none of the files changed.
+ *
  *    @return 0 on success.
  */
 static int spobs_load( void )
 {
-   char      **spob_files;
+   char      **spob_files, **comm_files;
    Commodity **stdList;
+   DataCache   dc;
+   int         cached = 0;
 
    /* Initialize stack if needed. */
    if ( spob_stack == NULL )
@@ -1839,30 +2047,44 @@ static int spobs_load( void )
    /* Extract the list of standard commodities. */
    stdList = standard_commodities();
 
-   /* Load XML stuff. */
+   /* Snapshot depends on the commodities and default Lua too. */
    spob_files = ndata_listRecursive( SPOB_DATA_PATH );
-   for ( int i = 0; i < array_size( spob_files ); i++ ) {
-      if ( ndata_matchExt( spob_files[i], "xml" ) ) {
-         Spob s;
-         int  ret = spob_parse( &s, spob_files[i], stdList );
-         if ( ret == 0 ) {
-            s.id = array_size( spob_stack );
-            array_push_back( &spob_stack, s );
-         }
-
-         /* Render if necessary. */
-         naev_renderLoadscreen();
+   comm_files = ndata_listRecursive( COMMODITY_DATA_PATH );
+   datacache_init( &dc, "spobs" );
+   datacache_keyFiles( &dc, spob_files );
+   datacache_keyFiles( &dc, comm_files );
+   datacache_keyFile( &dc, START_DATA_PATH );
+
+   if ( conf.data_cache && ( datacache_load( &dc ) == 0 ) )
+      cached = ( spobs_unpack( &dc ) == 0 );
+
+   if ( !cached ) {
+      /* Load XML stuff. */
+      spobs_parse( &spob_stack, spob_files, stdList );
+
+      /* Store for the next start. */
+      if ( conf.data_cache ) {
+         datacache_writeInt( &dc, array_size( spob_stack ) );
+         for ( int i = 0; i < array_size( spob_stack ); i++ )
+            spob_pack( &dc, &spob_stack[i] );
+         datacache_save( &dc );
       }
+   } else if ( conf.data_cache_verify )
+      spobs_verify( spob_files, stdList );
 
-      /* Clean up. */
-      free( spob_files[i] );
-   }
    qsort( spob_stack, array_size( spob_stack ), sizeof( Spob ), spob_cmp );
    for ( int j = 0; j < array_size( spob_stack ); j++ )
       spob_stack[j].id = j;
+   spobs_index_dirty = 1;
 
    /* Clean up. */
+   datacache_free( &dc );
+   for ( int i = 0; i < array_size( spob_files ); i++ )
+      free( spob_files[i] );
    array_free( spob_files );
+   for ( int i = 0; i < array_size( comm_files ); i++ )
+      free( comm_files[i] );
+   array_free( comm_files );
    array_free( stdList );
 
    return 0;
@@ -2253,6 +2475,32 @@ static int spob_parsePresence( xmlNodePtr node, SpobPresence *ap )
    return 0;
 }
 
+/**
+ * @brief Sets a spob to the defaults before loading it.
+ *
+ *    @param spob Spob to clear.
+ */
+static void spob_clear( Spob *spob )
+{
+   memset( spob, 0, sizeof( Spob ) );
+   spob->hide             = 0.01;
+   spob->radius           = -1.;
+   spob->presence.faction = -1;
+   spob->marker_scale     = 1.; /* Default scale. */
+   /* Lua stuff. */
+   spob->lua_env        = LUA_NOREF;
+   spob->lua_init       = LUA_NOREF;
+   spob->lua_load       = LUA_NOREF;
+   spob->lua_unload     = LUA_NOREF;
+   spob->lua_land       = LUA_NOREF;
+   spob->lua_can_land   = LUA_NOREF;
+   spob->lua_render     = LUA_NOREF;
+   spob->lua_update     = LUA_NOREF;
+   spob->lua_comm       = LUA_NOREF;
+   spob->lua_population = LUA_NOREF;
+   spob->lua_barbg      = LUA_NOREF;
+}
+
 /**
  * @brief Parses a spob from an xml node.
  *
@@ -2280,25 +2528,9 @@ static int spob_parse( Spob *spob, const char *filename, Commodity **stdList )
    }
 
    /* Clear up memory for safe defaults. */
-   memset( spob, 0, sizeof( Spob ) );
-   flags                  = 0;
-   spob->hide             = 0.01;
-   spob->radius           = -1.;
-   spob->presence.faction = -1;
-   spob->marker_scale     = 1.; /* Default scale. */
-   comms                  = array_create( Commodity                  *);
-   /* Lua stuff. */
-   spob->lua_env        = LUA_NOREF;
-   spob->lua_init       = LUA_NOREF;
-   spob->lua_load       = LUA_NOREF;
-   spob->lua_unload     = LUA_NOREF;
-   spob->lua_land       = LUA_NOREF;
-   spob->lua_can_land   = LUA_NOREF;
-   spob->lua_render     = LUA_NOREF;
-   spob->lua_update     = LUA_NOREF;
-   spob->lua_comm       = LUA_NOREF;
-   spob->lua_population = LUA_NOREF;
-   spob->lua_barbg      = LUA_NOREF;
+   spob_clear( spob );
+   flags = 0;
+   comms = array_create( Commodity * );
 
    /* Get the name. */
    xmlr_attr_strd( parent, "name", spob->name );
@@ -2558,6 +2790,210 @@ static int spob_parse( Spob *spob, const char *filename, Commodity **stdList )
    return 0;
 }
 
+/**
+ * @brief Stores a parsed spob in a data snapshot.
+ *
+ * Pointers to other data, such as factions and commodities, are stored by
+ * name so they can be looked up again in spob_unpack().
+ *
+ *    @param dc Snapshot to write to.
+ *    @param spob Spob to store.
+ */
+static void spob_pack( DataCache *dc, const Spob *spob )
+{
+   const char *faction = NULL;
+
+   datacache_writeStr( dc, spob->name );
+   datacache_writeStr( dc, spob->display );
+   datacache_writeStr( dc, spob->feature );
+   datacache_writeDouble( dc, spob->pos.x );
+   datacache_writeDouble( dc, spob->pos.y );
+   datacache_writeDouble( dc, spob->radius );
+   datacache_writeStr( dc,
+                       ( spob->marker != NULL ) ? spob->marker->name : NULL );
+   datacache_writeDouble( dc, spob->marker_scale );
+   datacache_writeStr( dc, spob->class );
+   datacache_writeInt( dc, spob->population );
+
+   if ( spob->presence.faction >= 0 )
+      faction = faction_nameRaw( spob->presence.faction );
+   datacache_writeStr( dc, faction );
+   datacache_writeDouble( dc, spob->presence.base );
+   datacache_writeDouble( dc, spob->presence.bonus );
+   datacache_writeInt( dc, spob->presence.range );
+   datacache_writeDouble( dc, spob->hide );
+
+   datacache_writeStr( dc, spob->description );
+   datacache_writeStr( dc, spob->bar_description );
+   datacache_writeInt( dc, spob->services );
+   datacache_writeInt( dc, spob->flags );
+
+   datacache_writeStr( dc, spob->gfx_spaceName );
+   datacache_writeStr( dc, spob->gfx_spacePath );
+   datacache_writeStr( dc, spob->gfx_exterior );
+   datacache_writeStr( dc, spob->gfx_exteriorPath );
+   datacache_writeStr( dc, spob->gfx_comm );
+   datacache_writeStr( dc, spob->gfx_commPath );
+   datacache_writeStr( dc, spob->lua_file );
+
+   /* Arrays, with -1 elements when they are NULL. */
+   datacache_writeInt( dc, ( spob->tags != NULL ) ? array_size( spob->tags )
+                                                  : -1 );
+   for ( int i = 0; i < array_size( spob->tags ); i++ )
+      datacache_writeStr( dc, spob->tags[i] );
+
+   datacache_writeInt( dc, ( spob->commodities != NULL )
+                              ? array_size( spob->commodities )
+                              : -1 );
+   for ( int i = 0; i < array_size( spob->commodities ); i++ )
+      datacache_writeStr( dc, spob->commodities[i]->name );
+
+   if ( spob->tech != NULL ) {
+      int    n;
+      char **names = tech_getItemNames( spob->tech, &n );
+      datacache_writeInt( dc, n );
+      for ( int i = 0; i < n; i++ ) {
+         datacache_writeStr( dc, names[i] );
+         free( names[i] );
+      }
+      free( names );
+   } else
+      datacache_writeInt( dc, -1 );
+}
+
+/**
+ * @brief Loads a spob stored with spob_pack().
+ *
+ *    @param dc Snapshot to read from.
+ *    @param[out] spob Spob to load, has to be freed even on failure.
+ *    @return 0 on success.
+ */
+static int spob_unpack( DataCache *dc, Spob *spob )
+{
+   char *str;
+   int   n;
+
+   spob_clear( spob );
+   spob->name    = datacache_readStr( dc );
+   spob->display = datacache_readStr( dc );
+   spob->feature = datacache_readStr( dc );
+   spob->pos.x   = datacache_readDouble( dc );
+   spob->pos.y   = datacache_readDouble( dc );
+   spob->radius  = datacache_readDouble( dc );
+   str           = datacache_readStr( dc );
+   if ( str != NULL ) {
+      spob->marker = shaders_getSimple( str );
+      free( str );
+   }
+   spob->marker_scale = datacache_readDouble( dc );
+   spob->class        = datacache_readStr( dc );
+   spob->population   = datacache_readInt( dc );
+
+   str = datacache_readStr( dc );
+   if ( str != NULL ) {
+      spob->presence.faction = faction_get( str );
+      free( str );
+   }
+   spob->presence.base  = datacache_readDouble( dc );
+   spob->presence.bonus = datacache_readDouble( dc );
+   spob->presence.range = datacache_readInt( dc );
+   spob->hide           = datacache_readDouble( dc );
+
+   spob->description     = datacache_readStr( dc );
+   spob->bar_description = datacache_readStr( dc );
+   spob->services        = datacache_readInt( dc );
+   spob->flags           = datacache_readInt( dc );
+
+   spob->gfx_spaceName    = datacache_readStr( dc );
+   spob->gfx_spacePath    = datacache_readStr( dc );
+   spob->gfx_exterior     = datacache_readStr( dc );
+   spob->gfx_exteriorPath = datacache_readStr( dc );
+   spob->gfx_comm         = datacache_readStr( dc );
+   spob->gfx_commPath     = datacache_readStr( dc );
+   spob->lua_file         = datacache_readStr( dc );
+
+   n = datacache_readInt( dc );
+   if ( n >= 0 ) {
+      spob->tags = array_create( char * );
+      for ( int i = 0; i < n && !dc->error; i++ ) {
+         str = datacache_readStr( dc );
+         if ( str != NULL )
+            array_push_back( &spob->tags, str );
+      }
+   }
+
+   n = datacache_readInt( dc );
+   if ( n >= 0 ) {
+      spob->commodityPrice = array_create( CommodityPrice );
+      spob->commodities    = array_create( Commodity    *);
+      for ( int i = 0; i < n && !dc->error; i++ ) {
+         Commodity *com;
+         str = datacache_readStr( dc );
+         com = ( str != NULL ) ? commodity_get( str ) : NULL;
+         if ( com != NULL )
+            spob_addCommodity( spob, com );
+         free( str );
+      }
+      array_shrink( &spob->commodities );
+      array_shrink( &spob->commodityPrice );
+   }
+
+   n = datacache_readInt( dc );
+   if ( n >= 0 ) {
+      spob->tech = tech_groupCreate();
+      for ( int i = 0; i < n && !dc->error; i++ ) {
+         str = datacache_readStr( dc );
+         if ( str != NULL )
+            tech_addItemTech( spob->tech, str );
+         free( str );
+      }
+   }
+
+   return dc->error ? -1 : 0;
+}
+
+/**
+ * @brief Frees a spob.
+ *
+ *    @param spb Spob to free.
+ */
+static void spob_free( Spob *spb )
+{
+   free( spb->name );
+   free( spb->display );
+   free( spb->feature );
+   free( spb->lua_file );
+   free( spb->class );
+   free( spb->description );
+   free( spb->bar_description );
+   for ( int j = 0; j < array_size( spb->tags ); j++ )
+      free( spb->tags[j] );
+   array_free( spb->tags );
+
+   /* graphics */
+   gl_freeTexture( spb->gfx_space );
+   free( spb->gfx_spaceName );
+   free( spb->gfx_spacePath );
+   free( spb->gfx_exterior );
+   free( spb->gfx_exteriorPath );
+   free( spb->gfx_comm );
+   free( spb->gfx_commPath );
+
+   /* Landing. */
+   free( spb->land_msg );
+
+   /* tech */
+   if ( spb->tech != NULL )
+      tech_groupDestroy( spb->tech );
+
+   /* commodities */
+   array_free( spb->commodities );
+   array_free( spb->commodityPrice );
+
+   /* Lua. */
+   nlua_freeEnv( spb->lua_env );
+}
+
 /**
  * @brief Adds a spob to a star system.
  *
@@ -2801,8 +3237,7 @@ StarSystem *system_new( void )
    StarSystem *sys;
    int         id;
 
-   if ( !systems_loading )
-      systemstack_changed = 1;
+   systems_index_dirty = 1;
 
    /* Protect current system in case of realloc. */
    id = -1;
@@ -3041,21 +3476,22 @@ static int system_parseAsteroidExclusion( const xmlNodePtr node,
  */
 static int system_parse( StarSystem *sys, const char *filename )
 {
-   xmlNodePtr node, parent;
-   xmlDocPtr  doc;
-   uint32_t   flags;
-
-   /* Load the file. */
-   doc = xml_parsePhysFS( filename );
-   if ( doc == NULL )
+   xmlTextReaderPtr reader;
+   int              depth, ret;
+   uint32_t         flags;
+
+   /* Load the file. Systems are streamed so only one element is built at a
+    * time, and the jumps are skipped until system_parseJumps(). */
+   reader = xml_readerPhysFS( filename );
+   if ( reader == NULL )
       return -1;
 
-   parent = doc->xmlChildrenNode; /* first spob node */
-   if ( parent == NULL ) {
+   if ( xml_readerRoot( reader, NULL ) ) {
       WARN( _( "Malformed %s file: does not contain elements" ), filename );
-      xmlFreeDoc( doc );
+      xmlFreeTextReader( reader );
       return -1;
    }
+   depth = xmlTextReaderDepth( reader );
 
    /* Clear memory for safe defaults. */
    system_init( sys );
@@ -3065,130 +3501,131 @@ static int system_parse( StarSystem *sys, const char *filename )
    sys->nebu_hue      = NEBULA_DEFAULT_HUE;
    sys->spacedust     = -1;
 
-   xmlr_attr_strd( parent, "name", sys->name );
-
-   node = parent->xmlChildrenNode;
-   do { /* load all the data */
-      /* Only handle nodes. */
-      xml_onlyNodes( node );
+   xmls_attr_strd( reader, "name", sys->name );
 
-      if ( xml_isNode( node, "pos" ) ) {
+   /* Load all the data. */
+   while ( ( ret = xml_readerNextChild( reader, depth ) ) > 0 ) {
+      if ( xmls_isNode( reader, "pos" ) ) {
          flags |= FLAG_POSSET;
-         xmlr_attr_float( node, "x", sys->pos.x );
-         xmlr_attr_float( node, "y", sys->pos.y );
+         xmls_attr_float( reader, "x", sys->pos.x );
+         xmls_attr_float( reader, "y", sys->pos.y );
          continue;
-      } else if ( xml_isNode( node, "general" ) ) {
-         xmlNodePtr cur = node->children;
-         do {
-            xml_onlyNodes( cur );
-            xmlr_strd( cur, "background", sys->background );
-            xmlr_strd( cur, "map_shader", sys->map_shader );
-            xmlr_strd( cur, "features", sys->features );
-            xmlr_int( cur, "spacedust", sys->spacedust );
-            if ( xml_isNode(
-                    cur, "stars" ) ) { /* Rename to "spacedust" in 0.11.0. TODO
-                                          remove sometime around 0.13.0. */
-               sys->spacedust = xml_getInt( cur );
+      } else if ( xmls_isNode( reader, "general" ) ) {
+         while ( xml_readerNextChild( reader, depth + 1 ) > 0 ) {
+            xmls_strd( reader, "background", sys->background );
+            xmls_strd( reader, "map_shader", sys->map_shader );
+            xmls_strd( reader, "features", sys->features );
+            xmls_int( reader, "spacedust", sys->spacedust );
+            if ( xmls_isNode(
+                    reader, "stars" ) ) { /* Rename to "spacedust" in 0.11.0.
+                                             TODO remove sometime around
+                                             0.13.0. */
+               sys->spacedust = xmls_getInt( reader );
                WARN( _( "System '%s' is using deprecated field 'stars'. Use "
                         "'spacedust' instead!" ),
                      sys->name );
             }
-            xmlr_float( cur, "radius", sys->radius );
-            if ( xml_isNode( cur, "interference" ) ) {
+            xmls_float( reader, "radius", sys->radius );
+            if ( xmls_isNode( reader, "interference" ) ) {
                flags |= FLAG_INTERFERENCESET;
-               sys->interference = xml_getFloat( cur );
+               sys->interference = xmls_getFloat( reader );
                continue;
             }
-            if ( xml_isNode( cur, "nebula" ) ) {
+            if ( xmls_isNode( reader, "nebula" ) ) {
                int trails = 0;
-               xmlr_attr_float( cur, "volatility", sys->nebu_volatility );
-               xmlr_attr_float_def( cur, "hue", sys->nebu_hue,
+               xmls_attr_float( reader, "volatility", sys->nebu_volatility );
+               xmls_attr_float_def( reader, "hue", sys->nebu_hue,
                                     NEBULA_DEFAULT_HUE );
-               xmlr_attr_int( cur, "trails", trails );
-               sys->nebu_density = xml_getFloat( cur );
+               xmls_attr_int( reader, "trails", trails );
+               sys->nebu_density = xmls_getFloat( reader );
                if ( trails || ( sys->nebu_density > 0. ) )
                   sys_setFlag( sys, SYSTEM_NEBULATRAIL );
                continue;
             }
-            if ( xml_isNode( cur, "nolanes" ) ) {
+            if ( xmls_isNode( reader, "nolanes" ) ) {
                sys_setFlag( sys, SYSTEM_NOLANES );
                continue;
             }
-            DEBUG( _( "Unknown node '%s' in star system '%s'" ), node->name,
-                   sys->name );
-         } while ( xml_nextNode( cur ) );
+            DEBUG( _( "Unknown node '%s' in star system '%s'" ),
+                   xmlTextReaderConstName( reader ), sys->name );
+         }
          continue;
       }
       /* Loads all the spobs. */
-      else if ( xml_isNode( node, "spobs" ) ) {
-         xmlNodePtr cur = node->children;
-         do {
-            xml_onlyNodes( cur );
-            if ( xml_isNode( cur, "spob" ) ) {
-               system_addSpob( sys, xml_get( cur ) );
+      else if ( xmls_isNode( reader, "spobs" ) ) {
+         while ( xml_readerNextChild( reader, depth + 1 ) > 0 ) {
+            if ( xmls_isNode( reader, "spob" ) ) {
+               char *name = xmls_getStrd( reader );
+               system_addSpob( sys, name );
+               free( name );
                continue;
             }
-            if ( xml_isNode( cur, "spob_virtual" ) ) {
-               system_addVirtualSpob( sys, xml_get( cur ) );
+            if ( xmls_isNode( reader, "spob_virtual" ) ) {
+               char *name = xmls_getStrd( reader );
+               system_addVirtualSpob( sys, name );
+               free( name );
                continue;
             }
-            DEBUG( _( "Unknown node '%s' in star system '%s'" ), node->name,
-                   sys->name );
-         } while ( xml_nextNode( cur ) );
+            DEBUG( _( "Unknown node '%s' in star system '%s'" ),
+                   xmlTextReaderConstName( reader ), sys->name );
+         }
          continue;
       }
 
-      if ( xml_isNode( node, "asteroids" ) ) {
-         xmlNodePtr cur = node->children;
-         do {
-            xml_onlyNodes( cur );
+      /* Asteroid fields are parsed as trees, one at a time. */
+      if ( xmls_isNode( reader, "asteroids" ) ) {
+         while ( xml_readerNextChild( reader, depth + 1 ) > 0 ) {
+            xmlNodePtr cur = xmlTextReaderExpand( reader );
             if ( xml_isNode( cur, "asteroid" ) )
                system_parseAsteroidField( cur, sys );
             else if ( xml_isNode( cur, "exclusion" ) )
                system_parseAsteroidExclusion( cur, sys );
-         } while ( xml_nextNode( cur ) );
+         }
+         continue;
       }
 
-      if ( xml_isNode( node, "stats" ) ) {
-         xmlNodePtr cur = node->children;
-         do {
-            xml_onlyNodes( cur );
-            ShipStatList *ll = ss_listFromXML( cur );
+      if ( xmls_isNode( reader, "stats" ) ) {
+         while ( xml_readerNextChild( reader, depth + 1 ) > 0 ) {
+            xmlNodePtr    cur = xmlTextReaderExpand( reader );
+            ShipStatList *ll  = ( cur == NULL ) ? NULL : ss_listFromXML( cur );
             if ( ll != NULL ) {
                ll->next   = sys->stats;
                sys->stats = ll;
                continue;
             }
             WARN( _( "System '%s' has unknown stat '%s'." ), sys->name,
-                  cur->name );
-         } while ( xml_nextNode( cur ) );
+                  xmlTextReaderConstName( reader ) );
+         }
          continue;
       }
 
-      if ( xml_isNode( node, "tags" ) ) {
-         xmlNodePtr cur = node->children;
-         sys->tags      = array_create( char      *);
-         do {
-            xml_onlyNodes( cur );
-            if ( xml_isNode( cur, "tag" ) ) {
-               const char *tmp = xml_get( cur );
+      if ( xmls_isNode( reader, "tags" ) ) {
+         sys->tags = array_create( char * );
+         while ( xml_readerNextChild( reader, depth + 1 ) > 0 ) {
+            if ( xmls_isNode( reader, "tag" ) ) {
+               char *tmp = xmls_getStrd( reader );
                if ( tmp != NULL )
-                  array_push_back( &sys->tags, strdup( tmp ) );
+                  array_push_back( &sys->tags, tmp );
                continue;
             }
             WARN( _( "System '%s' has unknown node in tags '%s'." ), sys->name,
-                  cur->name );
-         } while ( xml_nextNode( cur ) );
+                  xmlTextReaderConstName( reader ) );
+         }
          continue;
       }
 
       /* Avoid warnings. */
-      if ( xml_isNode( node, "jumps" ) || xml_isNode( node, "asteroids" ) )
+      if ( xmls_isNode( reader, "jumps" ) )
          continue;
 
-      DEBUG( _( "Unknown node '%s' in star system '%s'" ), node->name,
-             sys->name );
-   } while ( xml_nextNode( node ) );
+      DEBUG( _( "Unknown node '%s' in star system '%s'" ),
+             xmlTextReaderConstName( reader ), sys->name );
+   }
+   /* The system is kept since other systems and the spobs already refer to
+    * it, but it's missing whatever came after the error. */
+   if ( ret < 0 )
+      WARN( _( "Star System '%s' is incomplete: '%s' is malformed!" ),
+            sys->name, filename );
 
    ss_sort( &sys->stats );
    array_shrink( &sys->spobs );
@@ -3214,7 +3651,7 @@ static int system_parse( StarSystem *sys, const char *filename )
    MELEMENT( ( flags & FLAG_INTERFERENCESET ) == 0, "inteference" );
 #undef MELEMENT
 
-   xmlFreeDoc( doc );
+   xmlFreeTextReader( reader );
 
    return 0;
 }
@@ -3445,33 +3882,39 @@ static int system_parseJumpPoint( const xmlNodePtr node, StarSystem *sys )
  */
 static int system_parseJumps( StarSystem *sys )
 {
-   xmlNodePtr parent, node;
-   xmlDocPtr  doc;
+   xmlTextReaderPtr reader;
+   int              depth, ret;
 
-   doc = xml_parsePhysFS( sys->filename );
-   if ( doc == NULL )
+   /* Only the jumps are built, the rest of the file is skipped. */
+   reader = xml_readerPhysFS( sys->filename );
+   if ( reader == NULL )
       return -1;
 
-   parent = doc->xmlChildrenNode; /* first spob node */
-   if ( parent == NULL ) {
-      xmlFreeDoc( doc );
+   if ( xml_readerRoot( reader, NULL ) ) {
+      xmlFreeTextReader( reader );
       return -1;
    }
+   depth = xmlTextReaderDepth( reader );
 
-   node = parent->xmlChildrenNode;
-   do { /* load all the data */
-      if ( xml_isNode( node, "jumps" ) ) {
-         xmlNodePtr cur = node->children;
-         do {
+   /* Load all the data. */
+   while ( ( ret = xml_readerNextChild( reader, depth ) ) > 0 ) {
+      if ( xmls_isNode( reader, "jumps" ) ) {
+         while ( xml_readerNextChild( reader, depth + 1 ) > 0 ) {
+            xmlNodePtr cur = xmlTextReaderExpand( reader );
             if ( xml_isNode( cur, "jump" ) )
                system_parseJumpPoint( cur, sys );
-         } while ( xml_nextNode( cur ) );
+         }
       }
-   } while ( xml_nextNode( node ) );
+   }
 
    array_shrink( &sys->jumps );
 
-   xmlFreeDoc( doc );
+   xmlFreeTextReader( reader );
+   if ( ret < 0 ) {
+      WARN( _( "Star System '%s' may be missing jumps: '%s' is malformed!" ),
+            sys->name, sys->filename );
+      return -1;
+   }
    return 0;
 }
 
@@ -3577,6 +4020,7 @@ static int systems_load( void )
       systems_stack[j].id   = j;
       systems_stack[j].note = NULL; /* just to be sure */
    }
+   systems_index_dirty = 1;
 
    /*
     * Second pass - loads all the jump routes.
@@ -3765,44 +4209,13 @@ void space_exit( void )
    array_free( systemname_stack );
 
    /* Free the spobs. */
-   for ( int i = 0; i < array_size( spob_stack ); i++ ) {
-      Spob *spb = &spob_stack[i];
-
-      free( spb->name );
-      free( spb->display );
-      free( spb->feature );
-      free( spb->lua_file );
-      free( spb->class );
-      free( spb->description );
-      free( spb->bar_description );
-      for ( int j = 0; j < array_size( spb->tags ); j++ )
-         free( spb->tags[j] );
-      array_free( spb->tags );
-
-      /* graphics */
-      gl_freeTexture( spb->gfx_space );
-      free( spb->gfx_spaceName );
-      free( spb->gfx_spacePath );
-      free( spb->gfx_exterior );
-      free( spb->gfx_exteriorPath );
-      free( spb->gfx_comm );
-      free( spb->gfx_commPath );
-
-      /* Landing. */
-      free( spb->land_msg );
-
-      /* tech */
-      if ( spb->tech != NULL )
-         tech_groupDestroy( spb->tech );
-
-      /* commodities */
-      array_free( spb->commodities );
-      array_free( spb->commodityPrice );
-
-      /* Lua. */
-      nlua_freeEnv( spb->lua_env );
-   }
+   for ( int i = 0; i < array_size( spob_stack ); i++ )
+      spob_free( &spob_stack[i] );
    array_free( spob_stack );
+   nameindex_free( &spobs_index );
+   nameindex_free( &spobs_index_case );
+   nameindex_free( &spobs_index_trans );
+   spobs_index_dirty = 1;
 
    for ( int i = 0; i < array_size( spob_lua_stack ); i++ )
       spob_lua_free( &spob_lua_stack[i] );
@@ -3845,6 +4258,10 @@ void space_exit( void )
    }
    array_free( systems_stack );
    systems_stack = NULL;
+   nameindex_free( &systems_index );
+   nameindex_free( &systems_index_case );
+   nameindex_free( &systems_index_trans );
+   systems_index_dirty = 1;
 
    /* Free asteroids stuff. */
    asteroids_free();
@@ -4697,7 +5114,7 @@ static nlua_env spob_lua_get( int *mem, const char *filename )
       return LUA_NOREF;
    }
 
-   nlua_env env = nlua_newEnv();
+   nlua_env env = nlua_newEnv( filename );
    nlua_loadStandard( env );
    nlua_loadGFX( env );
    nlua_loadCamera( env );
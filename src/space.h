@@ -418,6 +418,7 @@ void        system_reconstructJumps( StarSystem *sys );
 void        systems_reconstructJumps( void );
 void        systems_reconstructSpobs( void );
 StarSystem *system_new( void );
+int         system_rename( StarSystem *sys, char *newname );
 int         system_addSpob( StarSystem *sys, const char *spobname );
 int         system_rmSpob( StarSystem *sys, const char *spobname );
 int         system_addVirtualSpob( StarSystem *sys, const char *spobname );
@@ -51,6 +51,33 @@
 static TrailSpec   *trail_spec_stack; /**< Trail specifications. */
 static Trail_spfx **trail_spfx_stack; /**< Active trail effects. */
 
+/**
+ * @brief Vertex of a trail segment, see trail.vert.
+ */
+typedef struct TrailVertex_ {
+   GLfloat  x, y;           /**< Position in screen coordinates. */
+   GLfloat  u, v;           /**< Position in the segment. */
+   glColour c;              /**< Colour. */
+   GLfloat  t, len;         /**< Time and length along the trail. */
+   GLfloat  thick1, thick2; /**< Thickness at both ends of the segment. */
+   GLfloat  dt, r;          /**< Timer and random value of the trail. */
+} TrailVertex;
+
+/**
+ * @brief Trail segments that are drawn with the same shader function.
+ */
+typedef struct TrailBatch_ {
+   GLuint       type;     /**< Shader function. */
+   TrailVertex *vertices; /**< Segment vertices (array.h). */
+} TrailBatch;
+
+#define TRAIL_VBO_SEGMENTS                                                     \
+   8192 /**< Segments that fit in the stream before orphaning it. */
+static TrailBatch *trail_batch      = NULL; /**< Batches by shader (array.h). */
+static gl_vbo     *trail_vbo        = NULL; /**< Ring buffer of vertices. */
+static GLsizei     trail_vbo_size   = 0;    /**< Size of trail_vbo in bytes. */
+static GLsizei     trail_vbo_offset = 0;    /**< Write position in trail_vbo. */
+
 /*
  * Special hard-coded special effects
  */
@@ -155,6 +182,8 @@ static void spfx_hapticRumble( double mod );
 static void spfx_update_trails( double dt );
 static void spfx_trail_update( Trail_spfx *trail, double dt );
 static void spfx_trail_free( Trail_spfx *trail );
+static void spfx_trail_build( const Trail_spfx *trail );
+static void spfx_trail_flush( void );
 
 /**
  * @brief For sorting and stuff.
@@ -472,6 +501,12 @@ void spfx_free( void )
       spfx_trail_free( trail_spfx_stack[i] );
    array_free( trail_spfx_stack );
    trail_spfx_stack = NULL;
+   for ( int i = 0; i < array_size( trail_batch ); i++ )
+      array_free( trail_batch[i].vertices );
+   array_free( trail_batch );
+   trail_batch = NULL;
+   gl_vboDestroy( trail_vbo );
+   trail_vbo = NULL;
 
    /* Free the trail styles. */
    for ( int i = 0; i < array_size( trail_spec_stack ); i++ ) {
@@ -854,36 +889,45 @@ static void spfx_trail_free( Trail_spfx *trail )
 }
 
 /**
- * @brief Draws a trail on screen.
+ * @brief Adds the segments of a trail to the batch of its shader function.
  */
-void spfx_trail_draw( const Trail_spfx *trail )
+static void spfx_trail_build( const Trail_spfx *trail )
 {
-   const TrailStyle *styles;
-   size_t            n;
-   GLfloat           len;
-   double            z;
-
-   n = trail_size( trail );
-   if ( n == 0 )
+   /* Corners of the segment quad as two triangles. */
+   static const GLfloat quad[6][2] = { { 0., 0. }, { 1., 0. }, { 0., 1. },
+                                       { 0., 1. }, { 1., 0. }, { 1., 1. } };
+   const TrailStyle    *styles;
+   TrailBatch          *b;
+   GLuint               type;
+   GLfloat              len;
+   double               z;
+
+   if ( trail_size( trail ) == 0 )
       return;
    styles = trail->spec->style;
 
-   /* Stuff that doesn't change for the entire trail. */
-   glUseProgram( shaders.trail.program );
-   if ( gl_has( OPENGL_SUBROUTINES ) )
-      glUniformSubroutinesuiv( GL_FRAGMENT_SHADER, 1, &trail->spec->type );
-   glEnableVertexAttribArray( shaders.trail.vertex );
-   gl_vboActivateAttribOffset( gl_squareVBO, shaders.trail.vertex, 0, 2,
-                               GL_FLOAT, 0 );
-   glUniform1f( shaders.trail.dt, trail->dt );
-   glUniform1f( shaders.trail.r, trail->r );
+   /* Without subroutines, all trails use the default function. */
+   type = gl_has( OPENGL_SUBROUTINES ) ? trail->spec->type : 0;
+   b    = NULL;
+   for ( int i = 0; i < array_size( trail_batch ); i++ ) {
+      if ( trail_batch[i].type == type ) {
+         b = &trail_batch[i];
+         break;
+      }
+   }
+   if ( b == NULL ) {
+      if ( trail_batch == NULL )
+         trail_batch = array_create( TrailBatch );
+      b           = &array_grow( &trail_batch );
+      b->type     = type;
+      b->vertices = array_create( TrailVertex );
+   }
 
    z   = cam_getZoom();
    len = 0.;
    for ( size_t i = trail->iread + 1; i < trail->iwrite; i++ ) {
-      mat4              projection;
       const TrailStyle *sp, *spp;
-      double            x1, y1, x2, y2, s;
+      double            x1, y1, x2, y2, s, dx, dy, w;
       TrailPoint       *tp  = &trail_at( trail, i );
       TrailPoint       *tpp = &trail_at( trail, i - 1 );
 
@@ -908,35 +952,136 @@ void spfx_trail_draw( const Trail_spfx *trail )
       sp  = &styles[tp->mode];
       spp = &styles[tpp->mode];
 
-      /* Set vertex. */
-      projection = gl_view_matrix;
-      mat4_translate_xy( &projection, x1, y1 );
-      mat4_rotate2dv( &projection, ( x2 - x1 ) / s, ( y2 - y1 ) / s );
-      mat4_scale_xy( &projection, s, z * ( sp->thick + spp->thick ) );
-      mat4_translate_xy( &projection, 0., -0.5 );
-
-      /* Set uniforms. */
-      gl_uniformMat4( shaders.trail.projection, &projection );
-      gl_uniformColour( shaders.trail.c1, &sp->col );
-      gl_uniformColour( shaders.trail.c2, &spp->col );
-      glUniform1f( shaders.trail.t1, tp->t );
-      glUniform1f( shaders.trail.t2, tpp->t );
-      glUniform2f( shaders.trail.pos2, len, sp->thick );
+      /* The segment goes from the newer point to the older one, with the
+       * thickness centered on it. */
+      dx = ( x2 - x1 ) / s;
+      dy = ( y2 - y1 ) / s;
+      w  = z * ( sp->thick + spp->thick );
+      for ( int j = 0; j < 6; j++ ) {
+         TrailVertex *v    = &array_grow( &b->vertices );
+         GLfloat      u    = quad[j][0];
+         GLfloat      h    = ( quad[j][1] - 0.5 ) * w;
+         const int    tail = ( u > 0.5 );
+         v->x              = x1 + u * s * dx - h * dy;
+         v->y              = y1 + u * s * dy + h * dx;
+         v->u              = u;
+         v->v              = quad[j][1];
+         v->c              = tail ? spp->col : sp->col;
+         v->t              = tail ? tpp->t : tp->t;
+         v->len            = tail ? len : len + s;
+         v->thick1         = spp->thick;
+         v->thick2         = sp->thick;
+         v->dt             = trail->dt;
+         v->r              = trail->r;
+      }
       len += s;
-      glUniform2f( shaders.trail.pos1, len, spp->thick );
+   }
+}
+
+/**
+ * @brief Draws all the batched trail segments, one call per shader function.
+ */
+static void spfx_trail_flush( void )
+{
+   GLsizei size = 0;
+   GLint   first;
 
-      /* Draw. */
-      glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   for ( int i = 0; i < array_size( trail_batch ); i++ )
+      size += array_size( trail_batch[i].vertices ) * sizeof( TrailVertex );
+   if ( size == 0 )
+      return;
+
+   /* Write after the last frames' data, only orphaning when full. */
+   if ( trail_vbo == NULL ) {
+      trail_vbo_size =
+         MAX( size, 6 * TRAIL_VBO_SEGMENTS * sizeof( TrailVertex ) );
+      trail_vbo = gl_vboCreateStream( trail_vbo_size, NULL );
+   } else if ( trail_vbo_offset + size > trail_vbo_size ) {
+      trail_vbo_size = MAX( size, trail_vbo_size );
+      gl_vboData( trail_vbo, trail_vbo_size, NULL );
+      trail_vbo_offset = 0;
+   }
+   first = trail_vbo_offset / sizeof( TrailVertex );
+   for ( int i = 0; i < array_size( trail_batch ); i++ ) {
+      GLsizei bsize =
+         array_size( trail_batch[i].vertices ) * sizeof( TrailVertex );
+      gl_vboSubData( trail_vbo, trail_vbo_offset, bsize,
+                     trail_batch[i].vertices );
+      trail_vbo_offset += bsize;
+   }
+
+   /* Stuff that doesn't change for any trail. */
+   glUseProgram( shaders.trail.program );
+   gl_uniformMat4( shaders.trail.projection, &gl_view_matrix );
+   glEnableVertexAttribArray( shaders.trail.vertex );
+   glEnableVertexAttribArray( shaders.trail.vertex_pos );
+   glEnableVertexAttribArray( shaders.trail.vertex_colour );
+   glEnableVertexAttribArray( shaders.trail.vertex_time );
+   glEnableVertexAttribArray( shaders.trail.vertex_thick );
+   glEnableVertexAttribArray( shaders.trail.vertex_param );
+   gl_vboActivateAttribOffset( trail_vbo, shaders.trail.vertex,
+                               offsetof( TrailVertex, x ), 2, GL_FLOAT,
+                               sizeof( TrailVertex ) );
+   gl_vboActivateAttribOffset( trail_vbo, shaders.trail.vertex_pos,
+                               offsetof( TrailVertex, u ), 2, GL_FLOAT,
+                               sizeof( TrailVertex ) );
+   gl_vboActivateAttribOffset( trail_vbo, shaders.trail.vertex_colour,
+                               offsetof( TrailVertex, c ), 4, GL_FLOAT,
+                               sizeof( TrailVertex ) );
+   gl_vboActivateAttribOffset( trail_vbo, shaders.trail.vertex_time,
+                               offsetof( TrailVertex, t ), 2, GL_FLOAT,
+                               sizeof( TrailVertex ) );
+   gl_vboActivateAttribOffset( trail_vbo, shaders.trail.vertex_thick,
+                               offsetof( TrailVertex, thick1 ), 2, GL_FLOAT,
+                               sizeof( TrailVertex ) );
+   gl_vboActivateAttribOffset( trail_vbo, shaders.trail.vertex_param,
+                               offsetof( TrailVertex, dt ), 2, GL_FLOAT,
+                               sizeof( TrailVertex ) );
+   gl_stats.states++;
+
+   /* One draw for all the trails sharing a shader function. */
+   for ( int i = 0; i < array_size( trail_batch ); i++ ) {
+      TrailBatch *b = &trail_batch[i];
+      GLsizei     n = array_size( b->vertices );
+      if ( n == 0 )
+         continue;
+      if ( gl_has( OPENGL_SUBROUTINES ) ) {
+         glUniformSubroutinesuiv( GL_FRAGMENT_SHADER, 1, &b->type );
+         gl_stats.states++;
+      }
+      glDrawArrays( GL_TRIANGLES, first, n );
+      first += n;
+      gl_stats.draws++;
+      gl_stats.instances += n / 6;
+      array_erase( &b->vertices, array_begin( b->vertices ),
+                   array_end( b->vertices ) );
    }
 
    /* Clear state. */
    glDisableVertexAttribArray( shaders.trail.vertex );
+   glDisableVertexAttribArray( shaders.trail.vertex_pos );
+   glDisableVertexAttribArray( shaders.trail.vertex_colour );
+   glDisableVertexAttribArray( shaders.trail.vertex_time );
+   glDisableVertexAttribArray( shaders.trail.vertex_thick );
+   glDisableVertexAttribArray( shaders.trail.vertex_param );
    glUseProgram( 0 );
 
    /* Check errors. */
    gl_checkErr();
 }
 
+/**
+ * @brief Draws a trail on screen.
+ *
+ * Used for the trails drawn on top of their pilot, the others are drawn all
+ * at once with the back layer.
+ */
+void spfx_trail_draw( const Trail_spfx *trail )
+{
+   spfx_trail_build( trail );
+   spfx_trail_flush();
+}
+
 /**
  * @brief Increases the current rumble level.
  *
@@ -1066,6 +1211,11 @@ void spfx_cinematic( void )
 
 static void spfx_renderStack( SPFX *spfx_stack )
 {
+   const SPFX_Base *last = NULL; /* Effect whose shader is bound. */
+
+   /* Sprites get drawn together once the shader effects are done. */
+   gl_batchBegin();
+
    for ( int i = array_size( spfx_stack ) - 1; i >= 0; i-- ) {
       SPFX      *spfx   = &spfx_stack[i];
       SPFX_Base *effect = &spfx_effects[spfx->effect];
@@ -1087,17 +1237,21 @@ static void spfx_renderStack( SPFX *spfx_stack )
               ( y > SCREEN_H + h ) )
             continue;
 
-         /* Let's get to business. */
-         glUseProgram( effect->shader );
+         /* Let's get to business, only switching shaders when needed. */
+         if ( ( last == NULL ) || ( last->shader != effect->shader ) ) {
+            if ( last != NULL )
+               glDisableVertexAttribArray( last->vertex );
+            glUseProgram( effect->shader );
+            glEnableVertexAttribArray( effect->vertex );
+            gl_vboActivateAttribOffset( gl_squareVBO, effect->vertex, 0, 2,
+                                        GL_FLOAT, 0 );
+            gl_stats.states++;
+            last = effect;
+         }
 
-         /* Set up the vertex. */
+         /* Set shader uniforms. */
          projection = gl_view_matrix;
          mat4_translate_scale_xy( &projection, x, y, w, h );
-         glEnableVertexAttribArray( effect->vertex );
-         gl_vboActivateAttribOffset( gl_squareVBO, effect->vertex, 0, 2,
-                                     GL_FLOAT, 0 );
-
-         /* Set shader uniforms. */
          gl_uniformMat4( effect->projection, &projection );
          glUniform1f( effect->u_time, spfx->time );
          glUniform1f( effect->u_r, spfx->unique );
@@ -1105,15 +1259,8 @@ static void spfx_renderStack( SPFX *spfx_stack )
 
          /* Draw. */
          glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
-
-         /* Clear state. */
-         glDisableVertexAttribArray( shaders.texture.vertex );
-
-         /* anything failed? */
-         gl_checkErr();
-
-         glUseProgram( 0 );
-
+         gl_stats.draws++;
+         gl_stats.instances++;
       }
       /* No shader. */
       else {
@@ -1130,11 +1277,22 @@ static void spfx_renderStack( SPFX *spfx_stack )
          }
 
          /* Renders */
-         gl_renderSprite( effect->gfx, VX( spfx_stack[i].pos ),
-                          VY( spfx_stack[i].pos ), spfx_stack[i].lastframe % sx,
-                          spfx_stack[i].lastframe / sx, NULL );
+         gl_batchSprite( effect->gfx, VX( spfx_stack[i].pos ),
+                         VY( spfx_stack[i].pos ), spfx_stack[i].lastframe % sx,
+                         spfx_stack[i].lastframe / sx, NULL );
       }
    }
+
+   /* Clear state. */
+   if ( last != NULL ) {
+      glDisableVertexAttribArray( last->vertex );
+      glUseProgram( 0 );
+
+      /* anything failed? */
+      gl_checkErr();
+   }
+
+   gl_batchEnd();
 }
 
 /**
@@ -1164,12 +1322,13 @@ void spfx_render( int layer, double dt )
       spfxL_renderbg( dt );
 
       NTracingZoneName( _ctx_trails, "spfx_render[trails]", 1 );
-      /* Trails are special (for now?). */
+      /* Trails are special, they get built together and drawn by shader. */
       for ( int i = 0; i < array_size( trail_spfx_stack ); i++ ) {
          const Trail_spfx *trail = trail_spfx_stack[i];
          if ( !trail->ontop )
-            spfx_trail_draw( trail );
+            spfx_trail_build( trail );
       }
+      spfx_trail_flush();
       NTracingZoneEnd( _ctx_trails );
       break;
 
@@ -253,14 +253,14 @@ int tech_groupWrite( xmlTextWriterPtr writer, tech_group_t *grp )
  */
 static int tech_parseFile( tech_group_t *tech, const char *file )
 {
-   xmlNodePtr parent;
-   xmlDocPtr  doc = xml_parsePhysFS( file );
-   if ( doc == NULL )
+   /* Only the root element is needed, so don't parse the items yet. */
+   xmlTextReaderPtr reader = xml_readerPhysFS( file );
+   if ( reader == NULL )
       return -1;
 
-   parent = doc->xmlChildrenNode; /* first faction node */
-   if ( parent == NULL ) {
+   if ( xml_readerRoot( reader, NULL ) ) {
       ERR( _( "Malformed '%s' file: does not contain elements" ), file );
+      xmlFreeTextReader( reader );
       return -1;
    }
 
@@ -268,14 +268,13 @@ static int tech_parseFile( tech_group_t *tech, const char *file )
    memset( tech, 0, sizeof( tech_group_t ) );
 
    /* Get name. */
-   xmlr_attr_strd( parent, "name", tech->name );
+   xmls_attr_strd( reader, "name", tech->name );
+   xmlFreeTextReader( reader );
    if ( tech->name == NULL ) {
       WARN( _( "tech node does not have 'name' attribute" ) );
       return 1;
    }
 
-   xmlFreeDoc( doc );
-
    return 0;
 }
 
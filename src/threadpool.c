@@ -108,6 +108,14 @@ struct vpoolThreadData_ {
 };
 typedef struct vpoolThreadData_ vpoolThreadData;
 
+/**
+ * @brief Background job data.
+ */
+typedef struct ThreadRunData_ {
+   ThreadQueueData wrapper; /**< Node that gets queued, runs the job. */
+   ThreadQueueData node;    /**< The job to be done. */
+} ThreadRunData;
+
 /* The global threadpool queue */
 static ThreadQueue *global_queue = NULL;
 
@@ -121,6 +129,7 @@ static void         tq_destroy( ThreadQueue *q );
 static int          threadpool_worker( void *data );
 static int          threadpool_handler( void *data );
 static int          vpool_worker( void *data );
+static int          threadpool_runWorker( void *data );
 
 /**
  * @brief Creates a concurrent queue.
@@ -492,6 +501,45 @@ int threadpool_init( void )
    return 0;
 }
 
+/**
+ * @brief Runs a background job and frees its data.
+ */
+static int threadpool_runWorker( void *data )
+{
+   ThreadRunData *run = (ThreadRunData *)data;
+   int            ret = run->node.function( run->node.data );
+   /* The handler is done with the wrapper once the job runs. */
+   free( run );
+   return ret;
+}
+
+/**
+ * @brief Runs a job in the background without waiting for it.
+ *
+ * Unlike with vpools, nothing waits for the job to finish, so the job has to
+ *  signal when it's done by itself if the result is needed.
+ *
+ *    @param function Function to run.
+ *    @param data Data to pass to the function.
+ */
+void threadpool_run( int ( *function )( void * ), void *data )
+{
+   ThreadRunData *run;
+
+   if ( global_queue == NULL ) {
+      WARN( _( "Threadpool has not been initialized yet!" ) );
+      function( data );
+      return;
+   }
+
+   run                   = malloc( sizeof( ThreadRunData ) );
+   run->node.function    = function;
+   run->node.data        = data;
+   run->wrapper.function = threadpool_runWorker;
+   run->wrapper.data     = run;
+   tq_enqueue( global_queue, &run->wrapper );
+}
+
 /**
  * @brief Creates a new vpool queue.
  *
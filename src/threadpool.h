@@ -20,6 +20,10 @@ typedef struct ThreadQueue_ ThreadQueue;
 /* Initializes the threadpool */
 int threadpool_init( void );
 
+/* Runs a job in the background without waiting for it. The job has to signal
+ * on its own when it is done. */
+void threadpool_run( int ( *function )( void * ), void *data );
+
 /* Creates a new vpool queue. Destroy with vpool_wait. */
 ThreadQueue *vpool_create( void );
 
@@ -36,6 +36,7 @@ static void        iar_updateSpacing( Widget *iar );
 static double      iar_maxPos( Widget *iar );
 static void        iar_setAltTextPos( Widget *iar, double bx, double by );
 static Widget     *iar_getWidget( unsigned int wid, const char *name );
+static void        iar_generate( Widget *iar, int start, int end );
 static const char *toolkit_getNameById( Widget *wgt, int elem );
 /* Clean up. */
 static void iar_cleanup( Widget *iar );
@@ -108,6 +109,9 @@ void window_addImageArray(
    wgt->dat.iar.fptr      = call;
    wgt->dat.iar.rmptr     = rmcall;
    wgt->dat.iar.dblptr    = dblcall;
+   wgt->dat.iar.genptr    = NULL;
+   wgt->dat.iar.altptr    = NULL;
+   wgt->dat.iar.lazydata  = NULL;
    iar_updateSpacing( wgt );
 
    if ( wdw->focus == -1 ) /* initialize the focus */
@@ -126,6 +130,39 @@ static void iar_updateSpacing( Widget *iar )
       ( iar->dat.iar.xelem == 0 ) ? 0 : ( nelem - 1 ) / iar->dat.iar.xelem + 1;
 }
 
+/**
+ * @brief Generates the cells of a lazy image array in a range if needed.
+ *
+ *    @param iar Image array to generate cells of.
+ *    @param start First cell to generate.
+ *    @param end One past the last cell to generate.
+ */
+static void iar_generate( Widget *iar, int start, int end )
+{
+   ImageArrayCell *cells = iar->dat.iar.images;
+
+   if ( iar->dat.iar.genptr == NULL )
+      return;
+
+   start = MAX( start, 0 );
+   end   = MIN( end, iar->dat.iar.nelements );
+   while ( start < end ) {
+      int run;
+
+      /* Skip what is already generated. */
+      if ( cells[start].generated ) {
+         start++;
+         continue;
+      }
+
+      /* Generate the whole run of missing cells at once. */
+      for ( run = start; ( run < end ) && !cells[run].generated; run++ )
+         cells[run].generated = 1;
+      iar->dat.iar.genptr( cells, start, run, iar->dat.iar.lazydata );
+      start = run;
+   }
+}
+
 /**
  * @brief Gets image array effective dimensions.
  */
@@ -192,6 +229,13 @@ static void iar_render( Widget *iar, double bx, double by )
       scroll_pos = iar->dat.iar.pos / hmax;
    toolkit_drawScrollbar( x + iar->w - 10., y, 10., iar->h, scroll_pos );
 
+   /* Only the visible rows have to exist for lazy image arrays. */
+   if ( ( iar->dat.iar.genptr != NULL ) && ( xelem > 0 ) ) {
+      int jstart = floor( iar->dat.iar.pos / ( h + yspace ) );
+      int jend   = ceil( ( iar->dat.iar.pos + iar->h ) / ( h + yspace ) );
+      iar_generate( iar, jstart * xelem, ( jend + 1 ) * xelem );
+   }
+
    /*
     * Main drawing loop.
     */
@@ -308,8 +352,9 @@ static void iar_render( Widget *iar, double bx, double by )
  */
 static void iar_renderOverlay( Widget *iar, double bx, double by )
 {
-   double      x, y;
-   const char *alt;
+   double          x, y;
+   const char     *alt;
+   ImageArrayCell *cell;
 
    /*
     * Draw Alt text if applicable.
@@ -321,8 +366,15 @@ static void iar_renderOverlay( Widget *iar, double bx, double by )
       x = bx + iar->x + iar->dat.iar.altx;
       y = by + iar->y + iar->dat.iar.alty;
 
-      /* Draw alt text. */
-      alt = iar->dat.iar.images[iar->dat.iar.alt].alt;
+      /* Draw alt text, generating it on first hover if lazy. */
+      cell = &iar->dat.iar.images[iar->dat.iar.alt];
+      if ( ( iar->dat.iar.altptr != NULL ) && !cell->altgenerated ) {
+         cell->altgenerated = 1;
+         free( cell->alt );
+         cell->alt = iar->dat.iar.altptr( iar->dat.iar.alt,
+                                          iar->dat.iar.lazydata );
+      }
+      alt = cell->alt;
       if ( alt != NULL )
          toolkit_drawAltText( x, y, alt );
    }
@@ -570,6 +622,7 @@ static void iar_cleanup( Widget *iar )
       array_free( cell->layers );
    }
    free( iar->dat.iar.images );
+   free( iar->dat.iar.lazydata );
 }
 
 /**
@@ -744,6 +797,7 @@ static const char *toolkit_getNameById( Widget *wgt, int elem )
    if ( elem == -1 )
       return NULL;
 
+   iar_generate( wgt, elem, elem + 1 );
    return wgt->dat.iar.images[elem].caption;
 }
 
@@ -792,6 +846,7 @@ int toolkit_setImageArray( unsigned int wid, const char *name,
    }
 
    /* Try to find the element. */
+   iar_generate( wgt, 0, wgt->dat.iar.nelements );
    for ( int i = 0; i < wgt->dat.iar.nelements; i++ ) {
       if ( strcmp( elem, wgt->dat.iar.images[i].caption ) == 0 ) {
          wgt->dat.iar.selected = i;
@@ -1038,3 +1093,33 @@ int toolkit_simImageArrayVisibleElements( int w, int h, int iw, int ih )
    int yelem = floor( ( h - 10 ) / ( ih + 10 + 2 + gl_smallFont.h ) );
    return xelem * yelem;
 }
+
+/**
+ * @brief Makes an image array lazy, only generating cells when they are needed.
+ *
+ * The cells passed when creating the image array should be zeroed out. Cells
+ * get generated the first time they become visible or are looked up, and the
+ * alt text is only generated when first hovered.
+ *
+ *    @param wid Window where image array is.
+ *    @param name Name of the image array.
+ *    @param gen Function to generate the cells from start to end (exclusive).
+ *    @param alt Function to generate the alt text of a cell, or NULL.
+ *    @param data Data to pass to the functions. Gets freed with the widget.
+ */
+void toolkit_setImageArrayLazy( unsigned int wid, const char *name,
+                                void ( *gen )( ImageArrayCell *, int, int,
+                                               void * ),
+                                char *( *alt )( int, void * ), void *data )
+{
+   Widget *wgt = iar_getWidget( wid, name );
+   if ( wgt == NULL ) {
+      free( data );
+      return;
+   }
+
+   free( wgt->dat.iar.lazydata );
+   wgt->dat.iar.genptr   = gen;
+   wgt->dat.iar.altptr   = alt;
+   wgt->dat.iar.lazydata = data;
+}
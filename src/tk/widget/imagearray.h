@@ -17,6 +17,9 @@ typedef struct ImageArrayCell_ {
    const glTexture *sloticon; /**< Icon for type of slot. */
    /* Additional layers can be set if needed. */
    glTexture **layers; /**< Layers to be added. */
+   /* Lazy image arrays. */
+   int generated;    /**< Whether the cell contents have been generated. */
+   int altgenerated; /**< Whether the alt text has been generated. */
 } ImageArrayCell;
 
 /**
@@ -49,6 +52,10 @@ typedef struct WidgetImageArrayData_ {
    void ( *accept )(
       unsigned int,
       const char * ); /**< Accept function pointer (when hitting enter). */
+   void ( *genptr )( ImageArrayCell *, int, int,
+                     void * ); /**< Generates cells of lazy arrays. */
+   char *( *altptr )( int, void * ); /**< Generates alt text of lazy arrays. */
+   void *lazydata; /**< Data passed to the lazy functions, freed on cleanup. */
 } WidgetImageArrayData;
 
 /**
@@ -94,3 +101,7 @@ void   toolkit_setImageArrayAccept( unsigned int wid, const char *name,
                                                   const char   *) );
 int toolkit_getImageArrayVisibleElements( unsigned int wid, const char *name );
 int toolkit_simImageArrayVisibleElements( int w, int h, int iw, int ih );
+void toolkit_setImageArrayLazy( unsigned int wid, const char *name,
+                                void ( *gen )( ImageArrayCell *, int, int,
+                                               void * ),
+                                char *( *alt )( int, void * ), void *data );
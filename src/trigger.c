@@ -0,0 +1,252 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file trigger.c
+ *
+ * @brief Finding the missions and events that can trigger at a location.
+ *
+ * Landing and entering systems used to check every mission and event, most of
+ * which are restricted to a single spob, system or set of factions. Instead,
+ * they get indexed at load time by their most specific restriction, so only
+ * the ones that can match the current location have to be checked.
+ */
+/** @cond */
+#include <stdlib.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "trigger.h"
+
+#include "array.h"
+#include "log.h"
+#include "nstring.h"
+#include "player.h"
+
+static char             *trigger_chapter = NULL; /**< Last chapter matched. */
+static unsigned int      trigger_gen     = 0;    /**< Chapter generation. */
+static pcre2_match_data *trigger_match   = NULL; /**< Reused match data. */
+
+/**
+ * @brief Adds a mission or event to an index.
+ *
+ *    @param idx Index to add to.
+ *    @param id ID of the mission or event data, they must be added in
+ * increasing order.
+ *    @param spob Spob it is restricted to or NULL.
+ *    @param sys System it is restricted to or NULL.
+ *    @param factions Array (array.h) of factions it is restricted to or NULL.
+ */
+void trigger_indexAdd( TriggerIndex *idx, int id, const char *spob,
+                       const char *sys, const int *factions )
+{
+   if ( spob != NULL ) {
+      if ( idx->spob_names == NULL ) {
+         idx->spob_names = array_create( const char * );
+         idx->spob_ids   = array_create( int );
+      }
+      array_push_back( &idx->spob_names, spob );
+      array_push_back( &idx->spob_ids, id );
+   } else if ( sys != NULL ) {
+      if ( idx->sys_names == NULL ) {
+         idx->sys_names = array_create( const char * );
+         idx->sys_ids   = array_create( int );
+      }
+      array_push_back( &idx->sys_names, sys );
+      array_push_back( &idx->sys_ids, id );
+   } else if ( array_size( factions ) > 0 ) {
+      if ( idx->faction_lists == NULL )
+         idx->faction_lists = array_create( int * );
+      for ( int i = 0; i < array_size( factions ); i++ ) {
+         int f = factions[i];
+         if ( f < 0 )
+            continue;
+         while ( array_size( idx->faction_lists ) <= f )
+            array_push_back( &idx->faction_lists, NULL );
+         if ( idx->faction_lists[f] == NULL )
+            idx->faction_lists[f] = array_create( int );
+         /* Factions may be repeated. */
+         if ( ( array_size( idx->faction_lists[f] ) > 0 ) &&
+              ( array_back( idx->faction_lists[f] ) == id ) )
+            continue;
+         array_push_back( &idx->faction_lists[f], id );
+      }
+   } else {
+      if ( idx->generic == NULL )
+         idx->generic = array_create( int );
+      array_push_back( &idx->generic, id );
+   }
+}
+
+/**
+ * @brief Groups the entries of a name bucket by name.
+ */
+static int **trigger_buildNames( NameIndex *nidx, const char **names,
+                                 const int *ids )
+{
+   int   n = array_size( names );
+   int **lists;
+   if ( n <= 0 )
+      return NULL;
+   if ( nameindex_build( nidx, names, n, 0 ) )
+      return NULL;
+   lists = calloc( n, sizeof( int * ) );
+   for ( int i = 0; i < n; i++ ) {
+      int k = nameindex_get( nidx, names[i] );
+      if ( lists[k] == NULL )
+         lists[k] = array_create( int );
+      array_push_back( &lists[k], ids[i] );
+   }
+   return lists;
+}
+
+/**
+ * @brief Builds the index once all the entries have been added.
+ */
+void trigger_indexBuild( TriggerIndex *idx )
+{
+   idx->spob_lists =
+      trigger_buildNames( &idx->spob_index, idx->spob_names, idx->spob_ids );
+   idx->sys_lists =
+      trigger_buildNames( &idx->sys_index, idx->sys_names, idx->sys_ids );
+}
+
+/**
+ * @brief Appends a sorted list of IDs to the query result.
+ */
+static void trigger_queryAppend( int **res, const int *ids )
+{
+   for ( int i = 0; i < array_size( ids ); i++ )
+      array_push_back( res, ids[i] );
+}
+
+/**
+ * @brief Compares IDs for qsort.
+ */
+static int trigger_cmp( const void *p1, const void *p2 )
+{
+   return *(const int *)p1 - *(const int *)p2;
+}
+
+/**
+ * @brief Gets the missions or events that can trigger at a location.
+ *
+ *    @param idx Index to query.
+ *    @param spob Current spob or NULL.
+ *    @param sys Current system or NULL.
+ *    @param faction Current faction, or -1 to not filter by faction.
+ *    @return Frame array (array.h) of candidate IDs in increasing order.
+ */
+int *trigger_indexQuery( const TriggerIndex *idx, const char *spob,
+                         const char *sys, int faction )
+{
+   int *res = array_create_frame( int, 64 );
+   int  k;
+
+   trigger_queryAppend( &res, idx->generic );
+   if ( ( spob != NULL ) &&
+        ( ( k = nameindex_get( &idx->spob_index, spob ) ) >= 0 ) )
+      trigger_queryAppend( &res, idx->spob_lists[k] );
+   if ( ( sys != NULL ) &&
+        ( ( k = nameindex_get( &idx->sys_index, sys ) ) >= 0 ) )
+      trigger_queryAppend( &res, idx->sys_lists[k] );
+   if ( faction < 0 ) {
+      for ( int i = 0; i < array_size( idx->faction_lists ); i++ )
+         trigger_queryAppend( &res, idx->faction_lists[i] );
+   } else if ( faction < array_size( idx->faction_lists ) )
+      trigger_queryAppend( &res, idx->faction_lists[faction] );
+
+   /* Keep the original order, which is by priority. */
+   if ( array_size( res ) > 1 ) {
+      int n = 1;
+      qsort( res, array_size( res ), sizeof( int ), trigger_cmp );
+      for ( int i = 1; i < array_size( res ); i++ )
+         if ( res[i] != res[n - 1] )
+            res[n++] = res[i];
+      array_resize( &res, n );
+   }
+   return res;
+}
+
+/**
+ * @brief Frees the buckets of names.
+ */
+static void trigger_freeNames( NameIndex *nidx, const char **names, int *ids,
+                               int **lists )
+{
+   if ( lists != NULL )
+      for ( int i = 0; i < array_size( names ); i++ )
+         array_free( lists[i] );
+   free( lists );
+   array_free( names );
+   array_free( ids );
+   nameindex_free( nidx );
+}
+
+/**
+ * @brief Frees an index, leaving it empty.
+ */
+void trigger_indexFree( TriggerIndex *idx )
+{
+   trigger_freeNames( &idx->spob_index, idx->spob_names, idx->spob_ids,
+                      idx->spob_lists );
+   trigger_freeNames( &idx->sys_index, idx->sys_names, idx->sys_ids,
+                      idx->sys_lists );
+   for ( int i = 0; i < array_size( idx->faction_lists ); i++ )
+      array_free( idx->faction_lists[i] );
+   array_free( idx->faction_lists );
+   array_free( idx->generic );
+   memset( idx, 0, sizeof( TriggerIndex ) );
+}
+
+/**
+ * @brief Checks to see if the player's chapter matches a regex.
+ *
+ * Results are cached until the chapter changes.
+ *
+ *    @param re Regex to match.
+ *    @param cache Cached result of the regex.
+ *    @param name Name of the mission or event for warnings.
+ *    @return 1 if it matches, 0 otherwise.
+ */
+int trigger_chapterMatch( pcre2_code *re, TriggerChapter *cache,
+                          const char *name )
+{
+   int rc;
+   if ( player.chapter == NULL )
+      return 0;
+
+   /* New chapter invalidates all the cached results. */
+   if ( ( trigger_chapter == NULL ) ||
+        ( strcmp( trigger_chapter, player.chapter ) != 0 ) ) {
+      free( trigger_chapter );
+      trigger_chapter = strdup( player.chapter );
+      trigger_gen++;
+   }
+   /* Generation 0 is never valid so zeroed caches get computed. */
+   if ( cache->gen == trigger_gen )
+      return cache->match;
+
+   if ( trigger_match == NULL )
+      trigger_match = pcre2_match_data_create( 1, NULL );
+   rc = pcre2_match( re, (PCRE2_SPTR)player.chapter, strlen( player.chapter ),
+                     0, 0, trigger_match, NULL );
+   if ( ( rc < 0 ) && ( rc != PCRE2_ERROR_NOMATCH ) )
+      WARN( _( "Matching error %d for chapter of '%s'" ), rc, name );
+   /* A return of 0 only means that the captures didn't fit. */
+   cache->match = ( rc >= 0 );
+   cache->gen   = trigger_gen;
+   return cache->match;
+}
+
+/**
+ * @brief Frees the chapter matching data.
+ */
+void trigger_exit( void )
+{
+   free( trigger_chapter );
+   trigger_chapter = NULL;
+   pcre2_match_data_free( trigger_match );
+   trigger_match = NULL;
+}
@@ -0,0 +1,52 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/** @cond */
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+/** @endcond */
+
+#include "nameindex.h"
+
+/**
+ * @brief Index of the mission or event data that can trigger at a location.
+ *
+ * Each entry goes in the most specific bucket it can: spob, system, faction or
+ * generic. Queries only return candidates, which still have to be fully
+ * checked.
+ */
+typedef struct TriggerIndex_ {
+   const char **spob_names; /**< Array (array.h): Spob name of each entry. */
+   int         *spob_ids;   /**< Array (array.h): Data ID of each entry. */
+   NameIndex    spob_index; /**< Index of the spob names. */
+   int        **spob_lists; /**< Data IDs of each indexed spob name. */
+   const char **sys_names;  /**< Array (array.h): System name of each entry. */
+   int         *sys_ids;    /**< Array (array.h): Data ID of each entry. */
+   NameIndex    sys_index;  /**< Index of the system names. */
+   int        **sys_lists;  /**< Data IDs of each indexed system name. */
+   int **faction_lists; /**< Array (array.h): Data IDs of each faction. */
+   int  *generic;       /**< Array (array.h): Data IDs without restrictions. */
+} TriggerIndex;
+
+/**
+ * @brief Cached result of matching the player's chapter.
+ */
+typedef struct TriggerChapter_ {
+   unsigned int gen;   /**< Chapter generation the result is for. */
+   int          match; /**< Whether the chapter matched. */
+} TriggerChapter;
+
+/* Location index. */
+void trigger_indexAdd( TriggerIndex *idx, int id, const char *spob,
+                       const char *sys, const int *factions );
+void trigger_indexBuild( TriggerIndex *idx );
+int *trigger_indexQuery( const TriggerIndex *idx, const char *spob,
+                         const char *sys, int faction );
+void trigger_indexFree( TriggerIndex *idx );
+
+/* Chapter matching. */
+int  trigger_chapterMatch( pcre2_code *re, TriggerChapter *cache,
+                           const char *name );
+void trigger_exit( void );
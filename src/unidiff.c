@@ -207,31 +207,29 @@ int diff_loadAvailable( void )
    diff_available =
       array_create_size( UniDiffData_t, array_size( diff_files ) );
    for ( int i = 0; i < array_size( diff_files ); i++ ) {
-      xmlDocPtr      doc;
-      xmlNodePtr     node;
-      UniDiffData_t *diff;
+      xmlTextReaderPtr reader;
+      UniDiffData_t   *diff;
 
-      /* Parse the header. */
-      doc = xml_parsePhysFS( diff_files[i] );
-      if ( doc == NULL ) {
+      /* Parse the header, stopping at the root element. */
+      reader = xml_readerPhysFS( diff_files[i] );
+      if ( reader == NULL ) {
          free( diff_files[i] );
          continue;
       }
 
-      node = doc->xmlChildrenNode;
-      if ( !xml_isNode( node, "unidiff" ) ) {
+      if ( xml_readerRoot( reader, "unidiff" ) ) {
          WARN( _( "Malformed XML header for '%s' UniDiff: missing root element "
                   "'%s'" ),
                diff_files[i], "unidiff" );
-         xmlFreeDoc( doc );
+         xmlFreeTextReader( reader );
          free( diff_files[i] );
          continue;
       }
 
       diff           = &array_grow( &diff_available );
       diff->filename = diff_files[i];
-      xmlr_attr_strd( node, "name", diff->name );
-      xmlFreeDoc( doc );
+      xmls_attr_strd( reader, "name", diff->name );
+      xmlFreeTextReader( reader );
    }
    array_free( diff_files );
    array_shrink( &diff_available );
@@ -81,6 +81,9 @@ static Quadtree weapon_quadtree; /**< Quadtree for weapons. */
 static IntList  weapon_qtquery;  /**< For querying collisions. */
 static IntList  weapon_qtexp; /**< For querying collisions from explosions. */
 
+/* Integration. */
+static SolidBatch weapon_batch; /**< Batch for integrating weapon solids. */
+
 /*
  * Prototypes
  */
@@ -111,6 +114,7 @@ static double weapon_computeTimes( double rdir, double rx, double ry,
 static void weapon_render( Weapon *w, double dt );
 static void weapon_updateCollide( Weapon *w, double dt );
 static void weapon_update( Weapon *w, double dt );
+static void weapon_updatePost( Weapon *w );
 static void weapon_sample_trail( Weapon *w );
 /* Destruction. */
 static void weapon_destroy( Weapon *w );
@@ -238,27 +242,25 @@ void weapon_minimap( double res, double w, double h, const RadarShape shape,
       rc = 0;
 
    /* Draw the points for weapons on all layers. */
-   /* TODO potentially do quadtree look-up. Not sure if worth it given that only
-    * weapons with health are currently added to the quadtree. */
+   /* Can't do a quadtree look-up here, since only weapons with health are
+    * added to the quadtree. */
    for ( int i = 0; i < array_size( weapon_stack ); i++ ) {
       double          x, y;
       const glColour *c;
       Weapon         *wp = &weapon_stack[i];
       int             isplayer;
 
-      /* Make sure is in range. */
-      if ( !pilot_inRange( player.p, wp->solid.pos.x, wp->solid.pos.y ) )
-         continue;
-
       /* Get radar position. */
       x = ( wp->solid.pos.x - player.p->solid.pos.x ) / res;
       y = ( wp->solid.pos.y - player.p->solid.pos.y ) / res;
 
-      /* Make sure in range. */
+      /* Make sure in range, cheap radar extent checks first. */
       if ( shape == RADAR_RECT && ( ABS( x ) > w / 2. || ABS( y ) > h / 2. ) )
          continue;
       if ( shape == RADAR_CIRCLE && ( ( ( x ) * ( x ) + ( y ) * ( y ) ) > rc ) )
          continue;
+      if ( !pilot_inRange( player.p, wp->solid.pos.x, wp->solid.pos.y ) )
+         continue;
 
       /* Choose colour based on if it'll hit player. */
       isplayer = ( ( wp->target.type == TARGET_PILOT ) &&
@@ -738,12 +740,21 @@ void weapons_update( double dt )
 {
    NTracingZone( _ctx, 1 );
 
+   /* Think and gather all the solids so they can be integrated at once. */
    for ( int i = 0; i < array_size( weapon_stack ); i++ ) {
       Weapon *w = &weapon_stack[i];
       /* Only increment if weapon wasn't destroyed. */
       if ( !weapon_isFlag( w, WEAPON_FLAG_DESTROYED ) )
          weapon_update( w, dt );
    }
+   solid_batchUpdate( &weapon_batch, dt );
+
+   /* Update what depends on the new positions. */
+   for ( int i = 0; i < array_size( weapon_stack ); i++ ) {
+      Weapon *w = &weapon_stack[i];
+      if ( !weapon_isFlag( w, WEAPON_FLAG_DESTROYED ) )
+         weapon_updatePost( w );
+   }
 
    NTracingZoneEnd( _ctx );
 }
@@ -758,11 +769,14 @@ void weapons_render( const WeaponLayer layer, double dt )
 {
    NTracingZone( _ctx, 1 );
 
+   /* Sprites are drawn in bulk after the beams and shader weapons. */
+   gl_batchBegin();
    for ( int i = 0; i < array_size( weapon_stack ); i++ ) {
       Weapon *w = &weapon_stack[i];
       if ( w->layer == layer )
          weapon_render( w, dt );
    }
+   gl_batchEnd();
 
    NTracingZoneEnd( _ctx );
 }
@@ -881,14 +895,14 @@ static void weapon_render( Weapon *w, double dt )
             }
 
             if ( gfx->tex_end != NULL )
-               gl_renderSpriteInterpolate(
+               gl_batchSpriteInterpolate(
                   tex, gfx->tex_end, w->timer / w->life, w->solid.pos.x,
                   w->solid.pos.y, w->sprite % (int)tex->sx,
                   w->sprite / (int)tex->sx, &c );
             else
-               gl_renderSprite( tex, w->solid.pos.x, w->solid.pos.y,
-                                w->sprite % (int)tex->sx,
-                                w->sprite / (int)tex->sx, &c );
+               gl_batchSprite( tex, w->solid.pos.x, w->solid.pos.y,
+                               w->sprite % (int)tex->sx,
+                               w->sprite / (int)tex->sx, &c );
          }
       }
       /* Outfit faces direction. */
@@ -897,12 +911,12 @@ static void weapon_render( Weapon *w, double dt )
          if ( gfx->tex != NULL ) {
             const glTexture *tex = gfx->tex;
             if ( gfx->tex_end != NULL )
-               gl_renderSpriteInterpolate( tex, gfx->tex_end,
-                                           w->timer / w->life, w->solid.pos.x,
-                                           w->solid.pos.y, w->sx, w->sy, &c );
+               gl_batchSpriteInterpolate( tex, gfx->tex_end,
+                                          w->timer / w->life, w->solid.pos.x,
+                                          w->solid.pos.y, w->sx, w->sy, &c );
             else
-               gl_renderSprite( tex, w->solid.pos.x, w->solid.pos.y, w->sx,
-                                w->sy, &c );
+               gl_batchSprite( tex, w->solid.pos.x, w->solid.pos.y, w->sx,
+                               w->sy, &c );
          } else {
             double r, z;
 
@@ -1447,6 +1461,8 @@ static void weapon_updateCollide( Weapon *w, double dt )
 /**
  * @brief Updates an individual weapon.
  *
+ * The solid is only queued for integration, see weapons_update.
+ *
  *    @param w Weapon to update.
  *    @param dt Current delta tick.
  */
@@ -1456,9 +1472,17 @@ static void weapon_update( Weapon *w, double dt )
    if ( w->think != NULL )
       ( *w->think )( w, dt );
 
-   /* Update the solid position. */
-   ( *w->solid.update )( &w->solid, dt );
+   /* Queue the solid position update. */
+   solid_batchAdd( &weapon_batch, &w->solid );
+}
 
+/**
+ * @brief Updates the parts of a weapon that follow its movement.
+ *
+ *    @param w Weapon to update.
+ */
+static void weapon_updatePost( Weapon *w )
+{
    /* Update the sound. */
    sound_updatePos( w->voice, w->solid.pos.x, w->solid.pos.y, w->solid.vel.x,
                     w->solid.vel.y );
@@ -2814,6 +2838,9 @@ void weapon_exit( void )
    qt_destroy( &weapon_quadtree );
    il_destroy( &weapon_qtquery );
    il_destroy( &weapon_qtexp );
+
+   /* Clean up the integration batch. */
+   solid_batchFree( &weapon_batch );
 }
 
 const IntList *weapon_collideQuery( int x1, int y1, int x2, int y2 )
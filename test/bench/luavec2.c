@@ -0,0 +1,205 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file luavec2.c
+ *
+ * @brief Measures the garbage made by the vec2 Lua API.
+ *
+ * The operators have to create new vectors, while the method forms work in
+ * place and the getters only push numbers, so they shouldn't allocate at all.
+ *
+ * Also covers the pilot handles, which are interned so pushing the same pilot
+ * again shouldn't allocate, and the pilot position and velocity getters.
+ *
+ * Run with "meson test --benchmark lua_vec2".
+ */
+/** @cond */
+#include <lauxlib.h>
+#include <lua.h>
+#include <lualib.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL_timer.h"
+/** @endcond */
+
+#include "collision.h"
+#include "nlua.h"
+#include "nlua_pilot.h"
+#include "nlua_vec2.h"
+
+#define NOPS 200000 /**< Operations per case, with the collector stopped. */
+
+lua_State   *naevL = NULL; /**< State the vectors get registered into. */
+static Pilot bench_pilot;  /**< Only pilot there is, with id 1. */
+
+/**
+ * @brief Case to measure.
+ */
+typedef struct Case_ {
+   const char *name;   /**< Name of the case. */
+   const char *body;   /**< Loop body, with vectors a and b and pilot p in
+                          scope. */
+   int         nogarb; /**< Whether the case should not allocate. */
+} Case;
+
+static const Case cases[] = {
+   { "a = a + b", "a = a + b", 0 },
+   { "a = a * 2", "a = a * 2", 0 },
+   { "a:add(b)", "a:add(b)", 1 },
+   { "a:add(1, 1)", "a:add(1, 1)", 1 },
+   { "a:mul(1)", "a:mul(1)", 1 },
+   { "a:get()", "local x, y = a:get()", 1 },
+   { "a:dist2(b)", "local d = a:dist2(b)", 1 },
+   { "pilot.get()", "local q = pilot.get()", 1 },
+   { "p:pos()", "local v = p:pos()", 0 },
+   { "p:posxy()", "local x, y = p:posxy()", 1 },
+   { "p:vel()", "local v = p:vel()", 0 },
+   { "p:velxy()", "local x, y = p:velxy()", 1 },
+   { NULL, NULL, 0 } };
+
+/*
+ * Stand-ins for what nlua_vec2.c needs from the rest of the game.
+ */
+void nlua_register( nlua_env env, const char *libname, const luaL_Reg *l,
+                    int metatable )
+{
+   (void)env;
+   luaL_newmetatable( naevL, libname );
+   if ( metatable ) {
+      lua_pushvalue( naevL, -1 );
+      lua_setfield( naevL, -2, "__index" );
+   }
+   luaL_register( naevL, NULL, l );
+   lua_setglobal( naevL, libname );
+}
+int CollideLineLine( double s1x, double s1y, double e1x, double e1y, double s2x,
+                     double s2y, double e2x, double e2y, vec2 *crash )
+{
+   (void)s1x, (void)s1y, (void)e1x, (void)e1y;
+   (void)s2x, (void)s2y, (void)e2x, (void)e2y, (void)crash;
+   return 0;
+}
+int CollideLineCircle( const vec2 *p1, const vec2 *p2, const vec2 *cc,
+                       double cr, vec2 crash[2] )
+{
+   (void)p1, (void)p2, (void)cc, (void)cr, (void)crash;
+   return 0;
+}
+Pilot *pilot_get( unsigned int id )
+{
+   return ( id == bench_pilot.id ) ? &bench_pilot : NULL;
+}
+
+/*
+ * Same as the pilot getters in nlua_pilot.c, which can't be linked on its own.
+ */
+static int pilotL_get( lua_State *L )
+{
+   lua_pushpilot( L, bench_pilot.id );
+   return 1;
+}
+static int pilotL_position( lua_State *L )
+{
+   const Pilot *p = luaL_validpilot( L, 1 );
+   lua_pushvector( L, p->solid.pos );
+   return 1;
+}
+static int pilotL_positionXY( lua_State *L )
+{
+   const Pilot *p = luaL_validpilot( L, 1 );
+   lua_pushnumber( L, p->solid.pos.x );
+   lua_pushnumber( L, p->solid.pos.y );
+   return 2;
+}
+static int pilotL_velocity( lua_State *L )
+{
+   const Pilot *p = luaL_validpilot( L, 1 );
+   lua_pushvector( L, p->solid.vel );
+   return 1;
+}
+static int pilotL_velocityXY( lua_State *L )
+{
+   const Pilot *p = luaL_validpilot( L, 1 );
+   lua_pushnumber( L, p->solid.vel.x );
+   lua_pushnumber( L, p->solid.vel.y );
+   return 2;
+}
+static const luaL_Reg pilotL_methods[] = {
+   { "get", pilotL_get },
+   { "pos", pilotL_position },
+   { "posxy", pilotL_positionXY },
+   { "vel", pilotL_velocity },
+   { "velxy", pilotL_velocityXY },
+   { 0, 0 } };
+
+static double elapsed( Uint64 t )
+{
+   return (double)( SDL_GetPerformanceCounter() - t ) /
+          (double)SDL_GetPerformanceFrequency();
+}
+
+static double memused( lua_State *L )
+{
+   return 1024. * lua_gc( L, LUA_GCCOUNT, 0 ) + lua_gc( L, LUA_GCCOUNTB, 0 );
+}
+
+static int run( lua_State *L, const Case *c )
+{
+   char   buf[256];
+   double m, bytes;
+   Uint64 t;
+   double dt;
+
+   snprintf( buf, sizeof( buf ),
+             "local a, b = vec2.new( 1, 2 ), vec2.new( 3, 4 )\n"
+             "local p = pilot.get()\n"
+             "for i = 1, %d do %s end",
+             NOPS, c->body );
+   if ( luaL_loadstring( L, buf ) ) {
+      fprintf( stderr, "%s\n", lua_tostring( L, -1 ) );
+      return 1;
+   }
+
+   lua_gc( L, LUA_GCCOLLECT, 0 );
+   lua_gc( L, LUA_GCSTOP, 0 );
+   m = memused( L );
+   t = SDL_GetPerformanceCounter();
+   if ( lua_pcall( L, 0, 0, 0 ) ) {
+      fprintf( stderr, "%s\n", lua_tostring( L, -1 ) );
+      lua_pop( L, 1 );
+      lua_gc( L, LUA_GCRESTART, 0 );
+      return 1;
+   }
+   dt    = elapsed( t );
+   bytes = ( memused( L ) - m ) / NOPS;
+   lua_gc( L, LUA_GCRESTART, 0 );
+
+   printf( "   %-14s %7.1f ns/op %7.1f bytes/op\n", c->name, 1e9 * dt / NOPS,
+           bytes );
+   if ( c->nogarb && bytes >= 1. ) {
+      fprintf( stderr, "%s should not allocate!\n", c->name );
+      return 1;
+   }
+   return 0;
+}
+
+int main( void )
+{
+   int fail = 0;
+
+   naevL = luaL_newstate();
+   luaL_openlibs( naevL );
+   nlua_loadVector( 0 );
+   nlua_register( 0, PILOT_METATABLE, pilotL_methods, 1 );
+   bench_pilot.id = 1;
+   vec2_cset( &bench_pilot.solid.pos, 1., 2. );
+   vec2_cset( &bench_pilot.solid.vel, 3., 4. );
+
+   for ( int i = 0; cases[i].name != NULL; i++ )
+      fail |= run( naevL, &cases[i] );
+
+   lua_close( naevL );
+   return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file nameindex.c
+ *
+ * @brief Compares name lookups through binary search and the name index.
+ *
+ * Run with "meson test --benchmark name_lookup".
+ */
+/** @cond */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#include "SDL_timer.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "nameindex.h"
+
+#define NNAMES 10000    /**< Number of names in the registry. */
+#define NLOOKUPS 1000000 /**< Number of lookups to time. */
+
+/*
+ * Minimal stand-ins for the engine functions nameindex.c pulls in.
+ */
+int log_warn( const char *file, size_t line, const char *func, const char *fmt,
+              ... )
+{
+   va_list ap;
+   fprintf( stderr, "WARNING %s:%zu [%s]: ", file, line, func );
+   va_start( ap, fmt );
+   vfprintf( stderr, fmt, ap );
+   va_end( ap );
+   fprintf( stderr, "\n" );
+   return 0;
+}
+const char *gettext_ngettext( const char *msgid, const char *msgid_plural,
+                              uint64_t n )
+{
+   return ( ( n == 1 ) || ( msgid_plural == NULL ) ) ? msgid : msgid_plural;
+}
+
+/**
+ * @brief Compares names the way the registries sort them.
+ */
+static int name_cmp( const void *p1, const void *p2 )
+{
+   return strcmp( *(const char **)p1, *(const char **)p2 );
+}
+
+/**
+ * @brief Makes up a name that looks a bit like game data.
+ */
+static char *make_name( int i )
+{
+   static const char *words[] = { "Heavy", "Laser",  "Turret", "Za'lek",
+                                  "Drone", "Cannon", "Shield", "Booster",
+                                  "Sirius", "Ion",   "Bay",    "Mk." };
+   const int          nwords  = sizeof( words ) / sizeof( words[0] );
+   char              *name;
+   SDL_asprintf( &name, "%s %s %s %d", words[rand() % nwords],
+                 words[rand() % nwords], words[rand() % nwords], i );
+   return name;
+}
+
+static double elapsed( Uint64 t )
+{
+   return (double)( SDL_GetPerformanceCounter() - t ) /
+          (double)SDL_GetPerformanceFrequency();
+}
+
+int main( void )
+{
+   char     **names = malloc( NNAMES * sizeof( char * ) );
+   char     **query = malloc( NNAMES * sizeof( char * ) );
+   NameIndex  idx, idxcase;
+   Uint64     t;
+   double     tb, tl, th, tc;
+   long       found;
+   int        fail;
+
+   memset( &idx, 0, sizeof( idx ) );
+   memset( &idxcase, 0, sizeof( idxcase ) );
+   srand( 42 );
+   for ( int i = 0; i < NNAMES; i++ )
+      names[i] = make_name( i );
+   qsort( names, NNAMES, sizeof( char * ), name_cmp );
+   /* Queries are copies so pointer equality can't help. */
+   for ( int i = 0; i < NNAMES; i++ )
+      query[i] = strdup( names[rand() % NNAMES] );
+
+   /* Building. */
+   t = SDL_GetPerformanceCounter();
+   nameindex_build( &idx, (const char *const *)names, NNAMES, 0 );
+   nameindex_build( &idxcase, (const char *const *)names, NNAMES,
+                    NAMEINDEX_CASE );
+   printf( "%d names, built both indices in %.3f ms\n", NNAMES,
+           1e3 * elapsed( t ) );
+
+   /* Binary search like the registries used to do. */
+   found = 0;
+   t     = SDL_GetPerformanceCounter();
+   for ( int i = 0; i < NLOOKUPS; i++ ) {
+      const char *q = query[i % NNAMES];
+      found += ( bsearch( &q, names, NNAMES, sizeof( char * ), name_cmp ) !=
+                 NULL );
+   }
+   tb = elapsed( t );
+
+   /* Hashed lookup. */
+   t = SDL_GetPerformanceCounter();
+   for ( int i = 0; i < NLOOKUPS; i++ )
+      found += ( nameindex_get( &idx, query[i % NNAMES] ) >= 0 );
+   th = elapsed( t );
+
+   /* Case insensitive linear search, on far fewer lookups as it's slow. */
+   t = SDL_GetPerformanceCounter();
+   for ( int i = 0; i < NLOOKUPS / 100; i++ ) {
+      for ( int j = 0; j < NNAMES; j++ ) {
+         if ( strcasecmp( query[i % NNAMES], names[j] ) == 0 ) {
+            found++;
+            break;
+         }
+      }
+   }
+   tl = elapsed( t ) * 100.;
+
+   /* Case insensitive hashed lookup. */
+   t = SDL_GetPerformanceCounter();
+   for ( int i = 0; i < NLOOKUPS; i++ )
+      found += ( nameindex_get( &idxcase, query[i % NNAMES] ) >= 0 );
+   tc = elapsed( t );
+
+   printf( "bsearch:          %.1f ns/lookup\n", 1e9 * tb / NLOOKUPS );
+   printf( "hashed:           %.1f ns/lookup (%.2fx)\n", 1e9 * th / NLOOKUPS,
+           tb / th );
+   printf( "linear (case):    %.1f ns/lookup\n", 1e9 * tl / NLOOKUPS );
+   printf( "hashed (case):    %.1f ns/lookup (%.2fx)\n", 1e9 * tc / NLOOKUPS,
+           tl / tc );
+
+   /* Make sure the index gives the same answers. */
+   fail = ( found != 3L * NLOOKUPS + NLOOKUPS / 100 );
+   for ( int i = 0; i < NNAMES; i++ ) {
+      char *upper = strdup( names[i] );
+      for ( char *c = upper; *c != '\0'; c++ )
+         *c = ( ( *c >= 'a' ) && ( *c <= 'z' ) ) ? *c - 'a' + 'A' : *c;
+      fail |= ( nameindex_get( &idx, names[i] ) != i );
+      fail |= ( nameindex_get( &idx, upper ) >= 0 );
+      fail |= ( nameindex_get( &idxcase, upper ) != i );
+      free( upper );
+   }
+   fail |= ( nameindex_get( &idx, "Not a name" ) >= 0 );
+   if ( fail )
+      fprintf( stderr, "Name index gave wrong results!\n" );
+
+   nameindex_free( &idx );
+   nameindex_free( &idxcase );
+   for ( int i = 0; i < NNAMES; i++ ) {
+      free( names[i] );
+      free( query[i] );
+   }
+   free( names );
+   free( query );
+
+   return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file quadtree.c
+ *
+ * @brief Compares linear scans with the quadtree nearest neighbour queries.
+ *
+ * Run with "meson test --benchmark quadtree_nearest".
+ */
+/** @cond */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL_timer.h"
+/** @endcond */
+
+#include "quadtree.h"
+
+#define RADIUS 15000.  /**< Radius of the system the pilots are in. */
+#define NQUERIES 10000 /**< Number of queries to time. */
+#define K 8            /**< Neighbours to get in the kNN queries. */
+
+/**
+ * @brief Stand-in for a pilot.
+ */
+typedef struct Point_ {
+   double x;        /**< X position. */
+   double y;        /**< Y position. */
+   int    size;     /**< Half size of the bounding box. */
+   int    disabled; /**< Filtered out of the queries. */
+} Point;
+
+/**
+ * @brief Query passed to the filter.
+ */
+typedef struct Query_ {
+   const Point *pts; /**< All the points. */
+   double       x;   /**< X position to query from. */
+   double       y;   /**< Y position to query from. */
+} Query;
+
+static double filter( void *data, int id )
+{
+   const Query *q = data;
+   const Point *p = &q->pts[id];
+   if ( p->disabled )
+      return -1.;
+   return ( q->x - p->x ) * ( q->x - p->x ) + ( q->y - p->y ) * ( q->y - p->y );
+}
+
+static double elapsed( Uint64 t )
+{
+   return (double)( SDL_GetPerformanceCounter() - t ) /
+          (double)SDL_GetPerformanceFrequency();
+}
+
+/**
+ * @brief Linear kNN like the old lookups, keeping a small sorted list.
+ */
+static int linear_knn( int n, Query *q, int *ids, double *d )
+{
+   int found = 0;
+   for ( int i = 0; i < n; i++ ) {
+      double td = filter( q, i );
+      int    j;
+      if ( td < 0. || ( found == K && td >= d[K - 1] ) )
+         continue;
+      j = ( found < K ) ? found++ : K - 1;
+      while ( j > 0 && d[j - 1] > td ) {
+         d[j]   = d[j - 1];
+         ids[j] = ids[j - 1];
+         j--;
+      }
+      d[j]   = td;
+      ids[j] = i;
+   }
+   return found;
+}
+
+static int run( int n )
+{
+   Point   *pts = malloc( n * sizeof( Point ) );
+   Query   *qs  = malloc( NQUERIES * sizeof( Query ) );
+   Quadtree qt;
+   IntList  out;
+   Uint64   t;
+   double   tb, tl, tq, tlk, tqk;
+   long     sum_l, sum_q;
+   int      fail = 0;
+
+   srand( 42 );
+   for ( int i = 0; i < n; i++ ) {
+      pts[i].x        = RADIUS * ( 2. * rand() / RAND_MAX - 1. );
+      pts[i].y        = RADIUS * ( 2. * rand() / RAND_MAX - 1. );
+      pts[i].size     = 10 + rand() % 100;
+      pts[i].disabled = ( rand() % 10 == 0 );
+   }
+   for ( int i = 0; i < NQUERIES; i++ ) {
+      qs[i].pts = pts;
+      qs[i].x   = pts[rand() % n].x + 500. * ( 2. * rand() / RAND_MAX - 1. );
+      qs[i].y   = pts[rand() % n].y + 500. * ( 2. * rand() / RAND_MAX - 1. );
+   }
+
+   /* Building, done once a frame by the game. */
+   t = SDL_GetPerformanceCounter();
+   qt_create( &qt, -RADIUS * 1.1, -RADIUS * 1.1, RADIUS * 1.1, RADIUS * 1.1,
+              2, 5 );
+   for ( int i = 0; i < n; i++ ) {
+      int x = round( pts[i].x );
+      int y = round( pts[i].y );
+      qt_insert( &qt, i, x - pts[i].size, y - pts[i].size, x + pts[i].size,
+                 y + pts[i].size );
+   }
+   tb = elapsed( t );
+   il_create( &out, 1 );
+
+   /* Nearest. */
+   sum_l = 0;
+   t     = SDL_GetPerformanceCounter();
+   for ( int i = 0; i < NQUERIES; i++ ) {
+      int    best = -1;
+      double d    = 0.;
+      for ( int j = 0; j < n; j++ ) {
+         double td = filter( &qs[i], j );
+         if ( td >= 0. && ( best < 0 || td < d ) ) {
+            best = j;
+            d    = td;
+         }
+      }
+      sum_l += best;
+   }
+   tl = elapsed( t );
+
+   sum_q = 0;
+   t     = SDL_GetPerformanceCounter();
+   for ( int i = 0; i < NQUERIES; i++ )
+      sum_q += qt_nearest( &qt, qs[i].x, qs[i].y, -1., filter, &qs[i], NULL );
+   tq = elapsed( t );
+   fail |= ( sum_l != sum_q );
+
+   /* k nearest. */
+   sum_l = 0;
+   t     = SDL_GetPerformanceCounter();
+   for ( int i = 0; i < NQUERIES; i++ ) {
+      int    ids[K];
+      double d[K];
+      int    found = linear_knn( n, &qs[i], ids, d );
+      for ( int j = 0; j < found; j++ )
+         sum_l += ids[j] * ( j + 1 );
+   }
+   tlk = elapsed( t );
+
+   sum_q = 0;
+   t     = SDL_GetPerformanceCounter();
+   for ( int i = 0; i < NQUERIES; i++ ) {
+      int found = qt_knn( &qt, &out, qs[i].x, qs[i].y, K, -1., filter, &qs[i] );
+      for ( int j = 0; j < found; j++ )
+         sum_q += il_get( &out, j, 0 ) * ( j + 1 );
+   }
+   tqk = elapsed( t );
+   fail |= ( sum_l != sum_q );
+
+   printf( "%d pilots, built quadtree in %.3f ms\n", n, 1e3 * tb );
+   printf( "   nearest linear:   %.2f us/query\n", 1e6 * tl / NQUERIES );
+   printf( "   nearest quadtree: %.2f us/query (%.1fx)\n", 1e6 * tq / NQUERIES,
+           tl / tq );
+   printf( "   %d-nn linear:      %.2f us/query\n", K, 1e6 * tlk / NQUERIES );
+   printf( "   %d-nn quadtree:    %.2f us/query (%.1fx)\n", K,
+           1e6 * tqk / NQUERIES, tlk / tqk );
+   if ( fail )
+      fprintf( stderr, "Quadtree gave different results for %d pilots!\n",
+               n );
+
+   il_destroy( &out );
+   qt_destroy( &qt );
+   free( pts );
+   free( qs );
+   return fail;
+}
+
+int main( void )
+{
+   int fail = 0;
+   fail |= run( 1000 );
+   fail |= run( 10000 );
+   return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
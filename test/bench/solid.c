@@ -0,0 +1,126 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file solid.c
+ *
+ * @brief Compares the scalar and batched solid integrators.
+ *
+ * Run with "meson test --benchmark solid_integrate".
+ */
+/** @cond */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL_timer.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "physics.h"
+#include "physics_simd.h"
+
+#define NSOLIDS 10000 /**< Number of solids to integrate. */
+#define NSTEPS 1000   /**< Number of steps to run. */
+#define DT ( 1. / 60. )
+
+/*
+ * Minimal stand-ins for the engine functions physics.c and arena.c pull in.
+ */
+int logprintf( FILE *stream, int newline, const char *fmt, ... )
+{
+   va_list ap;
+   va_start( ap, fmt );
+   vfprintf( stream, fmt, ap );
+   va_end( ap );
+   if ( newline )
+      fputc( '\n', stream );
+   return 0;
+}
+int log_warn( const char *file, size_t line, const char *func, const char *fmt,
+              ... )
+{
+   va_list ap;
+   fprintf( stderr, "WARNING %s:%zu [%s]: ", file, line, func );
+   va_start( ap, fmt );
+   vfprintf( stderr, fmt, ap );
+   va_end( ap );
+   fprintf( stderr, "\n" );
+   return 0;
+}
+const char *gettext_ngettext( const char *msgid, const char *msgid_plural,
+                              uint64_t n )
+{
+   return ( ( n == 1 ) || ( msgid_plural == NULL ) ) ? msgid : msgid_plural;
+}
+
+static void init_solids( Solid *solids )
+{
+   srand( 42 );
+   for ( int i = 0; i < NSOLIDS; i++ ) {
+      Solid *s = &solids[i];
+      vec2   pos, vel;
+      vec2_cset( &pos, 1e4 * rand() / RAND_MAX, 1e4 * rand() / RAND_MAX );
+      vec2_cset( &vel, 100. * rand() / RAND_MAX, 100. * rand() / RAND_MAX );
+      solid_init( s, 1., 2. * M_PI * rand() / RAND_MAX, &pos, &vel,
+                  SOLID_UPDATE_EULER );
+      s->dir_vel = 2. * ( (double)rand() / RAND_MAX - 0.5 );
+      s->accel   = 200. * rand() / RAND_MAX;
+   }
+}
+
+static double elapsed( Uint64 t )
+{
+   return (double)( SDL_GetPerformanceCounter() - t ) /
+          (double)SDL_GetPerformanceFrequency();
+}
+
+int main( void )
+{
+   Solid     *scalar  = malloc( NSOLIDS * sizeof( Solid ) );
+   Solid     *batched = malloc( NSOLIDS * sizeof( Solid ) );
+   SolidBatch batch;
+   Uint64     t;
+   double     ts, tb, err;
+
+   memset( &batch, 0, sizeof( batch ) );
+   init_solids( scalar );
+   init_solids( batched );
+
+   /* Scalar path. */
+   t = SDL_GetPerformanceCounter();
+   for ( int k = 0; k < NSTEPS; k++ )
+      for ( int i = 0; i < NSOLIDS; i++ )
+         scalar[i].update( &scalar[i], DT );
+   ts = elapsed( t );
+
+   /* Batched path, including gathering and scattering. */
+   t = SDL_GetPerformanceCounter();
+   for ( int k = 0; k < NSTEPS; k++ ) {
+      for ( int i = 0; i < NSOLIDS; i++ )
+         solid_batchAdd( &batch, &batched[i] );
+      solid_batchUpdate( &batch, DT );
+   }
+   tb = elapsed( t );
+
+   /* Both should agree up to the approximation error. */
+   err = 0.;
+   for ( int i = 0; i < NSOLIDS; i++ )
+      err = MAX( err, vec2_dist( &scalar[i].pos, &batched[i].pos ) );
+
+   printf( "%d solids, %d steps\n", NSOLIDS, NSTEPS );
+   printf( "scalar:  %.3f s (%.1f ns/solid)\n", ts,
+           1e9 * ts / ( NSOLIDS * NSTEPS ) );
+   printf( "batched: %.3f s (%.1f ns/solid)\n", tb,
+           1e9 * tb / ( NSOLIDS * NSTEPS ) );
+   printf( "speedup: %.2fx, max position error: %g km\n", ts / tb, err );
+
+   solid_batchFree( &batch );
+   free( scalar );
+   free( batched );
+
+   /* Drift beyond this means the kernels have diverged. */
+   return ( err > 1e-3 ) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Packs ndata into a single archive with a hashed index of the paths, which the
+game maps into memory instead of opening and stat'ing thousands of files.
+
+Usage: pack_ndata.py output.npak dir [dir ...]
+
+Files in later directories replace the ones with the same path in earlier
+ones. Relative paths are taken relative to MESON_INSTALL_DESTDIR_PREFIX when
+run as a meson install script. The format is described in
+src/physfs_archiver_npak.c.
+"""
+
+import os
+import struct
+import sys
+
+MAGIC = b'NPAK'
+VERSION = 1
+FLAG_DIR = 1
+ALIGN = 16
+HEADER = struct.Struct('<4sIIIQQ')
+ENTRY = struct.Struct('<QQQIIII')
+
+def fnv1a(data):
+    h = 0xcbf29ce484222325
+    for b in data:
+        h ^= b
+        h = (h * 0x100000001b3) & 0xffffffffffffffff
+    return h
+
+def collect(roots):
+    """ Maps the archive paths to the files and directories (None). """
+    entries = {'': None}
+    for root in roots:
+        for dirpath, dirnames, filenames in os.walk(root, followlinks=True):
+            rel = os.path.relpath(dirpath, root).replace(os.sep, '/')
+            rel = '' if rel == '.' else rel + '/'
+            for d in dirnames:
+                entries.setdefault(rel + d, None)
+            for f in filenames:
+                entries[rel + f] = os.path.join(dirpath, f)
+    return entries
+
+def pack(output, roots):
+    entries = collect(roots)
+    # Sorting by components puts parents before their children, and the
+    # children of a directory in order.
+    paths = sorted(entries, key=lambda p: p.split('/'))
+    index = {p: i for i, p in enumerate(paths)}
+    n = len(paths)
+
+    # Children of each directory as linked lists of entry indices plus one.
+    child = [0] * n
+    nxt = [0] * n
+    last = {}
+    for i, p in enumerate(paths[1:], 1):
+        parent = index[p.rpartition('/')[0]]
+        if parent in last:
+            nxt[last[parent]] = i + 1
+        else:
+            child[parent] = i + 1
+        last[parent] = i
+
+    # Open addressing hash table at most half full.
+    nslots = 1
+    while nslots < 2 * n:
+        nslots *= 2
+    slots = [0] * nslots
+    hashes = [fnv1a(p.encode()) for p in paths]
+    for i, h in enumerate(hashes):
+        s = h & (nslots - 1)
+        while slots[s]:
+            s = (s + 1) & (nslots - 1)
+        slots[s] = i + 1
+
+    entries_off = HEADER.size
+    slots_off = entries_off + ENTRY.size * n
+    names_off = slots_off + 4 * nslots
+    names = bytearray()
+    name_offs = []
+    for p in paths:
+        name_offs.append(names_off + len(names))
+        names += p.encode() + b'\0'
+    data_off = names_off + len(names)
+    data_off += -data_off % ALIGN
+
+    tmp = output + '.tmp'
+    offs = [0] * n
+    sizes = [0] * n
+    with open(tmp, 'wb') as out:
+        out.seek(data_off)
+        for i, p in enumerate(paths):
+            if entries[p] is None:
+                continue
+            with open(entries[p], 'rb') as f:
+                data = f.read()
+            offs[i] = out.tell()
+            sizes[i] = len(data)
+            # NUL terminated so it can be used as a string without copying.
+            out.write(data + b'\0')
+            out.write(b'\0' * (-out.tell() % ALIGN))
+
+        out.seek(0)
+        out.write(HEADER.pack(MAGIC, VERSION, n, nslots, entries_off, slots_off))
+        for i, p in enumerate(paths):
+            flags = FLAG_DIR if entries[p] is None else 0
+            out.write(ENTRY.pack(hashes[i], offs[i], sizes[i], name_offs[i],
+                                 child[i], nxt[i], flags))
+        out.write(struct.pack(f'<{nslots}I', *slots))
+        out.write(names)
+    os.replace(tmp, output)
+    return n
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        sys.exit(f'Usage: {sys.argv[0]} output.npak dir [dir ...]')
+
+    prefix = os.environ.get('MESON_INSTALL_DESTDIR_PREFIX', '')
+    args = [os.path.join(prefix, a) for a in sys.argv[1:]]
+    n = pack(args[0], args[1:])
+    print(f'Packed {n} entries into {args[0]}')